@@ -72,6 +72,18 @@ void GameApp::UpdateScene(float dt)
     {
         ImGui::Text("Third Person Mode");
         ImGui::Text("Hold the right mouse button and drag the view");
+        if (ImGui::CollapsingHeader("Texture Memory"))
+            ImGui::TextUnformatted(m_TextureManager.GetMemoryReport().c_str());
+        if (ImGui::Button("Run Mip Generator Test"))
+            m_MipTest = RunMipGeneratorTest();
+        if (m_MipTest.numChecks)
+        {
+            if (m_MipTest.numFailed)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "FAILED %u/%u: %s",
+                    m_MipTest.numFailed, m_MipTest.numChecks, m_MipTest.firstFailure);
+            else
+                ImGui::Text("Passed %u Checks", m_MipTest.numChecks);
+        }
     }
     ImGui::End();
     ImGui::Render();
@@ -124,6 +136,9 @@ bool GameApp::InitResource()
     
 
     // 初始化房屋模型
+    // 房屋的PNG纹理先在CPU以Kaiser滤波生成mip链，再压缩为BC1，结果缓存为house.png.bc.dds，之后启动直接读取缓存
+    m_TextureManager.SetCpuMipGeneration(true, MipGenerator::Filter::Kaiser, true);
+    m_TextureManager.SetBlockCompression(true, BCEncoder::Quality::Normal, false, true);
     pModel = m_ModelManager.CreateFromFile("..\\Model\\house.obj");
     m_House.SetModel(pModel);
     pModel->SetDebugObjectName("house");
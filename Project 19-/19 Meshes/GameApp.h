@@ -39,6 +39,8 @@ private:
     GameObject m_Ground;										// 地面
 
     std::shared_ptr<ThirdPersonCamera> m_pCamera;				// 摄像机
+
+    MipGeneratorTestResult m_MipTest{};                         // CPU生成mip链的检查结果
 };
 
 
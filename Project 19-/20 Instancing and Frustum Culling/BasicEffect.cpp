@@ -38,6 +38,9 @@ public:
     ComPtr<ID3D11InputLayout> m_pVertexPosNormalTexLayout;
 
     XMFLOAT4X4 m_World{}, m_View{}, m_Proj{};
+
+    ID3D11ShaderResourceView* m_pLastDiffuseMap = nullptr;
+    uint32_t m_DiffuseMapSwitches = 0;
 };
 
 //
@@ -175,7 +178,18 @@ void BasicEffect::SetMaterial(const Material& material)
     pImpl->m_pEffectHelper->GetConstantBufferVariable("g_Material")->SetRaw(&phongMat);
 
     auto pStr = material.TryGet<std::string>("$Diffuse");
-    pImpl->m_pEffectHelper->SetShaderResourceByName("g_DiffuseMap", pStr ? tm.GetTexture(*pStr) : tm.GetNullTexture());
+    ID3D11ShaderResourceView* pDiffuseMap = pStr ? tm.GetTexture(*pStr) : tm.GetNullTexture();
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_DiffuseMap", pDiffuseMap);
+    if (pDiffuseMap != pImpl->m_pLastDiffuseMap)
+    {
+        pImpl->m_pLastDiffuseMap = pDiffuseMap;
+        ++pImpl->m_DiffuseMapSwitches;
+    }
+
+    // 图集中的子区域，见TextureAtlas
+    XMFLOAT4 scaleOffset = material.Has<XMFLOAT4>("$DiffuseScaleOffset") ?
+        material.Get<XMFLOAT4>("$DiffuseScaleOffset") : XMFLOAT4(1.0f, 1.0f, 0.0f, 0.0f);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_DiffuseScaleOffset")->SetFloatVector(4, reinterpret_cast<const float*>(&scaleOffset));
 }
 
 MeshDataInput BasicEffect::GetInputData(const MeshData& meshData)
@@ -224,6 +238,17 @@ void BasicEffect::SetDiffuseColor(const DirectX::XMFLOAT4& color)
     pImpl->m_pEffectHelper->GetConstantBufferVariable("g_ConstantDiffuseColor")->SetFloatVector(4, reinterpret_cast<const float*>(&color));
 }
 
+uint32_t BasicEffect::GetDiffuseMapSwitchCount() const
+{
+    return pImpl->m_DiffuseMapSwitches;
+}
+
+void BasicEffect::ResetDiffuseMapSwitchCount()
+{
+    pImpl->m_pLastDiffuseMap = nullptr;
+    pImpl->m_DiffuseMapSwitches = 0;
+}
+
 void BasicEffect::SetRenderDefault()
 {
     pImpl->m_pCurrEffectPass = pImpl->m_pEffectHelper->GetEffectPass("BasicObject");
@@ -257,7 +282,8 @@ void BasicEffect::DrawInstanced(ID3D11DeviceContext* deviceContext, Buffer& inst
             input.pVertexBuffers.data(), input.strides.data(), input.offsets.data());
         deviceContext->IASetIndexBuffer(input.pIndexBuffer, input.indexCount > 65535 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
 
-        deviceContext->DrawIndexedInstanced(input.indexCount, numObjects, 0, 0, 0);
+        deviceContext->DrawIndexedInstanced(input.indexCount, numObjects,
+            pModel->meshdatas[i].m_StartIndex, pModel->meshdatas[i].m_BaseVertex, 0);
     }
     
 }
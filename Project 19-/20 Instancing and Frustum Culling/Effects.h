@@ -86,6 +86,10 @@ public:
     void SetEyePos(const DirectX::XMFLOAT3& eyePos);
     void SetDiffuseColor(const DirectX::XMFLOAT4& color);
 
+    // 相邻两次SetMaterial之间漫反射纹理发生变化的次数，用于比较图集的效果
+    uint32_t GetDiffuseMapSwitchCount() const;
+    void ResetDiffuseMapSwitchCount();
+
     // 应用常量缓冲区和纹理资源的变更
     void Apply(ID3D11DeviceContext* deviceContext) override;
 
@@ -104,6 +104,11 @@ void GameApp::UpdateScene(float dt)
         {
             m_GpuTimer_Instancing.Reset(m_pd3dImmediateContext.Get());
         }
+        if (ImGui::Checkbox("Enable Texture Atlas", &m_EnableTextureAtlas))
+        {
+            m_Trees.SetModel(m_ModelManager.GetModel(m_EnableTextureAtlas ? "TreesAtlas" : "..\\Model\\tree.obj"));
+            m_GpuTimer_Instancing.Reset(m_pd3dImmediateContext.Get());
+        }
     }
     ImGui::End();
 }
@@ -127,6 +132,8 @@ void GameApp::DrawScene()
     D3D11_VIEWPORT viewport = m_pCamera->GetViewPort();
     m_pd3dImmediateContext->RSSetViewports(1, &viewport);
 
+    m_BasicEffect.ResetDiffuseMapSwitchCount();
+
     // 统计实际绘制的物体数目
     // 是否开启视锥体裁剪
     auto& instancedData = (m_SceneMode == 0 ? m_TreeInstancedData : m_CubeInstancedData);
@@ -217,6 +224,10 @@ void GameApp::DrawScene()
         double avgTime = m_GpuTimer_Instancing.AverageTime();
         
         ImGui::Text("Instance Pass: %.3fms", avgTime * 1000.0);
+        ImGui::Text("Diffuse SRV Switches: %u", m_BasicEffect.GetDiffuseMapSwitchCount());
+        const TextureAtlas::Stats& atlasStats = m_TextureAtlas.GetStats();
+        ImGui::Text("Atlases: %u (%u packed, %u rejected)", atlasStats.numAtlases, atlasStats.numPacked, atlasStats.numRejected);
+        ImGui::Text("Atlas Memory: %.2fMB, Occupancy: %.1f%%", atlasStats.atlasBytes / 1048576.0, atlasStats.occupancy * 100.0f);
     }
     ImGui::End();
     ImGui::Render();
@@ -288,8 +299,15 @@ void GameApp::CreateRandomTrees()
 {
     // 初始化树
     Model* pModel = m_ModelManager.CreateFromFile("..\\Model\\tree.obj");
-    m_Trees.SetModel(pModel);
     pModel->SetDebugObjectName("Trees");
+
+    // 再读取一份同样的模型，把其中格式相同的小纹理打包成图集，便于对比SRV的切换次数
+    Model* pAtlasModel = m_ModelManager.CreateFromFile("TreesAtlas", "..\\Model\\tree.obj");
+    pAtlasModel->SetDebugObjectName("TreesAtlas");
+    m_TextureAtlas.AddModel(*pAtlasModel);
+    m_TextureAtlas.Build("TreeAtlas");
+    m_TextureAtlas.ApplyToModel(*pAtlasModel);
+    m_Trees.SetModel(m_EnableTextureAtlas ? pAtlasModel : pModel);
     XMMATRIX S = XMMatrixScaling(0.015f, 0.015f, 0.015f);
     
     BoundingBox treeBox = m_Trees.GetModel()->boundingbox;
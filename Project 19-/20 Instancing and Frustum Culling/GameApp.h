@@ -14,6 +14,7 @@
 #include <Collision.h>
 #include <ModelManager.h>
 #include <TextureManager.h>
+#include <TextureAtlas.h>
 
 class GameApp : public D3DApp
 {
@@ -36,6 +37,7 @@ private:
     
     TextureManager m_TextureManager;
     ModelManager m_ModelManager;
+    TextureAtlas m_TextureAtlas;                                        // 树的小纹理图集
 
     BasicEffect m_BasicEffect;				                            // 对象渲染特效管理
 
@@ -59,6 +61,7 @@ private:
     
     bool m_EnableFrustumCulling = true;							        // 视锥体裁剪开启
     bool m_EnableInstancing = true;								        // 硬件实例化开启
+    bool m_EnableTextureAtlas = true;                                   // 使用打包了图集的树模型
 
     std::shared_ptr<FirstPersonCamera> m_pCamera;                       // 摄像机
 };
@@ -14,6 +14,7 @@ cbuffer CBChangesEveryInstanceDrawing : register(b0)
 cbuffer CBChangesEveryObjectDrawing : register(b1)
 {
     Material g_Material;
+    float4 g_DiffuseScaleOffset;    // 纹理在图集中的缩放和偏移，不使用图集时为(1, 1, 0, 0)
 }
 
 cbuffer CBChangesEveryFrame : register(b2)
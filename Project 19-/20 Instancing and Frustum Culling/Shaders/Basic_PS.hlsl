@@ -3,7 +3,10 @@
 // 像素着色器(3D)
 float4 PS(VertexPosHWNormalColorTex pIn) : SV_Target
 {
-    float4 texColor = g_DiffuseMap.Sample(g_Sam, pIn.tex) * pIn.color;
+    // 在图集的子区域内模拟重复寻址，梯度按原始纹理坐标计算以保持mip选择
+    float2 texAtlas = frac(pIn.tex) * g_DiffuseScaleOffset.xy + g_DiffuseScaleOffset.zw;
+    float4 texColor = g_DiffuseMap.SampleGrad(g_Sam, texAtlas,
+        ddx(pIn.tex) * g_DiffuseScaleOffset.xy, ddy(pIn.tex) * g_DiffuseScaleOffset.xy) * pIn.color;
     // 提前进行Alpha裁剪，对不符合要求的像素可以避免后续运算
     clip(texColor.a - 0.1f);
 
@@ -272,7 +272,8 @@ void BasicEffect::DrawInstanced(ID3D11DeviceContext* deviceContext, Buffer& inst
             input.pVertexBuffers.data(), input.strides.data(), input.offsets.data());
         deviceContext->IASetIndexBuffer(input.pIndexBuffer, input.indexCount > 65535 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
 
-        deviceContext->DrawIndexedInstanced(input.indexCount, numObjects, 0, 0, 0);
+        deviceContext->DrawIndexedInstanced(input.indexCount, numObjects,
+            pModel->meshdatas[i].m_StartIndex, pModel->meshdatas[i].m_BaseVertex, 0);
     }
 }
 
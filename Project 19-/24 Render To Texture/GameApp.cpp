@@ -10,6 +10,8 @@ GameApp::GameApp(HINSTANCE hInstance, const std::wstring& windowName, int initWi
 
 GameApp::~GameApp()
 {
+    // 等待尚未写完的截图
+    m_FrameCapture.Flush(m_pd3dImmediateContext.Get());
 }
 
 bool GameApp::Init()
@@ -19,6 +21,7 @@ bool GameApp::Init()
 
     m_TextureManager.Init(m_pd3dDevice.Get());
     m_ModelManager.Init(m_pd3dDevice.Get());
+    m_FrameCapture.Init(m_pd3dDevice.Get());
 
     // 务必先初始化所有渲染状态，以供下面的特效使用
     RenderStates::InitAll(m_pd3dDevice.Get());
@@ -111,6 +114,10 @@ void GameApp::UpdateScene(float dt)
         {
             m_PrintScreenStarted = true;
         }
+        ImGui::Checkbox("Record frames (capture_xxxxx.png)", &m_Recording);
+        FrameCapture::Stats stats = m_FrameCapture.GetStats();
+        ImGui::Text("Captured: %u  Written: %u", stats.numCaptured, stats.numWritten);
+        ImGui::Text("Dropped: %u  Failed: %u  Pending: %u", stats.numDropped, stats.numFailed, stats.numPending);
 
         if (ImGui::Button("Exit & Fade out"))
         {
@@ -162,16 +169,23 @@ void GameApp::DrawScene()
         );
     }
 
-    // 保存到output.dds和output.png中
-    if (m_PrintScreenStarted)
+    // 截屏只在这里发起拷贝，几帧之后才读回并在后台线程中写入文件
+    if (m_PrintScreenStarted || m_Recording)
     {
-        ComPtr<ID3D11Texture2D> backBuffer;
-        GetBackBufferRTV()->GetResource(reinterpret_cast<ID3D11Resource**>(backBuffer.GetAddressOf()));
-        // 输出截屏
-        HR(SaveWICTextureToFile(m_pd3dImmediateContext.Get(), backBuffer.Get(), GUID_ContainerFormatJpeg, L"output.jpg", &GUID_WICPixelFormat24bppBGR));
+        ComPtr<ID3D11Resource> backBuffer;
+        GetBackBufferRTV()->GetResource(backBuffer.GetAddressOf());
+        if (m_PrintScreenStarted)
+            m_FrameCapture.Capture(m_pd3dImmediateContext.Get(), backBuffer.Get(), L"output.jpg", FrameCapture::FileFormat::JPEG);
+        if (m_Recording)
+        {
+            wchar_t fileName[32];
+            swprintf_s(fileName, L"capture_%05u.png", m_RecordIndex++);
+            m_FrameCapture.Capture(m_pd3dImmediateContext.Get(), backBuffer.Get(), fileName, FrameCapture::FileFormat::PNG);
+        }
         // 结束截屏
         m_PrintScreenStarted = false;
     }
+    m_FrameCapture.Update(m_pd3dImmediateContext.Get());
 
     ID3D11RenderTargetView* pRTVs[] = { GetBackBufferRTV() };
     m_pd3dImmediateContext->OMSetRenderTargets(1, pRTVs, nullptr);
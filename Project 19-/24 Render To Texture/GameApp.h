@@ -14,6 +14,7 @@
 #include <Collision.h>
 #include <ModelManager.h>
 #include <TextureManager.h>
+#include <FrameCapture.h>
 
 #include <ScreenGrab11.h>
 #include <wincodec.h> // 使用ScreenGrab11.h需要
@@ -55,7 +56,10 @@ private:
 
     std::unique_ptr<FirstPersonCamera> m_pCamera;				        // 摄像机
 
+    FrameCapture m_FrameCapture;                                        // 异步截图
     bool m_PrintScreenStarted = false;						            // 截屏当前帧
+    bool m_Recording = false;                                           // 连续截取每一帧
+    uint32_t m_RecordIndex = 0;
     bool m_FadeUsed = true;										        // 是否使用淡入/淡出
     float m_FadeAmount = 0.0f;							                // 淡入/淡出系数
     float m_FadeSign = 1.0f;								            // 1.0f表示淡入，-1.0f表示淡出
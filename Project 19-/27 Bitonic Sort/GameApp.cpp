@@ -1,4 +1,6 @@
 #include "GameApp.h"
+#include <ThreadPool.h>
+#include <numeric>
 
 using namespace DirectX;
 
@@ -26,191 +28,203 @@ void GameApp::Compute()
 {
     assert(m_pd3dImmediateContext);
 
-//#if defined(DEBUG) | defined(_DEBUG)
-//	ComPtr<IDXGraphicsAnalysis> graphicsAnalysis;
-//	HR(DXGIGetDebugInterface1(0, __uuidof(graphicsAnalysis.Get()), reinterpret_cast<void**>(graphicsAnalysis.GetAddressOf())));
-//	graphicsAnalysis->BeginCapture();
-//#endif
+    ThreadPool& threadPool = ThreadPool::GetDefault();
+    std::mt19937_64 randEngine64(1234);
 
-    // GPU排序
-    m_Timer.Reset();
-    m_Timer.Start();
-    m_GpuTimer.Init(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
-    m_GpuTimer.Start();
-    GPUSort();
-    m_GpuTimer.Stop();
-    double gpuComputeTime = m_GpuTimer.GetTime();
-
-    // 结果回读到CPU进行比较
-    m_pd3dImmediateContext->CopyResource(m_pTypedBufferCopy.Get(), m_pTypedBuffer1.Get());
-    D3D11_MAPPED_SUBRESOURCE mappedData;
-    m_pd3dImmediateContext->Map(m_pTypedBufferCopy.Get(), 0, D3D11_MAP_READ, 0, &mappedData);
-    m_Timer.Tick();
-    m_Timer.Stop();
-    float gpuTotalTime = m_Timer.TotalTime();
-
-//#if defined(DEBUG) | defined(_DEBUG)
-//	graphicsAnalysis->EndCapture();
-//#endif
+    std::wstring wstr = L"单位：毫秒。CPU多线程使用" + std::to_wstring(threadPool.GetThreadCount() + 1) + L"个线程\n";
+    wstr += L"元素数目: GPU计算 / GPU总计 | std::sort / 基数排序 / 多线程基数排序 | "
+        L"64位键 std::sort / 多线程基数排序 | 键值对 std::sort / 多线程基数排序\n";
+    bool allSame = true;
+    for (UINT log2Count = 9; (1ull << log2Count) <= m_RandomNums.size(); ++log2Count)
+    {
+        UINT count = 1u << log2Count;
+
+        // GPU排序
+        std::vector<uint32_t> gpuResult;
+        float gpuTotalTime = 0.0f;
+        double gpuComputeTime = GPUSort(m_GpuSort, count, false, gpuResult, gpuTotalTime);
+
+        // 小规模时重复多次取平均
+        UINT reps = (std::max)(1u, (1u << 20) / count);
+        std::vector<uint32_t> keys((size_t)count * reps), values((size_t)count * reps);
+        auto PrepareKeys = [&] {
+            for (UINT r = 0; r < reps; ++r)
+                std::copy(m_RandomNums.begin(), m_RandomNums.begin() + count, keys.begin() + (size_t)r * count);
+        };
+        auto MeasureKeys = [&](auto&& sortFunc) {
+            PrepareKeys();
+            m_Timer.Reset();
+            m_Timer.Start();
+            for (UINT r = 0; r < reps; ++r)
+                sortFunc(keys.data() + (size_t)r * count);
+            m_Timer.Tick();
+            m_Timer.Stop();
+            // 检查第一份的结果是否有序
+            allSame &= std::is_sorted(keys.begin(), keys.begin() + count);
+            return m_Timer.TotalTime() / reps;
+        };
+
+        // CPU排序
+        float cpuStdSortTime = MeasureKeys([&](uint32_t* pKeys) { std::sort(pKeys, pKeys + count); });
+        allSame &= std::equal(gpuResult.begin(), gpuResult.end(), keys.begin());
+        std::vector<uint32_t> sortedKeys(keys.begin(), keys.begin() + count);
+
+        float cpuRadixTime = MeasureKeys([&](uint32_t* pKeys) { CpuSort::RadixSort(pKeys, count); });
+        allSame &= std::equal(sortedKeys.begin(), sortedKeys.end(), keys.begin());
+        float cpuParallelRadixTime = MeasureKeys([&](uint32_t* pKeys) { CpuSort::RadixSort(pKeys, count, &threadPool); });
+        allSame &= std::equal(sortedKeys.begin(), sortedKeys.end(), keys.begin());
+
+        // 64位键
+        std::vector<uint64_t> keys64Src(count), keys64((size_t)count * reps);
+        std::generate(keys64Src.begin(), keys64Src.end(), [&] { return randEngine64(); });
+        auto MeasureKeys64 = [&](auto&& sortFunc) {
+            for (UINT r = 0; r < reps; ++r)
+                std::copy(keys64Src.begin(), keys64Src.end(), keys64.begin() + (size_t)r * count);
+            m_Timer.Reset();
+            m_Timer.Start();
+            for (UINT r = 0; r < reps; ++r)
+                sortFunc(keys64.data() + (size_t)r * count);
+            m_Timer.Tick();
+            m_Timer.Stop();
+            allSame &= std::is_sorted(keys64.begin(), keys64.begin() + count);
+            return m_Timer.TotalTime() / reps;
+        };
+        float cpuStdSort64Time = MeasureKeys64([&](uint64_t* pKeys) { std::sort(pKeys, pKeys + count); });
+        float cpuParallelRadix64Time = MeasureKeys64([&](uint64_t* pKeys) { CpuSort::RadixSort(pKeys, count, &threadPool); });
+
+        // 键值对：值为元素原来的下标，用于对深度排序后的绘制顺序等
+        std::vector<std::pair<uint32_t, uint32_t>> pairs((size_t)count * reps);
+        for (UINT r = 0; r < reps; ++r)
+            for (UINT i = 0; i < count; ++i)
+                pairs[(size_t)r * count + i] = { m_RandomNums[i], i };
+        m_Timer.Reset();
+        m_Timer.Start();
+        for (UINT r = 0; r < reps; ++r)
+        {
+            std::sort(pairs.begin() + (size_t)r * count, pairs.begin() + (size_t)(r + 1) * count,
+                [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        }
+        m_Timer.Tick();
+        m_Timer.Stop();
+        float cpuStdSortPairsTime = m_Timer.TotalTime() / reps;
+
+        PrepareKeys();
+        for (UINT r = 0; r < reps; ++r)
+            std::iota(values.begin() + (size_t)r * count, values.begin() + (size_t)(r + 1) * count, 0u);
+        m_Timer.Reset();
+        m_Timer.Start();
+        for (UINT r = 0; r < reps; ++r)
+            CpuSort::RadixSort(keys.data() + (size_t)r * count, values.data() + (size_t)r * count, count, &threadPool);
+        m_Timer.Tick();
+        m_Timer.Stop();
+        float cpuParallelRadixPairsTime = m_Timer.TotalTime() / reps;
+        allSame &= std::equal(sortedKeys.begin(), sortedKeys.end(), keys.begin());
+        for (UINT i = 0; i < count && allSame; ++i)
+            allSame &= m_RandomNums[values[i]] == keys[i];
+
+        wchar_t line[256];
+        swprintf_s(line, L"2^%u: %.3f / %.3f | %.3f / %.3f / %.3f | %.3f / %.3f | %.3f / %.3f\n",
+            log2Count, gpuComputeTime * 1000.0, gpuTotalTime * 1000.0f,
+            cpuStdSortTime * 1000.0f, cpuRadixTime * 1000.0f, cpuParallelRadixTime * 1000.0f,
+            cpuStdSort64Time * 1000.0f, cpuParallelRadix64Time * 1000.0f,
+            cpuStdSortPairsTime * 1000.0f, cpuParallelRadixPairsTime * 1000.0f);
+        wstr += line;
+    }
 
-    // CPU排序
-    m_Timer.Reset();
-    m_Timer.Start();
-    std::sort(m_RandomNums.begin(), m_RandomNums.begin() + m_RandomNumsCount);
-    m_Timer.Tick();
-    m_Timer.Stop();
-    float cpuTotalTime = m_Timer.TotalTime();
+    // 任意元素数目、键值对与降序：先在CPU上模拟调度计划，再与GPU结果比较
+    // 3000000超过512^2，会走全局比较交换的路径
+    wstr += L"\n键值对降序 元素数目: GPU计算 / GPU总计\n";
+    for (UINT count : { 1000u, 100000u, 3000000u })
+    {
+        std::vector<GpuSortKeyValue> expected(count);
+        for (UINT i = 0; i < count; ++i)
+            expected[i] = { m_RandomNums[i], i };
+        std::sort(expected.begin(), expected.end(), [](const GpuSortKeyValue& lhs, const GpuSortKeyValue& rhs) {
+            return lhs.key > rhs.key || (lhs.key == rhs.key && lhs.value > rhs.value);
+        });
+
+        if (count <= 100000)
+        {
+            UINT capacity = GpuSortSchedule::GetCapacity(count);
+            std::vector<GpuSortKeyValue> simData(capacity), simTemp(capacity);
+            for (UINT i = 0; i < count; ++i)
+                simData[i] = { m_RandomNums[i], i };
+            GpuSortKeyValue* pBuffers[2] = { simData.data(), simTemp.data() };
+            GpuSortSchedule::Simulate(GpuSortSchedule::Build(count), pBuffers, true);
+            allSame &= !memcmp(simData.data(), expected.data(), sizeof(GpuSortKeyValue) * count);
+        }
 
-    bool isSame = !memcmp(mappedData.pData, m_RandomNums.data(),
-        sizeof(uint32_t) * m_RandomNums.size());
+        std::vector<uint32_t> gpuResult;
+        float gpuTotalTime = 0.0f;
+        double gpuComputeTime = GPUSort(m_GpuSortKeyValue, count, true, gpuResult, gpuTotalTime);
+        allSame &= !memcmp(gpuResult.data(), expected.data(), sizeof(GpuSortKeyValue) * count);
 
-    m_pd3dImmediateContext->Unmap(m_pTypedBufferCopy.Get(), 0);
+        wchar_t line[256];
+        swprintf_s(line, L"%u: %.3f / %.3f\n", count, gpuComputeTime * 1000.0, gpuTotalTime * 1000.0f);
+        wstr += line;
+    }
 
-    std::wstring wstr = L"排序元素数目：" + std::to_wstring(m_RandomNumsCount) +
-        L"/" + std::to_wstring(m_RandomNums.size());
-    wstr += L"\nGPU计算用时：" + std::to_wstring(gpuComputeTime) + L"秒";
-    wstr += L"\nGPU总用时：" + std::to_wstring(gpuTotalTime) + L"秒";
-    wstr += L"\nCPU用时：" + std::to_wstring(cpuTotalTime) + L"秒";
-    wstr += isSame ? L"\n排序结果一致" : L"\n排序结果不一致";
+    wstr += allSame ? L"排序结果一致" : L"排序结果不一致";
     MessageBox(nullptr, wstr.c_str(), L"排序结束", MB_OK);
-
 }
 
 
 
 bool GameApp::InitResource()
 {
-    // 初始化随机数数据
+    // 初始化随机数数据，元素数目为2的次幂，从2^9到2^24
     std::mt19937 randEngine;
     randEngine.seed(std::random_device()());
-    std::uniform_int_distribution<uint32_t> powRange(9, 18);
-    // 元素数目必须为2的次幂且不小于512个，并用最大值填充
-    uint32_t elemCount = 1 << 18;
-    m_RandomNums.assign(elemCount, UINT_MAX);
-    // 填充随机数目的随机数，数目在一半容量到最大容量之间
-    std::uniform_int_distribution<uint32_t> numsCountRange((uint32_t)m_RandomNums.size() / 2,
-        (uint32_t)m_RandomNums.size());
-    m_RandomNumsCount = elemCount;
-    std::generate(m_RandomNums.begin(), m_RandomNums.begin() + m_RandomNumsCount, [&] {return randEngine(); });
-
-    CD3D11_BUFFER_DESC bufferDesc(
-        (uint32_t)m_RandomNums.size() * sizeof(uint32_t),
-        D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS);
-    D3D11_SUBRESOURCE_DATA initData{};
-    initData.pSysMem = m_RandomNums.data();
-    m_pd3dDevice->CreateBuffer(&bufferDesc, &initData, m_pTypedBuffer1.GetAddressOf());
-    m_pd3dDevice->CreateBuffer(&bufferDesc, nullptr, m_pTypedBuffer2.GetAddressOf());
-    
-    bufferDesc.BindFlags = 0;
-    bufferDesc.Usage = D3D11_USAGE_STAGING;
-    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-    m_pd3dDevice->CreateBuffer(&bufferDesc, nullptr, m_pTypedBufferCopy.GetAddressOf());
-
-    bufferDesc = CD3D11_BUFFER_DESC(sizeof(CB), D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
-    m_pd3dDevice->CreateBuffer(&bufferDesc, nullptr, m_pConstantBuffer.GetAddressOf());
-
-    // 创建着色器资源视图
-    CD3D11_SHADER_RESOURCE_VIEW_DESC srvDesc(D3D11_SRV_DIMENSION_BUFFER, DXGI_FORMAT_R32_UINT, 0, (uint32_t)m_RandomNums.size());
-    m_pd3dDevice->CreateShaderResourceView(m_pTypedBuffer1.Get(), &srvDesc,
-        m_pDataSRV1.GetAddressOf());
-    m_pd3dDevice->CreateShaderResourceView(m_pTypedBuffer2.Get(), &srvDesc,
-        m_pDataSRV2.GetAddressOf());
-
-    // 创建无序访问视图
-    D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc;
-    uavDesc.Format = DXGI_FORMAT_R32_UINT;
-    uavDesc.ViewDimension = D3D11_UAV_DIMENSION_BUFFER;
-    uavDesc.Buffer.FirstElement = 0;
-    uavDesc.Buffer.Flags = 0;
-    uavDesc.Buffer.NumElements = (UINT)m_RandomNums.size();
-    m_pd3dDevice->CreateUnorderedAccessView(m_pTypedBuffer1.Get(), &uavDesc,
-        m_pDataUAV1.GetAddressOf());
-    m_pd3dDevice->CreateUnorderedAccessView(m_pTypedBuffer2.Get(), &uavDesc,
-        m_pDataUAV2.GetAddressOf());
-
-    // 创建计算着色器
-    ComPtr<ID3DBlob> blob;
-    D3DReadFileToBlob(L"Shaders\\BitonicSort_CS.cso", blob.ReleaseAndGetAddressOf());
-    m_pd3dDevice->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, m_pBitonicSort_CS.GetAddressOf());
-
-    D3DReadFileToBlob(L"Shaders\\MatrixTranspose_CS.cso", blob.ReleaseAndGetAddressOf());
-    m_pd3dDevice->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, m_pMatrixTranspose_CS.GetAddressOf());
+    m_RandomNums.resize(1 << 24);
+    std::generate(m_RandomNums.begin(), m_RandomNums.end(), [&] {return randEngine(); });
+
+    // 创建GPU排序器与回读缓冲区
+    if (FAILED(m_GpuSort.InitResource(m_pd3dDevice.Get(), (UINT)m_RandomNums.size(), false)))
+        return false;
+    if (FAILED(m_GpuSortKeyValue.InitResource(m_pd3dDevice.Get(), (UINT)m_RandomNums.size(), true)))
+        return false;
 
+    CD3D11_BUFFER_DESC bufferDesc(m_GpuSortKeyValue.GetCapacity() * m_GpuSortKeyValue.GetElementSize(),
+        0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+    m_pd3dDevice->CreateBuffer(&bufferDesc, nullptr, m_pReadbackBuffer.GetAddressOf());
 
     return true;
 }
 
-void GameApp::SetConstants(UINT level, UINT descendMask, UINT matrixWidth, UINT matrixHeight)
+double GameApp::GPUSort(GpuSort& sorter, UINT count, bool descending, std::vector<uint32_t>& result, float& totalTime)
 {
-    D3D11_MAPPED_SUBRESOURCE mappedData{};
-    m_pd3dImmediateContext->Map(m_pConstantBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData);
-    CB cb = { level, descendMask, matrixWidth, matrixHeight };
-    memcpy_s(mappedData.pData, sizeof cb, &cb, sizeof cb);
-    m_pd3dImmediateContext->Unmap(m_pConstantBuffer.Get(), 0);
-    m_pd3dImmediateContext->CSSetConstantBuffers(0, 1, m_pConstantBuffer.GetAddressOf());
-}
-
-void GameApp::GPUSort()
-{
-    UINT size = (UINT)m_RandomNums.size();
-
-    m_pd3dImmediateContext->CSSetShader(m_pBitonicSort_CS.Get(), nullptr, 0);
-    m_pd3dImmediateContext->CSSetUnorderedAccessViews(0, 1, m_pDataUAV1.GetAddressOf(), nullptr);
-
-    // 按行数据进行排序，先排序level <= BLOCK_SIZE 的所有情况
-    for (UINT level = 2; level <= size && level <= BITONIC_BLOCK_SIZE; level *= 2)
+    UINT elemSize = sorter.GetElementSize();
+    D3D11_BOX box = { 0, 0, 0, count * elemSize, 1, 1 };
+    if (sorter.IsKeyValue())
     {
-        SetConstants(level, level, 0, 0);
-        m_pd3dImmediateContext->Dispatch((size + BITONIC_BLOCK_SIZE - 1) / BITONIC_BLOCK_SIZE, 1, 1);
+        std::vector<GpuSortKeyValue> pairs(count);
+        for (UINT i = 0; i < count; ++i)
+            pairs[i] = { m_RandomNums[i], i };
+        m_pd3dImmediateContext->UpdateSubresource(sorter.GetBuffer(), 0, &box, pairs.data(), 0, 0);
     }
-    
-    // 计算相近的矩阵宽高(宽>=高且需要都为2的次幂)
-    UINT matrixWidth = 2, matrixHeight = 2;
-    while (matrixWidth * matrixWidth < size)
+    else
     {
-        matrixWidth *= 2;
+        m_pd3dImmediateContext->UpdateSubresource(sorter.GetBuffer(), 0, &box, m_RandomNums.data(), 0, 0);
     }
-    matrixHeight = size / matrixWidth;
-
-    // 排序level > BLOCK_SIZE 的所有情况
-    ComPtr<ID3D11ShaderResourceView> pNullSRV;
-    for (UINT level = BITONIC_BLOCK_SIZE * 2; level <= size; level *= 2)
-    {
-        // 如果达到最高等级，则为全递增序列
-        if (level == size)
-        {
-            SetConstants(level / matrixWidth, level, matrixWidth, matrixHeight);
-        }
-        else
-        {
-            SetConstants(level / matrixWidth, level / matrixWidth, matrixWidth, matrixHeight);
-        }
-        // 先进行转置，并把数据输出到Buffer2
-        m_pd3dImmediateContext->CSSetShader(m_pMatrixTranspose_CS.Get(), nullptr, 0);
-        m_pd3dImmediateContext->CSSetShaderResources(0, 1, pNullSRV.GetAddressOf());
-        m_pd3dImmediateContext->CSSetUnorderedAccessViews(0, 1, m_pDataUAV2.GetAddressOf(), nullptr);
-        m_pd3dImmediateContext->CSSetShaderResources(0, 1, m_pDataSRV1.GetAddressOf());
-        m_pd3dImmediateContext->Dispatch(matrixWidth / TRANSPOSE_BLOCK_SIZE, 
-            matrixHeight / TRANSPOSE_BLOCK_SIZE, 1);
-
-        // 对Buffer2排序列数据
-        m_pd3dImmediateContext->CSSetShader(m_pBitonicSort_CS.Get(), nullptr, 0);
-        m_pd3dImmediateContext->Dispatch(size / BITONIC_BLOCK_SIZE, 1, 1);
-
-        // 接着转置回来，并把数据输出到Buffer1
-        SetConstants(matrixWidth, level, matrixWidth, matrixHeight);
-        m_pd3dImmediateContext->CSSetShader(m_pMatrixTranspose_CS.Get(), nullptr, 0);
-        m_pd3dImmediateContext->CSSetShaderResources(0, 1, pNullSRV.GetAddressOf());
-        m_pd3dImmediateContext->CSSetUnorderedAccessViews(0, 1, m_pDataUAV1.GetAddressOf(), nullptr);
-        m_pd3dImmediateContext->CSSetShaderResources(0, 1, m_pDataSRV2.GetAddressOf());
-        m_pd3dImmediateContext->Dispatch(matrixWidth / TRANSPOSE_BLOCK_SIZE,
-            matrixHeight / TRANSPOSE_BLOCK_SIZE, 1);
-
-        // 对Buffer1排序剩余行数据
-        m_pd3dImmediateContext->CSSetShader(m_pBitonicSort_CS.Get(), nullptr, 0);
-        m_pd3dImmediateContext->Dispatch(size / BITONIC_BLOCK_SIZE, 1, 1);
-    }
-}
 
+    m_Timer.Reset();
+    m_Timer.Start();
+    m_GpuTimer.Init(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
+    m_GpuTimer.Start();
+    sorter.Sort(m_pd3dImmediateContext.Get(), count, descending);
+    m_GpuTimer.Stop();
+    double computeTime = m_GpuTimer.GetTime();
 
+    // 结果回读到CPU进行比较
+    m_pd3dImmediateContext->CopySubresourceRegion(m_pReadbackBuffer.Get(), 0, 0, 0, 0, sorter.GetBuffer(), 0, &box);
+    D3D11_MAPPED_SUBRESOURCE mappedData;
+    m_pd3dImmediateContext->Map(m_pReadbackBuffer.Get(), 0, D3D11_MAP_READ, 0, &mappedData);
+    m_Timer.Tick();
+    m_Timer.Stop();
+    totalTime = m_Timer.TotalTime();
 
+    result.resize(count * elemSize / sizeof(uint32_t));
+    memcpy_s(result.data(), count * elemSize, mappedData.pData, count * elemSize);
+    m_pd3dImmediateContext->Unmap(m_pReadbackBuffer.Get(), 0);
+    return computeTime;
+}
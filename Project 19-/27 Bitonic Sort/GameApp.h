@@ -2,6 +2,8 @@
 #define GAMEAPP_H
 
 #include "d3dApp.h"
+#include <GpuSort.h>
+#include <CpuSort.h>
 #include <random>
 #include <algorithm>
 // 编程捕获帧(需支持DirectX 11.2 API)
@@ -12,21 +14,8 @@
 //#include <DXProgrammableCapture.h>  
 //#endif
 
-#define BITONIC_BLOCK_SIZE 512
-
-#define TRANSPOSE_BLOCK_SIZE 16
-
 class GameApp : public D3DApp
 {
-public:
-    struct CB
-    {
-        UINT level;
-        UINT descendMask;
-        UINT matrixWidth;
-        UINT matrixHeight;
-    };
-
 public:
     GameApp(HINSTANCE hInstance);
     ~GameApp();
@@ -36,22 +25,15 @@ public:
 
 private:
     bool InitResource();
-    void SetConstants(UINT level, UINT descendMask, UINT matrixWidth, UINT matrixHeight);
-    void GPUSort();
+    // 把m_RandomNums的前count个数(键值对时值为下标)写入排序器的缓冲区，排序后读回到result
+    // 返回GPU计算用时，totalTime为包含回读的总用时
+    double GPUSort(GpuSort& sorter, UINT count, bool descending, std::vector<uint32_t>& result, float& totalTime);
 private:
-    ComPtr<ID3D11Buffer> m_pConstantBuffer;				// 常量缓冲区
-    ComPtr<ID3D11Buffer> m_pTypedBuffer1;				// 有类型缓冲区1
-    ComPtr<ID3D11Buffer> m_pTypedBuffer2;				// 有类型缓冲区2
-    ComPtr<ID3D11Buffer> m_pTypedBufferCopy;			// 用于拷贝的有类型缓冲区
-    ComPtr<ID3D11UnorderedAccessView> m_pDataUAV1;		// 有类型缓冲区1对应的无序访问视图
-    ComPtr<ID3D11UnorderedAccessView> m_pDataUAV2;		// 有类型缓冲区2对应的无序访问视图
-    ComPtr<ID3D11ShaderResourceView> m_pDataSRV1;		// 有类型缓冲区1对应的着色器资源视图
-    ComPtr<ID3D11ShaderResourceView> m_pDataSRV2;		// 有类型缓冲区2对应的着色器资源视图
-
-    std::vector<UINT> m_RandomNums;
-    UINT m_RandomNumsCount = 0;
-    ComPtr<ID3D11ComputeShader> m_pBitonicSort_CS;
-    ComPtr<ID3D11ComputeShader> m_pMatrixTranspose_CS;
+    GpuSort m_GpuSort;                                  // 只对键排序
+    GpuSort m_GpuSortKeyValue;                          // 对键值对排序
+    ComPtr<ID3D11Buffer> m_pReadbackBuffer;             // 用于回读结果的缓冲区
+
+    std::vector<UINT> m_RandomNums;                     // 最大规模的随机数，各规模取前面的部分
 
     GpuTimer m_GpuTimer;
 };
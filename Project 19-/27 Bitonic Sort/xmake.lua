@@ -12,6 +12,9 @@ target(targetName)
     add_rules("hlsl_shader_complier")
     add_headerfiles("Shaders/**.hlsl|Shaders/**.hlsli")
     add_files("Shaders/**.hlsl|Shaders/**.hlsli")
+    -- GpuSort的着色器
+    add_headerfiles("../Common/Shaders/**.hlsl|../Common/Shaders/**.hlsli")
+    add_files("../Common/Shaders/**.hlsl|../Common/Shaders/**.hlsli")
     -- assert
     add_rules("asset_file")
 target_end() 
\ No newline at end of file
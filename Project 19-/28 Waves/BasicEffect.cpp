@@ -12,6 +12,16 @@ using namespace DirectX;
 
 # pragma warning(disable: 26812)
 
+namespace
+{
+    // CPU水波：高度、法线的xz分量(snorm16)、纹理坐标分别位于三个顶点缓冲区
+    const D3D11_INPUT_ELEMENT_DESC s_HeightNormalTexLayout[3] = {
+        { "HEIGHT", 0, DXGI_FORMAT_R32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 1, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 2, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+    };
+}
+
 
 //
 // BasicEffect::Impl 需要先于BasicEffect的定义
@@ -33,8 +43,10 @@ public:
     std::shared_ptr<IEffectPass> m_pCurrEffectPass;
     ComPtr<ID3D11InputLayout> m_pCurrInputLayout;
     D3D11_PRIMITIVE_TOPOLOGY m_CurrTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    std::vector<uint32_t> m_CurrStrides = { 12, 12, 8 };
 
     ComPtr<ID3D11InputLayout> m_pVertexPosNormalTexLayout;
+    ComPtr<ID3D11InputLayout> m_pHeightNormalTexLayout;
 
     XMFLOAT4X4 m_World{}, m_View{}, m_Proj{};
 };
@@ -97,6 +109,12 @@ bool BasicEffect::InitAll(ID3D11Device* device)
     HR(device->CreateInputLayout(VertexPosNormalTex::GetInputLayout(), ARRAYSIZE(VertexPosNormalTex::GetInputLayout()),
         blob->GetBufferPointer(), blob->GetBufferSize(), pImpl->m_pVertexPosNormalTexLayout.GetAddressOf()));
 
+    pImpl->m_pEffectHelper->CreateShaderFromFile("CpuWavesVS", L"Shaders/CpuWaves_VS.cso", device,
+        "VS", "vs_5_0", nullptr, blob.ReleaseAndGetAddressOf());
+    HR(device->CreateInputLayout(s_HeightNormalTexLayout, ARRAYSIZE(s_HeightNormalTexLayout),
+        blob->GetBufferPointer(), blob->GetBufferSize(), pImpl->m_pHeightNormalTexLayout.GetAddressOf()));
+    pImpl->m_pEffectHelper->CreateShaderFromFile("OceanVS", L"Shaders/Ocean_VS.cso", device);
+
     // 创建像素着色器
     pImpl->m_pEffectHelper->CreateShaderFromFile("BasicPS", L"Shaders/Basic_PS.cso", device);
 
@@ -105,12 +123,23 @@ bool BasicEffect::InitAll(ID3D11Device* device)
     passDesc.nameVS = "BasicVS";
     passDesc.namePS = "BasicPS";
     HR(pImpl->m_pEffectHelper->AddEffectPass("Basic", device, &passDesc));
+    passDesc.nameVS = "CpuWavesVS";
+    HR(pImpl->m_pEffectHelper->AddEffectPass("CpuWaves", device, &passDesc));
+    auto pPass = pImpl->m_pEffectHelper->GetEffectPass("CpuWaves");
+    pPass->SetRasterizerState(RenderStates::RSNoCull.Get());
+    pPass->SetBlendState(RenderStates::BSTransparent.Get(), nullptr, 0xFFFFFFFF);
+    passDesc.nameVS = "OceanVS";
+    HR(pImpl->m_pEffectHelper->AddEffectPass("Ocean", device, &passDesc));
+    pPass = pImpl->m_pEffectHelper->GetEffectPass("Ocean");
+    pPass->SetRasterizerState(RenderStates::RSNoCull.Get());
+    pPass->SetBlendState(RenderStates::BSTransparent.Get(), nullptr, 0xFFFFFFFF);
     pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamLinearWrap", RenderStates::SSLinearWrap.Get());
     pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamPointClamp", RenderStates::SSPointClamp.Get());
 
     // 设置调试对象名
 #if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
     SetDebugObjectName(pImpl->m_pVertexPosNormalTexLayout.Get(), "BasicEffect.VertexPosNormalTexLayout");
+    SetDebugObjectName(pImpl->m_pHeightNormalTexLayout.Get(), "BasicEffect.HeightNormalTexLayout");
 #endif
     pImpl->m_pEffectHelper->SetDebugObjectName("BasicEffect");
 
@@ -174,7 +203,7 @@ MeshDataInput BasicEffect::GetInputData(const MeshData& meshData)
         meshData.m_pNormals.Get(),
         meshData.m_pTexcoordArrays.empty() ? nullptr : meshData.m_pTexcoordArrays[0].Get()
     };
-    input.strides = { 12, 12, 8 };
+    input.strides = pImpl->m_CurrStrides;
     input.offsets = { 0, 0, 0 };
 
     input.pIndexBuffer = meshData.m_pIndices.Get();
@@ -229,10 +258,25 @@ void BasicEffect::SetWavesStates(bool enabled, float gridSpatialStep)
     pImpl->m_pEffectHelper->GetConstantBufferVariable("g_WavesEnabled")->SetSInt(enabled);
 }
 
+void BasicEffect::SetCpuWavesGrid(uint32_t rows, uint32_t cols, float gridSpatialStep)
+{
+    uint32_t gridSize[2] = { cols, rows };
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_GridSize")->SetUIntVector(2, gridSize);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_GridSpatialStep")->SetFloat(gridSpatialStep);
+}
+
+void BasicEffect::SetOceanStates(ID3D11ShaderResourceView* displacement, ID3D11ShaderResourceView* slope, float patchSize)
+{
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_DisplacementMap", displacement);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_SlopeMap", slope);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_OceanPatchSize")->SetFloat(patchSize);
+}
+
 void BasicEffect::SetRenderDefault()
 {
     pImpl->m_pCurrEffectPass = pImpl->m_pEffectHelper->GetEffectPass("Basic");
     pImpl->m_pCurrInputLayout = pImpl->m_pVertexPosNormalTexLayout;
+    pImpl->m_CurrStrides = { 12, 12, 8 };
     pImpl->m_CurrTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
     pImpl->m_pCurrEffectPass->SetRasterizerState(nullptr);
     pImpl->m_pCurrEffectPass->SetDepthStencilState(nullptr, 0);
@@ -242,11 +286,28 @@ void BasicEffect::SetRenderTransparent()
 {
     pImpl->m_pCurrEffectPass = pImpl->m_pEffectHelper->GetEffectPass("Basic");
     pImpl->m_pCurrInputLayout = pImpl->m_pVertexPosNormalTexLayout;
+    pImpl->m_CurrStrides = { 12, 12, 8 };
     pImpl->m_CurrTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
     pImpl->m_pCurrEffectPass->SetRasterizerState(RenderStates::RSNoCull.Get());
     pImpl->m_pCurrEffectPass->SetBlendState(RenderStates::BSTransparent.Get(), nullptr, 0xFFFFFFFF);
 }
 
+void BasicEffect::SetRenderCpuWaves()
+{
+    pImpl->m_pCurrEffectPass = pImpl->m_pEffectHelper->GetEffectPass("CpuWaves");
+    pImpl->m_pCurrInputLayout = pImpl->m_pHeightNormalTexLayout;
+    pImpl->m_CurrTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    pImpl->m_CurrStrides = { 4, 4, 8 };
+}
+
+void BasicEffect::SetRenderOcean()
+{
+    pImpl->m_pCurrEffectPass = pImpl->m_pEffectHelper->GetEffectPass("Ocean");
+    pImpl->m_pCurrInputLayout = pImpl->m_pVertexPosNormalTexLayout;
+    pImpl->m_CurrTopology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    pImpl->m_CurrStrides = { 12, 12, 8 };
+}
+
 void BasicEffect::SetTextureDisplacement(ID3D11ShaderResourceView* textureDisplacement)
 {
     pImpl->m_pEffectHelper->SetShaderResourceByName("g_DisplacementMap", textureDisplacement);
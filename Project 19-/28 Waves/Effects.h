@@ -60,6 +60,10 @@ public:
     void SetRenderDefault();
     // 透明混合绘制
     void SetRenderTransparent();
+    // 透明混合绘制CPU水波，顶点输入为高度和压缩的法线
+    void SetRenderCpuWaves();
+    // 透明混合绘制FFT海面，顶点位置与法线来自位移贴图和斜率贴图
+    void SetRenderOcean();
     
     void SetTextureDisplacement(ID3D11ShaderResourceView* textureDisplacement);
 
@@ -78,6 +82,10 @@ public:
     void SetFogRange(float fogRange);
 
     void SetWavesStates(bool enabled, float gridSpatialStep = 0.0f);
+    // CPU水波的顶点列数、行数与空间步长，用于从顶点索引还原x/z坐标
+    void SetCpuWavesGrid(uint32_t rows, uint32_t cols, float gridSpatialStep);
+    // FFT海面的位移贴图、斜率贴图，以及贴图覆盖的世界空间边长
+    void SetOceanStates(ID3D11ShaderResourceView* displacement, ID3D11ShaderResourceView* slope, float patchSize);
 
     // 应用常量缓冲区和纹理资源的变更
     void Apply(ID3D11DeviceContext* deviceContext) override;
@@ -76,20 +76,64 @@ void GameApp::UpdateScene(float dt)
     {
         static const char* wavemode_strs[] = {
             "CPU",
-            "GPU"
+            "GPU",
+            "FFT Ocean"
         };
         if (ImGui::Combo("Waves Mode", &m_WavesMode, wavemode_strs, ARRAYSIZE(wavemode_strs)))
         {
-            if (m_WavesMode)
+            if (m_WavesMode == 0)
+                m_CpuWaves.InitResource(m_pd3dDevice.Get(), 256, 256, 5.0f, 5.0f, 0.03f, 0.625f, 2.0f, 0.2f, 0.05f, 0.1f);
+            else if (m_WavesMode == 1)
                 m_GpuWaves.InitResource(m_pd3dDevice.Get(), 256, 256, 5.0f, 5.0f, 0.03f, 0.625f, 2.0f, 0.2f, 0.05f, 0.1f);
             else
-                m_CpuWaves.InitResource(m_pd3dDevice.Get(), 256, 256, 5.0f, 5.0f, 0.03f, 0.625f, 2.0f, 0.2f, 0.05f, 0.1f);
-                
+                InitOceanWaves();
         }
         if (ImGui::Checkbox("Enable Fog", &m_EnabledFog))
         {
             m_BasicEffect.SetFogState(m_EnabledFog);
         }
+        if (m_WavesMode == 0)
+        {
+            // 会阻塞数秒
+            if (ImGui::Button("Run CPU Benchmark (128^2 ~ 4096^2)"))
+                m_BenchmarkResults = m_CpuWaves.RunBenchmark();
+            for (auto& result : m_BenchmarkResults)
+            {
+                ImGui::Text("%4u^2: scalar %.3fms  SIMD+MT %.3fms  (x%.1f)", result.gridSize,
+                    result.scalarMs, result.simdMs, result.scalarMs / (std::max)(result.simdMs, 1e-6f));
+            }
+
+            // 等效带宽按逐步遍历需要读写的字节数计算，时间分块超出内存带宽的部分来自缓存复用
+            if (ImGui::Button("Run Stencil Benchmark (256^2 ~ 4096^2)"))
+                m_StencilBenchmarkResults = RunStencilBenchmark();
+            for (auto& result : m_StencilBenchmarkResults)
+            {
+                ImGui::Text("%-5s %4u^2: naive %.3fms (%.1fGB/s)  tiled %.3fms (%.1fGB/s)  err %g", result.kernelName,
+                    result.gridSize, result.naiveMs, result.naiveGBps, result.tiledMs, result.tiledGBps, result.maxError);
+            }
+        }
+        else if (m_WavesMode == 2)
+        {
+            static const char* spectrum_strs[] = {
+                "Phillips",
+                "JONSWAP"
+            };
+            bool changed = ImGui::Combo("Spectrum", &m_OceanSpectrum, spectrum_strs, ARRAYSIZE(spectrum_strs));
+            changed |= ImGui::SliderFloat("Wind Speed", &m_OceanWindSpeed, 2.0f, 20.0f, "%.1f m/s");
+            changed |= ImGui::SliderFloat("Choppiness", &m_OceanChoppiness, 0.0f, 2.0f);
+            // 频谱只在初始化时生成，参数变化后需要重建
+            if (changed)
+                InitOceanWaves();
+
+            // 会阻塞数秒
+            if (ImGui::Button("Run Ocean Benchmark (256^2 ~ 1024^2)"))
+                m_OceanBenchmarkResults = OceanWaves::RunBenchmark();
+            for (auto& result : m_OceanBenchmarkResults)
+            {
+                ImGui::Text("%4u^2: spectrum %.3fms  FFT %.3fms  pack %.3fms", result.fftSize,
+                    result.spectrumMs, result.fftMs, result.packMs);
+            }
+        }
     }
     ImGui::End();
     ImGui::Render();
@@ -98,13 +142,13 @@ void GameApp::UpdateScene(float dt)
     if (m_Timer.TotalTime() - m_BaseTime >= 0.25f)
     {
         m_BaseTime += 0.25f;
-        if (m_WavesMode)
+        if (m_WavesMode == 1)
         {
             m_GpuWaves.Disturb(m_pd3dImmediateContext.Get(), 
                 m_RowRange(m_RandEngine), m_ColRange(m_RandEngine),
                 m_MagnitudeRange(m_RandEngine));
         }
-        else
+        else if (m_WavesMode == 0)
         {
             m_CpuWaves.Disturb(m_RowRange(m_RandEngine), m_ColRange(m_RandEngine),
                 m_MagnitudeRange(m_RandEngine));
@@ -113,10 +157,12 @@ void GameApp::UpdateScene(float dt)
     }
 
     // 更新波浪
-    if (m_WavesMode)
+    if (m_WavesMode == 0)
+        m_CpuWaves.Update(dt);
+    else if (m_WavesMode == 1)
         m_GpuWaves.Update(m_pd3dImmediateContext.Get(), dt);
     else
-        m_CpuWaves.Update(dt);
+        m_OceanWaves.Update(dt);
 }
 
 void GameApp::DrawScene()
@@ -150,10 +196,20 @@ void GameApp::DrawScene()
     m_BasicEffect.SetRenderTransparent();
     m_WireFence.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
 
-    if (m_WavesMode)
+    if (m_WavesMode == 0)
+    {
+        m_BasicEffect.SetRenderCpuWaves();
+        m_CpuWaves.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+    }
+    else if (m_WavesMode == 1)
+    {
         m_GpuWaves.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+    }
     else
-        m_CpuWaves.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+    {
+        m_BasicEffect.SetRenderOcean();
+        m_OceanWaves.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+    }
     
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 
@@ -204,6 +260,7 @@ bool GameApp::InitResource()
     //
     m_CpuWaves.InitResource(m_pd3dDevice.Get(), 256, 256, 5.0f, 5.0f, 0.03f, 0.625f, 2.0f, 0.2f, 0.05f, 0.1f);
     m_GpuWaves.InitResource(m_pd3dDevice.Get(), 256, 256, 5.0f, 5.0f, 0.03f, 0.625f, 2.0f, 0.2f, 0.05f, 0.1f);
+    InitOceanWaves();
 
     // ******************
     // 初始化随机数生成器
@@ -264,3 +321,9 @@ bool GameApp::InitResource()
     return true;
 }
 
+void GameApp::InitOceanWaves()
+{
+    // 80m的面片在160m见方的网格上重复2x2次
+    m_OceanWaves.InitResource(m_pd3dDevice.Get(), 256, 256, 5.0f, 5.0f, 1.0f / 30.0f, 0.625f,
+        256, 80.0f, m_OceanWindSpeed, 0.5f, static_cast<OceanWaves::Spectrum>(m_OceanSpectrum), m_OceanChoppiness);
+}
@@ -6,6 +6,7 @@
 #include "d3dApp.h"
 #include "Effects.h"
 #include "Waves.h"
+#include <StencilEngine.h>
 #include <CameraController.h>
 #include <RenderStates.h>
 #include <GameObject.h>
@@ -29,6 +30,7 @@ public:
 
 private:
     bool InitResource();
+    void InitOceanWaves();
 
 private:
     
@@ -46,12 +48,19 @@ private:
     GameObject m_WireFence;										// 篱笆盒
     CpuWaves m_CpuWaves;                                        // CPU水波
     GpuWaves m_GpuWaves;                                        // GPU水波
+    OceanWaves m_OceanWaves;                                    // FFT海面
+    std::vector<CpuWaves::BenchmarkResult> m_BenchmarkResults;  // CPU水波的性能测试结果
+    std::vector<OceanWaves::BenchmarkResult> m_OceanBenchmarkResults;   // FFT海面的性能测试结果
+    std::vector<StencilBenchmarkResult> m_StencilBenchmarkResults;     // 时间分块模板计算的性能测试结果
 
     std::unique_ptr<Depth2D> m_pDepthTexture;                   // 深度纹理
     std::unique_ptr<Texture2D> m_pLitTexture;                   // 场景绘制的缓冲区
 
     float m_BaseTime = 0.0f;									// 控制水波生成的基准时间
-    int m_WavesMode = 1;                                        // 波浪绘制模式，0-GPU，1-CPU
+    int m_WavesMode = 1;                                        // 波浪绘制模式，0-CPU，1-GPU，2-FFT海面
+    int m_OceanSpectrum = 1;                                    // 海浪频谱，0-Phillips，1-JONSWAP
+    float m_OceanWindSpeed = 6.0f;                              // 风速(m/s)
+    float m_OceanChoppiness = 1.0f;                             // 水平位移系数
     bool m_EnabledFog = true;									// 开启雾效
 
     std::shared_ptr<ThirdPersonCamera> m_pCamera;				// 摄像机
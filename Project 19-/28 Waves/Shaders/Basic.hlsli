@@ -2,6 +2,7 @@
 
 Texture2D g_DiffuseMap : register(t0);          // 物体纹理
 Texture2D g_DisplacementMap : register(t1);     // 位移贴图
+Texture2D g_SlopeMap : register(t2);            // 海面的斜率贴图
 SamplerState g_SamLinearWrap : register(s0);    // 线性过滤+Wrap采样器
 SamplerState g_SamPointClamp : register(s1);    // 点过滤+Clamp采样器
 
@@ -34,7 +35,8 @@ cbuffer CBDrawingStates : register(b3)
     int g_WavesEnabled;                     // 开启波浪绘制
     
     float g_GridSpatialStep;                // 栅格空间步长
-    float3 g_Pad2;
+    uint2 g_GridSize;                       // 栅格的顶点列数和行数
+    float g_OceanPatchSize;                 // 海面位移贴图覆盖的世界空间边长
 }
 
 cbuffer CBChangesRarely : register(b4)
@@ -51,6 +53,15 @@ struct VertexPosNormalTex
     float2 tex : TEXCOORD;
 };
 
+// CPU水波的顶点只有高度与法线的xz分量，x/z坐标由顶点索引还原
+struct VertexHeightNormalTex
+{
+    float height : HEIGHT;
+    float2 normalXZ : NORMAL;
+    float2 tex : TEXCOORD;
+    uint vertexID : SV_VertexID;
+};
+
 struct InstancePosNormalTex
 {
     float3 posL : POSITION;
@@ -0,0 +1,25 @@
+#include "Basic.hlsli"
+
+// 顶点着色器
+VertexPosHWNormalTex VS(VertexHeightNormalTex vIn)
+{
+    VertexPosHWNormalTex vOut;
+    
+    // 网格以原点为中心，行号对应z方向，列号对应x方向
+    uint row = vIn.vertexID / g_GridSize.x;
+    uint col = vIn.vertexID % g_GridSize.x;
+    float3 posL;
+    posL.x = ((float) col - 0.5f * (g_GridSize.x - 1)) * g_GridSpatialStep;
+    posL.y = vIn.height;
+    posL.z = ((float) row - 0.5f * (g_GridSize.y - 1)) * g_GridSpatialStep;
+    // 法线的y分量总是非负的
+    float3 normalL = float3(vIn.normalXZ.x, sqrt(saturate(1.0f - dot(vIn.normalXZ, vIn.normalXZ))), vIn.normalXZ.y);
+    
+    vector posW = mul(float4(posL, 1.0f), g_World);
+
+    vOut.posW = posW.xyz;
+    vOut.posH = mul(posW, g_ViewProj);
+    vOut.normalW = mul(normalL, (float3x3) g_WorldInvTranspose);
+    vOut.tex = mul(float4(vIn.tex, 0.0f, 1.0f), g_TexTransform).xy;
+    return vOut;
+}
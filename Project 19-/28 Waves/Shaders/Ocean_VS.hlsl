@@ -0,0 +1,22 @@
+#include "Basic.hlsli"
+
+// 顶点着色器
+VertexPosHWNormalTex VS(VertexPosNormalTex vIn)
+{
+    VertexPosHWNormalTex vOut;
+    
+    // 位移贴图是周期的，按世界空间坐标Wrap采样即可平铺到任意大小的网格
+    float2 uv = vIn.posL.xz / g_OceanPatchSize;
+    float3 displacement = g_DisplacementMap.SampleLevel(g_SamLinearWrap, uv, 0.0f).xyz;
+    float2 slope = g_SlopeMap.SampleLevel(g_SamLinearWrap, uv, 0.0f).xy;
+    vIn.posL += displacement;
+    vIn.normalL = normalize(float3(-slope.x, 1.0f, -slope.y));
+    
+    vector posW = mul(float4(vIn.posL, 1.0f), g_World);
+
+    vOut.posW = posW.xyz;
+    vOut.posH = mul(posW, g_ViewProj);
+    vOut.normalW = mul(vIn.normalL, (float3x3) g_WorldInvTranspose);
+    vOut.tex = mul(float4(vIn.tex, 0.0f, 1.0f), g_TexTransform).xy;
+    return vOut;
+}
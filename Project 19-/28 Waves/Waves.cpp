@@ -2,12 +2,177 @@
 #include <ModelManager.h>
 #include <TextureManager.h>
 #include <DXTrace.h>
+#include <CpuTimer.h>
+#include <ThreadPool.h>
+#include <FFT.h>
+#include <random>
+#include <algorithm>
 
 #pragma warning(disable: 26812)
 
 using namespace DirectX;
 using namespace Microsoft::WRL;
 
+namespace
+{
+    struct WaveStepParams
+    {
+        float k1, k2, k3;
+        float normalY;                  // 2 * 空间步长
+        uint32_t rows, cols;
+    };
+
+    // 原先的实现：顶点存放为XMFLOAT3，逐点求解波动方程后，再单独遍历一次计算法线
+    void StepScalar(const WaveStepParams& params, XMFLOAT3* prev, const XMFLOAT3* curr, XMFLOAT3* normals)
+    {
+        size_t cols = params.cols;
+        for (size_t i = 1; i < params.rows - 1; ++i)
+        {
+            for (size_t j = 1; j < cols - 1; ++j)
+            {
+                prev[i * cols + j].y =
+                    params.k1 * prev[i * cols + j].y +
+                    params.k2 * curr[i * cols + j].y +
+                    params.k3 * (curr[(i + 1) * cols + j].y +
+                        curr[(i - 1) * cols + j].y +
+                        curr[i * cols + j + 1].y +
+                        curr[i * cols + j - 1].y);
+            }
+        }
+
+        for (size_t i = 1; i < params.rows - 1; ++i)
+        {
+            for (size_t j = 1; j < cols - 1; ++j)
+            {
+                float left = prev[i * cols + j - 1].y;
+                float right = prev[i * cols + j + 1].y;
+                float top = prev[(i - 1) * cols + j].y;
+                float bottom = prev[(i + 1) * cols + j].y;
+                normals[i * cols + j] = XMFLOAT3(-right + left, params.normalY, bottom - top);
+                XMVECTOR nVec = XMVector3Normalize(XMLoadFloat3(&normals[i * cols + j]));
+                XMStoreFloat3(&normals[i * cols + j], nVec);
+            }
+        }
+    }
+
+    XMVECTOR LoadFloat4(const float* p)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p));
+    }
+
+    void XM_CALLCONV StoreFloat4(float* p, FXMVECTOR v)
+    {
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(p), v);
+    }
+
+    // 求解第i行内部顶点的下一时刻高度，原址写入prev
+    void SolveRow(const WaveStepParams& params, float* prev, const float* curr, uint32_t i)
+    {
+        size_t cols = params.cols;
+        float* pPrev = prev + i * cols;
+        const float* pCurr = curr + i * cols;
+        XMVECTOR k1 = XMVectorReplicate(params.k1);
+        XMVECTOR k2 = XMVectorReplicate(params.k2);
+        XMVECTOR k3 = XMVectorReplicate(params.k3);
+
+        size_t j = 1;
+        for (; j + 4 <= cols - 1; j += 4)
+        {
+            XMVECTOR sum = XMVectorAdd(
+                XMVectorAdd(LoadFloat4(pCurr + j - cols), LoadFloat4(pCurr + j + cols)),
+                XMVectorAdd(LoadFloat4(pCurr + j - 1), LoadFloat4(pCurr + j + 1)));
+            XMVECTOR next = XMVectorMultiplyAdd(k1, LoadFloat4(pPrev + j),
+                XMVectorMultiplyAdd(k2, LoadFloat4(pCurr + j), XMVectorMultiply(k3, sum)));
+            StoreFloat4(pPrev + j, next);
+        }
+        for (; j < cols - 1; ++j)
+        {
+            pPrev[j] = params.k1 * pPrev[j] + params.k2 * pCurr[j] +
+                params.k3 * (pCurr[j + cols] + pCurr[j - cols] + pCurr[j + 1] + pCurr[j - 1]);
+        }
+    }
+
+    // 根据高度计算第i行内部顶点的法线，只保存归一化后的xz分量，要求第i - 1到i + 1行都已求解完毕
+    void NormalRow(const WaveStepParams& params, const float* heights, PackedVector::XMSHORTN2* normals, uint32_t i)
+    {
+        size_t cols = params.cols;
+        const float* pHeights = heights + i * cols;
+        PackedVector::XMSHORTN2* pNormals = normals + i * cols;
+        XMVECTOR nySq = XMVectorReplicate(params.normalY * params.normalY);
+
+        size_t j = 1;
+        for (; j + 4 <= cols - 1; j += 4)
+        {
+            XMVECTOR nx = XMVectorSubtract(LoadFloat4(pHeights + j - 1), LoadFloat4(pHeights + j + 1));
+            XMVECTOR nz = XMVectorSubtract(LoadFloat4(pHeights + j + cols), LoadFloat4(pHeights + j - cols));
+            XMVECTOR invLength = XMVectorReciprocalSqrt(
+                XMVectorMultiplyAdd(nx, nx, XMVectorMultiplyAdd(nz, nz, nySq)));
+            nx = XMVectorMultiply(nx, invLength);
+            nz = XMVectorMultiply(nz, invLength);
+            // 两个XMSHORTN2正好是一个XMSHORTN4
+            auto pDest = reinterpret_cast<PackedVector::XMSHORTN4*>(pNormals + j);
+            PackedVector::XMStoreShortN4(pDest, XMVectorMergeXY(nx, nz));
+            PackedVector::XMStoreShortN4(pDest + 1, XMVectorMergeZW(nx, nz));
+        }
+        for (; j < cols - 1; ++j)
+        {
+            XMVECTOR nVec = XMVector3Normalize(XMVectorSet(pHeights[j - 1] - pHeights[j + 1], params.normalY,
+                pHeights[j + cols] - pHeights[j - cols], 0.0f));
+            PackedVector::XMStoreShortN2(pNormals + j, XMVectorSwizzle<XM_SWIZZLE_X, XM_SWIZZLE_Z, XM_SWIZZLE_Y, XM_SWIZZLE_W>(nVec));
+        }
+    }
+
+    // 求解[rowBegin, rowEnd)行，并更新受影响的[rowBegin - 1, rowEnd + 1)行的法线
+    // 范围以外的内部行要求在prev和curr中的高度都为0
+    void StepParallel(const WaveStepParams& params, float* prev, const float* curr,
+        PackedVector::XMSHORTN2* normals, uint32_t rowBegin, uint32_t rowEnd)
+    {
+        if (rowBegin >= rowEnd)
+            return;
+
+        // 每个行带在求解完第i行后立即计算第i - 1行的法线。
+        // 行带首尾两行的法线依赖相邻行带的结果，留到所有行带求解完后再计算
+        uint32_t bandRows = (std::max)(16u, 32768u / params.cols);
+        uint32_t numBands = (rowEnd - rowBegin + bandRows - 1) / bandRows;
+        ThreadPool& pool = ThreadPool::GetDefault();
+
+        pool.ParallelFor(0, numBands, 1, [&](uint32_t b0, uint32_t b1) {
+            for (uint32_t b = b0; b < b1; ++b)
+            {
+                uint32_t r0 = rowBegin + b * bandRows;
+                uint32_t r1 = (std::min)(r0 + bandRows, rowEnd);
+                uint32_t normalBegin = r0 == rowBegin ? r0 : r0 + 1;
+                for (uint32_t i = r0; i < r1; ++i)
+                {
+                    SolveRow(params, prev, curr, i);
+                    if (i > normalBegin)
+                        NormalRow(params, prev, normals, i - 1);
+                }
+                if (r1 == rowEnd && r1 - 1 >= normalBegin)
+                    NormalRow(params, prev, normals, r1 - 1);
+            }
+        });
+
+        pool.ParallelFor(0, numBands, 1, [&](uint32_t b0, uint32_t b1) {
+            for (uint32_t b = b0; b < b1; ++b)
+            {
+                uint32_t r0 = rowBegin + b * bandRows;
+                uint32_t r1 = (std::min)(r0 + bandRows, rowEnd);
+                if (r0 > rowBegin)
+                    NormalRow(params, prev, normals, r0);
+                if (r1 < rowEnd && (r1 - 1 > r0 || r0 == rowBegin))
+                    NormalRow(params, prev, normals, r1 - 1);
+            }
+        });
+
+        // 紧挨着求解范围的两行高度不变，但法线会受影响
+        if (rowBegin > 1)
+            NormalRow(params, prev, normals, rowBegin - 1);
+        if (rowEnd < params.rows - 1)
+            NormalRow(params, prev, normals, rowEnd);
+    }
+}
+
 uint32_t Waves::RowCount() const
 {
     return m_NumRows;
@@ -61,15 +226,26 @@ void CpuWaves::InitResource(ID3D11Device* device,
     float waveSpeed, float damping, float flowSpeedX, float flowSpeedY)
 {
     Waves::InitResource(device, rows, cols, texU, texV, timeStep,
-        spatialStep, waveSpeed, damping, flowSpeedX, flowSpeedY, true);
-
-    // 取出顶点数据
-    m_CurrSolution.swap(m_MeshData.vertices);
-    // 保持与顶点数目一致
-    m_PrevSolution.resize(m_CurrSolution.size());
-    m_CurrNormals.resize(m_CurrSolution.size());
-    // 顶点位置复制到Prev
-    std::copy(m_CurrSolution.begin(), m_CurrSolution.end(), m_PrevSolution.begin());
+        spatialStep, waveSpeed, damping, flowSpeedX, flowSpeedY, false);
+
+    // 取出顶点高度，x/z坐标由顶点着色器根据顶点索引还原
+    m_CurrHeights.resize(m_MeshData.vertices.size());
+    for (size_t i = 0; i < m_CurrHeights.size(); ++i)
+        m_CurrHeights[i] = m_MeshData.vertices[i].y;
+    m_PrevHeights = m_CurrHeights;
+    // 法线初始朝上
+    m_CurrNormals.assign(m_CurrHeights.size(), PackedVector::XMSHORTN2(0.0f, 0.0f));
+    m_ActiveRowBegin = m_ActiveRowEnd = 0;
+    m_DirtyRowBegin = m_DirtyRowEnd = 0;
+
+    // 用紧凑的高度和法线缓冲区替换掉原来的位置和法线缓冲区，只通过UpdateSubresource更新变化的行
+    MeshData& meshData = m_Model.meshdatas[0];
+    CD3D11_BUFFER_DESC bufferDesc((uint32_t)m_CurrHeights.size() * sizeof(float), D3D11_BIND_VERTEX_BUFFER);
+    D3D11_SUBRESOURCE_DATA initData{ m_CurrHeights.data() };
+    HR(device->CreateBuffer(&bufferDesc, &initData, meshData.m_pVertices.ReleaseAndGetAddressOf()));
+    bufferDesc.ByteWidth = (uint32_t)m_CurrNormals.size() * sizeof(PackedVector::XMSHORTN2);
+    initData.pSysMem = m_CurrNormals.data();
+    HR(device->CreateBuffer(&bufferDesc, &initData, meshData.m_pNormals.ReleaseAndGetAddressOf()));
 }
 
 void CpuWaves::Update(float dt)
@@ -83,47 +259,76 @@ void CpuWaves::Update(float dt)
     // 仅仅在累积时间大于时间步长时才更新
     if (m_AccumulateTime > m_TimeStep)
     {
-        m_isUpdated = true;
-        // 仅仅对内部顶点进行更新
-        for (size_t i = 1; i < m_NumRows - 1; ++i)
+        // 起伏每一步最多向外扩散一行
+        if (m_ActiveRowBegin < m_ActiveRowEnd)
         {
-            for (size_t j = 1; j < m_NumCols - 1; ++j)
-            {
-                // 在这次更新之后，我们将丢弃掉上一次模拟的数据。
-                // 因此我们将运算的结果保存到Prev[i][j]的位置上。
-                // 注意我们能够使用这种原址更新是因为Prev[i][j]
-                // 的数据仅在当前计算Next[i][j]的时候才用到
-                m_PrevSolution[i * m_NumCols + j].y =
-                    m_K1 * m_PrevSolution[i * m_NumCols + j].y +
-                    m_K2 * m_CurrSolution[i * m_NumCols + j].y +
-                    m_K3 * (m_CurrSolution[(i + 1) * m_NumCols + j].y +
-                        m_CurrSolution[(i - 1) * m_NumCols + j].y +
-                        m_CurrSolution[i * m_NumCols + j + 1].y +
-                        m_CurrSolution[i * m_NumCols + j - 1].y);
-            }
+            m_ActiveRowBegin = (std::max)(m_ActiveRowBegin - 1, 1u);
+            m_ActiveRowEnd = (std::min)(m_ActiveRowEnd + 1, m_NumRows - 1);
         }
 
+        // 在这次更新之后，我们将丢弃掉上一次模拟的数据。
+        // 因此我们将运算的结果保存到Prev[i][j]的位置上。
+        // 注意我们能够使用这种原址更新是因为Prev[i][j]
+        // 的数据仅在当前计算Next[i][j]的时候才用到
+        WaveStepParams params{ m_K1, m_K2, m_K3, 2.0f * m_SpatialStep, m_NumRows, m_NumCols };
+        StepParallel(params, m_PrevHeights.data(), m_CurrHeights.data(), m_CurrNormals.data(),
+            m_ActiveRowBegin, m_ActiveRowEnd);
+        if (m_ActiveRowBegin < m_ActiveRowEnd)
+            MarkDirtyRows(m_ActiveRowBegin - 1, m_ActiveRowEnd + 1);
+
         // 由于把下一次模拟的结果写到了上一次模拟的缓冲区内，
         // 我们需要将下一次模拟的结果与当前模拟的结果交换
-        m_PrevSolution.swap(m_CurrSolution);
+        m_PrevHeights.swap(m_CurrHeights);
 
         m_AccumulateTime = 0.0f;    // 重置时间
+    }
+}
+
+std::vector<CpuWaves::BenchmarkResult> CpuWaves::RunBenchmark(uint32_t minSize, uint32_t maxSize) const
+{
+    std::vector<BenchmarkResult> results;
+    CpuTimer timer;
+    for (uint32_t size = (std::max)(minSize, 8u); size <= maxSize; size *= 2)
+    {
+        size_t numVertices = (size_t)size * size;
+        WaveStepParams params{ m_K1, m_K2, m_K3, 2.0f * m_SpatialStep, size, size };
+        // 让每个规模的总计算量相近
+        uint32_t numSteps = (std::max)(2u, (1u << 22) / size / size);
+        BenchmarkResult result{ size };
 
-        // 使用有限差分法计算法向量
-        for (size_t i = 1; i < m_NumRows - 1; ++i)
         {
-            for (size_t j = 1; j < m_NumCols - 1; ++j)
-            {
-                float left = m_CurrSolution[i * m_NumCols + j - 1].y;
-                float right = m_CurrSolution[i * m_NumCols + j + 1].y;
-                float top = m_CurrSolution[(i - 1) * m_NumCols + j].y;
-                float bottom = m_CurrSolution[(i + 1) * m_NumCols + j].y;
-                m_CurrNormals[i * m_NumCols + j] = XMFLOAT3(-right + left, 2.0f * m_SpatialStep, bottom - top);
-                XMVECTOR nVec = XMVector3Normalize(XMLoadFloat3(&m_CurrNormals[i * m_NumCols + j]));
-                XMStoreFloat3(&m_CurrNormals[i * m_NumCols + j], nVec);
-            }
+            std::vector<XMFLOAT3> prev(numVertices), curr(numVertices), normals(numVertices);
+            // 放入一些起伏，避免全零的高度
+            for (size_t k = 0; k < numVertices; k += 97)
+                curr[k].y = 0.5f;
+
+            timer.Reset();
+            timer.Start();
+            for (uint32_t k = 0; k < numSteps; ++k)
+                StepScalar(params, prev.data(), curr.data(), normals.data());
+            timer.Tick();
+            timer.Stop();
+            result.scalarMs = timer.TotalTime() * 1000.0f / numSteps;
+        }
+
+        {
+            std::vector<float> prev(numVertices), curr(numVertices);
+            std::vector<PackedVector::XMSHORTN2> normals(numVertices);
+            for (size_t k = 0; k < numVertices; k += 97)
+                curr[k] = 0.5f;
+
+            timer.Reset();
+            timer.Start();
+            for (uint32_t k = 0; k < numSteps; ++k)
+                StepParallel(params, prev.data(), curr.data(), normals.data(), 1, size - 1);
+            timer.Tick();
+            timer.Stop();
+            result.simdMs = timer.TotalTime() * 1000.0f / numSteps;
         }
+
+        results.push_back(result);
     }
+    return results;
 }
 
 void CpuWaves::Disturb(uint32_t i, uint32_t j, float magnitude)
@@ -136,37 +341,64 @@ void CpuWaves::Disturb(uint32_t i, uint32_t j, float magnitude)
 
     // 对顶点[i][j]及其相邻顶点修改高度值
     size_t curr = i * (size_t)m_NumCols + j;
-    m_CurrSolution[curr].y += magnitude;
-    m_CurrSolution[curr - 1].y += halfMag;
-    m_CurrSolution[curr + 1].y += halfMag;
-    m_CurrSolution[curr - m_NumCols].y += halfMag;
-    m_CurrSolution[curr + m_NumCols].y += halfMag;
+    m_CurrHeights[curr] += magnitude;
+    m_CurrHeights[curr - 1] += halfMag;
+    m_CurrHeights[curr + 1] += halfMag;
+    m_CurrHeights[curr - m_NumCols] += halfMag;
+    m_CurrHeights[curr + m_NumCols] += halfMag;
 
-    m_isUpdated = true;
+    if (m_ActiveRowBegin < m_ActiveRowEnd)
+    {
+        m_ActiveRowBegin = (std::min)(m_ActiveRowBegin, i - 1);
+        m_ActiveRowEnd = (std::max)(m_ActiveRowEnd, i + 2);
+    }
+    else
+    {
+        m_ActiveRowBegin = i - 1;
+        m_ActiveRowEnd = i + 2;
+    }
+
+    // 重新计算受影响的法线
+    WaveStepParams params{ m_K1, m_K2, m_K3, 2.0f * m_SpatialStep, m_NumRows, m_NumCols };
+    uint32_t normalBegin = (std::max)(i - 2, 1u), normalEnd = (std::min)(i + 3, m_NumRows - 1);
+    for (uint32_t row = normalBegin; row < normalEnd; ++row)
+        NormalRow(params, m_CurrHeights.data(), m_CurrNormals.data(), row);
+    MarkDirtyRows(normalBegin, normalEnd);
 }
 
-void CpuWaves::Draw(ID3D11DeviceContext* deviceContext, IEffect& effect)
+void CpuWaves::Draw(ID3D11DeviceContext* deviceContext, BasicEffect& effect)
 {
-    // 更新动态顶点缓冲区的数据
-    if (m_isUpdated)
+    // 只更新发生变化的行
+    if (m_DirtyRowBegin < m_DirtyRowEnd)
     {
-        m_isUpdated = false;
-        // 更新数据
-        D3D11_MAPPED_SUBRESOURCE mappedData;
-        deviceContext->Map(m_Model.meshdatas[0].m_pVertices.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData);
-        memcpy_s(mappedData.pData, m_Model.meshdatas[0].m_VertexCount * sizeof(XMFLOAT3),
-            m_CurrSolution.data(), (uint32_t)m_CurrSolution.size() * sizeof(XMFLOAT3));
-        deviceContext->Unmap(m_Model.meshdatas[0].m_pVertices.Get(), 0);
-
-        deviceContext->Map(m_Model.meshdatas[0].m_pNormals.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedData);
-        memcpy_s(mappedData.pData, m_Model.meshdatas[0].m_VertexCount * sizeof(XMFLOAT3),
-            m_CurrNormals.data(), (uint32_t)m_CurrNormals.size() * sizeof(XMFLOAT3));
-        deviceContext->Unmap(m_Model.meshdatas[0].m_pNormals.Get(), 0);
+        MeshData& meshData = m_Model.meshdatas[0];
+        size_t first = (size_t)m_DirtyRowBegin * m_NumCols;
+        uint32_t count = (m_DirtyRowEnd - m_DirtyRowBegin) * m_NumCols;
+        D3D11_BOX box{ (uint32_t)first * sizeof(float), 0, 0, (uint32_t)(first + count) * sizeof(float), 1, 1 };
+        deviceContext->UpdateSubresource(meshData.m_pVertices.Get(), 0, &box, m_CurrHeights.data() + first, 0, 0);
+        static_assert(sizeof(PackedVector::XMSHORTN2) == sizeof(float));
+        deviceContext->UpdateSubresource(meshData.m_pNormals.Get(), 0, &box, m_CurrNormals.data() + first, 0, 0);
+        m_DirtyRowBegin = m_DirtyRowEnd = 0;
     }
 
+    effect.SetCpuWavesGrid(m_NumRows, m_NumCols, m_SpatialStep);
     GameObject::Draw(deviceContext, effect);
 }
 
+void CpuWaves::MarkDirtyRows(uint32_t begin, uint32_t end)
+{
+    if (m_DirtyRowBegin < m_DirtyRowEnd)
+    {
+        m_DirtyRowBegin = (std::min)(m_DirtyRowBegin, begin);
+        m_DirtyRowEnd = (std::max)(m_DirtyRowEnd, end);
+    }
+    else
+    {
+        m_DirtyRowBegin = begin;
+        m_DirtyRowEnd = end;
+    }
+}
+
 std::unique_ptr<EffectHelper> GpuWaves::m_pEffectHelper = nullptr;
 
 void GpuWaves::InitResource(ID3D11Device* device,
@@ -273,3 +505,292 @@ void GpuWaves::Draw(ID3D11DeviceContext* deviceContext, BasicEffect& effect)
 }
 
 
+
+//
+// OceanWaves::Simulation
+//
+
+class OceanWaves::Simulation
+{
+public:
+    void Init(uint32_t fftSize, float patchSize, float windSpeed, float windDirection,
+        Spectrum spectrum, float choppiness);
+    // 求出t时刻的三个频谱：
+    // F0 = H + i·DxSpec, F1 = DzSpec + i·SxSpec, F2 = SzSpec
+    // 由于五个场在空间域都是实数，两两打包后只需要三次复数IFFT
+    void EvaluateSpectrum(float time);
+    void Transform();
+    void Pack();
+
+    uint32_t size = 0;
+    float choppiness = 1.0f;
+    FFT2D fft;
+
+    std::vector<float> h0Re, h0Im;              // h0(k)
+    std::vector<float> h0MinusRe, h0MinusIm;    // conj(h0(-k))
+    std::vector<float> omega;                   // 量化到重复周期上的角频率
+    std::vector<float> kx, kz;                  // 波矢
+    std::vector<float> kxNorm, kzNorm;          // 单位波矢
+    std::vector<float> fieldRe[3], fieldIm[3];
+
+    std::vector<PackedVector::XMHALF4> displacements;
+    std::vector<PackedVector::XMHALF2> slopes;
+};
+
+namespace
+{
+    const float g_Gravity = 9.81f;
+    // 角频率量化到该周期的整数倍，使时间可以循环而不损失精度
+    const float g_RepeatPeriod = 200.0f;
+    // JONSWAP使用的风区长度(m)
+    const float g_Fetch = 100000.0f;
+
+    // 返回单位波数平面面积上的方差谱密度
+    float EvaluateDirectionalSpectrum(OceanWaves::Spectrum spectrum, float k, float cosTheta, float windSpeed)
+    {
+        // 只保留顺风方向的波，方向分布为(2/π)cos²θ
+        if (k < 1e-6f || cosTheta <= 0.0f)
+            return 0.0f;
+        float directional = 2.0f / XM_PI * cosTheta * cosTheta;
+        // 抑制比最大波长小很多的波
+        float largestWave = windSpeed * windSpeed / g_Gravity;
+        float smallWave = largestWave * 0.001f;
+        float suppression = expf(-k * k * smallWave * smallWave);
+
+        float omnidirectional = 0.0f;
+        if (spectrum == OceanWaves::Spectrum::Phillips)
+        {
+            // F(k) = α/2 k^-3 exp(-1/(kL)²)
+            const float alpha = 0.0081f;
+            float kL = k * largestWave;
+            omnidirectional = 0.5f * alpha / (k * k * k) * expf(-1.0f / (kL * kL));
+        }
+        else
+        {
+            // S(ω)按JONSWAP，再通过深水色散关系ω² = gk换算为F(k) = S(ω)dω/dk
+            float omega = sqrtf(g_Gravity * k);
+            float alpha = 0.076f * powf(windSpeed * windSpeed / (g_Fetch * g_Gravity), 0.22f);
+            float omegaPeak = 22.0f * powf(g_Gravity * g_Gravity / (windSpeed * g_Fetch), 1.0f / 3.0f);
+            float sigma = omega <= omegaPeak ? 0.07f : 0.09f;
+            float r = expf(-(omega - omegaPeak) * (omega - omegaPeak) / (2.0f * sigma * sigma * omegaPeak * omegaPeak));
+            float ratio = omegaPeak / omega;
+            float spectrumOmega = alpha * g_Gravity * g_Gravity / powf(omega, 5.0f) *
+                expf(-1.25f * ratio * ratio * ratio * ratio) * powf(3.3f, r);
+            omnidirectional = spectrumOmega * g_Gravity / (2.0f * omega);
+        }
+        return omnidirectional / k * directional * suppression;
+    }
+}
+
+void OceanWaves::Simulation::Init(uint32_t fftSize, float patchSize, float windSpeed, float windDirection,
+    Spectrum spectrum, float choppinessFactor)
+{
+    size = fftSize;
+    choppiness = choppinessFactor;
+    fft.Init(size);
+
+    size_t count = (size_t)size * size;
+    for (auto* pArray : { &h0Re, &h0Im, &h0MinusRe, &h0MinusIm, &omega, &kx, &kz, &kxNorm, &kzNorm })
+        pArray->assign(count, 0.0f);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        fieldRe[i].assign(count, 0.0f);
+        fieldIm[i].assign(count, 0.0f);
+    }
+    displacements.resize(count);
+    slopes.resize(count);
+
+    // 固定种子，使同样的参数得到同样的海面
+    std::mt19937 randEngine(1337);
+    std::normal_distribution<float> gauss;
+    float deltaK = XM_2PI / patchSize;
+    float omega0 = XM_2PI / g_RepeatPeriod;
+    float windX = cosf(windDirection), windZ = sinf(windDirection);
+    for (uint32_t z = 0; z < size; ++z)
+    {
+        int nz = z < size / 2 ? (int)z : (int)z - (int)size;
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            int nx = x < size / 2 ? (int)x : (int)x - (int)size;
+            size_t idx = (size_t)z * size + x;
+            kx[idx] = nx * deltaK;
+            kz[idx] = nz * deltaK;
+            float k = sqrtf(kx[idx] * kx[idx] + kz[idx] * kz[idx]);
+            if (k > 0.0f)
+            {
+                kxNorm[idx] = kx[idx] / k;
+                kzNorm[idx] = kz[idx] / k;
+            }
+            omega[idx] = floorf(sqrtf(g_Gravity * k) / omega0) * omega0;
+
+            // Nyquist频率的-k就是自身，无法保证水平位移为实数，直接舍去
+            float amplitude = 0.0f;
+            if (nx != -(int)size / 2 && nz != -(int)size / 2)
+            {
+                float cosTheta = kxNorm[idx] * windX + kzNorm[idx] * windZ;
+                amplitude = sqrtf(0.5f * EvaluateDirectionalSpectrum(spectrum, k, cosTheta, windSpeed)) * deltaK;
+            }
+            h0Re[idx] = gauss(randEngine) * amplitude;
+            h0Im[idx] = gauss(randEngine) * amplitude;
+        }
+    }
+
+    for (uint32_t z = 0; z < size; ++z)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            size_t idx = (size_t)z * size + x;
+            size_t minusIdx = (size_t)((size - z) % size) * size + (size - x) % size;
+            h0MinusRe[idx] = h0Re[minusIdx];
+            h0MinusIm[idx] = -h0Im[minusIdx];
+        }
+    }
+}
+
+void OceanWaves::Simulation::EvaluateSpectrum(float time)
+{
+    XMVECTOR t = XMVectorReplicate(time);
+    XMVECTOR one = XMVectorReplicate(1.0f);
+    ThreadPool::GetDefault().ParallelFor(0, size, 16, [&](uint32_t z0, uint32_t z1) {
+        for (size_t idx = (size_t)z0 * size; idx < (size_t)z1 * size; idx += 4)
+        {
+            XMVECTOR s, c;
+            XMVectorSinCos(&s, &c, XMVectorMultiply(LoadFloat4(&omega[idx]), t));
+
+            // H = h0·e^{iωt} + conj(h0(-k))·e^{-iωt}
+            XMVECTOR aRe = LoadFloat4(&h0Re[idx]), aIm = LoadFloat4(&h0Im[idx]);
+            XMVECTOR bRe = LoadFloat4(&h0MinusRe[idx]), bIm = LoadFloat4(&h0MinusIm[idx]);
+            XMVECTOR hRe = XMVectorAdd(XMVectorMultiply(XMVectorAdd(aRe, bRe), c), XMVectorMultiply(XMVectorSubtract(bIm, aIm), s));
+            XMVECTOR hIm = XMVectorAdd(XMVectorMultiply(XMVectorAdd(aIm, bIm), c), XMVectorMultiply(XMVectorSubtract(aRe, bRe), s));
+
+            XMVECTOR vkx = LoadFloat4(&kx[idx]), vkz = LoadFloat4(&kz[idx]);
+            XMVECTOR vkxNorm = LoadFloat4(&kxNorm[idx]), vkzNorm = LoadFloat4(&kzNorm[idx]);
+
+            // DxSpec = -i·k̂x·H，i·DxSpec = k̂x·H
+            XMVECTOR scale = XMVectorAdd(one, vkxNorm);
+            StoreFloat4(&fieldRe[0][idx], XMVectorMultiply(hRe, scale));
+            StoreFloat4(&fieldIm[0][idx], XMVectorMultiply(hIm, scale));
+            // DzSpec = -i·k̂z·H，i·SxSpec = i·(i·kx·H) = -kx·H
+            StoreFloat4(&fieldRe[1][idx], XMVectorSubtract(XMVectorMultiply(vkzNorm, hIm), XMVectorMultiply(vkx, hRe)));
+            StoreFloat4(&fieldIm[1][idx], XMVectorNegate(XMVectorAdd(XMVectorMultiply(vkzNorm, hRe), XMVectorMultiply(vkx, hIm))));
+            // SzSpec = i·kz·H
+            StoreFloat4(&fieldRe[2][idx], XMVectorNegate(XMVectorMultiply(vkz, hIm)));
+            StoreFloat4(&fieldIm[2][idx], XMVectorMultiply(vkz, hRe));
+        }
+    });
+}
+
+void OceanWaves::Simulation::Transform()
+{
+    for (uint32_t i = 0; i < 3; ++i)
+        fft.Transform(fieldRe[i].data(), fieldIm[i].data(), true);
+}
+
+void OceanWaves::Simulation::Pack()
+{
+    ThreadPool::GetDefault().ParallelFor(0, size, 16, [&](uint32_t z0, uint32_t z1) {
+        for (size_t idx = (size_t)z0 * size; idx < (size_t)z1 * size; ++idx)
+        {
+            PackedVector::XMStoreHalf4(&displacements[idx], XMVectorSet(
+                choppiness * fieldIm[0][idx], fieldRe[0][idx], choppiness * fieldRe[1][idx], 0.0f));
+            PackedVector::XMStoreHalf2(&slopes[idx], XMVectorSet(fieldIm[1][idx], fieldRe[2][idx], 0.0f, 0.0f));
+        }
+    });
+}
+
+//
+// OceanWaves
+//
+
+OceanWaves::OceanWaves() = default;
+OceanWaves::~OceanWaves() = default;
+OceanWaves::OceanWaves(OceanWaves&&) noexcept = default;
+OceanWaves& OceanWaves::operator=(OceanWaves&&) noexcept = default;
+
+void OceanWaves::InitResource(ID3D11Device* device, uint32_t rows, uint32_t cols, float texU, float texV,
+    float timeStep, float spatialStep, uint32_t fftSize, float patchSize, float windSpeed, float windDirection,
+    Spectrum spectrum, float choppiness)
+{
+    // 波速与阻尼只用于有限差分法，这里不需要
+    Waves::InitResource(device, rows, cols, texU, texV, timeStep,
+        spatialStep, 0.0f, 0.0f, 0.0f, 0.0f, false);
+
+    m_PatchSize = patchSize;
+    m_TotalTime = 0.0f;
+    m_pSimulation = std::make_unique<Simulation>();
+    m_pSimulation->Init(fftSize, patchSize, windSpeed, windDirection, spectrum, choppiness);
+
+    m_pDisplacementTexture = std::make_unique<Texture2D>(device, fftSize, fftSize,
+        DXGI_FORMAT_R16G16B16A16_FLOAT, 1, D3D11_BIND_SHADER_RESOURCE);
+    m_pSlopeTexture = std::make_unique<Texture2D>(device, fftSize, fftSize,
+        DXGI_FORMAT_R16G16_FLOAT, 1, D3D11_BIND_SHADER_RESOURCE);
+
+    // 立即求出初始时刻的海面
+    m_AccumulateTime = timeStep;
+    Update(0.0f);
+    m_AccumulateTime = 0.0f;
+}
+
+void OceanWaves::Update(float dt)
+{
+    m_AccumulateTime += dt;
+    m_TotalTime = fmodf(m_TotalTime + dt, g_RepeatPeriod);
+
+    // 仅仅在累积时间大于时间步长时才更新
+    if (m_AccumulateTime >= m_TimeStep)
+    {
+        m_pSimulation->EvaluateSpectrum(m_TotalTime);
+        m_pSimulation->Transform();
+        m_pSimulation->Pack();
+        m_IsUpdated = true;
+        m_AccumulateTime = 0.0f;
+    }
+}
+
+void OceanWaves::Draw(ID3D11DeviceContext* deviceContext, BasicEffect& effect)
+{
+    if (m_IsUpdated)
+    {
+        m_IsUpdated = false;
+        uint32_t size = m_pSimulation->size;
+        deviceContext->UpdateSubresource(m_pDisplacementTexture->GetTexture(), 0, nullptr,
+            m_pSimulation->displacements.data(), size * sizeof(PackedVector::XMHALF4), 0);
+        deviceContext->UpdateSubresource(m_pSlopeTexture->GetTexture(), 0, nullptr,
+            m_pSimulation->slopes.data(), size * sizeof(PackedVector::XMHALF2), 0);
+    }
+
+    effect.SetOceanStates(m_pDisplacementTexture->GetShaderResource(), m_pSlopeTexture->GetShaderResource(), m_PatchSize);
+    GameObject::Draw(deviceContext, effect);
+
+    // 立即撤下纹理的绑定
+    effect.SetOceanStates(nullptr, nullptr, m_PatchSize);
+    effect.Apply(deviceContext);
+}
+
+std::vector<OceanWaves::BenchmarkResult> OceanWaves::RunBenchmark(uint32_t minSize, uint32_t maxSize)
+{
+    std::vector<BenchmarkResult> results;
+    CpuTimer timer;
+    for (uint32_t size = (std::max)(minSize, 4u); size <= maxSize; size *= 2)
+    {
+        Simulation simulation;
+        simulation.Init(size, 256.0f, 10.0f, 0.0f, Spectrum::JONSWAP, 1.0f);
+        const uint32_t numSteps = 8;
+        BenchmarkResult result{ size };
+
+        auto Measure = [&](auto&& func) {
+            timer.Reset();
+            timer.Start();
+            for (uint32_t k = 0; k < numSteps; ++k)
+                func(k);
+            timer.Tick();
+            timer.Stop();
+            return timer.TotalTime() * 1000.0f / numSteps;
+        };
+        result.spectrumMs = Measure([&](uint32_t k) { simulation.EvaluateSpectrum(k * 0.033f); });
+        result.fftMs = Measure([&](uint32_t) { simulation.Transform(); });
+        result.packMs = Measure([&](uint32_t) { simulation.Pack(); });
+        results.push_back(result);
+    }
+    return results;
+}
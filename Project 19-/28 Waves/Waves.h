@@ -12,6 +12,7 @@
 #include <vector>
 #include <string>
 #include <string_view>
+#include <DirectXPackedVector.h>
 #include <Vertex.h>
 #include <Transform.h>
 #include <Texture2D.h>
@@ -107,21 +108,39 @@ public:
         float flowSpeedX,               // 水流X方向速度
         float flowSpeedY);              // 水流Y方向速度
 
+    // 按行带划分给线程池，每行用SIMD一次求解4个顶点，
+    // 并在同一次遍历中滞后一行计算法线，以复用仍在缓存中的高度
+    // 只求解可能有起伏的行，其余行的高度恒为0
     void Update(float dt);
 
     // 在顶点[i][j]处激起高度为magnitude的波浪
     // 仅允许在1 < i < rows和1 < j < cols的范围内激起
     void Disturb(uint32_t i, uint32_t j, float magnitude);
-    // 绘制水面
-    void Draw(ID3D11DeviceContext* deviceContext, IEffect& effect);
+    // 绘制水面，只上传发生变化的行。需要先调用BasicEffect::SetRenderCpuWaves
+    void Draw(ID3D11DeviceContext* deviceContext, BasicEffect& effect);
+
+    struct BenchmarkResult
+    {
+        uint32_t gridSize;              // 网格边长
+        float scalarMs;                 // 原先存放XMFLOAT3、逐点两次遍历的单线程实现的单步耗时
+        float simdMs;                   // 当前实现的单步耗时
+    };
+    // 使用当前的模拟参数，对边长从minSize到maxSize(每次翻倍)的网格比较两种实现
+    // 不创建GPU资源，但4096x4096的网格需要约600MB内存
+    std::vector<BenchmarkResult> RunBenchmark(uint32_t minSize = 128, uint32_t maxSize = 4096) const;
 
 private:
 
-    std::vector<DirectX::XMFLOAT3> m_CurrSolution;      // 保存当前模拟结果的顶点二维数组的一维展开
-    std::vector<DirectX::XMFLOAT3> m_CurrNormals;       // 保存当前模拟结果的顶点法线二维数组的一维展开
-    std::vector<DirectX::XMFLOAT3> m_PrevSolution;      // 保存上一次模拟结果的顶点位置二维数组的一维展开
+    void MarkDirtyRows(uint32_t begin, uint32_t end);
 
-    bool m_isUpdated = false;                           // 当前是否有顶点数据更新
+    std::vector<float> m_CurrHeights;                   // 保存当前模拟结果的高度二维数组的一维展开
+    std::vector<float> m_PrevHeights;                   // 保存上一次模拟结果的高度二维数组的一维展开
+    std::vector<DirectX::PackedVector::XMSHORTN2> m_CurrNormals;    // 当前模拟结果的法线xz分量，y分量由单位长度还原
+
+    uint32_t m_ActiveRowBegin = 0;                      // [begin, end)以外的内部行高度恒为0
+    uint32_t m_ActiveRowEnd = 0;
+    uint32_t m_DirtyRowBegin = 0;                       // 自上次绘制以来发生变化的行
+    uint32_t m_DirtyRowEnd = 0;
 };
 
 class GpuWaves : public Waves
@@ -168,4 +187,64 @@ private:
     std::unique_ptr<Texture2D> m_pPrevSolutionTexture;      // 保存上一次模拟结果的y值二维数组
 };
 
+class OceanWaves : public Waves
+{
+public:
+    enum class Spectrum
+    {
+        Phillips,
+        JONSWAP
+    };
+
+    struct BenchmarkResult
+    {
+        uint32_t fftSize;
+        float spectrumMs;               // 频谱随时间演化
+        float fftMs;                    // 三次二维IFFT
+        float packMs;                   // 转换为半精度纹理数据
+    };
+
+    OceanWaves();
+    ~OceanWaves();
+    // 不允许拷贝，允许移动
+    OceanWaves(const OceanWaves&) = delete;
+    OceanWaves& operator=(const OceanWaves&) = delete;
+    OceanWaves(OceanWaves&&) noexcept;
+    OceanWaves& operator=(OceanWaves&&) noexcept;
+
+    // 海面由边长为patchSize的可平铺面片重复构成，绘制网格本身的大小由rows/cols/spatialStep决定
+    void InitResource(
+        ID3D11Device* device,
+        uint32_t rows,                  // 顶点行数
+        uint32_t cols,                  // 顶点列数
+        float texU,                     // 纹理坐标U方向最大值
+        float texV,                     // 纹理坐标V方向最大值
+        float timeStep,                 // 时间步长
+        float spatialStep,              // 空间步长
+        uint32_t fftSize,               // FFT分辨率，需要是2的幂
+        float patchSize,                // 面片边长(m)
+        float windSpeed,                // 距海面10m处的风速(m/s)
+        float windDirection,            // 风向与x轴的夹角(弧度)
+        Spectrum spectrum,              // 频谱类型
+        float choppiness);              // 水平位移的系数，0表示只有高度
+
+    // 在CPU上求出当前时刻的高度、水平位移和斜率
+    void Update(float dt);
+    // 绘制海面。需要先调用BasicEffect::SetRenderOcean
+    void Draw(ID3D11DeviceContext* deviceContext, BasicEffect& effect);
+
+    // 不创建GPU资源，测量各个FFT分辨率(每次翻倍)下单次更新的耗时
+    static std::vector<BenchmarkResult> RunBenchmark(uint32_t minSize = 256, uint32_t maxSize = 1024);
+
+private:
+    class Simulation;
+
+    std::unique_ptr<Simulation> m_pSimulation;
+    std::unique_ptr<Texture2D> m_pDisplacementTexture;      // (Dx, h, Dz)
+    std::unique_ptr<Texture2D> m_pSlopeTexture;             // (dh/dx, dh/dz)
+    float m_PatchSize = 0.0f;
+    float m_TotalTime = 0.0f;                               // 按重复周期循环的模拟时间
+    bool m_IsUpdated = false;
+};
+
 #endif
@@ -5,7 +5,7 @@ using namespace DirectX;
 
 GameApp::GameApp(HINSTANCE hInstance, const std::wstring& windowName, int initWidth, int initHeight)
     : D3DApp(hInstance, windowName, initWidth, initHeight),
-    m_EnabledFog(true), m_EnabledOIT(true)
+    m_EnabledFog(true)
 {
 }
 
@@ -30,6 +30,11 @@ bool GameApp::Init()
     if (!InitResource())
         return false;
 
+    OITPoolPolicy::Desc oitPoolDesc;
+    oitPoolDesc.nodeBytes = sizeof(FLStaticNode);
+    oitPoolDesc.budgetBytes = (uint64_t)m_OITBudgetMB << 20;
+    m_OITManager.Init(m_pd3dDevice.Get(), oitPoolDesc, m_ClientWidth, m_ClientHeight);
+
     return true;
 }
 
@@ -38,13 +43,10 @@ void GameApp::OnResize()
     D3DApp::OnResize();
 
     m_pDepthTexture = std::make_unique<Depth2D>(m_pd3dDevice.Get(), m_ClientWidth, m_ClientHeight);
-    m_pFLStaticNodeBuffer = std::make_unique<StructuredBuffer<FLStaticNode>>(m_pd3dDevice.Get(), m_ClientWidth * m_ClientHeight * 4);
-    m_pStartOffsetBuffer = std::make_unique<ByteAddressBuffer>(m_pd3dDevice.Get(), m_ClientWidth * m_ClientHeight);
+    m_OITManager.OnResize(m_pd3dDevice.Get(), m_ClientWidth, m_ClientHeight);
     m_pLitTexture = std::make_unique<Texture2D>(m_pd3dDevice.Get(), m_ClientWidth, m_ClientHeight, DXGI_FORMAT_R8G8B8A8_UNORM);
 
     m_pDepthTexture->SetDebugObjectName("DepthTexture");
-    m_pFLStaticNodeBuffer->SetDebugObjectName("FLStaticNodeBuffer");
-    m_pStartOffsetBuffer->SetDebugObjectName("StartOffsetBuffer");
     m_pLitTexture->SetDebugObjectName("LitTexture");
 
     // 摄像机变更显示
@@ -83,7 +85,44 @@ void GameApp::UpdateScene(float dt)
         {
             m_BasicEffect.SetFogState(m_EnabledFog);
         }
-        ImGui::Checkbox("Enable OIT", &m_EnabledOIT);
+        static const char* modeStrs[] = {
+            "Auto (OIT Only Where Needed)",
+            "Sorted Queue",
+            "Linked List OIT",
+            "Unsorted"
+        };
+        ImGui::Combo("Transparency", &m_TransparencyMode, modeStrs, ARRAYSIZE(modeStrs));
+        if (m_TransparencyMode <= 1)
+        {
+            ImGui::Checkbox("Split Clusters", &m_SplitClusters);
+            const TransparentQueue::Stats& stats = m_TransparentQueue.GetStats();
+            ImGui::Text("Sort Time: %.4f ms", stats.sortTimeMs);
+            ImGui::Text("Objects: %u  Items: %u  OIT Objects: %u", stats.objectCount, stats.itemCount, stats.oitObjectCount);
+            ImGui::Text("Draws Back/OIT/Front: %u / %u / %u", stats.drawCounts[TransparentQueue::Layer_Back],
+                stats.drawCounts[TransparentQueue::Layer_OIT], stats.drawCounts[TransparentQueue::Layer_Front]);
+        }
+        if (ImGui::CollapsingHeader("OIT Node Pool"))
+        {
+            if (ImGui::SliderInt("Budget (MB)", &m_OITBudgetMB, 16, 512))
+                m_OITManager.SetBudget(m_pd3dDevice.Get(), (uint64_t)m_OITBudgetMB << 20);
+            const OITPoolPolicy::Stats& stats = m_OITManager.GetPolicy().GetStats();
+            ImGui::Text("Capacity: %u nodes (%.1f MB)", m_OITManager.GetNodeCapacity(),
+                m_OITManager.GetNodeBufferBytes() / 1048576.0);
+            ImGui::Text("Requested: %u  High Water: %u", stats.lastRequested, stats.highWaterMark);
+            ImGui::Text("Overflow Frames: %llu  Dropped: %u (Total %llu)", stats.overflowFrames,
+                stats.lastDropped, stats.droppedNodes);
+            ImGui::Text("Resizes: %u", stats.resizeCount);
+            if (ImGui::Button("Run Pool Policy Test"))
+                m_PoolPolicyTest = RunOITPoolPolicyTest();
+            if (m_PoolPolicyTest.numChecks)
+            {
+                if (m_PoolPolicyTest.numFailed)
+                    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "FAILED %u/%u: %s",
+                        m_PoolPolicyTest.numFailed, m_PoolPolicyTest.numChecks, m_PoolPolicyTest.firstFailure);
+                else
+                    ImGui::Text("Passed %u Checks", m_PoolPolicyTest.numChecks);
+            }
+        }
     }
     ImGui::End();
     ImGui::Render();
@@ -114,8 +153,22 @@ void GameApp::DrawScene()
         m_pd3dDevice->CreateRenderTargetView(pBackBuffer.Get(), &rtvDesc, m_pRenderTargetViews[m_FrameCount].ReleaseAndGetAddressOf());
     }
 
+    // 收集并排序透明物体
+    bool useQueue = m_TransparencyMode <= 1;
+    if (useQueue)
+    {
+        m_TransparentQueue.Clear();
+        m_TransparentQueue.AddObject(m_RedBox, m_SplitClusters);
+        m_TransparentQueue.AddObject(m_YellowBox, m_SplitClusters);
+        m_TransparentQueue.AddCustom(m_GpuWaves.GetBoundingBox(), [this](ID3D11DeviceContext* deviceContext, IEffect&) {
+            m_GpuWaves.Draw(deviceContext, m_BasicEffect);
+        });
+        m_TransparentQueue.Sort(m_pCamera->GetViewMatrixXM(), m_TransparencyMode == 0);
+    }
+    bool useOIT = m_TransparencyMode == 2 || (m_TransparencyMode == 0 && m_TransparentQueue.HasLayer(TransparentQueue::Layer_OIT));
+
     float gray[4] = { 0.75f, 0.75f, 0.75f, 1.0f };
-    ID3D11RenderTargetView* pRTVs[1] = { m_EnabledOIT ? m_pLitTexture->GetRenderTarget() : GetBackBufferRTV() };
+    ID3D11RenderTargetView* pRTVs[1] = { useOIT ? m_pLitTexture->GetRenderTarget() : GetBackBufferRTV() };
     m_pd3dImmediateContext->ClearRenderTargetView(*pRTVs, gray);
     m_pd3dImmediateContext->ClearDepthStencilView(m_pDepthTexture->GetDepthStencil(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
     m_pd3dImmediateContext->OMSetRenderTargets(1, pRTVs, m_pDepthTexture->GetDepthStencil());
@@ -129,42 +182,64 @@ void GameApp::DrawScene()
     m_Land.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
 
     // ******************
-    // 2. 存放透明物体的像素片元
+    // 2. 绘制在所有OIT物体之后的透明物体，并存放需要OIT的透明物体的像素片元
     //
-    if (m_EnabledOIT)
+    if (useQueue)
+    {
+        m_BasicEffect.SetRenderTransparent();
+        m_TransparentQueue.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect, TransparentQueue::Layer_Back);
+    }
+    if (useOIT)
     {
+        m_OITManager.BeginFrame(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
         m_BasicEffect.ClearOITBuffers(
             m_pd3dImmediateContext.Get(),
-            m_pFLStaticNodeBuffer->GetUnorderedAccess(),
-            m_pStartOffsetBuffer->GetUnorderedAccess()
+            m_OITManager.GetNodeBufferUAV(),
+            m_OITManager.GetStartOffsetUAV()
         );
         m_BasicEffect.SetRenderOITStorage(
-            m_pFLStaticNodeBuffer->GetUnorderedAccess(), 
-            m_pStartOffsetBuffer->GetUnorderedAccess(),
+            m_OITManager.GetNodeBufferUAV(), 
+            m_OITManager.GetStartOffsetUAV(),
             m_ClientWidth);
     }
-    else
+    else if (!useQueue)
     {
         m_BasicEffect.SetRenderTransparent();
     }
-    m_RedBox.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
-    m_YellowBox.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
-    m_GpuWaves.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+    if (useQueue)
+    {
+        if (useOIT)
+            m_TransparentQueue.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect, TransparentQueue::Layer_OIT);
+    }
+    else
+    {
+        m_RedBox.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+        m_YellowBox.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+        m_GpuWaves.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect);
+    }
 
     // ******************
-    // 3. 进行透明混合
+    // 3. 进行透明混合，再绘制在所有OIT物体之前的透明物体
     //
-    if (m_EnabledOIT)
+    if (useOIT)
     {
+        m_OITManager.EndStorage(m_pd3dImmediateContext.Get());
         m_BasicEffect.RenderOIT(
             m_pd3dImmediateContext.Get(),
-            m_pFLStaticNodeBuffer->GetShaderResource(),
-            m_pStartOffsetBuffer->GetShaderResource(),
+            m_OITManager.GetNodeBufferSRV(),
+            m_OITManager.GetStartOffsetSRV(),
             m_pLitTexture->GetShaderResource(),
             GetBackBufferRTV(),
             m_pCamera->GetViewPort()
         );
     }
+    if (useQueue && m_TransparentQueue.HasLayer(TransparentQueue::Layer_Front))
+    {
+        pRTVs[0] = GetBackBufferRTV();
+        m_pd3dImmediateContext->OMSetRenderTargets(1, pRTVs, m_pDepthTexture->GetDepthStencil());
+        m_BasicEffect.SetRenderTransparent();
+        m_TransparentQueue.Draw(m_pd3dImmediateContext.Get(), m_BasicEffect, TransparentQueue::Layer_Front);
+    }
     
     pRTVs[0] = GetBackBufferRTV();
     m_pd3dImmediateContext->OMSetRenderTargets(1, pRTVs, nullptr);
@@ -200,7 +275,8 @@ bool GameApp::InitResource()
     }
     // 红色盒子
     {
-        Model* pModel = m_ModelManager.CreateFromGeometry("RedBox", Geometry::CreateBox(8.0f, 8.0f, 8.0f));
+        // 每个面两个三角形为一簇，透明排序时按面从后往前绘制
+        Model* pModel = m_ModelManager.CreateFromGeometry("RedBox", Geometry::CreateBox(8.0f, 8.0f, 8.0f), false, 2);
         pModel->SetDebugObjectName("RedBox");
         m_TextureManager.CreateFromFile("..\\Texture\\Red.dds");
         pModel->materials[0].Set<std::string>("$Diffuse", "..\\Texture\\Red.dds");
@@ -214,7 +290,7 @@ bool GameApp::InitResource()
     }
     // 黄色盒子
     {
-        Model* pModel = m_ModelManager.CreateFromGeometry("YellowBox", Geometry::CreateBox(8.0f, 8.0f, 8.0f));
+        Model* pModel = m_ModelManager.CreateFromGeometry("YellowBox", Geometry::CreateBox(8.0f, 8.0f, 8.0f), false, 2);
         pModel->SetDebugObjectName("YellowBox");
         m_TextureManager.CreateFromFile("..\\Texture\\Yellow.dds");
         pModel->materials[0].Set<std::string>("$Diffuse", "..\\Texture\\Yellow.dds");
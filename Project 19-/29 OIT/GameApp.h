@@ -14,18 +14,8 @@
 #include <Collision.h>
 #include <ModelManager.h>
 #include <TextureManager.h>
-
-struct FragmentData
-{
-    uint32_t color;
-    float depth;
-};
-
-struct FLStaticNode
-{
-    FragmentData data;
-    uint32_t next;
-};
+#include <TransparentQueue.h>
+#include "OITManager.h"
 
 class GameApp : public D3DApp
 {
@@ -58,15 +48,20 @@ private:
     GameObject m_YellowBox;                                     // 黄色盒子
     GpuWaves m_GpuWaves;                                        // GPU水波
 
-    std::unique_ptr<StructuredBuffer<FLStaticNode>> m_pFLStaticNodeBuffer;    // 静态链表缓冲区
-    std::unique_ptr<ByteAddressBuffer> m_pStartOffsetBuffer;    // 起始偏移缓冲区
+    OITManager m_OITManager;                                    // OIT链表缓冲区
+    int m_OITBudgetMB = 128;                                    // OIT节点池的内存预算
+    OITPoolPolicyTestResult m_PoolPolicyTest{};                 // 节点池策略的检查结果
 
     std::unique_ptr<Depth2D> m_pDepthTexture;                   // 深度纹理
     std::unique_ptr<Texture2D> m_pLitTexture;                   // 不透明场景渲染缓冲区
 
     float m_BaseTime = 0.0f;									// 控制水波生成的基准时间
     bool m_EnabledFog = true;									// 开启雾效
-    bool m_EnabledOIT = true;                                   // 开启OIT
+    // 0: 自动(只对相交的物体使用OIT)  1: 排序队列  2: 链表OIT  3: 不排序
+    int m_TransparencyMode = 0;
+    bool m_SplitClusters = true;                                // 透明物体按簇排序
+
+    TransparentQueue m_TransparentQueue;                        // 从后往前排序的透明物体队列
 
     std::shared_ptr<ThirdPersonCamera> m_pCamera;				// 摄像机
 };
@@ -0,0 +1,68 @@
+#include "OITManager.h"
+
+void OITManager::Init(ID3D11Device* device, const OITPoolPolicy::Desc& desc, uint32_t width, uint32_t height)
+{
+    m_Policy = OITPoolPolicy(desc, desc.minNodes);
+    m_pFLStaticNodeBuffer.reset();
+
+    CD3D11_BUFFER_DESC stagingDesc(sizeof(uint32_t), 0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+    for (auto& pReadback : m_pReadbackBuffers)
+        device->CreateBuffer(&stagingDesc, nullptr, pReadback.ReleaseAndGetAddressOf());
+    m_ReadbackRing.Reset();
+
+    OnResize(device, width, height);
+}
+
+void OITManager::OnResize(ID3D11Device* device, uint32_t width, uint32_t height)
+{
+    if (!m_pReadbackBuffers[0])
+        return;
+
+    m_pStartOffsetBuffer = std::make_unique<ByteAddressBuffer>(device, width * height);
+    m_pStartOffsetBuffer->SetDebugObjectName("StartOffsetBuffer");
+
+    // 首次按每像素一个节点估计，之后由回读结果调整，窗口大小改变时保留统计
+    if (!m_pFLStaticNodeBuffer)
+    {
+        m_Policy = OITPoolPolicy(m_Policy.GetDesc(), width * height);
+        CreateNodeBuffer(device, m_Policy.GetCapacity());
+    }
+}
+
+void OITManager::BeginFrame(ID3D11Device* device, ID3D11DeviceContext* deviceContext)
+{
+    // 从最早提交的回读开始，只取已经完成的结果，不等待GPU
+    m_ReadbackRing.Poll(m_Policy, [&](uint32_t slot, uint32_t& requested) {
+        D3D11_MAPPED_SUBRESOURCE mappedData;
+        if (FAILED(deviceContext->Map(m_pReadbackBuffers[slot].Get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedData)))
+            return false;
+        requested = *static_cast<uint32_t*>(mappedData.pData);
+        deviceContext->Unmap(m_pReadbackBuffers[slot].Get(), 0);
+        return true;
+    });
+
+    if (m_Policy.GetCapacity() != m_NodeCapacity)
+        CreateNodeBuffer(device, m_Policy.GetCapacity());
+}
+
+void OITManager::EndStorage(ID3D11DeviceContext* deviceContext)
+{
+    // 所有槽都在等待时跳过这一帧
+    int slot = m_ReadbackRing.Push(m_NodeCapacity);
+    if (slot < 0)
+        return;
+    deviceContext->CopyStructureCount(m_pReadbackBuffers[slot].Get(), 0, m_pFLStaticNodeBuffer->GetUnorderedAccess());
+}
+
+void OITManager::SetBudget(ID3D11Device* device, uint64_t budgetBytes)
+{
+    if (m_Policy.SetBudget(budgetBytes) != m_NodeCapacity)
+        CreateNodeBuffer(device, m_Policy.GetCapacity());
+}
+
+void OITManager::CreateNodeBuffer(ID3D11Device* device, uint32_t capacity)
+{
+    m_NodeCapacity = capacity;
+    m_pFLStaticNodeBuffer = std::make_unique<StructuredBuffer<FLStaticNode>>(device, capacity);
+    m_pFLStaticNodeBuffer->SetDebugObjectName("FLStaticNodeBuffer");
+}
@@ -0,0 +1,68 @@
+//***************************************************************************************
+// OITManager.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 管理OIT的链表节点池与起始偏移缓冲区，异步回读节点计数并自适应调整节点池大小
+// Manages OIT linked-list buffers, reads node counts back asynchronously and resizes the pool.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef OIT_MANAGER_H
+#define OIT_MANAGER_H
+
+#include <memory>
+#include <WinMin.h>
+#include <Buffer.h>
+#include "OITPoolPolicy.h"
+
+struct FragmentData
+{
+    uint32_t color;
+    float depth;
+};
+
+struct FLStaticNode
+{
+    FragmentData data;
+    uint32_t next;
+};
+
+class OITManager
+{
+public:
+    template <class T>
+    using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+    void Init(ID3D11Device* device, const OITPoolPolicy::Desc& desc, uint32_t width, uint32_t height);
+    // 起始偏移缓冲区与分辨率一致，节点池初始为每像素一个节点。Init之前调用时忽略
+    void OnResize(ID3D11Device* device, uint32_t width, uint32_t height);
+
+    // 每帧在存放片元之前调用：处理已完成的回读，必要时重建节点池
+    void BeginFrame(ID3D11Device* device, ID3D11DeviceContext* deviceContext);
+    // 存放片元之后调用：把节点计数器拷贝到回读缓冲区
+    void EndStorage(ID3D11DeviceContext* deviceContext);
+
+    void SetBudget(ID3D11Device* device, uint64_t budgetBytes);
+
+    ID3D11UnorderedAccessView* GetNodeBufferUAV() { return m_pFLStaticNodeBuffer->GetUnorderedAccess(); }
+    ID3D11ShaderResourceView* GetNodeBufferSRV() { return m_pFLStaticNodeBuffer->GetShaderResource(); }
+    ID3D11UnorderedAccessView* GetStartOffsetUAV() { return m_pStartOffsetBuffer->GetUnorderedAccess(); }
+    ID3D11ShaderResourceView* GetStartOffsetSRV() { return m_pStartOffsetBuffer->GetShaderResource(); }
+
+    uint32_t GetNodeCapacity() const { return m_NodeCapacity; }
+    uint64_t GetNodeBufferBytes() const { return (uint64_t)m_NodeCapacity * sizeof(FLStaticNode); }
+    const OITPoolPolicy& GetPolicy() const { return m_Policy; }
+
+private:
+    void CreateNodeBuffer(ID3D11Device* device, uint32_t capacity);
+
+    OITPoolPolicy m_Policy;
+    uint32_t m_NodeCapacity = 0;
+    std::unique_ptr<StructuredBuffer<FLStaticNode>> m_pFLStaticNodeBuffer;     // 静态链表缓冲区
+    std::unique_ptr<ByteAddressBuffer> m_pStartOffsetBuffer;                    // 起始偏移缓冲区
+    ComPtr<ID3D11Buffer> m_pReadbackBuffers[OITReadbackRing::s_Size];           // 节点计数的回读缓冲区
+    OITReadbackRing m_ReadbackRing;
+};
+
+#endif
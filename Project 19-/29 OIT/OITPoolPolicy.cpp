@@ -0,0 +1,266 @@
+#include "OITPoolPolicy.h"
+#include <algorithm>
+#include <vector>
+
+OITPoolPolicy::OITPoolPolicy(const Desc& desc, uint32_t initialCapacity)
+    : m_Desc(desc)
+{
+    m_Capacity = ClampCapacity(initialCapacity);
+}
+
+uint32_t OITPoolPolicy::Update(uint32_t requestedNodes, uint32_t capacityUsed)
+{
+    m_Stats.lastRequested = requestedNodes;
+    m_Stats.lastDropped = requestedNodes > capacityUsed ? requestedNodes - capacityUsed : 0;
+    if (m_Stats.lastDropped)
+    {
+        ++m_Stats.overflowFrames;
+        m_Stats.droppedNodes += m_Stats.lastDropped;
+    }
+
+    m_History.push_back(requestedNodes);
+    while (m_History.size() > (std::max)(m_Desc.historyFrames, 1u))
+        m_History.pop_front();
+    m_Stats.highWaterMark = *std::max_element(m_History.begin(), m_History.end());
+    ++m_FramesSinceResize;
+
+    uint32_t target = ClampCapacity((uint64_t)(m_Stats.highWaterMark * (double)m_Desc.headroom));
+    if (requestedNodes > m_Capacity)
+    {
+        // 溢出：按高水位加余量扩容
+        SetCapacity((std::max)(target, m_Capacity));
+    }
+    else if (m_FramesSinceResize >= m_Desc.historyFrames &&
+        target < (uint64_t)(m_Capacity * (double)m_Desc.shrinkRatio))
+    {
+        // 整个窗口内都用不到这么多节点时才收缩
+        SetCapacity(target);
+    }
+    return m_Capacity;
+}
+
+uint32_t OITPoolPolicy::SetBudget(uint64_t budgetBytes)
+{
+    m_Desc.budgetBytes = budgetBytes;
+    SetCapacity((std::min)(m_Capacity, GetMaxCapacity()));
+    return m_Capacity;
+}
+
+uint32_t OITPoolPolicy::GetMaxCapacity() const
+{
+    uint64_t maxNodes = m_Desc.budgetBytes ? m_Desc.budgetBytes / (std::max)(m_Desc.nodeBytes, 1u) : UINT32_MAX;
+    // 向下对齐，但至少保留一个粒度
+    uint64_t granularity = (std::max)(m_Desc.granularity, 1u);
+    maxNodes = (std::max)(maxNodes / granularity * granularity, granularity);
+    return (uint32_t)(std::min)(maxNodes, (uint64_t)UINT32_MAX / granularity * granularity);
+}
+
+uint32_t OITPoolPolicy::ClampCapacity(uint64_t nodes) const
+{
+    uint64_t granularity = (std::max)(m_Desc.granularity, 1u);
+    nodes = (std::max)(nodes, (uint64_t)m_Desc.minNodes);
+    nodes = (nodes + granularity - 1) / granularity * granularity;
+    return (uint32_t)(std::min)(nodes, (uint64_t)GetMaxCapacity());
+}
+
+void OITPoolPolicy::SetCapacity(uint32_t capacity)
+{
+    if (capacity == m_Capacity)
+        return;
+    m_Capacity = capacity;
+    m_FramesSinceResize = 0;
+    ++m_Stats.resizeCount;
+}
+
+int OITReadbackRing::Push(uint32_t capacityUsed)
+{
+    Slot& slot = m_Slots[m_Index];
+    if (slot.pending)
+        return -1;
+    slot.capacity = capacityUsed;
+    slot.pending = true;
+    int slotIndex = (int)m_Index;
+    m_Index = (m_Index + 1) % s_Size;
+    return slotIndex;
+}
+
+void OITReadbackRing::Reset()
+{
+    for (auto& slot : m_Slots)
+        slot = Slot{};
+    m_Index = 0;
+}
+
+namespace
+{
+    struct PoolChecker
+    {
+        OITPoolPolicyTestResult result{ 0, 0, nullptr };
+
+        void Check(bool condition, const char* description)
+        {
+            ++result.numChecks;
+            if (condition)
+                return;
+            ++result.numFailed;
+            if (!result.firstFailure)
+                result.firstFailure = description;
+        }
+    };
+
+    struct RingSimulation
+    {
+        uint32_t firstOverflowFrame = UINT32_MAX;   // 策略第一次看到溢出的帧
+        uint32_t capacityAfterSpike = 0;            // 看到尖峰后的容量
+        uint32_t secondDropped = 0;                 // 第二个尖峰的丢弃数
+        uint64_t overflowFrames = 0;
+        uint32_t skippedFrames = 0;                 // 所有槽都在等待而跳过写入的帧数
+        bool inOrder = true;                        // 取回的帧号严格递增
+        bool allRetrieved = true;                   // 写入的计数最终都被取回
+    };
+
+    // 第frame帧开始时处理回读、结束时写入计数；GPU在写入gpuLatency帧后才完成。
+    // 第10、11帧分别请求200000与150000个节点，其余帧远低于容量
+    RingSimulation SimulateReadbackRing(uint32_t gpuLatency)
+    {
+        RingSimulation sim;
+        OITPoolPolicy policy(OITPoolPolicy::Desc{}, 0);
+        OITReadbackRing ring;
+        uint32_t slotFrames[OITReadbackRing::s_Size] = {};
+        uint32_t slotRequested[OITReadbackRing::s_Size] = {};
+        uint32_t lastRetrieved = 0, numPushed = 0, numRetrieved = 0;
+        bool anyRetrieved = false;
+        const uint32_t numFrames = 40;
+
+        for (uint32_t frame = 0; frame < numFrames + gpuLatency; ++frame)
+        {
+            numRetrieved += ring.Poll(policy, [&](uint32_t slot, uint32_t& requested) {
+                if (frame < slotFrames[slot] + gpuLatency)
+                    return false;
+                if (anyRetrieved && slotFrames[slot] <= lastRetrieved)
+                    sim.inOrder = false;
+                anyRetrieved = true;
+                lastRetrieved = slotFrames[slot];
+                requested = slotRequested[slot];
+                return true;
+            });
+
+            const OITPoolPolicy::Stats& stats = policy.GetStats();
+            if (stats.lastDropped && sim.firstOverflowFrame == UINT32_MAX)
+            {
+                sim.firstOverflowFrame = frame;
+                sim.capacityAfterSpike = policy.GetCapacity();
+            }
+            else if (stats.lastDropped && stats.lastRequested == 150000)
+                sim.secondDropped = stats.lastDropped;
+
+            if (frame >= numFrames)
+                continue;
+            int slot = ring.Push(policy.GetCapacity());
+            if (slot < 0)
+            {
+                ++sim.skippedFrames;
+                continue;
+            }
+            slotFrames[slot] = frame;
+            slotRequested[slot] = frame == 10 ? 200000 : frame == 11 ? 150000 : 1000 + frame;
+            ++numPushed;
+        }
+        sim.overflowFrames = policy.GetStats().overflowFrames;
+        sim.allRetrieved = numPushed == numRetrieved;
+        return sim;
+    }
+}
+
+OITPoolPolicyTestResult RunOITPoolPolicyTest()
+{
+    PoolChecker checker;
+
+    //
+    // 初始容量、溢出扩容与预算上限(12MB即1M个节点)
+    //
+    {
+        OITPoolPolicy::Desc desc;
+        desc.budgetBytes = 12ull << 20;
+        OITPoolPolicy policy(desc, 100000);
+        checker.Check(policy.GetCapacity() == 131072, "Initial capacity is rounded up to the granularity");
+        checker.Check(policy.GetMaxCapacity() == 1048576, "Max capacity follows the budget");
+
+        uint32_t capacity = policy.Update(50000, policy.GetCapacity());
+        checker.Check(capacity == 131072 && policy.GetStats().overflowFrames == 0 && policy.GetStats().resizeCount == 0,
+            "Requests below capacity neither overflow nor resize");
+
+        capacity = policy.Update(400000, capacity);
+        checker.Check(policy.GetStats().lastDropped == 400000 - 131072 && policy.GetStats().overflowFrames == 1,
+            "Overflow counts the nodes beyond the capacity used");
+        checker.Check(capacity == 524288 && policy.GetStats().resizeCount == 1,
+            "Overflow grows immediately to high water x headroom");
+
+        capacity = policy.Update(5000000, capacity);
+        checker.Check(capacity == 1048576, "Growth is capped by the budget");
+        checker.Check(policy.GetStats().droppedNodes == (400000 - 131072) + (5000000 - 524288) &&
+            policy.GetStats().overflowFrames == 2, "Dropped nodes accumulate over overflow frames");
+
+        desc.budgetBytes = 12000;
+        checker.Check(OITPoolPolicy(desc, 1).GetCapacity() == 65536, "A tiny budget still keeps one granule");
+    }
+
+    //
+    // 收缩的滞回与预算下调
+    //
+    {
+        OITPoolPolicy policy(OITPoolPolicy::Desc{}, 0);
+        checker.Check(policy.GetCapacity() == 65536, "Initial capacity is at least minNodes");
+        uint32_t capacity = policy.Update(400000, policy.GetCapacity());
+        checker.Check(capacity == 524288, "Unbudgeted overflow grows to high water x headroom");
+
+        bool keptSize = true;
+        for (uint32_t i = 0; i < 200; ++i)
+            keptSize = policy.Update(300000, capacity) == 524288 && keptSize;
+        checker.Check(keptSize && policy.GetStats().resizeCount == 1,
+            "No shrink while high water x headroom stays above shrinkRatio x capacity");
+
+        // 200000 x 1.25对齐后恰好等于收缩比例 x 容量
+        for (uint32_t i = 0; i < 200; ++i)
+            keptSize = policy.Update(200000, capacity) == 524288 && keptSize;
+        checker.Check(keptSize, "No shrink when the target equals shrinkRatio x capacity");
+
+        for (uint32_t i = 0; i < 119; ++i)
+            keptSize = policy.Update(100000, capacity) == 524288 && keptSize;
+        checker.Check(keptSize, "No shrink while the old high water is still in the window");
+        capacity = policy.Update(100000, capacity);
+        checker.Check(capacity == 131072 && policy.GetStats().resizeCount == 2,
+            "Shrink on the frame the old high water leaves the window");
+
+        capacity = policy.SetBudget(12 * 100000);
+        checker.Check(capacity == 65536 && policy.GetMaxCapacity() == 65536, "Lowering the budget shrinks immediately");
+        capacity = policy.Update(100000, capacity);
+        checker.Check(capacity == 65536 && policy.GetStats().lastDropped == 100000 - 65536,
+            "Overflow cannot grow past the budget");
+        checker.Check(policy.SetBudget(0) == 65536, "Raising the budget does not grow by itself");
+    }
+
+    //
+    // 回读环：尖峰在GPU延迟之后被看到，丢弃数按写入时的容量计算
+    // 延迟至少为2帧时第二个尖峰才会在扩容前写入
+    //
+    for (uint32_t gpuLatency = 2; gpuLatency <= OITReadbackRing::s_Size; ++gpuLatency)
+    {
+        RingSimulation sim = SimulateReadbackRing(gpuLatency);
+        checker.Check(sim.firstOverflowFrame == 10 + gpuLatency, "A spike reaches the policy exactly gpuLatency frames later");
+        checker.Check(sim.capacityAfterSpike == 262144, "The pool grows on the frame the spike is read back");
+        checker.Check(sim.secondDropped == 150000 - 65536, "Drops are counted against the capacity at write time");
+        checker.Check(sim.overflowFrames == 2, "In-flight counts written before the resize still overflow");
+        checker.Check(sim.skippedFrames == 0, "A latency up to the ring size never skips a frame");
+        checker.Check(sim.inOrder && sim.allRetrieved, "Counts are read back in submission order");
+    }
+
+    // GPU延迟超过槽数时跳过写入而不阻塞，取回的顺序不变
+    {
+        RingSimulation sim = SimulateReadbackRing(OITReadbackRing::s_Size + 1);
+        checker.Check(sim.skippedFrames > 0, "A latency beyond the ring size skips frames");
+        checker.Check(sim.inOrder && sim.allRetrieved, "Skipped frames keep the read back order");
+    }
+
+    return checker.result;
+}
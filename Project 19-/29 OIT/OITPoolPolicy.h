@@ -0,0 +1,129 @@
+//***************************************************************************************
+// OITPoolPolicy.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// OIT链表节点池的容量策略，根据回读的节点请求数扩容或收缩
+// Capacity policy of the OIT linked-list node pool driven by read back node counts.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef OIT_POOL_POLICY_H
+#define OIT_POOL_POLICY_H
+
+#include <cstdint>
+#include <deque>
+
+class OITPoolPolicy
+{
+public:
+    struct Desc
+    {
+        uint32_t nodeBytes = 12;            // 每个节点的字节数
+        uint32_t minNodes = 1 << 16;        // 容量下限
+        uint32_t granularity = 1 << 16;     // 容量按此对齐，避免频繁重建
+        float headroom = 1.25f;             // 新容量 = 高水位 x headroom
+        float shrinkRatio = 0.5f;           // 窗口内高水位 x headroom 低于容量的此比例时收缩
+        uint32_t historyFrames = 120;       // 高水位的统计窗口
+        uint64_t budgetBytes = 0;           // 节点池的内存预算，0表示不限制
+    };
+
+    struct Stats
+    {
+        uint32_t lastRequested = 0;         // 最近一帧请求的节点数
+        uint32_t highWaterMark = 0;         // 窗口内的最大请求数
+        uint64_t overflowFrames = 0;        // 请求数超过当时容量的帧数
+        uint64_t droppedNodes = 0;          // 累计丢弃的节点(片元)数
+        uint32_t lastDropped = 0;           // 最近一帧丢弃的节点数
+        uint32_t resizeCount = 0;           // 容量改变的次数
+    };
+
+    OITPoolPolicy() = default;
+    OITPoolPolicy(const Desc& desc, uint32_t initialCapacity);
+
+    // 记录一帧的节点请求数以及该帧使用的容量，返回新的容量
+    // 超出容量时立即扩容，窗口内持续偏低时才收缩，且始终不超过预算
+    uint32_t Update(uint32_t requestedNodes, uint32_t capacityUsed);
+
+    // 预算改变后立即收缩到预算以内
+    uint32_t SetBudget(uint64_t budgetBytes);
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetMaxCapacity() const;
+    const Desc& GetDesc() const { return m_Desc; }
+    const Stats& GetStats() const { return m_Stats; }
+
+private:
+    uint32_t ClampCapacity(uint64_t nodes) const;
+    void SetCapacity(uint32_t capacity);
+
+    Desc m_Desc;
+    uint32_t m_Capacity = 0;
+    uint32_t m_FramesSinceResize = 0;
+    std::deque<uint32_t> m_History;         // 最近historyFrames帧的请求数
+    Stats m_Stats;
+};
+
+// 节点计数回读环的槽位管理，与D3D资源无关
+// 计数写入后至多在s_Size帧内陆续取回，按提交顺序交给策略；所有槽都在等待时跳过写入而不阻塞
+class OITReadbackRing
+{
+public:
+    static constexpr uint32_t s_Size = 3;
+
+    // 存放片元之后调用：占用下一个槽并记录写入时的容量，返回槽号；所有槽都在等待时返回-1
+    int Push(uint32_t capacityUsed);
+
+    // 每帧开始时调用：从最早提交的槽开始，tryRead(slot, requested)读取已完成的计数，
+    // 返回false表示GPU尚未完成，此时停止以保证顺序。返回取回的个数
+    template <class TryRead>
+    uint32_t Poll(OITPoolPolicy& policy, TryRead&& tryRead)
+    {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < s_Size; ++i)
+        {
+            uint32_t slotIndex = (m_Index + i) % s_Size;
+            Slot& slot = m_Slots[slotIndex];
+            if (!slot.pending)
+                continue;
+            uint32_t requested = 0;
+            if (!tryRead(slotIndex, requested))
+                break;
+            slot.pending = false;
+            policy.Update(requested, slot.capacity);
+            ++count;
+        }
+        return count;
+    }
+
+    void Reset();
+
+private:
+    struct Slot
+    {
+        uint32_t capacity = 0;              // 写入计数时节点池的容量
+        bool pending = false;
+    };
+
+    Slot m_Slots[s_Size];
+    uint32_t m_Index = 0;                   // 下一个写入的槽，也是最早提交的槽
+};
+
+//
+// 正确性检查
+//
+
+struct OITPoolPolicyTestResult
+{
+    uint32_t numChecks;                 // 检查的条件总数
+    uint32_t numFailed;                 // 不满足的条件数目
+    const char* firstFailure;           // 第一个不满足的条件，全部满足时为nullptr
+};
+
+// 按脚本化的片元数序列驱动策略：初始容量的对齐与预算上限，溢出时的丢弃统计与立即扩容，
+// 收缩的滞回(目标不低于收缩比例时保持，高水位滑出窗口的那一帧才收缩)，预算下调时立即收缩；
+// 并用模拟的GPU延迟驱动回读环：尖峰恰好在GPU延迟后被看到，丢弃数按写入时的容量计算，
+// 延迟超过槽数时跳过写入但取回的顺序不变
+OITPoolPolicyTestResult RunOITPoolPolicyTest();
+
+#endif
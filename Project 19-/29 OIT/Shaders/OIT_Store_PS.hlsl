@@ -70,7 +70,12 @@ void PS(VertexPosHWNormalTex pIn)
     litColor = saturate(litColor);
     
     // 取得当前像素数目并自递增计数器
+    // 超出节点池容量时丢弃该片元，计数器仍会增加，CPU回读后据此扩容并统计溢出
     uint pixelCount = g_FLBufferRW.IncrementCounter();
+    uint numNodes, stride;
+    g_FLBufferRW.GetDimensions(numNodes, stride);
+    if (pixelCount >= numNodes)
+        return;
     
     // 在StartOffsetBuffer实现值交换
     uint2 vPos = (uint2) pIn.posH.xy;  
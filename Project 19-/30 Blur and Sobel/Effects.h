@@ -14,6 +14,8 @@
 #include <MeshData.h>
 #include <LightHelper.h>
 
+struct BlurPyramidPass;
+
 class BasicEffect : public IEffect, public IEffectTransform,
     public IEffectMaterial, public IEffectMeshData
 {
@@ -169,6 +171,17 @@ public:
         ID3D11UnorderedAccessView* output,
         uint32_t width, uint32_t height);
 
+    //
+    // 模糊金字塔
+    //
+
+    // 执行BlurPyramid::BuildSchedule生成的一趟，output的大小为pass.dstWidth x pass.dstHeight
+    void ComputeBlurPyramidPass(
+        ID3D11DeviceContext* deviceContext,
+        ID3D11ShaderResourceView* input,
+        ID3D11UnorderedAccessView* output,
+        const BlurPyramidPass& pass);
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl;
@@ -1,6 +1,7 @@
 #include "GameApp.h"
 #include <XUtil.h>
 #include <DXTrace.h>
+#include <ThreadPool.h>
 using namespace DirectX;
 
 GameApp::GameApp(HINSTANCE hInstance, const std::wstring& windowName, int initWidth, int initHeight)
@@ -53,6 +54,18 @@ void GameApp::OnResize()
     m_pLitTexture->SetDebugObjectName("LitTexture");
     m_pTempTexture->SetDebugObjectName("TempTexture");
 
+    // 金字塔的中间层使用半精度浮点，避免多次下采样和上采样累积量化误差
+    m_pPyramidTextures.clear();
+    uint32_t pyramidLevels = (std::min)(BlurPyramid::GetMaxIterations(m_ClientWidth, m_ClientHeight), (uint32_t)MaxPyramidIterations);
+    for (uint32_t level = 1; level <= pyramidLevels; ++level)
+    {
+        uint32_t width, height;
+        BlurPyramid::GetLevelSize(m_ClientWidth, m_ClientHeight, level, width, height);
+        m_pPyramidTextures.push_back(std::make_unique<Texture2D>(m_pd3dDevice.Get(), width, height,
+            DXGI_FORMAT_R16G16B16A16_FLOAT, 1, D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS));
+        m_pPyramidTextures.back()->SetDebugObjectName("PyramidTexture" + std::to_string(level));
+    }
+
     // 摄像机变更显示
     if (m_pCamera != nullptr)
     {
@@ -90,12 +103,13 @@ void GameApp::UpdateScene(float dt)
         static int mode = m_BlurMode;
         static const char* modeStrs[] = {
             "Sobel Mode",
-            "Blur Mode"
+            "Blur Mode",
+            "Blur Pyramid Mode"
         };
         if (ImGui::Combo("Mode", &mode, modeStrs, ARRAYSIZE(modeStrs)))
             m_BlurMode = mode;
 
-        if (m_BlurMode)
+        if (m_BlurMode == 1)
         {
             if (ImGui::SliderInt("Blur Radius", &m_BlurRadius, 1, 15))
             {
@@ -107,6 +121,31 @@ void GameApp::UpdateScene(float dt)
             }
             ImGui::SliderInt("Blur Times", &m_BlurTimes, 0, 5);
         }
+        else if (m_BlurMode == 2)
+        {
+            bool changed = ImGui::SliderInt("Iterations", &m_PyramidIterations, 1, MaxPyramidIterations);
+            changed |= ImGui::SliderFloat("Offset", &m_PyramidOffset, 0.5f, 3.0f, "%.2f");
+            if (changed || m_PyramidSigma == 0.0f)
+                m_PyramidSigma = BlurPyramid::EstimateSigma(m_PyramidIterations, m_PyramidOffset);
+            ImGui::Text("Approx. Gaussian Sigma: %.1f", m_PyramidSigma);
+        }
+
+        if (ImGui::CollapsingHeader("CPU Reference"))
+        {
+            // GPU模糊的中间结果存放在R8G8B8A8纹理中，每趟模糊可能有1左右的舍入差异
+            if (ImGui::Button("Compare GPU with CPU"))
+                m_CompareWithCpu = true;
+            if (m_CompareMaxError >= 0)
+                ImGui::Text("Max Error: %d/255  CPU: %.3fms", m_CompareMaxError, m_CompareCpuMs);
+
+            if (ImGui::Button("Run CPU Filter Benchmark (1280x720)"))
+                m_FilterBenchmarkResults = RunImageFilterBenchmark(1280, 720, m_BlurSigma, m_BlurRadius);
+            for (auto& result : m_FilterBenchmarkResults)
+            {
+                ImGui::Text("%-9s %-7s: 1T %.2fms (%.0fMP/s)  MT %.2fms (%.0fMP/s)", result.filterName, result.formatName,
+                    result.singleThreadMs, result.singleThreadMPixels, result.multiThreadMs, result.multiThreadMPixels);
+            }
+        }
     }
 
     ImGui::End();
@@ -196,6 +235,9 @@ void GameApp::DrawScene()
     // ******************
     // 4. 滤波
     //
+    ImageFilter::ImageRGBA8 cpuImage;
+    if (m_CompareWithCpu)
+        ReadbackTexture(m_pLitTexture->GetTexture(), cpuImage);
 
     // 高斯滤波
     if (m_BlurMode == 1)
@@ -211,7 +253,21 @@ void GameApp::DrawScene()
                 m_pLitTexture->GetUnorderedAccess(),
                 m_ClientWidth, m_ClientHeight);
         }
+    }
+    // 模糊金字塔
+    else if (m_BlurMode == 2)
+    {
+        for (const BlurPyramidPass& pass : GetPyramidSchedule())
+        {
+            m_PostProcessEffect.ComputeBlurPyramidPass(m_pd3dImmediateContext.Get(),
+                pass.srcLevel ? m_pPyramidTextures[pass.srcLevel - 1]->GetShaderResource() : m_pLitTexture->GetShaderResource(),
+                pass.dstLevel ? m_pPyramidTextures[pass.dstLevel - 1]->GetUnorderedAccess() : m_pLitTexture->GetUnorderedAccess(),
+                pass);
+        }
+    }
 
+    if (m_BlurMode != 0)
+    {
         // 直通(RGB->sRGB)
         m_PostProcessEffect.RenderComposite(m_pd3dImmediateContext.Get(),
             m_pLitTexture->GetShaderResource(),
@@ -233,6 +289,46 @@ void GameApp::DrawScene()
             m_pCamera->GetViewPort());
     }
 
+    // 用相同的参数在CPU上滤波，与GPU的结果比较
+    if (m_CompareWithCpu)
+    {
+        m_CompareWithCpu = false;
+        ImageFilter::ImageRGBA8 gpuImage;
+        ReadbackTexture(m_BlurMode != 0 ? m_pLitTexture->GetTexture() : m_pTempTexture->GetTexture(), gpuImage);
+
+        CpuTimer timer;
+        timer.Reset();
+        timer.Start();
+        if (m_BlurMode == 1)
+        {
+            for (int i = 0; i < m_BlurTimes; ++i)
+                ImageFilter::GaussianBlur(cpuImage, cpuImage, m_BlurSigma, m_BlurRadius, &ThreadPool::GetDefault());
+        }
+        else if (m_BlurMode == 2)
+        {
+            ImageFilter::ImageF image;
+            ImageFilter::Convert(cpuImage, image, &ThreadPool::GetDefault());
+            BlurPyramid::Execute(GetPyramidSchedule(), image, image, &ThreadPool::GetDefault());
+            ImageFilter::Convert(image, cpuImage, &ThreadPool::GetDefault());
+        }
+        else
+        {
+            ImageFilter::Sobel(cpuImage, cpuImage, &ThreadPool::GetDefault());
+        }
+        timer.Tick();
+        timer.Stop();
+        m_CompareCpuMs = timer.TotalTime() * 1000.0f;
+
+        m_CompareMaxError = 0;
+        for (size_t i = 0; i < cpuImage.pixels.size(); ++i)
+        {
+            const uint8_t* pCpu = reinterpret_cast<const uint8_t*>(&cpuImage.pixels[i]);
+            const uint8_t* pGpu = reinterpret_cast<const uint8_t*>(&gpuImage.pixels[i]);
+            for (int c = 0; c < 4; ++c)
+                m_CompareMaxError = (std::max)(m_CompareMaxError, abs(pCpu[c] - pGpu[c]));
+        }
+    }
+
     pRTVs[0] = GetBackBufferRTV();
     m_pd3dImmediateContext->OMSetRenderTargets(1, pRTVs, nullptr);
     ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
@@ -242,6 +338,30 @@ void GameApp::DrawScene()
 
 
 
+std::vector<BlurPyramidPass> GameApp::GetPyramidSchedule() const
+{
+    uint32_t iterations = (std::min)((uint32_t)m_PyramidIterations, (uint32_t)m_pPyramidTextures.size());
+    return BlurPyramid::BuildSchedule(m_ClientWidth, m_ClientHeight, iterations, m_PyramidOffset);
+}
+
+void GameApp::ReadbackTexture(ID3D11Texture2D* pTexture, ImageFilter::ImageRGBA8& image)
+{
+    D3D11_TEXTURE2D_DESC texDesc;
+    pTexture->GetDesc(&texDesc);
+    CD3D11_TEXTURE2D_DESC stagingDesc(texDesc.Format, texDesc.Width, texDesc.Height, 1, 1, 0,
+        D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+    ComPtr<ID3D11Texture2D> pStagingTexture;
+    HR(m_pd3dDevice->CreateTexture2D(&stagingDesc, nullptr, pStagingTexture.GetAddressOf()));
+    m_pd3dImmediateContext->CopyResource(pStagingTexture.Get(), pTexture);
+
+    D3D11_MAPPED_SUBRESOURCE mappedData;
+    HR(m_pd3dImmediateContext->Map(pStagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mappedData));
+    image.Resize(texDesc.Width, texDesc.Height);
+    for (UINT y = 0; y < texDesc.Height; ++y)
+        memcpy(image.Row(y), reinterpret_cast<const uint8_t*>(mappedData.pData) + y * mappedData.RowPitch, texDesc.Width * 4);
+    m_pd3dImmediateContext->Unmap(pStagingTexture.Get(), 0);
+}
+
 bool GameApp::InitResource()
 {
     // ******************
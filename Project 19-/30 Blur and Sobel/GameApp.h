@@ -14,6 +14,8 @@
 #include <Collision.h>
 #include <ModelManager.h>
 #include <TextureManager.h>
+#include <ImageFilter.h>
+#include <BlurPyramid.h>
 
 struct FragmentData
 {
@@ -40,8 +42,13 @@ public:
 
 private:
     bool InitResource();
+    // 当前设置下模糊金字塔的各趟，层数不超过已创建的纹理
+    std::vector<BlurPyramidPass> GetPyramidSchedule() const;
+    // 把R8G8B8A8纹理回读到内存
+    void ReadbackTexture(ID3D11Texture2D* pTexture, ImageFilter::ImageRGBA8& image);
 
 private:
+    static constexpr int MaxPyramidIterations = 6;
 
     TextureManager m_TextureManager;
     ModelManager m_ModelManager;
@@ -65,16 +72,25 @@ private:
     std::unique_ptr<Depth2D> m_pDepthTexture;                   // 深度纹理
     std::unique_ptr<Texture2D> m_pLitTexture;                   // 场景渲染缓冲区(不透明+透明)
     std::unique_ptr<Texture2D> m_pTempTexture;                  // 临时缓冲区
+    std::vector<std::unique_ptr<Texture2D>> m_pPyramidTextures; // 模糊金字塔的第1层及之后各层
 
     float m_BaseTime = 0.0f;								    // 控制水波生成的基准时间
 
     bool m_EnabledFog = true;									// 开启雾效
     bool m_EnabledOIT = true;									// 开启OIT
-    int m_BlurMode = 1;										    // 0-Sobel, 1-Blur
+    int m_BlurMode = 1;										    // 0-Sobel, 1-Blur, 2-Blur Pyramid
 
     float m_BlurSigma = 2.5f;									// 模糊用的sigma值
     int m_BlurRadius = 5;										// 模糊用的半径
     int m_BlurTimes = 1;										// 模糊次数
+    int m_PyramidIterations = 4;                                // 模糊金字塔的下采样次数
+    float m_PyramidOffset = 1.0f;                               // 模糊金字塔的采样偏移
+    float m_PyramidSigma = 0.0f;                                // 效果相近的高斯模糊的sigma
+
+    std::vector<ImageFilterBenchmarkResult> m_FilterBenchmarkResults;   // CPU滤波性能测试结果
+    bool m_CompareWithCpu = false;                              // 下一帧回读GPU滤波的输入输出并与CPU滤波比较
+    int m_CompareMaxError = -1;                                 // 两者各通道在0~255下的最大差异，-1表示尚未比较
+    float m_CompareCpuMs = 0.0f;                                // CPU滤波的用时
 
     std::shared_ptr<Camera> m_pCamera;						    // 摄像机
 };
@@ -6,34 +6,14 @@
 #include <Vertex.h>
 #include <TextureManager.h>
 #include <ModelManager.h>
+#include <ImageFilter.h>
+#include <BlurPyramid.h>
 #include "LightHelper.h"
 
 using namespace DirectX;
 
 # pragma warning(disable: 26812)
 
-
-static void GenerateGaussianWeights(float weights[], int kernelSize, float sigma)
-{
-    float twoSigmaSq = 2.0f * sigma * sigma;
-    int radius = kernelSize / 2;
-    float sum = 0.0f;
-    for (int i = -radius; i <= radius; ++i)
-    {
-        float x = (float)i;
-
-        weights[radius + i] = expf(-x * x / twoSigmaSq);
-
-        sum += weights[radius + i];
-    }
-
-    // 标准化权值使得权值和为1.0
-    for (int i = 0; i <= kernelSize; ++i)
-    {
-        weights[i] /= sum;
-    }
-}
-
 //
 // PostProcessEffect::Impl 需要先于PostProcessEffect的定义
 //
@@ -116,6 +96,7 @@ bool PostProcessEffect::InitAll(ID3D11Device* device)
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("CompositePS", L"Shaders/Composite_PS.cso", device));
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("BlurVertCS", L"Shaders/Blur_Vert_CS.cso", device));
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("SobelCS", L"Shaders/Sobel_CS.cso", device));
+    HR(pImpl->m_pEffectHelper->CreateShaderFromFile("BlurPyramidCS", L"Shaders/BlurPyramid_CS.cso", device));
 
 
     // 创建通道
@@ -126,6 +107,8 @@ bool PostProcessEffect::InitAll(ID3D11Device* device)
     HR(pImpl->m_pEffectHelper->AddEffectPass("BlurVert", device, &passDesc));
     passDesc.nameCS = "SobelCS";
     HR(pImpl->m_pEffectHelper->AddEffectPass("Sobel", device, &passDesc));
+    passDesc.nameCS = "BlurPyramidCS";
+    HR(pImpl->m_pEffectHelper->AddEffectPass("BlurPyramid", device, &passDesc));
     passDesc.nameVS = "CompositeVS";
     passDesc.namePS = "CompositePS";
     passDesc.nameCS = "";
@@ -134,6 +117,7 @@ bool PostProcessEffect::InitAll(ID3D11Device* device)
 
     pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamLinearWrap", RenderStates::SSLinearWrap.Get());
     pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamPointClamp", RenderStates::SSPointClamp.Get());
+    pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamLinearClamp", RenderStates::SSLinearClamp.Get());
 
     pImpl->m_pEffectHelper->SetDebugObjectName("PostProcessEffect");
 
@@ -187,7 +171,8 @@ void PostProcessEffect::SetBlurKernelSize(int size)
         return;
 
     pImpl->m_BlurRadius = size / 2;
-    GenerateGaussianWeights(pImpl->m_Weights, size, pImpl->m_BlurSigma);
+    auto weights = ImageFilter::GenerateGaussianWeights(pImpl->m_BlurSigma, pImpl->m_BlurRadius);
+    std::copy(weights.begin(), weights.end(), pImpl->m_Weights);
 }
 
 void PostProcessEffect::SetBlurSigma(float sigma)
@@ -196,7 +181,8 @@ void PostProcessEffect::SetBlurSigma(float sigma)
         return;
 
     pImpl->m_BlurSigma = sigma;
-    GenerateGaussianWeights(pImpl->m_Weights, pImpl->m_BlurRadius * 2 + 1, pImpl->m_BlurSigma);
+    auto weights = ImageFilter::GenerateGaussianWeights(pImpl->m_BlurSigma, pImpl->m_BlurRadius);
+    std::copy(weights.begin(), weights.end(), pImpl->m_Weights);
 }
 
 void PostProcessEffect::ComputeGaussianBlurX(
@@ -242,3 +228,24 @@ void PostProcessEffect::ComputeGaussianBlurY(
     deviceContext->CSSetShaderResources(pImpl->m_pEffectHelper->MapShaderResourceSlot("g_Input"), 1, &input);
     deviceContext->CSSetUnorderedAccessViews(pImpl->m_pEffectHelper->MapUnorderedAccessSlot("g_Output"), 1, &output, nullptr);
 }
+
+void PostProcessEffect::ComputeBlurPyramidPass(
+    ID3D11DeviceContext* deviceContext,
+    ID3D11ShaderResourceView* input,
+    ID3D11UnorderedAccessView* output,
+    const BlurPyramidPass& pass)
+{
+    auto pPass = pImpl->m_pEffectHelper->GetEffectPass("BlurPyramid");
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_Taps")->SetRaw(pass.taps);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_TapCount")->SetSInt((int)pass.tapCount);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_Input", input);
+    pImpl->m_pEffectHelper->SetUnorderedAccessByName("g_Output", output);
+    pPass->Apply(deviceContext);
+    pPass->Dispatch(deviceContext, pass.dstWidth, pass.dstHeight);
+
+    // 清空
+    input = nullptr;
+    output = nullptr;
+    deviceContext->CSSetShaderResources(pImpl->m_pEffectHelper->MapShaderResourceSlot("g_Input"), 1, &input);
+    deviceContext->CSSetUnorderedAccessViews(pImpl->m_pEffectHelper->MapUnorderedAccessSlot("g_Output"), 1, &output, nullptr);
+}
@@ -0,0 +1,20 @@
+#include "PostProcess.hlsli"
+
+// 模糊金字塔的一趟下采样或上采样，采样点由CPU端的BlurPyramid::BuildSchedule生成
+[numthreads(8, 8, 1)]
+void CS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint width, height;
+    g_Output.GetDimensions(width, height);
+    if (DTid.x >= width || DTid.y >= height)
+        return;
+    
+    float2 texcoord = (DTid.xy + 0.5f) / float2(width, height);
+    float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < g_TapCount; ++i)
+    {
+        color += g_Taps[i].z * g_Input.SampleLevel(g_SamLinearClamp, texcoord + g_Taps[i].xy, 0.0f);
+    }
+    
+    g_Output[DTid.xy] = color;
+}
@@ -6,6 +6,10 @@ cbuffer CBSettings : register(b0)
     float4 g_Weights[8];
     // 不位于常量缓冲区
     static float s_Weights[32] = (float[32]) g_Weights;
+    
+    // 模糊金字塔每一趟的采样点：xy为纹理坐标偏移，z为权重
+    float4 g_Taps[8];
+    int g_TapCount;
 }
 
 Texture2D g_Input : register(t0);
@@ -15,6 +19,7 @@ RWTexture2D<float4> g_Output : register(u0);
 
 SamplerState g_SamLinearWrap : register(s0); // 线性过滤+Wrap采样器
 SamplerState g_SamPointClamp : register(s1); // 点过滤+Clamp采样器
+SamplerState g_SamLinearClamp : register(s2); // 线性过滤+Clamp采样器
 
 
 #define MAX_BLUR_RADIUS 15
@@ -14,6 +14,8 @@
 #include <MeshData.h>
 #include <LightHelper.h>
 
+struct BlurPyramidPass;
+
 class BasicEffect : public IEffect, public IEffectTransform,
     public IEffectMaterial, public IEffectMeshData
 {
@@ -303,6 +305,15 @@ public:
         ID3D11RenderTargetView* output,
         const D3D11_VIEWPORT& vp);
 
+    // 进行模糊金字塔的一趟，output的大小为pass.dstWidth x pass.dstHeight
+    // 与双边滤波一样跳过法向量或深度相差太大的采样点
+    void PyramidBlur(
+        ID3D11DeviceContext* deviceContext,
+        ID3D11ShaderResourceView* input,
+        ID3D11ShaderResourceView* normalDepth,
+        ID3D11RenderTargetView* output,
+        const BlurPyramidPass& pass);
+
 
     // 绘制AO图到纹理
     void RenderAmbientOcclusionToTexture(ID3D11DeviceContext* deviceContext,
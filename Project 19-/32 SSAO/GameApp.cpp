@@ -92,6 +92,17 @@ void GameApp::UpdateScene(float dt)
             }
             ImGui::SliderFloat("Sample Radius", &m_SSAOManager.m_OcclusionRadius, 0.0f, 2.0f, "%.1f");
             ImGui::SliderInt("Sample Count", reinterpret_cast<int*>(&m_SSAOManager.m_SampleCount), 1, 14);
+            ImGui::Checkbox("Pyramid Blur", &m_SSAOManager.m_UsePyramidBlur);
+            if (m_SSAOManager.m_UsePyramidBlur)
+            {
+                ImGui::SliderInt("Pyramid Iterations", reinterpret_cast<int*>(&m_SSAOManager.m_PyramidIterations),
+                    1, SSAOManager::MaxPyramidIterations);
+                ImGui::SliderFloat("Pyramid Offset", &m_SSAOManager.m_PyramidOffset, 0.5f, 3.0f, "%.2f");
+            }
+            else
+            {
+                ImGui::SliderInt("Blur Count", reinterpret_cast<int*>(&m_SSAOManager.m_BlurCount), 0, 8);
+            }
             ImGui::Checkbox("Debug SSAO", &m_EnableDebug);
             
         }
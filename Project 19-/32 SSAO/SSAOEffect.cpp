@@ -6,6 +6,7 @@
 #include <Vertex.h>
 #include <TextureManager.h>
 #include <ModelManager.h>
+#include <BlurPyramid.h>
 #include "LightHelper.h"
 
 using namespace DirectX;
@@ -126,6 +127,7 @@ bool SSAOEffect::InitAll(ID3D11Device* device)
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("SSAO_PS", L"Shaders\\SSAO.hlsl", device, "SSAO_PS", "ps_5_0"));
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("SSAO_BilateralVertPS", L"Shaders\\SSAO.hlsl", device, "BilateralPS", "ps_5_0"));
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("SSAO_BilateralHorzPS", L"Shaders\\SSAO.hlsl", device, "BilateralPS", "ps_5_0", defines));
+    HR(pImpl->m_pEffectHelper->CreateShaderFromFile("SSAO_PyramidBlurPS", L"Shaders\\SSAO.hlsl", device, "PyramidBlurPS", "ps_5_0"));
     HR(pImpl->m_pEffectHelper->CreateShaderFromFile("DebugAO_PS", L"Shaders\\SSAO.hlsl", device, "DebugAO_PS", "ps_5_0"));
 
     // ******************
@@ -145,6 +147,9 @@ bool SSAOEffect::InitAll(ID3D11Device* device)
     passDesc.namePS = "SSAO_BilateralVertPS";
     HR(pImpl->m_pEffectHelper->AddEffectPass("SSAO_BlurVert", device, &passDesc));
     passDesc.nameVS = "FullScreenTriangleTexcoordVS";
+    passDesc.namePS = "SSAO_PyramidBlurPS";
+    HR(pImpl->m_pEffectHelper->AddEffectPass("SSAO_PyramidBlur", device, &passDesc));
+    passDesc.nameVS = "FullScreenTriangleTexcoordVS";
     passDesc.namePS = "DebugAO_PS";
     HR(pImpl->m_pEffectHelper->AddEffectPass("DebugAO", device, &passDesc));
 
@@ -351,6 +356,34 @@ void SSAOEffect::BilateralBlurY(
     deviceContext->PSSetShaderResources(pImpl->m_pEffectHelper->MapShaderResourceSlot("g_NormalDepthMap"), 1, &normalDepth);
 }
 
+void SSAOEffect::PyramidBlur(
+    ID3D11DeviceContext* deviceContext,
+    ID3D11ShaderResourceView* input,
+    ID3D11ShaderResourceView* normalDepth,
+    ID3D11RenderTargetView* output,
+    const BlurPyramidPass& pass)
+{
+    CD3D11_VIEWPORT vp(0.0f, 0.0f, (float)pass.dstWidth, (float)pass.dstHeight);
+    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext->RSSetViewports(1, &vp);
+    deviceContext->OMSetRenderTargets(1, &output, nullptr);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_InputImage", input);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_NormalDepthMap", normalDepth);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_PyramidTaps")->SetRaw(pass.taps);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_PyramidTapCount")->SetSInt((int)pass.tapCount);
+    auto pPass = pImpl->m_pEffectHelper->GetEffectPass("SSAO_PyramidBlur");
+    pPass->Apply(deviceContext);
+    deviceContext->Draw(3, 0);
+
+    // 清空
+    input = nullptr;
+    output = nullptr;
+    normalDepth = nullptr;
+    deviceContext->OMSetRenderTargets(0, &output, nullptr);
+    deviceContext->PSSetShaderResources(pImpl->m_pEffectHelper->MapShaderResourceSlot("g_InputImage"), 1, &input);
+    deviceContext->PSSetShaderResources(pImpl->m_pEffectHelper->MapShaderResourceSlot("g_NormalDepthMap"), 1, &normalDepth);
+}
+
 void SSAOEffect::RenderAmbientOcclusionToTexture(
     ID3D11DeviceContext* deviceContext, 
     ID3D11ShaderResourceView* input, 
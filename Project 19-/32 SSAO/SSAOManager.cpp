@@ -1,6 +1,7 @@
 #include "SSAOManager.h"
 #include <XUtil.h>
 #include <DirectXPackedVector.h>
+#include <BlurPyramid.h>
 #include <random>
 
 #pragma warning(disable: 26812)
@@ -26,6 +27,16 @@ void SSAOManager::OnResize(ID3D11Device* device, int width, int height)
     m_pNormalDepthTexture->SetDebugObjectName("NormalDepthTexture");
     m_pAOTexture->SetDebugObjectName("SSAOTexture");
     m_pAOTempTexture->SetDebugObjectName("SSAOTempTexture");
+
+    m_pAOPyramidTextures.clear();
+    uint32_t maxIterations = BlurPyramid::GetMaxIterations(m_pAOTexture->GetWidth(), m_pAOTexture->GetHeight());
+    for (uint32_t level = 1; level <= (std::min)(maxIterations, MaxPyramidIterations); ++level)
+    {
+        uint32_t levelWidth, levelHeight;
+        BlurPyramid::GetLevelSize(m_pAOTexture->GetWidth(), m_pAOTexture->GetHeight(), level, levelWidth, levelHeight);
+        m_pAOPyramidTextures.push_back(std::make_unique<Texture2D>(device, levelWidth, levelHeight, DXGI_FORMAT_R16_FLOAT));
+        m_pAOPyramidTextures.back()->SetDebugObjectName("SSAOPyramidTexture" + std::to_string(level));
+    }
 }
 
 
@@ -76,6 +87,21 @@ void SSAOManager::RenderToSSAOTexture(ID3D11DeviceContext* deviceContext, SSAOEf
 
 void SSAOManager::BlurAmbientMap(ID3D11DeviceContext* deviceContext, SSAOEffect& ssaoEffect)
 {
+    if (m_UsePyramidBlur)
+    {
+        uint32_t iterations = (std::min)(m_PyramidIterations, (uint32_t)m_pAOPyramidTextures.size());
+        auto passes = BlurPyramid::BuildSchedule(m_pAOTexture->GetWidth(), m_pAOTexture->GetHeight(), iterations, m_PyramidOffset);
+        for (const BlurPyramidPass& pass : passes)
+        {
+            ssaoEffect.PyramidBlur(deviceContext,
+                pass.srcLevel ? m_pAOPyramidTextures[pass.srcLevel - 1]->GetShaderResource() : m_pAOTexture->GetShaderResource(),
+                m_pNormalDepthTexture->GetShaderResource(),
+                pass.dstLevel ? m_pAOPyramidTextures[pass.dstLevel - 1]->GetRenderTarget() : m_pAOTexture->GetRenderTarget(),
+                pass);
+        }
+        return;
+    }
+
     CD3D11_VIEWPORT vp(0.0f, 0.0f, (float)m_pAOTempTexture->GetWidth(), (float)m_pAOTempTexture->GetHeight());
     ssaoEffect.SetBlurRadius(m_BlurRadius);
     ssaoEffect.SetBlurWeights(m_BlurWeights);
@@ -51,7 +51,8 @@ public:
     void RenderToSSAOTexture(ID3D11DeviceContext* deviceContext, SSAOEffect& ssaoEffect, const Camera& camera);
 
     // 对SSAO图进行模糊，使得由于每个像素的采样次数较少而产生的噪点进行平滑处理
-    // 这里使用边缘保留的模糊
+    // 这里使用边缘保留的模糊。m_UsePyramidBlur为true时改用模糊金字塔，
+    // 开销几乎不随模糊范围增长
     void BlurAmbientMap(ID3D11DeviceContext* deviceContext, SSAOEffect& ssaoEffect);
 
 
@@ -62,6 +63,8 @@ public:
     ID3D11ShaderResourceView* GetNormalDepthTexture();
 
 public:
+    static constexpr uint32_t MaxPyramidIterations = 4;
+
     // SSAO默认设置，可进行修改
     uint32_t m_SampleCount = 14;        // 采样向量数
     uint32_t m_BlurCount = 4;           // 模糊次数
@@ -71,6 +74,9 @@ public:
     float m_SurfaceEpsilon = 0.05f;     // 防止自相交用的距离值
     float m_BlurWeights[11]{ 0.05f, 0.05f, 0.1f, 0.1f, 0.1f, 0.2f, 0.1f, 0.1f, 0.1f, 0.05f, 0.05f };
     uint32_t m_BlurRadius = 5;
+    bool m_UsePyramidBlur = false;      // 使用模糊金字塔代替多次全分辨率的双边滤波
+    uint32_t m_PyramidIterations = 2;   // 模糊金字塔的下采样次数
+    float m_PyramidOffset = 1.0f;       // 模糊金字塔的采样偏移
 
 private:
 
@@ -85,6 +91,7 @@ private:
     std::unique_ptr<Texture2D> m_pAOTexture;                    // 环境光遮蔽贴图
     std::unique_ptr<Texture2D> m_pAOTempTexture;                // 中间环境光遮蔽贴图
     std::unique_ptr<Texture2D> m_pRandomVectorTexture;          // 随机向量纹理
+    std::vector<std::unique_ptr<Texture2D>> m_pAOPyramidTextures;   // 模糊金字塔的第1层及之后各层
 };
 
 #endif
@@ -53,7 +53,13 @@ cbuffer CBChangesRarely : register(b3)
     static float s_BlurWeights[12] = (float[12]) g_BlurWeights;
     
     int g_BlurRadius;
-    float3 g_Pad;
+    
+    //
+    // 用于模糊金字塔：xy为纹理坐标偏移，z为权重
+    //
+    int g_PyramidTapCount;
+    float2 g_Pad;
+    float4 g_PyramidTaps[8];
 };
 
 //
@@ -303,6 +309,31 @@ float4 BilateralPS(float4 posH : SV_position,
     return color / totalWeight;
 }
 
+// 模糊金字塔的一趟下采样或上采样，采样点由CPU端的BlurPyramid::BuildSchedule生成
+// 与双边滤波一样，法向量或深度与中心相差太大的采样点不参与混合
+float4 PyramidBlurPS(float4 posH : SV_position,
+                     float2 texcoord : TEXCOORD) : SV_Target
+{
+    float4 centerNormalDepth = g_NormalDepthMap.SampleLevel(g_SamBlur, texcoord, 0.0f);
+    float4 color = float4(0.0f, 0.0f, 0.0f, 0.0f);
+    float totalWeight = 0.0f;
+    
+    for (int i = 0; i < g_PyramidTapCount; ++i)
+    {
+        float2 tapTexcoord = texcoord + g_PyramidTaps[i].xy;
+        float4 neighborNormalDepth = g_NormalDepthMap.SampleLevel(g_SamBlur, tapTexcoord, 0.0f);
+        if (dot(neighborNormalDepth.xyz, centerNormalDepth.xyz) >= 0.8f &&
+            abs(neighborNormalDepth.w - centerNormalDepth.w) <= 0.2f)
+        {
+            color += g_PyramidTaps[i].z * g_InputImage.SampleLevel(g_SamBlur, tapTexcoord, 0.0f);
+            totalWeight += g_PyramidTaps[i].z;
+        }
+    }
+    
+    // 所有采样点都被丢弃时保留中心值
+    return totalWeight > 0.0f ? color / totalWeight : g_InputImage.SampleLevel(g_SamBlur, texcoord, 0.0f);
+}
+
 
 float4 DebugAO_PS(float4 posH : SV_position,
                   float2 texCoord : TEXCOORD) : SV_Target
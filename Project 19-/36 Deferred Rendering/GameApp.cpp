@@ -24,6 +24,8 @@ bool GameApp::Init()
 
     m_TextureManager.Init(m_pd3dDevice.Get());
     m_ModelManager.Init(m_pd3dDevice.Get());
+    // Sponza的子网格合并到共享缓冲区，减少IA重绑定
+    m_ModelManager.SetMeshMergeMode(MeshMergeMode::Global);
 
     m_GpuTimer_PreZ.Init(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
     m_GpuTimer_Lighting.Init(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
@@ -67,6 +69,10 @@ void GameApp::OnResize()
 
 void GameApp::UpdateScene(float dt)
 {
+    // 上传已经解码完成的纹理，并回收超出预算的无引用资源
+    m_TextureManager.Update();
+    m_ModelManager.Update();
+
     // 更新摄像机
     m_FPSCameraController.Update(dt);
     bool need_gpu_timer_reset = false;
@@ -185,6 +191,12 @@ void GameApp::UpdateScene(float dt)
     BoundingFrustum::CreateFromMatrix(frustum, m_pCamera->GetProjMatrixXM());
     frustum.Transform(frustum, m_pCamera->GetLocalToWorldMatrixXM());
     m_Sponza.FrustumCulling(frustum);
+    m_VisibleSubmeshes = m_Sponza.GetSubModelInFrustumCount();
+    m_VisibleSubmeshesAABB = m_Sponza.CountInFrustumAABB(frustum);
+
+    // 按可见子网格的屏幕覆盖请求纹理的mip等级
+    float projScale = m_pCamera->GetViewPort().Height / (2.0f * tanf(0.5f * m_pCamera->GetFovY()));
+    m_Sponza.RequestTextureMips(m_pCamera->GetPosition(), projScale);
 }
 
 void GameApp::DrawScene()
@@ -249,6 +261,28 @@ void GameApp::DrawScene()
         total_time += m_GpuTimer_Skybox.AverageTime();
         
         ImGui::Text("Total: %.3f ms", total_time * 1000);
+
+        // AABB通过但紧凑包围体未通过的子网格即为AABB的误判
+        ImGui::Separator();
+        ImGui::Text("Visible Submeshes: %zu (AABB: %zu)", m_VisibleSubmeshes, m_VisibleSubmeshesAABB);
+        if (m_VisibleSubmeshesAABB)
+            ImGui::Text("AABB False Positives: %.1f%%",
+                100.0f * ((float)m_VisibleSubmeshesAABB - (float)m_VisibleSubmeshes) / m_VisibleSubmeshesAABB);
+
+        auto streamingStats = m_TextureManager.GetStreamingStats();
+        ImGui::Separator();
+        ImGui::Text("Streamed Textures: %u", streamingStats.numTextures);
+        ImGui::Text("Resident: %.1f MB / Budget: %.1f MB", streamingStats.residentBytes / 1048576.0f,
+            streamingStats.budgetBytes / 1048576.0f);
+        ImGui::Text("Requested: %.1f MB (Pending Mips: %u)", streamingStats.requestedBytes / 1048576.0f,
+            streamingStats.numPendingMips);
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("Resource Memory"))
+        {
+            ImGui::TextUnformatted(m_TextureManager.GetMemoryReport().c_str());
+            ImGui::TextUnformatted(m_ModelManager.GetMemoryReport().c_str());
+        }
     }
     ImGui::End();
 
@@ -330,6 +364,10 @@ bool GameApp::InitResource()
     // ******************
     // 初始化对象
     //
+    // 天空盒纹理同步加载，Sponza的材质纹理在后台解码，加载完成前使用空纹理
+    // 带mip链的DDS纹理改为流送，先载入64x64以下的mip，再按屏幕覆盖逐步载入更精细的mip
+    m_TextureManager.SetAsyncLoading(true);
+    m_TextureManager.SetStreaming(true, 128 << 20);
     m_Sponza.SetModel(m_ModelManager.CreateFromFile("..\\Model\\Sponza\\Sponza.gltf"));
     m_Sponza.GetTransform().SetScale(0.05f, 0.05f, 0.05f);
     m_ModelManager.CreateFromGeometry("skyboxCube", Geometry::CreateBox());
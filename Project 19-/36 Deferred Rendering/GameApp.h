@@ -117,6 +117,8 @@ private:
     // 模型
     GameObject m_Sponza;											// 场景模型
     GameObject m_Skybox;											// 天空盒模型
+    size_t m_VisibleSubmeshes = 0;                                  // 紧凑包围体裁剪后可见的子网格数
+    size_t m_VisibleSubmeshesAABB = 0;                              // 使用AABB裁剪时可见的子网格数
 
     // 特效
     ForwardEffect m_ForwardEffect;				                    // 前向渲染特效
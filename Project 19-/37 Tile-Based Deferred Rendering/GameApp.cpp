@@ -24,6 +24,8 @@ bool GameApp::Init()
 
     m_TextureManager.Init(m_pd3dDevice.Get());
     m_ModelManager.Init(m_pd3dDevice.Get());
+    // Sponza的子网格合并到共享缓冲区，减少IA重绑定
+    m_ModelManager.SetMeshMergeMode(MeshMergeMode::Global);
 
     m_GpuTimer_PreZ.Init(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
     m_GpuTimer_Lighting.Init(m_pd3dDevice.Get(), m_pd3dImmediateContext.Get());
@@ -69,6 +71,9 @@ void GameApp::OnResize()
 
 void GameApp::UpdateScene(float dt)
 {
+    // 上传已经解码完成的纹理
+    m_TextureManager.Update();
+
     // 更新摄像机
     m_FPSCameraController.Update(dt);
 
@@ -366,6 +371,8 @@ bool GameApp::InitResource()
     // ******************
     // 初始化对象
     //
+    // 天空盒纹理同步加载，Sponza的材质纹理在后台解码，加载完成前使用空纹理
+    m_TextureManager.SetAsyncLoading(true);
     m_Sponza.SetModel(m_ModelManager.CreateFromFile("..\\Model\\Sponza\\sponza.gltf"));
     m_Sponza.GetTransform().SetScale(0.05f, 0.05f, 0.05f);
     m_ModelManager.CreateFromGeometry("skyboxCube", Geometry::CreateBox());
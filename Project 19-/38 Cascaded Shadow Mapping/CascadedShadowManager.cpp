@@ -1,4 +1,5 @@
 #include "CascadedShadowManager.h"
+#include <CascadeMath.h>
 
 using namespace DirectX;
 
@@ -6,6 +7,11 @@ HRESULT CascadedShadowManager::InitResource(ID3D11Device* device)
 {
 
     m_pCSMTextureArray = std::make_unique<Depth2DArray>(device, m_ShadowSize, m_ShadowSize, m_CascadeLevels);
+    if (m_StaticShadowCache)
+        m_pStaticCSMTextureArray = std::make_unique<Depth2DArray>(device, m_ShadowSize, m_ShadowSize, m_CascadeLevels);
+    else
+        m_pStaticCSMTextureArray.reset();
+    InvalidateStaticCache();
 
     m_ShadowViewport.TopLeftX = 0;
     m_ShadowViewport.TopLeftY = 0;
@@ -17,6 +23,61 @@ HRESULT CascadedShadowManager::InitResource(ID3D11Device* device)
     return S_OK;
 }
 
+void CascadedShadowManager::ApplyStaticCache(ID3D11DeviceContext* deviceContext, size_t cascadeIndex)
+{
+    // 深度纹理只能整个子资源复制
+    UINT subresource = D3D11CalcSubresource(0, (UINT)cascadeIndex, 1);
+    deviceContext->CopySubresourceRegion(m_pCSMTextureArray->GetTexture(), subresource, 0, 0, 0,
+        m_pStaticCSMTextureArray->GetTexture(), subresource, nullptr);
+}
+
+void CascadedShadowManager::InvalidateStaticCache()
+{
+    for (bool& valid : m_StaticCacheValid)
+        valid = false;
+    m_HasFrameInputs = false;
+}
+
+void CascadedShadowManager::SetVisibleDepthRange(float minZ, float maxZ)
+{
+    m_VisibleDepthMin = minZ;
+    m_VisibleDepthMax = maxZ;
+    m_HasVisibleDepth = minZ < maxZ;
+}
+
+bool CascadedShadowManager::SetVisibleDepthHistogram(const uint32_t histogram[], uint32_t binCount, float minZ, float maxZ, float percentile)
+{
+    float visibleMinZ, visibleMaxZ;
+    if (!CascadeMath::ComputeDepthRangeFromHistogram(histogram, binCount, minZ, maxZ, percentile, visibleMinZ, visibleMaxZ))
+        return false;
+    SetVisibleDepthRange(visibleMinZ, visibleMaxZ);
+    return true;
+}
+
+void CascadedShadowManager::UpdateCascadePartitions(float nearZ, float farZ)
+{
+    m_CascadeStartPercentage = 0.0f;
+    if (m_SelectedCascadePartition == CascadePartition::CascadePartition_Manual)
+        return;
+
+    // 级联区间以视空间深度除以(farZ - nearZ)的比例表示
+    float beginZ = nearZ, endZ = farZ;
+    float cameraNearFarRange = farZ - nearZ;
+    if (m_SelectedCascadePartition == CascadePartition::CascadePartition_SDSM && m_HasVisibleDepth)
+    {
+        // 只覆盖可见像素所在的深度范围，且至少保留视锥体的1%，避免级联过于细长
+        beginZ = (std::max)(m_VisibleDepthMin, nearZ);
+        endZ = (std::min)((std::max)(m_VisibleDepthMax, beginZ + 0.01f * cameraNearFarRange), farZ);
+        beginZ = (std::min)(beginZ, endZ - 0.01f * cameraNearFarRange);
+        m_CascadeStartPercentage = beginZ / cameraNearFarRange;
+    }
+
+    float splits[8];
+    CascadeMath::ComputePracticalSplits(beginZ, endZ, (uint32_t)m_CascadeLevels, m_PSSMLambda, splits);
+    for (int i = 0; i < m_CascadeLevels; ++i)
+        m_CascadePartitionsPercentage[i] = (std::min)(splits[i] / cameraNearFarRange, 1.0f);
+}
+
 void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
     const Camera& lightCamera, 
     const DirectX::BoundingBox& sceneBoundingBox)
@@ -24,6 +85,60 @@ void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
     XMMATRIX ViewerProj = viewerCamera.GetProjMatrixXM();
     XMMATRIX ViewerView = viewerCamera.GetViewMatrixXM();
     XMMATRIX LightView = lightCamera.GetViewMatrixXM();
+
+    UpdateCascadePartitions(viewerCamera.GetNearZ(), viewerCamera.GetFarZ());
+
+    // 摄像机、光源、场景与级联配置都没有变化时，沿用上一次的结果
+    FrameInputs inputs{};
+    XMStoreFloat4x4(&inputs.viewerView, ViewerView);
+    XMStoreFloat4x4(&inputs.viewerProj, ViewerProj);
+    XMStoreFloat4x4(&inputs.lightView, LightView);
+    inputs.sceneCenter = sceneBoundingBox.Center;
+    inputs.sceneExtents = sceneBoundingBox.Extents;
+    inputs.viewerNearZ = viewerCamera.GetNearZ();
+    inputs.viewerFarZ = viewerCamera.GetFarZ();
+    inputs.cascadeStart = m_CascadeStartPercentage;
+    memcpy_s(inputs.cascadePartitions, sizeof inputs.cascadePartitions, m_CascadePartitionsPercentage, sizeof m_CascadePartitionsPercentage);
+    inputs.cascadeLevels = m_CascadeLevels;
+    inputs.shadowSize = m_ShadowSize;
+    inputs.kernelSize = m_PCFKernelSize;
+    inputs.fixedSizeFrustumAABB = m_FixedSizeFrustumAABB;
+    inputs.moveLightTexelSize = m_MoveLightTexelSize;
+    inputs.cascadesFit = static_cast<int>(m_SelectedCascadesFit);
+    inputs.nearFarFit = static_cast<int>(m_SelectedNearFarFit);
+    inputs.staticShadowCache = m_StaticShadowCache;
+    inputs.staticCacheGuardBand = m_StaticCacheGuardBand;
+    inputs.lightDirectionTolerance = m_LightDirectionTolerance;
+    m_ShadowProjChanged = !m_HasFrameInputs || memcmp(&inputs, &m_FrameInputs, sizeof(FrameInputs)) != 0;
+    if (!m_ShadowProjChanged)
+    {
+        for (int cascadeIndex = 0; cascadeIndex < m_CascadeLevels; ++cascadeIndex)
+            m_StaticCacheInvalidation[cascadeIndex] = m_StaticCacheValid[cascadeIndex] ?
+                ShadowCacheInvalidation::ShadowCacheInvalidation_None : ShadowCacheInvalidation::ShadowCacheInvalidation_Empty;
+        return;
+    }
+
+    // 场景包围盒、近/远平面的求法或保护带改变时，所有级联的缓存都需要重新绘制
+    ShadowCacheInvalidation staticCacheInvalidation = ShadowCacheInvalidation::ShadowCacheInvalidation_None;
+    if (m_HasFrameInputs && (memcmp(&inputs.sceneCenter, &m_FrameInputs.sceneCenter, sizeof(XMFLOAT3) * 2) != 0 ||
+        inputs.nearFarFit != m_FrameInputs.nearFarFit || inputs.staticCacheGuardBand != m_FrameInputs.staticCacheGuardBand))
+        staticCacheInvalidation = ShadowCacheInvalidation::ShadowCacheInvalidation_Settings;
+    m_FrameInputs = inputs;
+    m_HasFrameInputs = true;
+
+    // 方向光的阴影与光源位置无关，光照方向的变化不超过容差时沿用生成缓存时的视图矩阵
+    if (!m_StaticShadowCache || !m_HasShadowView || !CascadeMath::IsLightDirectionWithinTolerance(
+        XMLoadFloat3(&m_ShadowLightDir), lightCamera.GetLookAxisXM(), XMConvertToRadians(m_LightDirectionTolerance)))
+    {
+        if (m_HasShadowView && staticCacheInvalidation == ShadowCacheInvalidation::ShadowCacheInvalidation_None)
+            staticCacheInvalidation = ShadowCacheInvalidation::ShadowCacheInvalidation_LightDirection;
+        XMStoreFloat4x4(&m_ShadowView, LightView);
+        XMStoreFloat4x4(&m_ShadowInvView, lightCamera.GetLocalToWorldMatrixXM());
+        m_ShadowLightDir = lightCamera.GetLookAxis();
+        m_HasShadowView = true;
+    }
+    LightView = XMLoadFloat4x4(&m_ShadowView);
+
     XMMATRIX ViewerInvView = XMMatrixInverse(nullptr, ViewerView);
     
     float frustumIntervalBegin, frustumIntervalEnd;
@@ -32,6 +147,26 @@ void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
     float cameraNearFarRange = viewerCamera.GetFarZ() - viewerCamera.GetNearZ();
 
     XMVECTOR worldUnitsPerTexelVec = g_XMZero;
+
+    // 将场景AABB的角点变换到光照空间，所有级联共用
+    XMVECTOR sceneAABBPointsLightSpace[8]{};
+    XMVECTOR lightSpaceSceneAABBminValueVec = g_XMFltMax.v;
+    XMVECTOR lightSpaceSceneAABBmaxValueVec = -g_XMFltMax.v;
+    {
+        XMFLOAT3 corners[8];
+        sceneBoundingBox.GetCorners(corners);
+        for (int i = 0; i < 8; ++i)
+        {
+            XMVECTOR v = XMLoadFloat3(corners + i);
+            sceneAABBPointsLightSpace[i] = XMVector3Transform(v, LightView);
+            lightSpaceSceneAABBminValueVec = XMVectorMin(sceneAABBPointsLightSpace[i], lightSpaceSceneAABBminValueVec);
+            lightSpaceSceneAABBmaxValueVec = XMVectorMax(sceneAABBPointsLightSpace[i], lightSpaceSceneAABBmaxValueVec);
+        }
+    }
+
+    XMFLOAT4 orthographicRects[8];              // 各级联的(minX, minY, maxX, maxY)
+    float nearPlanes[8]{};
+    float farPlanes[8]{};
     //
     // 为每个级联计算光照空间下的正交投影矩阵
     //
@@ -43,7 +178,7 @@ void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
             // 因为我们希望让正交投影矩阵在级联周围紧密贴合，我们将最小级联值
             // 设置为上一级联的区间末端
             if (cascadeIndex == 0)
-                frustumIntervalBegin = 0.0f;
+                frustumIntervalBegin = m_CascadeStartPercentage;
             else
                 frustumIntervalBegin = m_CascadePartitionsPercentage[cascadeIndex - 1];
         }
@@ -52,7 +187,7 @@ void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
             // 在FIT_PROJECTION_TO_SCENE中，这些级联相互重叠
             // 比如级联1-8覆盖了区间1
             // 级联2-8覆盖了区间2
-            frustumIntervalBegin = 0.0f;
+            frustumIntervalBegin = m_CascadeStartPercentage;
         }
 
         // 算出视锥体Z区间
@@ -136,20 +271,10 @@ void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
             lightCameraOrthographicMaxVec *= worldUnitsPerTexelVec;
         }
 
-        float nearPlane = 0.0f;
-        float farPlane = 0.0f;
-
-        // 将场景AABB的角点变换到光照空间
-        XMVECTOR sceneAABBPointsLightSpace[8]{};
-        {
-            XMFLOAT3 corners[8];
-            sceneBoundingBox.GetCorners(corners);
-            for (int i = 0; i < 8; ++i)
-            {
-                XMVECTOR v = XMLoadFloat3(corners + i);
-                sceneAABBPointsLightSpace[i] = XMVector3Transform(v, LightView);
-            }
-        }
+        XMStoreFloat4(orthographicRects + cascadeIndex, XMVectorPermute<0, 1, 4, 5>(
+            lightCameraOrthographicMinVec, lightCameraOrthographicMaxVec));
+        float& nearPlane = nearPlanes[cascadeIndex];
+        float& farPlane = farPlanes[cascadeIndex];
 
         if (m_SelectedNearFarFit == FitNearFar::FitNearFar_ZeroOne)
         {
@@ -166,222 +291,61 @@ void CascadedShadowManager::UpdateFrame(const Camera& viewerCamera,
         }
         else if (m_SelectedNearFarFit == FitNearFar::FitNearFar_SceneAABB)
         {
-            XMVECTOR lightSpaceSceneAABBminValueVec = g_XMFltMax.v;
-            XMVECTOR lightSpaceSceneAABBmaxValueVec = -g_XMFltMax.v;
-            // 我们计算光照空间下场景的min max向量
-            // 其中光照空间AABB的minZ和maxZ可以用于近平面和远平面
+            // 光照空间下场景AABB的minZ和maxZ可以用于近平面和远平面
             // 这比场景与AABB的相交测试简单，在某些情况下也能提供相似的结果
-            for (int i = 0; i < 8; ++i)
-            {
-                lightSpaceSceneAABBminValueVec = XMVectorMin(sceneAABBPointsLightSpace[i], lightSpaceSceneAABBminValueVec);
-                lightSpaceSceneAABBmaxValueVec = XMVectorMax(sceneAABBPointsLightSpace[i], lightSpaceSceneAABBmaxValueVec);
-            }
             nearPlane = XMVectorGetZ(lightSpaceSceneAABBminValueVec);
             farPlane = XMVectorGetZ(lightSpaceSceneAABBmaxValueVec);
         }
-        else if (m_SelectedNearFarFit == FitNearFar::FitNearFar_SceneAABB_Intersection)
-        {
-            // 通过光照空间下视锥体的AABB 与 变换到光照空间的场景AABB 的相交测试，我们可以得到一个更紧密的近平面和远平面
-            ComputeNearAndFar(nearPlane, farPlane, lightCameraOrthographicMinVec, lightCameraOrthographicMaxVec, 
-                sceneAABBPointsLightSpace);
-        }
-
-        XMStoreFloat4x4(m_ShadowProj + cascadeIndex,
-            XMMatrixOrthographicOffCenterLH(XMVectorGetX(
-                lightCameraOrthographicMinVec), XMVectorGetX(lightCameraOrthographicMaxVec),
-                XMVectorGetY(lightCameraOrthographicMinVec), XMVectorGetY(lightCameraOrthographicMaxVec),
-                nearPlane, farPlane));
-
-        // 创建最终的正交投影AABB
-        lightCameraOrthographicMinVec = XMVectorSetZ(lightCameraOrthographicMinVec, nearPlane);
-        lightCameraOrthographicMaxVec = XMVectorSetZ(lightCameraOrthographicMaxVec, farPlane);
-        BoundingBox::CreateFromPoints(m_ShadowProjBoundingBox[cascadeIndex], 
-            lightCameraOrthographicMinVec, lightCameraOrthographicMaxVec);
         
         m_CascadePartitionsFrustum[cascadeIndex] = frustumIntervalEnd;
     }
-}
 
-struct Triangle
-{
-    XMVECTOR point[3];
-    bool isCulled;
-};
-//--------------------------------------------------------------------------------------
-// 计算一个准确的近平面/远平面可以减少surface acne和Peter-panning
-// 通常偏移量会用于PCF滤波来解决阴影问题
-// 而准确的近平面/远平面可以提升精度
-// 这个概念并不复杂，但相交测试的代码比较复杂
-//--------------------------------------------------------------------------------------
-void XM_CALLCONV CascadedShadowManager::ComputeNearAndFar(
-    float& outNearPlane, 
-    float& outFarPlane, 
-    FXMVECTOR lightCameraOrthographicMinVec, 
-    FXMVECTOR lightCameraOrthographicMaxVec, 
-    XMVECTOR pointsInCameraView[])
-{
-    // 核心思想
-    // 1. 对AABB的所有12个三角形进行迭代
-    // 2. 每个三角形分别对正交投影的4个侧面进行裁剪。裁剪过程中可能会出现这些情况：
-    //    - 0个点在该侧面的内部，该三角形可以剔除
-    //    - 1个点在该侧面的内部，计算该点与另外两个点在侧面上的交点得到新三角形
-    //    - 2个点在该侧面的内部，计算这两个点与另一个点在侧面上的交点，分裂得到2个新三角形
-    //    - 3个点都在该侧面的内部
-    //    遍历中的三角形与新生产的三角形都要进行剩余侧面的裁剪
-    // 3. 在这些三角形中找到最小/最大的Z值作为近平面/远平面
-
-    outNearPlane = FLT_MAX;
-    outFarPlane = -FLT_MAX;
-    Triangle triangleList[16]{};
-    int numTriangles;
-
-    //      4----5
-    //     /|   /| 
-    //    0-+--1 | 
-    //    | 7--|-6
-    //    |/   |/  
-    //    3----2
-    static const int all_indices[][3] = {
-        {4,7,6}, {6,5,4},
-        {5,6,2}, {2,1,5},
-        {1,2,3}, {3,0,1},
-        {0,3,7}, {7,4,0},
-        {7,3,2}, {2,6,7},
-        {0,4,5}, {5,1,0}
-    };
-    bool triPointPassCollision[3]{};
-    const float minX = XMVectorGetX(lightCameraOrthographicMinVec);
-    const float maxX = XMVectorGetX(lightCameraOrthographicMaxVec);
-    const float minY = XMVectorGetY(lightCameraOrthographicMinVec);
-    const float maxY = XMVectorGetY(lightCameraOrthographicMaxVec);
-
-    for (auto& indices : all_indices)
+    if (m_SelectedNearFarFit == FitNearFar::FitNearFar_SceneAABB_Intersection)
+    {
+        // 通过光照空间下视锥体的AABB 与 变换到光照空间的场景AABB 的相交测试，我们可以得到一个更紧密的近平面和远平面
+        // 所有级联一起批量计算
+        CascadeMath::ComputeNearAndFar(nearPlanes, farPlanes, orthographicRects, (uint32_t)m_CascadeLevels,
+            sceneAABBPointsLightSpace);
+    }
+
+    for (int cascadeIndex = 0; cascadeIndex < m_CascadeLevels; ++cascadeIndex)
     {
-        triangleList[0].point[0] = pointsInCameraView[indices[0]];
-        triangleList[0].point[1] = pointsInCameraView[indices[1]];
-        triangleList[0].point[2] = pointsInCameraView[indices[2]];
-        numTriangles = 1;
-        triangleList[0].isCulled = false;
-
-        // 每个三角形都需要对4个视锥体侧面进行裁剪
-        for (int planeIdx = 0; planeIdx < 4; ++planeIdx)
+        XMFLOAT4 rect = orthographicRects[cascadeIndex];
+        float nearPlane = nearPlanes[cascadeIndex];
+        float farPlane = farPlanes[cascadeIndex];
+
+        // 启用静态阴影缓存时，沿用缓存的正交投影；缓存失效时以当前需要的范围加上保护带重新生成
+        ShadowCacheInvalidation& invalidation = m_StaticCacheInvalidation[cascadeIndex];
+        if (!m_StaticShadowCache)
         {
-            float edge;
-            int component;
-            switch (planeIdx)
-            {
-            case 0: edge = minX; component = 0; break;
-            case 1: edge = maxX; component = 0; break;
-            case 2: edge = minY; component = 1; break;
-            case 3: edge = maxY; component = 1; break;
-            default: break;
-            }
+            m_StaticCacheValid[cascadeIndex] = false;
+            invalidation = ShadowCacheInvalidation::ShadowCacheInvalidation_Empty;
+        }
+        else
+        {
+            ShadowCacheRegion& region = m_StaticCacheRegions[cascadeIndex];
+            if (!m_StaticCacheValid[cascadeIndex])
+                invalidation = ShadowCacheInvalidation::ShadowCacheInvalidation_Empty;
+            else if (staticCacheInvalidation != ShadowCacheInvalidation::ShadowCacheInvalidation_None)
+                invalidation = staticCacheInvalidation;
+            else
+                invalidation = CascadeMath::CheckShadowCacheRegion(region, rect, nearPlane, farPlane, m_StaticCacheGuardBand);
 
-            for (int triIdx = 0; triIdx < numTriangles; ++triIdx)
+            if (invalidation != ShadowCacheInvalidation::ShadowCacheInvalidation_None)
             {
-                // 跳过裁剪的三角形
-                if (triangleList[triIdx].isCulled)
-                    continue;
-
-                int insideVertexCount = 0;
-                
-                for (int triVtxIdx = 0; triVtxIdx < 3; ++triVtxIdx)
-                {
-                    switch (planeIdx)
-                    {
-                    case 0: triPointPassCollision[triVtxIdx] = (XMVectorGetX(triangleList[triIdx].point[triVtxIdx]) > minX); break;
-                    case 1: triPointPassCollision[triVtxIdx] = (XMVectorGetX(triangleList[triIdx].point[triVtxIdx]) < maxX); break;
-                    case 2: triPointPassCollision[triVtxIdx] = (XMVectorGetY(triangleList[triIdx].point[triVtxIdx]) > minY); break;
-                    case 3: triPointPassCollision[triVtxIdx] = (XMVectorGetY(triangleList[triIdx].point[triVtxIdx]) < maxY); break;
-                    default: break;
-                    }
-                    insideVertexCount += triPointPassCollision[triVtxIdx];
-                }
-
-                // 将通过视锥体测试的点挪到数组前面
-                if (triPointPassCollision[1] && !triPointPassCollision[0])
-                {
-                    std::swap(triangleList[triIdx].point[0], triangleList[triIdx].point[1]);
-                    triPointPassCollision[0] = true;
-                    triPointPassCollision[1] = false;
-                }
-                if (triPointPassCollision[2] && !triPointPassCollision[1])
-                {
-                    std::swap(triangleList[triIdx].point[1], triangleList[triIdx].point[2]);
-                    triPointPassCollision[1] = true;
-                    triPointPassCollision[2] = false;
-                }
-                if (triPointPassCollision[1] && !triPointPassCollision[0])
-                {
-                    std::swap(triangleList[triIdx].point[0], triangleList[triIdx].point[1]);
-                    triPointPassCollision[0] = true;
-                    triPointPassCollision[1] = false;
-                }
-
-                // 裁剪测试
-                triangleList[triIdx].isCulled = (insideVertexCount == 0);
-                if (insideVertexCount == 1)
-                {
-                    // 找出三角形与当前平面相交的另外两个点
-                    XMVECTOR v0v1Vec = triangleList[triIdx].point[1] - triangleList[triIdx].point[0];
-                    XMVECTOR v0v2Vec = triangleList[triIdx].point[2] - triangleList[triIdx].point[0];
-                    
-                    float hitPointRatio = edge - XMVectorGetByIndex(triangleList[triIdx].point[0], component);
-                    float distAlong_v0v1 = hitPointRatio / XMVectorGetByIndex(v0v1Vec, component);
-                    float distAlong_v0v2 = hitPointRatio / XMVectorGetByIndex(v0v2Vec, component);
-                    v0v1Vec = distAlong_v0v1 * v0v1Vec + triangleList[triIdx].point[0];
-                    v0v2Vec = distAlong_v0v2 * v0v2Vec + triangleList[triIdx].point[0];
-
-                    triangleList[triIdx].point[1] = v0v2Vec;
-                    triangleList[triIdx].point[2] = v0v1Vec;
-                }
-                else if (insideVertexCount == 2)
-                {
-                    // 裁剪后需要分开成两个三角形
-
-                    // 把当前三角形后面的三角形(如果存在的话)复制出来，这样
-                    // 我们就可以用算出来的新三角形覆盖它
-                    triangleList[numTriangles] = triangleList[triIdx + 1];
-                    triangleList[triIdx + 1].isCulled = false;
-
-                    // 找出三角形与当前平面相交的另外两个点
-                    XMVECTOR v2v0Vec = triangleList[triIdx].point[0] - triangleList[triIdx].point[2];
-                    XMVECTOR v2v1Vec = triangleList[triIdx].point[1] - triangleList[triIdx].point[2];
-
-                    float hitPointRatio = edge - XMVectorGetByIndex(triangleList[triIdx].point[2], component);
-                    float distAlong_v2v0 = hitPointRatio / XMVectorGetByIndex(v2v0Vec, component);
-                    float distAlong_v2v1 = hitPointRatio / XMVectorGetByIndex(v2v1Vec, component);
-                    v2v0Vec = distAlong_v2v0 * v2v0Vec + triangleList[triIdx].point[2];
-                    v2v1Vec = distAlong_v2v1 * v2v1Vec + triangleList[triIdx].point[2];
-
-                    // 添加三角形
-                    triangleList[triIdx + 1].point[0] = triangleList[triIdx].point[0];
-                    triangleList[triIdx + 1].point[1] = triangleList[triIdx].point[1];
-                    triangleList[triIdx + 1].point[2] = v2v0Vec;
-
-                    triangleList[triIdx].point[0] = triangleList[triIdx + 1].point[1];
-                    triangleList[triIdx].point[1] = triangleList[triIdx + 1].point[2];
-                    triangleList[triIdx].point[2] = v2v1Vec;
-
-                    // 添加三角形数目，跳过我们刚插入的三角形
-                    ++numTriangles;
-                    ++triIdx;
-                }
+                region = CascadeMath::BuildShadowCacheRegion(rect, nearPlane, farPlane, m_StaticCacheGuardBand, (uint32_t)m_ShadowSize);
+                m_StaticCacheValid[cascadeIndex] = true;
             }
+            rect = region.rect;
+            nearPlane = region.nearZ;
+            farPlane = region.farZ;
         }
 
-        for (int triIdx = 0; triIdx < numTriangles; ++triIdx)
-        {
-            if (!triangleList[triIdx].isCulled)
-            {
-                for (int vtxIdx = 0; vtxIdx < 3; ++vtxIdx)
-                {
-                    float z = XMVectorGetZ(triangleList[triIdx].point[vtxIdx]);
+        XMStoreFloat4x4(m_ShadowProj + cascadeIndex,
+            XMMatrixOrthographicOffCenterLH(rect.x, rect.z, rect.y, rect.w, nearPlane, farPlane));
 
-                    outNearPlane = (std::min)(outNearPlane, z);
-                    outFarPlane = (std::max)(outFarPlane, z);
-                }
-            }
-        }
+        // 创建最终的正交投影AABB
+        BoundingBox::CreateFromPoints(m_ShadowProjBoundingBox[cascadeIndex],
+            XMVectorSet(rect.x, rect.y, nearPlane, 0.0f), XMVectorSet(rect.z, rect.w, farPlane, 0.0f));
     }
 }
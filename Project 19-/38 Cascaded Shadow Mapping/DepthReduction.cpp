@@ -0,0 +1,125 @@
+#include "DepthReduction.h"
+#include <CascadeMath.h>
+#include <DXTrace.h>
+#include <algorithm>
+#include <cfloat>
+
+using namespace DirectX;
+
+HRESULT DepthReduction::InitResource(ID3D11Device* device, uint32_t width, uint32_t height)
+{
+    if (!m_pEffectHelper)
+    {
+        m_pEffectHelper = std::make_unique<EffectHelper>();
+        m_pEffectHelper->SetBinaryCacheDirectory(L"Shaders\\Cache");
+        HR(m_pEffectHelper->CreateShaderFromFile("DepthReductionCS", L"Shaders/DepthReduction.hlsl",
+            device, "DepthReductionCS", "cs_5_0"));
+        EffectPassDesc passDesc;
+        passDesc.nameCS = "DepthReductionCS";
+        HR(m_pEffectHelper->AddEffectPass("DepthReduction", device, &passDesc));
+    }
+
+    m_Width = width;
+    m_Height = height;
+    m_TileCountX = (width + s_TileSize - 1) / s_TileSize;
+    m_TileCountY = (height + s_TileSize - 1) / s_TileSize;
+
+    m_pTileDepthRange = std::make_unique<Texture2D>(device, m_TileCountX, m_TileCountY, DXGI_FORMAT_R32G32_FLOAT, 1,
+        D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_UNORDERED_ACCESS);
+    m_pTileDepthRange->SetDebugObjectName("TileDepthRange");
+
+    CD3D11_TEXTURE2D_DESC stagingDesc(DXGI_FORMAT_R32G32_FLOAT, m_TileCountX, m_TileCountY, 1, 1, 0,
+        D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+    for (auto& readback : m_Readbacks)
+    {
+        HR(device->CreateTexture2D(&stagingDesc, nullptr, readback.pStaging.ReleaseAndGetAddressOf()));
+        readback.pending = false;
+    }
+    m_ReadbackIndex = 0;
+    m_TileDepthRanges.assign((size_t)m_TileCountX * m_TileCountY, XMFLOAT2(FLT_MAX, 0.0f));
+
+    return S_OK;
+}
+
+void XM_CALLCONV DepthReduction::Reduce(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* depthTexture, FXMMATRIX proj)
+{
+    // 所有槽都在等待时跳过这一帧
+    Readback& readback = m_Readbacks[m_ReadbackIndex];
+    if (readback.pending)
+        return;
+
+    // 投影后的深度为_33 + _43 / z，由此还原视空间深度
+    XMFLOAT4X4 P;
+    XMStoreFloat4x4(&P, proj);
+    uint32_t depthSize[4] = { m_Width, m_Height };
+    m_pEffectHelper->GetConstantBufferVariable("g_ProjZ")->SetFloat(P._33);
+    m_pEffectHelper->GetConstantBufferVariable("g_ProjW")->SetFloat(P._43);
+    m_pEffectHelper->GetConstantBufferVariable("g_DepthSize")->SetUIntVector(2, depthSize);
+    m_pEffectHelper->SetShaderResourceByName("g_DepthTexture", depthTexture);
+    m_pEffectHelper->SetUnorderedAccessByName("g_TileDepthRange", m_pTileDepthRange->GetUnorderedAccess(), 0);
+    auto pPass = m_pEffectHelper->GetEffectPass("DepthReduction");
+    pPass->Apply(deviceContext);
+    pPass->Dispatch(deviceContext, m_Width, m_Height);
+
+    // 清除绑定
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    deviceContext->CSSetShaderResources(0, 1, &nullSRV);
+    deviceContext->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+    m_pEffectHelper->SetShaderResourceByName("g_DepthTexture", nullptr);
+
+    deviceContext->CopyResource(readback.pStaging.Get(), m_pTileDepthRange->GetTexture());
+    readback.pending = true;
+    m_ReadbackIndex = (m_ReadbackIndex + 1) % s_ReadbackLatency;
+}
+
+bool DepthReduction::Update(ID3D11DeviceContext* deviceContext)
+{
+    // 从最早提交的回读开始，只取已经完成的结果，不等待GPU
+    bool updated = false;
+    for (uint32_t i = 0; i < s_ReadbackLatency; ++i)
+    {
+        Readback& readback = m_Readbacks[(m_ReadbackIndex + i) % s_ReadbackLatency];
+        if (!readback.pending)
+            continue;
+        D3D11_MAPPED_SUBRESOURCE mappedData;
+        if (FAILED(deviceContext->Map(readback.pStaging.Get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedData)))
+            break;
+        for (uint32_t y = 0; y < m_TileCountY; ++y)
+        {
+            memcpy(m_TileDepthRanges.data() + (size_t)y * m_TileCountX,
+                static_cast<const uint8_t*>(mappedData.pData) + (size_t)y * mappedData.RowPitch,
+                m_TileCountX * sizeof(XMFLOAT2));
+        }
+        deviceContext->Unmap(readback.pStaging.Get(), 0);
+        readback.pending = false;
+        updated = true;
+    }
+    return updated;
+}
+
+bool DepthReduction::GetDepthRange(float& minZ, float& maxZ) const
+{
+    minZ = FLT_MAX;
+    maxZ = 0.0f;
+    for (const XMFLOAT2& range : m_TileDepthRanges)
+    {
+        minZ = (std::min)(minZ, range.x);
+        maxZ = (std::max)(maxZ, range.y);
+    }
+    return minZ <= maxZ;
+}
+
+void DepthReduction::AccumulateHistogram(float minZ, float maxZ, uint32_t binCount, uint32_t histogram[]) const
+{
+    std::vector<float> depths;
+    depths.reserve(2 * m_TileDepthRanges.size());
+    for (const XMFLOAT2& range : m_TileDepthRanges)
+    {
+        if (range.x > range.y)
+            continue;
+        depths.push_back(range.x);
+        depths.push_back(range.y);
+    }
+    CascadeMath::AccumulateDepthHistogram(depths.data(), depths.size(), minZ, maxZ, binCount, histogram);
+}
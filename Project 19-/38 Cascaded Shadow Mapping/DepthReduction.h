@@ -0,0 +1,67 @@
+//***************************************************************************************
+// DepthReduction.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 深度缓冲区分块归约与异步回读，为SDSM提供可见像素的深度范围
+// Tiled depth buffer reduction with asynchronous readback for SDSM.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef DEPTH_REDUCTION_H
+#define DEPTH_REDUCTION_H
+
+#include <WinMin.h>
+#include <d3d11_1.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <memory>
+#include <vector>
+#include <EffectHelper.h>
+#include <Texture2D.h>
+
+// 计算着色器把深度缓冲区按16x16分块，求出每块可见像素的视空间深度最小/最大值
+// 分块结果拷贝到staging纹理的环形缓冲区，几帧后以D3D11_MAP_FLAG_DO_NOT_WAIT取回，不会阻塞渲染
+// 回读只有原图的1/256大小，剩下的归约或直方图统计在CPU上完成
+class DepthReduction
+{
+public:
+    template<class T>
+    using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+    // 窗口大小改变时需要重新调用
+    HRESULT InitResource(ID3D11Device* device, uint32_t width, uint32_t height);
+
+    // depthTexture必须是反向Z、清为0的(多重采样)深度缓冲区，深度为0的像素视为天空而不参与统计，只读取第0个样本
+    // proj为绘制它时使用的反向Z投影矩阵
+    void XM_CALLCONV Reduce(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* depthTexture, DirectX::FXMMATRIX proj);
+
+    // 取回已完成的最新结果，没有新结果时返回false
+    bool Update(ID3D11DeviceContext* deviceContext);
+
+    // 最近一次取回的结果中可见像素的深度范围，没有可见像素时返回false
+    bool GetDepthRange(float& minZ, float& maxZ) const;
+    // 把每个分块的最小/最大深度累加到对数划分的直方图中，见CascadeMath::AccumulateDepthHistogram
+    void AccumulateHistogram(float minZ, float maxZ, uint32_t binCount, uint32_t histogram[]) const;
+
+private:
+    static constexpr uint32_t s_TileSize = 16;
+    static constexpr uint32_t s_ReadbackLatency = 3;
+
+    struct Readback
+    {
+        ComPtr<ID3D11Texture2D> pStaging;
+        bool pending = false;
+    };
+
+    std::unique_ptr<EffectHelper> m_pEffectHelper;
+    std::unique_ptr<Texture2D> m_pTileDepthRange;           // 每个分块的(minZ, maxZ)
+    Readback m_Readbacks[s_ReadbackLatency];
+    uint32_t m_ReadbackIndex = 0;
+
+    uint32_t m_Width = 0, m_Height = 0;
+    uint32_t m_TileCountX = 0, m_TileCountY = 0;
+    std::vector<DirectX::XMFLOAT2> m_TileDepthRanges;       // 最近一次取回的分块结果，空的分块为(FLT_MAX, 0)
+};
+
+#endif
@@ -56,6 +56,7 @@ void GameApp::OnResize()
     sampleDesc.Quality = 0;
     m_pLitBuffer = std::make_unique<Texture2DMS>(m_pd3dDevice.Get(), m_ClientWidth, m_ClientHeight, DXGI_FORMAT_R8G8B8A8_UNORM, sampleDesc);
     m_pDepthBuffer = std::make_unique<Depth2DMS>(m_pd3dDevice.Get(), m_ClientWidth, m_ClientHeight, sampleDesc, DepthStencilBitsFlag::Depth_32Bits);
+    m_DepthReduction.InitResource(m_pd3dDevice.Get(), m_ClientWidth, m_ClientHeight);
 
     // 摄像机变更显示
     if (m_pViewerCamera != nullptr)
@@ -157,6 +158,19 @@ void GameApp::UpdateScene(float dt)
             need_gpu_timer_reset = true;
         if (ImGui::Checkbox("Fit Light to Texels", &m_CSManager.m_MoveLightTexelSize))
             need_gpu_timer_reset = true;
+        if (ImGui::Checkbox("Static Shadow Cache", &m_CSManager.m_StaticShadowCache))
+        {
+            m_CSManager.InitResource(m_pd3dDevice.Get());
+            need_gpu_timer_reset = true;
+        }
+        if (m_CSManager.m_StaticShadowCache)
+        {
+            ImGui::SliderFloat("Guard Band", &m_CSManager.m_StaticCacheGuardBand, 0.0f, 0.5f);
+            ImGui::SliderFloat("Light Tolerance", &m_CSManager.m_LightDirectionTolerance, 0.0f, 2.0f, "%.2f deg");
+        }
+        ImGui::Checkbox("Single-pass Caster Culling", &m_SinglePassCasterCulling);
+        if (m_SinglePassCasterCulling)
+            ImGui::Checkbox("Sweep Toward Light", &m_SweepTowardLight);
         
         static const char* fit_projection_strs[] = {
             "Fit Projection To Cascade",
@@ -234,10 +248,40 @@ void GameApp::UpdateScene(float dt)
             need_gpu_timer_reset = true;
         }
 
+        static const char* cascade_partition_strs[] = {
+            "Manual Partition",
+            "Practical Partition (PSSM)",
+            "Sample Distribution (SDSM)"
+        };
+        if (ImGui::Combo("##8", reinterpret_cast<int*>(&m_CSManager.m_SelectedCascadePartition), cascade_partition_strs, ARRAYSIZE(cascade_partition_strs)))
+            need_gpu_timer_reset = true;
+
+        if (m_CSManager.m_SelectedCascadePartition != CascadePartition::CascadePartition_Manual)
+        {
+            ImGui::SliderFloat("Lambda", &m_CSManager.m_PSSMLambda, 0.0f, 1.0f);
+        }
+        if (m_CSManager.m_SelectedCascadePartition == CascadePartition::CascadePartition_SDSM)
+        {
+            ImGui::Checkbox("Depth Histogram", &m_SDSMUseHistogram);
+            if (m_SDSMUseHistogram)
+                ImGui::SliderFloat("Percentile", &m_SDSMPercentile, 0.0f, 0.1f, "%.3f");
+            float minZ, maxZ;
+            if (m_CSManager.GetVisibleDepthRange(minZ, maxZ))
+                ImGui::Text("Visible Depth: %.2f - %.2f", minZ, maxZ);
+            else
+                ImGui::Text("Visible Depth: N/A");
+        }
+
         char level_str[] = "Level1";
         for (int i = 0; i < m_CSManager.m_CascadeLevels; ++i)
         {
             level_str[5] = '1' + i;
+            if (m_CSManager.m_SelectedCascadePartition != CascadePartition::CascadePartition_Manual)
+            {
+                // 自动划分的结果每帧都会被改写，只显示
+                ImGui::Text("%s: %.1f%%", level_str, m_CSManager.m_CascadePartitionsPercentage[i] * 100);
+                continue;
+            }
             ImGui::SliderFloat(level_str, m_CSManager.m_CascadePartitionsPercentage + i, 0.0f, 1.0f, "");
             ImGui::SameLine();
             ImGui::Text("%.1f%%", m_CSManager.m_CascadePartitionsPercentage[i] * 100);
@@ -284,15 +328,32 @@ void GameApp::UpdateScene(float dt)
         ShadowProjRZ.r[2] *= g_XMNegateZ.v;
         ShadowProjRZ.r[3] = XMVectorSetZ(ShadowProjRZ.r[3], 1.0f - XMVectorGetZ(ShadowProjRZ.r[3]));
         
-        m_ForwardEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_ForwardEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
         m_ForwardEffect.SetProjMatrix(ShadowProjRZ);
-        m_SkyboxEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_SkyboxEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
         m_SkyboxEffect.SetProjMatrix(ShadowProjRZ);
     }
         
-    m_ShadowEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+    // 取回几帧前的深度归约结果，作为SDSM的可见深度范围
+    if (m_DepthReduction.Update(m_pd3dImmediateContext.Get()))
+    {
+        if (m_SDSMUseHistogram)
+        {
+            uint32_t histogram[64]{};
+            float nearZ = m_pViewerCamera->GetNearZ(), farZ = m_pViewerCamera->GetFarZ();
+            m_DepthReduction.AccumulateHistogram(nearZ, farZ, ARRAYSIZE(histogram), histogram);
+            m_CSManager.SetVisibleDepthHistogram(histogram, ARRAYSIZE(histogram), nearZ, farZ, m_SDSMPercentile);
+        }
+        else
+        {
+            float minZ, maxZ;
+            if (m_DepthReduction.GetDepthRange(minZ, maxZ))
+                m_CSManager.SetVisibleDepthRange(minZ, maxZ);
+        }
+    }
 
     m_CSManager.UpdateFrame(*m_pViewerCamera, *m_pLightCamera, m_Powerplant.GetModel()->boundingbox);
+    m_ShadowEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
     m_ForwardEffect.SetLightDir(m_pLightCamera->GetLookAxis());
 }
 
@@ -316,6 +377,10 @@ void GameApp::DrawScene()
     RenderShadowForAllCascades();
     RenderForward();
     RenderSkybox();
+    // 只有从用户摄像机观察时深度缓冲区才对应划分所用的视锥体
+    if (m_CSManager.m_SelectedCascadePartition == CascadePartition::CascadePartition_SDSM &&
+        m_CSManager.m_SelectedCamera == CameraSelection::CameraSelection_Eye)
+        m_DepthReduction.Reduce(m_pd3dImmediateContext.Get(), m_pDepthBuffer->GetShaderResource(), m_pViewerCamera->GetProjMatrixXM(true));
 
     //
     // ImGui部分
@@ -339,6 +404,58 @@ void GameApp::DrawScene()
         total_time += m_GpuTimer_Skybox.AverageTime();
 
         ImGui::Text("Total: %.3f ms", total_time * 1000);
+
+        ImGui::Separator();
+        ImGui::Text("CPU Profile");
+        ImGui::Text("Shadow Projection: %s", m_CSManager.IsShadowProjectionChanged() ? "Updated" : "Cached");
+        ImGui::Text("Caster Culling: %.3f ms", m_CasterCullingTime);
+        ImGui::Text("Caster Draws: %u", m_CasterDrawCount);
+        if (m_CSManager.m_StaticShadowCache)
+        {
+            ImGui::Separator();
+            ImGui::Text("Static Shadow Cache");
+            static const char* invalidation_strs[] = {
+                "None",
+                "Empty",
+                "Settings",
+                "Light Direction",
+                "Out of Bounds",
+                "Resolution"
+            };
+            for (int i = 0; i < m_CSManager.m_CascadeLevels; ++i)
+                ImGui::Text("Cascade %d: %u Rebuilds (%s)", i + 1, m_StaticCacheRebuildCounts[i],
+                    invalidation_strs[static_cast<int>(m_StaticCacheLastInvalidations[i])]);
+        }
+        if (ImGui::Button("Run Near/Far Benchmark"))
+            m_NearFarBenchmark = RunCascadeNearFarBenchmark(20000, (uint32_t)m_CSManager.m_CascadeLevels);
+        if (m_NearFarBenchmark.numScenes)
+        {
+            ImGui::Text("%u Scenes x %u Cascades", m_NearFarBenchmark.numScenes, m_NearFarBenchmark.cascadeCount);
+            ImGui::Text("Scalar: %.3f ms", m_NearFarBenchmark.referenceMs);
+            ImGui::Text("Batched: %.3f ms (x%.1f)", m_NearFarBenchmark.batchedMs,
+                m_NearFarBenchmark.referenceMs / m_NearFarBenchmark.batchedMs);
+            ImGui::Text("Max Error: %.2e", m_NearFarBenchmark.maxError);
+        }
+        if (ImGui::Button("Run Split Test"))
+            m_SplitTest = RunCascadeSplitTest();
+        if (m_SplitTest.numChecks)
+        {
+            if (m_SplitTest.numFailed)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "FAILED %u/%u: %s",
+                    m_SplitTest.numFailed, m_SplitTest.numChecks, m_SplitTest.firstFailure);
+            else
+                ImGui::Text("Passed %u Checks", m_SplitTest.numChecks);
+        }
+        if (ImGui::Button("Run Shadow Cache Test"))
+            m_ShadowCacheTest = RunShadowCacheTest();
+        if (m_ShadowCacheTest.numChecks)
+        {
+            if (m_ShadowCacheTest.numFailed)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "FAILED %u/%u: %s",
+                    m_ShadowCacheTest.numFailed, m_ShadowCacheTest.numChecks, m_ShadowCacheTest.firstFailure);
+            else
+                ImGui::Text("Passed %u Checks", m_ShadowCacheTest.numChecks);
+        }
     }
     ImGui::End();
 
@@ -468,26 +585,82 @@ void GameApp::RenderShadowForAllCascades()
         D3D11_VIEWPORT vp = m_CSManager.GetShadowViewport();
         m_pd3dImmediateContext->RSSetViewports(1, &vp);
 
+        // 静态缓存全部可用时不需要裁剪静态物体
+        bool needStaticCasters = !m_CSManager.m_StaticShadowCache;
+        for (size_t cascadeIdx = 0; cascadeIdx < m_CSManager.m_CascadeLevels; ++cascadeIdx)
+            needStaticCasters |= !m_CSManager.IsStaticCacheValid(cascadeIdx);
+
+        m_CasterCullingTimer.Reset();
+        m_CasterCullingTimer.Stop();
+        m_CasterDrawCount = 0;
+        if (m_SinglePassCasterCulling)
+        {
+            // 每个子网格只变换一次，与所有级联比较得到级联掩码
+            BoundingBox cascadeBoxes[8];
+            for (size_t cascadeIdx = 0; cascadeIdx < m_CSManager.m_CascadeLevels; ++cascadeIdx)
+                cascadeBoxes[cascadeIdx] = m_CSManager.GetShadowAABB(cascadeIdx);
+
+            m_CasterCullingTimer.Start();
+            XMMATRIX shadowView = m_CSManager.GetShadowViewXM();
+            if (needStaticCasters)
+                m_Powerplant.CascadeCulling(shadowView, cascadeBoxes, m_CSManager.m_CascadeLevels, m_SweepTowardLight);
+            m_Cube.CascadeCulling(shadowView, cascadeBoxes, m_CSManager.m_CascadeLevels, m_SweepTowardLight);
+            m_CasterCullingTimer.Stop();
+        }
+
         for (size_t cascadeIdx = 0; cascadeIdx < m_CSManager.m_CascadeLevels; ++cascadeIdx)
         {
             ID3D11RenderTargetView* nullRTV = nullptr;
             ID3D11DepthStencilView* depthDSV = m_CSManager.GetCascadeDepthStencilView(cascadeIdx);
-            m_pd3dImmediateContext->ClearDepthStencilView(depthDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
-            m_pd3dImmediateContext->OMSetRenderTargets(1, &nullRTV, depthDSV);
 
             XMMATRIX shadowProj = m_CSManager.GetShadowProjectionXM(cascadeIdx);
             m_ShadowEffect.SetProjMatrix(shadowProj);
 
             // 更新物体与投影立方体的裁剪
             BoundingOrientedBox obb = m_CSManager.GetShadowOBB(cascadeIdx);
-            obb.Transform(obb, m_pLightCamera->GetLocalToWorldMatrixXM());
-            m_Powerplant.CubeCulling(obb);
+            obb.Transform(obb, m_CSManager.GetShadowInvViewXM());
+            auto cullCaster = [&](GameObject& caster) {
+                m_CasterCullingTimer.Start();
+                if (m_SinglePassCasterCulling)
+                    caster.SelectCascade((uint32_t)cascadeIdx);
+                else
+                    caster.CubeCulling(obb);
+                m_CasterCullingTimer.Stop();
+                if (caster.InFrustum())
+                    m_CasterDrawCount += (uint32_t)caster.GetSubModelInFrustumCount();
+            };
 
-            m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+            if (m_CSManager.m_StaticShadowCache)
+            {
+                // 静态物体只在缓存失效时重新绘制，之后每帧复制缓存
+                if (!m_CSManager.IsStaticCacheValid(cascadeIdx))
+                {
+                    ID3D11DepthStencilView* staticDSV = m_CSManager.GetStaticCascadeDepthStencilView(cascadeIdx);
+                    m_pd3dImmediateContext->ClearDepthStencilView(staticDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+                    m_pd3dImmediateContext->OMSetRenderTargets(1, &nullRTV, staticDSV);
+                    cullCaster(m_Powerplant);
+                    m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+
+                    ++m_StaticCacheRebuildCounts[cascadeIdx];
+                    m_StaticCacheLastInvalidations[cascadeIdx] = m_CSManager.GetStaticCacheInvalidation(cascadeIdx);
+                }
+                m_pd3dImmediateContext->OMSetRenderTargets(0, nullptr, nullptr);
+                m_CSManager.ApplyStaticCache(m_pd3dImmediateContext.Get(), cascadeIdx);
+                m_pd3dImmediateContext->OMSetRenderTargets(1, &nullRTV, depthDSV);
+            }
+            else
+            {
+                m_pd3dImmediateContext->ClearDepthStencilView(depthDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+                m_pd3dImmediateContext->OMSetRenderTargets(1, &nullRTV, depthDSV);
+                cullCaster(m_Powerplant);
+                m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+            }
 
-            m_Cube.CubeCulling(obb);
+            // 立方体作为动态物体，每帧都要绘制
+            cullCaster(m_Cube);
             m_Cube.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
         }
+        m_CasterCullingTime = 0.95f * m_CasterCullingTime + 0.05f * m_CasterCullingTimer.TotalTime() * 1000.0f;
     }
     m_GpuTimer_Shadow.Stop();
 }
@@ -521,7 +694,7 @@ void GameApp::RenderForward()
         {
             BoundingOrientedBox bbox = m_CSManager.GetShadowOBB(
                 static_cast<int>(m_CSManager.m_SelectedCamera) - 2);
-            bbox.Transform(bbox, m_pLightCamera->GetLocalToWorldMatrixXM());
+            bbox.Transform(bbox, m_CSManager.GetShadowInvViewXM());
             m_Powerplant.CubeCulling(bbox);
             m_Cube.CubeCulling(bbox);
             viewport.Width = (float)std::min(m_ClientHeight, m_ClientWidth);
@@ -555,7 +728,7 @@ void GameApp::RenderForward()
         }
         m_ForwardEffect.SetCascadeOffsets(offsets);
         m_ForwardEffect.SetCascadeScales(scales);
-        m_ForwardEffect.SetShadowViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_ForwardEffect.SetShadowViewMatrix(m_CSManager.GetShadowViewXM());
         m_ForwardEffect.SetShadowTextureArray(m_CSManager.GetCascadesOutput());
         // 注意：反向Z
         m_ForwardEffect.SetRenderDefault(true);
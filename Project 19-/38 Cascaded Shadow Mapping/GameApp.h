@@ -14,6 +14,8 @@
 #include <ModelManager.h>
 #include <TextureManager.h>
 #include "CascadedShadowManager.h"
+#include "DepthReduction.h"
+#include <CascadeMath.h>
 
 
 class GameApp : public D3DApp
@@ -49,7 +51,22 @@ private:
 
     // 阴影
     CascadedShadowManager m_CSManager;
+    uint32_t m_StaticCacheRebuildCounts[8]{};                      // 各级联静态阴影缓存的重新绘制次数
+    ShadowCacheInvalidation m_StaticCacheLastInvalidations[8]{};   // 各级联最近一次重新绘制的原因
     bool m_DebugShadow = false;
+    bool m_SinglePassCasterCulling = true;                          // 一次性对所有级联裁剪阴影投射体，否则逐级联裁剪
+    bool m_SweepTowardLight = false;                                // 级联范围朝光源方向延伸
+    CpuTimer m_CasterCullingTimer;                                  // 阴影投射体裁剪的CPU计时
+    float m_CasterCullingTime = 0.0f;                               // 阴影投射体裁剪的平均耗时(ms)
+    uint32_t m_CasterDrawCount = 0;                                 // 当前帧所有级联绘制的子网格总数
+    CascadeNearFarBenchmarkResult m_NearFarBenchmark{};            // 近/远平面计算的CPU性能测试结果
+    CascadeCheckResult m_SplitTest{};                               // 级联划分与深度直方图的检查结果
+    CascadeCheckResult m_ShadowCacheTest{};                         // 静态阴影缓存失效判断的检查结果
+
+    // SDSM
+    DepthReduction m_DepthReduction;                                // 深度缓冲区归约
+    bool m_SDSMUseHistogram = false;                                // 用直方图去掉两端的离群深度，否则直接用最小/最大值
+    float m_SDSMPercentile = 0.01f;                                 // 直方图两端各忽略的样本比例
 
     // 各种资源
     TextureManager m_TextureManager;                                // 纹理读取管理
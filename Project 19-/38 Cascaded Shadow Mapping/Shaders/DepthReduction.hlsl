@@ -0,0 +1,52 @@
+#ifndef DEPTH_REDUCTION_HLSL
+#define DEPTH_REDUCTION_HLSL
+
+#define TILE_SIZE 16
+
+cbuffer CB : register(b0)
+{
+    float g_ProjZ;          // 投影矩阵的_33
+    float g_ProjW;          // 投影矩阵的_43
+    uint2 g_DepthSize;
+}
+
+Texture2DMS<float> g_DepthTexture : register(t0);
+RWTexture2D<float2> g_TileDepthRange : register(u0);
+
+groupshared float2 s_DepthRange[TILE_SIZE * TILE_SIZE];
+
+// 每个线程组求一个分块内可见像素的视空间深度最小/最大值
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void DepthReductionCS(uint3 DTid : SV_DispatchThreadID, uint3 Gid : SV_GroupID, uint GI : SV_GroupIndex)
+{
+    // 没有可见像素的分块输出(FLT_MAX, 0)
+    float2 depthRange = float2(3.402823466e+38f, 0.0f);
+    if (all(DTid.xy < g_DepthSize))
+    {
+        // 反向Z下深度缓冲区清为0，天空盒所在的像素不参与统计
+        float depth = g_DepthTexture.Load(DTid.xy, 0);
+        if (depth > 0.0f)
+        {
+            float viewZ = g_ProjW / (depth - g_ProjZ);
+            depthRange = float2(viewZ, viewZ);
+        }
+    }
+    s_DepthRange[GI] = depthRange;
+    GroupMemoryBarrierWithGroupSync();
+    
+    [unroll]
+    for (uint stride = TILE_SIZE * TILE_SIZE / 2; stride > 0; stride >>= 1)
+    {
+        if (GI < stride)
+        {
+            float2 other = s_DepthRange[GI + stride];
+            s_DepthRange[GI] = float2(min(s_DepthRange[GI].x, other.x), max(s_DepthRange[GI].y, other.y));
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+    
+    if (GI == 0)
+        g_TileDepthRange[Gid.xy] = s_DepthRange[0];
+}
+
+#endif
@@ -90,6 +90,13 @@ public:
     // VSM
     void SetMagicPower(float power);
 
+    // SAT
+    // 开启后VSM/EVSM从求和面积表中求矩形范围内矩的平均值，而不是采样阴影图
+    void SetSATEnabled(bool enable);
+    void SetSummedAreaTable(ID3D11ShaderResourceView* sat);
+    // scales与fractionBits需要与生成SAT时一致，滤波宽度以texel为单位
+    void SetSATParameters(const float scales[4], uint32_t fractionBits, float minFilterWidth, float maxFilterWidth);
+
 
 
 
@@ -210,6 +217,21 @@ public:
         ID3D11RenderTargetView* output, 
         const D3D11_VIEWPORT& vp);
 
+    // 由第cascadeIndex个级联的矩生成求和面积表(SAT)，moments为所有级联的纹理数组
+    // rowTemp为与阴影图同样大小的临时纹理，output为SAT数组中该级联的UAV
+    // channels为2或4，size需要为256的倍数；各通道乘以scales映射到[0, 1]后量化为fractionBits位小数的定点数
+    void GenerateSummedAreaTable(
+        ID3D11DeviceContext* deviceContext,
+        ID3D11ShaderResourceView* moments,
+        uint32_t cascadeIndex,
+        ID3D11UnorderedAccessView* rowTempUAV,
+        ID3D11ShaderResourceView* rowTempSRV,
+        ID3D11UnorderedAccessView* output,
+        uint32_t size,
+        uint32_t channels,
+        const float scales[4],
+        uint32_t fractionBits);
+
 
     // 应用常量缓冲区和纹理资源的变更
     void Apply(ID3D11DeviceContext* deviceContext) override;
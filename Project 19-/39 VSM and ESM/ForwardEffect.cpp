@@ -261,6 +261,24 @@ void ForwardEffect::SetMagicPower(float power)
     pImpl->m_pEffectHelper->GetConstantBufferVariable("g_MagicPower")->SetFloat(power);
 }
 
+void ForwardEffect::SetSATEnabled(bool enable)
+{
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_UseSAT")->SetSInt(enable);
+}
+
+void ForwardEffect::SetSummedAreaTable(ID3D11ShaderResourceView* sat)
+{
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_ShadowSAT", sat);
+}
+
+void ForwardEffect::SetSATParameters(const float scales[4], uint32_t fractionBits, float minFilterWidth, float maxFilterWidth)
+{
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATScales")->SetFloatVector(4, scales);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATQuantScale")->SetFloat((float)(1u << fractionBits));
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATMinFilterWidth")->SetFloat(minFilterWidth);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATMaxFilterWidth")->SetFloat(maxFilterWidth);
+}
+
 void ForwardEffect::SetShadowSize(int size)
 {
     pImpl->m_ShadowSize = size;
@@ -188,6 +188,37 @@ void GameApp::UpdateScene(float dt)
                 m_ForwardEffect.SetLightBleedingReduction(m_CSManager.m_LightBleedingReduction);
             }
 
+            if (ImGui::Checkbox("Summed Area Table", &m_CSManager.m_SummedAreaTable))
+            {
+                m_CSManager.InitResource(m_pd3dDevice.Get());
+                need_gpu_timer_reset = true;
+            }
+            if (m_CSManager.m_SummedAreaTable)
+            {
+                if (ImGui::SliderFloat("SAT Max Width", &m_CSManager.m_SATMaxFilterWidth, 4.0f, 128.0f, "%.0f texels"))
+                    m_CSManager.m_SATFilterWidth = (std::min)(m_CSManager.m_SATFilterWidth, m_CSManager.m_SATMaxFilterWidth);
+                ImGui::SliderFloat("SAT Min Width", &m_CSManager.m_SATFilterWidth, 1.0f, m_CSManager.m_SATMaxFilterWidth, "%.1f texels");
+                uint32_t fractionBits = m_CSManager.GetSATFractionBits();
+                ImGui::Text("Fraction Bits: %u", fractionBits);
+
+                if (ImGui::Button("Run SAT Precision Test"))
+                    m_SATPrecisionTest = RunSATPrecisionTest((uint32_t)(std::min)(m_CSManager.m_ShadowSize, 2048), m_CSManager.m_SATMaxFilterWidth);
+                if (m_SATPrecisionTest.size)
+                {
+                    ImGui::Text("%ux%u, %u Queries, %u Bits", m_SATPrecisionTest.size, m_SATPrecisionTest.size,
+                        m_SATPrecisionTest.numQueries, m_SATPrecisionTest.fractionBits);
+                    ImGui::Text("Fixed: Mean %.1e Var %.1e", m_SATPrecisionTest.fixedMaxMeanError, m_SATPrecisionTest.fixedMaxVarianceError);
+                    ImGui::Text("Float: Mean %.1e Var %.1e", m_SATPrecisionTest.floatMaxMeanError, m_SATPrecisionTest.floatMaxVarianceError);
+                    ImGui::Text("Float Offset: Mean %.1e Var %.1e", m_SATPrecisionTest.offsetMaxMeanError, m_SATPrecisionTest.offsetMaxVarianceError);
+                    ImGui::Text("Fixed Build: %.2f ms", m_SATPrecisionTest.fixedBuildMs);
+                    if (m_SATPrecisionTest.passed)
+                        ImGui::Text("Passed (Limit: Mean %.1e Var %.1e)", m_SATPrecisionTest.meanErrorLimit, m_SATPrecisionTest.varianceErrorLimit);
+                    else
+                        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "FAILED (Limit: Mean %.1e Var %.1e)",
+                            m_SATPrecisionTest.meanErrorLimit, m_SATPrecisionTest.varianceErrorLimit);
+                }
+            }
+
             static const char* sampler_strs[] = {
                 "Point",
                 "Linear",
@@ -223,18 +254,26 @@ void GameApp::UpdateScene(float dt)
 
         if (m_CSManager.m_ShadowType >= ShadowType::ShadowType_EVSM2)
         {
-            if (ImGui::SliderFloat("Pos Exp", &m_CSManager.m_PosExp, 0.1f, 42.0f, "%.1f"))
+            // 定点数SAT能表示的指数有上限，随最大滤波宽度变化，滑动条的范围与当前值一并钳位
+            float maxExp = 42.0f;
+            if (m_CSManager.IsSATEnabled())
             {
-                m_ForwardEffect.SetPosExponent(m_CSManager.m_PosExp);
+                maxExp = (std::min)(maxExp, SummedAreaTable::GetMaxEVSMExponent(m_CSManager.GetSATFractionBits()));
+                m_CSManager.m_PosExp = (std::min)(m_CSManager.m_PosExp, maxExp);
+                m_CSManager.m_NegExp = (std::min)(m_CSManager.m_NegExp, maxExp);
             }
-        }
 
-        if (m_CSManager.m_ShadowType == ShadowType::ShadowType_EVSM4)
-        {
-            if (ImGui::SliderFloat("Neg Exp", &m_CSManager.m_NegExp, 0.1f, 42.0f, "%.1f"))
+            if (ImGui::SliderFloat("Pos Exp", &m_CSManager.m_PosExp, 0.1f, maxExp, "%.1f"))
+            {
+                m_ForwardEffect.SetPosExponent(m_CSManager.m_PosExp);
+            }
+            if (m_CSManager.m_ShadowType == ShadowType::ShadowType_EVSM4 &&
+                ImGui::SliderFloat("Neg Exp", &m_CSManager.m_NegExp, 0.1f, maxExp, "%.1f"))
             {
                 m_ForwardEffect.SetNegExponent(m_CSManager.m_NegExp);
             }
+            if (m_CSManager.IsSATEnabled())
+                ImGui::Text("Exponent Clamped (SAT max %.2f)", maxExp);
         }
 
 
@@ -253,6 +292,16 @@ void GameApp::UpdateScene(float dt)
 
         if (ImGui::Checkbox("Fit Light to Texels", &m_CSManager.m_MoveLightTexelSize))
             need_gpu_timer_reset = true;
+        if (ImGui::Checkbox("Static Shadow Cache", &m_CSManager.m_StaticShadowCache))
+        {
+            m_CSManager.InitResource(m_pd3dDevice.Get());
+            need_gpu_timer_reset = true;
+        }
+        if (m_CSManager.m_StaticShadowCache)
+        {
+            ImGui::SliderFloat("Guard Band", &m_CSManager.m_StaticCacheGuardBand, 0.0f, 0.5f);
+            ImGui::SliderFloat("Light Tolerance", &m_CSManager.m_LightDirectionTolerance, 0.0f, 2.0f, "%.2f deg");
+        }
         
         static const char* fit_projection_strs[] = {
             "Fit Projection To Cascade",
@@ -379,15 +428,14 @@ void GameApp::UpdateScene(float dt)
         ShadowProjRZ.r[2] *= g_XMNegateZ.v;
         ShadowProjRZ.r[3] = XMVectorSetZ(ShadowProjRZ.r[3], 1.0f - XMVectorGetZ(ShadowProjRZ.r[3]));
         
-        m_ForwardEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_ForwardEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
         m_ForwardEffect.SetProjMatrix(ShadowProjRZ);
-        m_SkyboxEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_SkyboxEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
         m_SkyboxEffect.SetProjMatrix(ShadowProjRZ);
     }
         
-    m_ShadowEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
-
     m_CSManager.UpdateFrame(*m_pViewerCamera, *m_pLightCamera, m_Powerplant.GetModel()->boundingbox);
+    m_ShadowEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
     m_ForwardEffect.SetLightDir(m_pLightCamera->GetLookAxis());
 }
 
@@ -434,6 +482,23 @@ void GameApp::DrawScene()
         total_time += m_GpuTimer_Skybox.AverageTime();
 
         ImGui::Text("Total: %.3f ms", total_time * 1000);
+
+        if (m_CSManager.m_StaticShadowCache)
+        {
+            ImGui::Separator();
+            ImGui::Text("Static Shadow Cache");
+            static const char* invalidation_strs[] = {
+                "None",
+                "Empty",
+                "Settings",
+                "Light Direction",
+                "Out of Bounds",
+                "Resolution"
+            };
+            for (int i = 0; i < m_CSManager.m_CascadeLevels; ++i)
+                ImGui::Text("Cascade %d: %u Rebuilds (%s)", i + 1, m_StaticCacheRebuildCounts[i],
+                    invalidation_strs[static_cast<int>(m_StaticCacheLastInvalidations[i])]);
+        }
     }
     ImGui::End();
 
@@ -586,28 +651,61 @@ void GameApp::RenderShadowForAllCascades()
             ID3D11DepthStencilView* depthDSV = m_CSManager.GetDepthBufferDSV();
             ID3D11RenderTargetView* depthRTV = m_CSManager.GetCascadeRenderTargetView(cascadeIdx);
             m_pd3dImmediateContext->ClearRenderTargetView(depthRTV, clearColor);
-            m_pd3dImmediateContext->ClearDepthStencilView(depthDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
-            if (m_CSManager.m_ShadowType != ShadowType::ShadowType_CSM)
+            if (m_CSManager.m_ShadowType != ShadowType::ShadowType_CSM || m_CSManager.m_StaticShadowCache)
                 depthRTV = nullptr;
-            m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, depthDSV);
 
             XMMATRIX shadowProj = m_CSManager.GetShadowProjectionXM(cascadeIdx);
             m_ShadowEffect.SetProjMatrix(shadowProj);
 
             // 更新物体与投影立方体的裁剪
             BoundingOrientedBox obb = m_CSManager.GetShadowOBB(cascadeIdx);
-            obb.Transform(obb, m_pLightCamera->GetLocalToWorldMatrixXM());
-            m_Powerplant.CubeCulling(obb);
+            obb.Transform(obb, m_CSManager.GetShadowInvViewXM());
 
-            m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
-            
+            if (m_CSManager.m_StaticShadowCache)
+            {
+                // 缓存只保存深度，CSM的级联纹理在叠加动态物体后再由深度缓冲区生成
+                m_ShadowEffect.SetRenderDepthOnly();
+                // 静态物体只在缓存失效时重新绘制，之后每帧复制缓存
+                if (!m_CSManager.IsStaticCacheValid(cascadeIdx))
+                {
+                    ID3D11DepthStencilView* staticDSV = m_CSManager.GetStaticCascadeDepthStencilView(cascadeIdx);
+                    m_pd3dImmediateContext->ClearDepthStencilView(staticDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+                    m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, staticDSV);
+                    m_Powerplant.CubeCulling(obb);
+                    m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+
+                    ++m_StaticCacheRebuildCounts[cascadeIdx];
+                    m_StaticCacheLastInvalidations[cascadeIdx] = m_CSManager.GetStaticCacheInvalidation(cascadeIdx);
+                }
+                m_pd3dImmediateContext->OMSetRenderTargets(0, nullptr, nullptr);
+                m_CSManager.ApplyStaticCache(m_pd3dImmediateContext.Get(), cascadeIdx);
+                m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, depthDSV);
+            }
+            else
+            {
+                m_pd3dImmediateContext->ClearDepthStencilView(depthDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+                m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, depthDSV);
+                m_Powerplant.CubeCulling(obb);
+                m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+            }
+
+            // 立方体作为动态物体，每帧都要绘制
             m_Cube.CubeCulling(obb);
             m_Cube.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
 
             m_pd3dImmediateContext->OMSetRenderTargets(0, nullptr, nullptr);
 
+            if (m_CSManager.m_StaticShadowCache && m_CSManager.m_ShadowType == ShadowType::ShadowType_CSM)
+            {
+                m_ShadowEffect.RenderDepthToTexture(m_pd3dImmediateContext.Get(),
+                    m_CSManager.GetDepthBufferSRV(),
+                    m_CSManager.GetCascadeRenderTargetView(cascadeIdx),
+                    m_CSManager.GetShadowViewport());
+            }
+
             if (m_CSManager.m_ShadowType == ShadowType::ShadowType_VSM || m_CSManager.m_ShadowType >= ShadowType::ShadowType_EVSM2)
             {
+                float negExp = m_CSManager.GetEVSMNegExponent();
                 if (m_CSManager.m_ShadowType == ShadowType::ShadowType_VSM)
                     m_ShadowEffect.RenderVarianceShadow(m_pd3dImmediateContext.Get(),
                         m_CSManager.GetDepthBufferSRV(),
@@ -617,10 +715,22 @@ void GameApp::RenderShadowForAllCascades()
                     m_ShadowEffect.RenderExponentialVarianceShadow(m_pd3dImmediateContext.Get(),
                         m_CSManager.GetDepthBufferSRV(),
                         m_CSManager.GetCascadeRenderTargetView(cascadeIdx),
-                        m_CSManager.GetShadowViewport(), m_CSManager.m_PosExp,
-                        m_CSManager.m_ShadowType == ShadowType::ShadowType_EVSM4 ? &m_CSManager.m_NegExp : nullptr);
+                        m_CSManager.GetShadowViewport(), m_CSManager.GetEVSMPosExponent(),
+                        m_CSManager.m_ShadowType == ShadowType::ShadowType_EVSM4 ? &negExp : nullptr);
 
-                if (m_CSManager.m_BlurKernelSize > 1)
+                if (m_CSManager.IsSATEnabled())
+                {
+                    // 求和面积表代替高斯模糊，滤波宽度在采样时逐像素决定
+                    float scales[4];
+                    m_CSManager.GetSATScales(scales);
+                    m_ShadowEffect.GenerateSummedAreaTable(m_pd3dImmediateContext.Get(),
+                        m_CSManager.GetCascadesOutput(), (uint32_t)cascadeIdx,
+                        m_CSManager.GetSATTempUAV(), m_CSManager.GetSATTempOutput(),
+                        m_CSManager.GetSATUnorderedAccess(cascadeIdx),
+                        (uint32_t)m_CSManager.m_ShadowSize, m_CSManager.GetSATChannels(),
+                        scales, m_CSManager.GetSATFractionBits());
+                }
+                else if (m_CSManager.m_BlurKernelSize > 1)
                 {
                     m_ShadowEffect.GaussianBlurX(m_pd3dImmediateContext.Get(),
                         m_CSManager.GetCascadeOutput(cascadeIdx),
@@ -659,7 +769,7 @@ void GameApp::RenderShadowForAllCascades()
     }
 
     if ((m_CSManager.m_ShadowType == ShadowType::ShadowType_VSM || m_CSManager.m_ShadowType >= ShadowType::ShadowType_EVSM2) 
-        && m_CSManager.m_GenerateMips)
+        && m_CSManager.m_GenerateMips && !m_CSManager.IsSATEnabled())
     {
         m_pd3dImmediateContext->GenerateMips(m_CSManager.GetCascadesOutput());
     }
@@ -696,7 +806,7 @@ void GameApp::RenderForward()
         {
             BoundingOrientedBox bbox = m_CSManager.GetShadowOBB(
                 static_cast<int>(m_CSManager.m_SelectedCamera) - 2);
-            bbox.Transform(bbox, m_pLightCamera->GetLocalToWorldMatrixXM());
+            bbox.Transform(bbox, m_CSManager.GetShadowInvViewXM());
             m_Powerplant.CubeCulling(bbox);
             m_Cube.CubeCulling(bbox);
             viewport.Width = (float)std::min(m_ClientHeight, m_ClientWidth);
@@ -730,8 +840,20 @@ void GameApp::RenderForward()
         }
         m_ForwardEffect.SetCascadeOffsets(offsets);
         m_ForwardEffect.SetCascadeScales(scales);
-        m_ForwardEffect.SetShadowViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_ForwardEffect.SetShadowViewMatrix(m_CSManager.GetShadowViewXM());
         m_ForwardEffect.SetShadowTextureArray(m_CSManager.GetCascadesOutput());
+        // 使用SAT时EVSM的指数可能被限制，每帧与生成阴影时保持一致
+        m_ForwardEffect.SetPosExponent(m_CSManager.GetEVSMPosExponent());
+        m_ForwardEffect.SetNegExponent(m_CSManager.GetEVSMNegExponent());
+        m_ForwardEffect.SetSATEnabled(m_CSManager.IsSATEnabled());
+        if (m_CSManager.IsSATEnabled())
+        {
+            float scales[4];
+            m_CSManager.GetSATScales(scales);
+            m_ForwardEffect.SetSATParameters(scales, m_CSManager.GetSATFractionBits(),
+                m_CSManager.m_SATFilterWidth, m_CSManager.m_SATMaxFilterWidth);
+            m_ForwardEffect.SetSummedAreaTable(m_CSManager.GetSATOutput());
+        }
         // 注意：反向Z
         m_ForwardEffect.SetRenderDefault(true);
         m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ForwardEffect);
@@ -740,6 +862,7 @@ void GameApp::RenderForward()
         // 清除绑定
         m_pd3dImmediateContext->OMSetRenderTargets(0, nullptr, nullptr);
         m_ForwardEffect.SetShadowTextureArray(nullptr);
+        m_ForwardEffect.SetSummedAreaTable(nullptr);
         m_ForwardEffect.Apply(m_pd3dImmediateContext.Get());
     }
     m_GpuTimer_Lighting.Stop();
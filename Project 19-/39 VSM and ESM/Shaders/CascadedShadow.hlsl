@@ -30,6 +30,7 @@
 // 在使用更大的PCF核时，可以给高端PC使用基于偏导的深度偏移
 
 Texture2DArray g_ShadowMap : register(t10);
+Texture2DArray<uint4> g_ShadowSAT : register(t11);
 SamplerComparisonState g_SamShadowCmp : register(s10);
 SamplerState g_SamShadow : register(s11);
 
@@ -126,6 +127,68 @@ float CalculatePCFPercentLit(int currentCascadeIndex,
     return percentLit;
 }
 
+//--------------------------------------------------------------------------------------
+// SAT：求矩形范围内矩的平均值，开销与矩形大小无关
+// 滤波宽度由纹理坐标的偏导求出，并限制在[g_SATMinFilterWidth, g_SATMaxFilterWidth]之内
+//--------------------------------------------------------------------------------------
+float4 SampleSATMoments(float2 shadowTexCoord,
+                        float2 shadowTexCoordDDX,
+                        float2 shadowTexCoordDDY,
+                        int currentCascadeIndex)
+{
+    float shadowSize = 1.0f / g_TexelSize;
+    float2 filterSize = (abs(shadowTexCoordDDX) + abs(shadowTexCoordDDY)) * shadowSize;
+    float2 halfSize = 0.5f * clamp(filterSize, g_SATMinFilterWidth, g_SATMaxFilterWidth);
+    float2 center = shadowTexCoord * shadowSize;
+    float2 rectMin = clamp(center - halfSize, 0.0f, shadowSize);
+    float2 rectMax = clamp(center + halfSize, 0.0f, shadowSize);
+    
+    // 端点t处的前缀和由floor(t)与floor(t) + 1两处插值得到，位置i对应SAT中的i - 1，越界读取的结果为0
+    int2 i0 = int2(floor(rectMin));
+    int2 i1 = int2(floor(rectMax));
+    float2 f0 = rectMin - i0;
+    float2 f1 = rectMax - i1;
+    int4 xs = int4(i0.x, i0.x + 1, i1.x, i1.x + 1) - 1;
+    int4 ys = int4(i0.y, i0.y + 1, i1.y, i1.y + 1) - 1;
+    float4 wx = float4(1.0f - f0.x, f0.x, 1.0f - f1.x, f1.x);
+    float4 wy = float4(1.0f - f0.y, f0.y, 1.0f - f1.y, f1.y);
+    
+    uint4 prefixSums[4][4];
+    [unroll]
+    for (int j = 0; j < 4; ++j)
+    {
+        [unroll]
+        for (int i = 0; i < 4; ++i)
+        {
+            prefixSums[j][i] = g_ShadowSAT.Load(int4(xs[i], ys[j], currentCascadeIndex, 0));
+        }
+    }
+    
+    // 拆成16个整数矩形，每个矩形在定点数下相减，按有符号数解释后再转为浮点数，避免大数相减的舍入误差
+    float4 sum = 0.0f;
+    [unroll]
+    for (int a = 0; a < 2; ++a)
+    {
+        [unroll]
+        for (int b = 2; b < 4; ++b)
+        {
+            [unroll]
+            for (int c = 0; c < 2; ++c)
+            {
+                [unroll]
+                for (int d = 2; d < 4; ++d)
+                {
+                    uint4 box = prefixSums[d][b] - prefixSums[d][a] - prefixSums[c][b] + prefixSums[c][a];
+                    sum += wx[a] * wx[b] * wy[c] * wy[d] * (float4) asint(box);
+                }
+            }
+        }
+    }
+    
+    float2 rectSize = rectMax - rectMin;
+    return sum / (max(rectSize.x * rectSize.y, 1e-6f) * g_SATQuantScale) / g_SATScales;
+}
+
 //--------------------------------------------------------------------------------------
 // VSM：采样深度图并返回着色百分比
 //--------------------------------------------------------------------------------------
@@ -144,9 +207,17 @@ float CalculateVarianceShadow(float4 shadowTexCoord,
     shadowTexCoordDDX *= g_CascadeScale[currentCascadeIndex].xyz;
     shadowTexCoordDDY *= g_CascadeScale[currentCascadeIndex].xyz;
     
-    moments += g_ShadowMap.SampleGrad(g_SamShadow,
-                   float3(shadowTexCoord.xy, (float) currentCascadeIndex),
-                   shadowTexCoordDDX.xy, shadowTexCoordDDY.xy).xy;
+    [branch]
+    if (g_UseSAT)
+    {
+        moments = SampleSATMoments(shadowTexCoord.xy, shadowTexCoordDDX.xy, shadowTexCoordDDY.xy, currentCascadeIndex).xy;
+    }
+    else
+    {
+        moments += g_ShadowMap.SampleGrad(g_SamShadow,
+                       float3(shadowTexCoord.xy, (float) currentCascadeIndex),
+                       shadowTexCoordDDX.xy, shadowTexCoordDDY.xy).xy;
+    }
     
     percentLit = ChebyshevUpperBound(moments, shadowTexCoord.z, 0.00001f, g_LightBleedingReduction);
     
@@ -196,9 +267,17 @@ float CalculateExponentialVarianceShadow(float4 shadowTexCoord,
     shadowTexCoordDDX *= g_CascadeScale[currentCascadeIndex].xyz;
     shadowTexCoordDDY *= g_CascadeScale[currentCascadeIndex].xyz;
     
-    moments += g_ShadowMap.SampleGrad(g_SamShadow,
-                    float3(shadowTexCoord.xy, (float) currentCascadeIndex),
-                    shadowTexCoordDDX.xy, shadowTexCoordDDY.xy);
+    [branch]
+    if (g_UseSAT)
+    {
+        moments = SampleSATMoments(shadowTexCoord.xy, shadowTexCoordDDX.xy, shadowTexCoordDDY.xy, currentCascadeIndex);
+    }
+    else
+    {
+        moments += g_ShadowMap.SampleGrad(g_SamShadow,
+                        float3(shadowTexCoord.xy, (float) currentCascadeIndex),
+                        shadowTexCoordDDX.xy, shadowTexCoordDDY.xy);
+    }
     
     percentLit = ChebyshevUpperBound(moments.xy, expDepth.x, 0.00001f, g_LightBleedingReduction);
     if (SHADOW_TYPE == 4)
@@ -36,6 +36,12 @@ cbuffer CBCascadedShadow : register(b1)
     float  g_EvsmNegExp;                // EVSM的负指数项
     int    g_16BitShadow;               // 是否16位阴影格式
     
+    float4 g_SATScales;                 // SAT各通道映射到[0, 1]的缩放
+    float  g_SATQuantScale;             // SAT定点数的2^fractionBits
+    float  g_SATMinFilterWidth;         // SAT滤波的最小宽度(texel)
+    float  g_SATMaxFilterWidth;         // SAT滤波的最大宽度(texel)
+    int    g_UseSAT;                    // VSM/EVSM是否使用SAT滤波
+    
     float4 g_CascadeFrustumsEyeSpaceDepthsData[2]; // 不同子视锥体远平面的Z值，将级联分开
     // 这严格来说是不属于cbuffer内的，不应该在外部去访问
     static float g_CascadeFrustumsEyeSpaceDepths[8] = (float[8]) g_CascadeFrustumsEyeSpaceDepthsData;
@@ -0,0 +1,104 @@
+
+#ifndef SUMMED_AREA_TABLE_HLSL
+#define SUMMED_AREA_TABLE_HLSL
+
+// 2: VSM/EVSM2
+// 4: EVSM4
+#ifndef SAT_CHANNELS
+#define SAT_CHANNELS 2
+#endif
+
+#define SAT_GROUP_SIZE 256
+
+#if SAT_CHANNELS == 4
+typedef uint4 SATValue;
+#else
+typedef uint2 SATValue;
+#endif
+
+cbuffer CBSummedAreaTable : register(b2)
+{
+    float4 g_SATScales;         // 各通道映射到[0, 1]的缩放
+    float  g_SATQuantScale;     // 2^fractionBits
+    uint   g_SATSize;           // 阴影图宽高，需要为SAT_GROUP_SIZE的倍数
+    uint   g_SATSlice;          // 读取的级联索引
+    uint   g_SATPad;
+}
+
+Texture2DArray<float4> g_SATMoments : register(t1);
+Texture2D<SATValue> g_SATRows : register(t2);
+RWTexture2D<SATValue> g_SATRowsOutput : register(u0);
+RWTexture2DArray<SATValue> g_SATOutput : register(u1);
+
+groupshared SATValue s_SATScan[2][SAT_GROUP_SIZE];
+
+// 映射到[0, 1]后四舍五入为定点数，与SummedAreaTable::Build一致
+SATValue QuantizeMoments(float4 moments)
+{
+    float4 value = saturate(moments * g_SATScales) * g_SATQuantScale + 0.5f;
+#if SAT_CHANNELS == 4
+    return (uint4) value;
+#else
+    return (uint2) value.xy;
+#endif
+}
+
+// 组内的包含式前缀和(Hillis-Steele)。无符号整数的加法按2^32回绕且满足结合律，
+// 因此不论求和顺序如何，结果都与CPU端逐个累加完全一致
+SATValue GroupInclusiveScan(SATValue value, uint threadIndex, out SATValue total)
+{
+    s_SATScan[0][threadIndex] = value;
+    GroupMemoryBarrierWithGroupSync();
+
+    uint src = 0;
+    [unroll]
+    for (uint offset = 1; offset < SAT_GROUP_SIZE; offset <<= 1)
+    {
+        SATValue sum = s_SATScan[src][threadIndex];
+        if (threadIndex >= offset)
+            sum += s_SATScan[src][threadIndex - offset];
+        s_SATScan[1 - src][threadIndex] = sum;
+        src = 1 - src;
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    SATValue result = s_SATScan[src][threadIndex];
+    total = s_SATScan[src][SAT_GROUP_SIZE - 1];
+    // 下一段写入前确保所有线程都已读取
+    GroupMemoryBarrierWithGroupSync();
+    return result;
+}
+
+// 每个线程组处理一行，逐段扫描并加上前面各段的和
+[numthreads(SAT_GROUP_SIZE, 1, 1)]
+void SATHorizontalCS(uint3 groupID : SV_GroupID,
+                     uint3 groupThreadID : SV_GroupThreadID)
+{
+    SATValue carry = 0;
+    for (uint base = 0; base < g_SATSize; base += SAT_GROUP_SIZE)
+    {
+        uint2 coord = uint2(base + groupThreadID.x, groupID.x);
+        SATValue total;
+        SATValue sum = GroupInclusiveScan(QuantizeMoments(g_SATMoments[uint3(coord, g_SATSlice)]), groupThreadID.x, total);
+        g_SATRowsOutput[coord] = sum + carry;
+        carry += total;
+    }
+}
+
+// 每个线程组处理一列，结果写入该级联的SAT
+[numthreads(SAT_GROUP_SIZE, 1, 1)]
+void SATVerticalCS(uint3 groupID : SV_GroupID,
+                   uint3 groupThreadID : SV_GroupThreadID)
+{
+    SATValue carry = 0;
+    for (uint base = 0; base < g_SATSize; base += SAT_GROUP_SIZE)
+    {
+        uint2 coord = uint2(groupID.x, base + groupThreadID.x);
+        SATValue total;
+        SATValue sum = GroupInclusiveScan(g_SATRows[coord], groupThreadID.x, total);
+        g_SATOutput[uint3(coord, 0)] = sum + carry;
+        carry += total;
+    }
+}
+
+#endif
@@ -232,6 +232,35 @@ bool ShadowEffect::InitAll(ID3D11Device* device)
         passName += str;
         HR(pImpl->m_pEffectHelper->AddEffectPass(passName, device, &passDesc));
     }
+
+    // ******************
+    // 创建求和面积表的计算着色器与通道
+    //
+    const char* sat_channel_strs[] = { "2", "4" };
+    defines[0].Name = "SAT_CHANNELS";
+    for (const char* str : sat_channel_strs)
+    {
+        defines[0].Definition = str;
+        EffectPassDesc satPassDesc;
+
+        psName = "SATHorizontalCS_";
+        psName += str;
+        HR(pImpl->m_pEffectHelper->CreateShaderFromFile(psName, L"Shaders\\SummedAreaTable.hlsl",
+            device, "SATHorizontalCS", "cs_5_0", defines));
+        satPassDesc.nameCS = psName;
+        passName = "SATHorizontal_";
+        passName += str;
+        HR(pImpl->m_pEffectHelper->AddEffectPass(passName, device, &satPassDesc));
+
+        psName = "SATVerticalCS_";
+        psName += str;
+        HR(pImpl->m_pEffectHelper->CreateShaderFromFile(psName, L"Shaders\\SummedAreaTable.hlsl",
+            device, "SATVerticalCS", "cs_5_0", defines));
+        satPassDesc.nameCS = psName;
+        passName = "SATVertical_";
+        passName += str;
+        HR(pImpl->m_pEffectHelper->AddEffectPass(passName, device, &satPassDesc));
+    }
     
     pImpl->m_pEffectHelper->SetSamplerStateByName("g_SamplerPointClamp", RenderStates::SSPointClamp.Get());
 
@@ -455,6 +484,55 @@ void ShadowEffect::LogGaussianBlur(
     deviceContext->OMSetRenderTargets(0, nullptr, nullptr);
 }
 
+void ShadowEffect::GenerateSummedAreaTable(
+    ID3D11DeviceContext* deviceContext,
+    ID3D11ShaderResourceView* moments,
+    uint32_t cascadeIndex,
+    ID3D11UnorderedAccessView* rowTempUAV,
+    ID3D11ShaderResourceView* rowTempSRV,
+    ID3D11UnorderedAccessView* output,
+    uint32_t size,
+    uint32_t channels,
+    const float scales[4],
+    uint32_t fractionBits)
+{
+    // 与SummedAreaTable.hlsl中的SAT_GROUP_SIZE一致，每个线程组处理一行或一列
+    static const uint32_t s_SATGroupSize = 256;
+    std::string suffix = channels == 4 ? "_4" : "_2";
+
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATScales")->SetFloatVector(4, scales);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATQuantScale")->SetFloat((float)(1u << fractionBits));
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATSize")->SetUInt(size);
+    pImpl->m_pEffectHelper->GetConstantBufferVariable("g_SATSlice")->SetUInt(cascadeIndex);
+
+    // 先按行量化并求前缀和
+    auto pPass = pImpl->m_pEffectHelper->GetEffectPass("SATHorizontal" + suffix);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_SATMoments", moments);
+    pImpl->m_pEffectHelper->SetUnorderedAccessByName("g_SATRowsOutput", rowTempUAV, 0);
+    pPass->Apply(deviceContext);
+    pPass->Dispatch(deviceContext, size * s_SATGroupSize);
+
+    ID3D11ShaderResourceView* nullSRVs[2] = {};
+    ID3D11UnorderedAccessView* nullUAVs[2] = {};
+    deviceContext->CSSetShaderResources(1, 2, nullSRVs);
+    deviceContext->CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+
+    // 再按列求前缀和
+    pPass = pImpl->m_pEffectHelper->GetEffectPass("SATVertical" + suffix);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_SATRows", rowTempSRV);
+    pImpl->m_pEffectHelper->SetUnorderedAccessByName("g_SATOutput", output, 0);
+    pPass->Apply(deviceContext);
+    pPass->Dispatch(deviceContext, size * s_SATGroupSize);
+
+    // 清除绑定
+    deviceContext->CSSetShaderResources(1, 2, nullSRVs);
+    deviceContext->CSSetUnorderedAccessViews(0, 2, nullUAVs, nullptr);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_SATMoments", nullptr);
+    pImpl->m_pEffectHelper->SetShaderResourceByName("g_SATRows", nullptr);
+    pImpl->m_pEffectHelper->SetUnorderedAccessByName("g_SATRowsOutput", nullptr);
+    pImpl->m_pEffectHelper->SetUnorderedAccessByName("g_SATOutput", nullptr);
+}
+
 void XM_CALLCONV ShadowEffect::SetWorldMatrix(DirectX::FXMMATRIX W)
 {
     XMStoreFloat4x4(&pImpl->m_World, W);
@@ -17,6 +17,7 @@
 #include <memory>
 #include <CameraController.h>
 #include <Texture2D.h>
+#include <CascadeMath.h>
 
 enum class ShadowType
 {
@@ -61,6 +62,13 @@ enum class FitProjection
     FitProjection_ToScene
 };
 
+enum class CascadePartition
+{
+    CascadePartition_Manual,            // 使用m_CascadePartitionsPercentage
+    CascadePartition_Practical,         // 在摄像机近/远平面之间进行实用划分(PSSM)
+    CascadePartition_SDSM               // 在可见像素的深度范围内进行实用划分
+};
+
 class CascadedShadowManager
 {
 public:
@@ -95,6 +103,32 @@ public:
     void GetCascadePartitions(float output[8]) const { memcpy_s(output, sizeof m_CascadePartitionsFrustum, m_CascadePartitionsFrustum, sizeof m_CascadePartitionsFrustum); }
     DirectX::XMMATRIX GetShadowProjectionXM(size_t cascadeIndex) const { return XMLoadFloat4x4(&m_ShadowProj[cascadeIndex]); }
     DirectX::BoundingBox GetShadowAABB(size_t cascadeIndex) const { return m_ShadowProjBoundingBox[cascadeIndex]; }
+    // SDSM：提供可见像素的视空间深度范围，通常来自几帧前深度缓冲区的归约结果
+    void SetVisibleDepthRange(float minZ, float maxZ);
+    // SDSM：由CascadeMath::AccumulateDepthHistogram生成的直方图求可见深度范围，两端各忽略percentile比例的样本
+    bool SetVisibleDepthHistogram(const uint32_t histogram[], uint32_t binCount, float minZ, float maxZ, float percentile = 0.0f);
+    bool GetVisibleDepthRange(float& minZ, float& maxZ) const { minZ = m_VisibleDepthMin; maxZ = m_VisibleDepthMax; return m_HasVisibleDepth; }
+    // 第一个级联起点占视锥体的比例，仅SDSM下大于0
+    float GetCascadeStartPercentage() const { return m_CascadeStartPercentage; }
+
+    // 摄像机、光源、场景与级联配置都不变时UpdateFrame会沿用上一次的结果，此时返回false
+    bool IsShadowProjectionChanged() const { return m_ShadowProjChanged; }
+    // 绘制与采样阴影时使用的光照视图矩阵。启用静态阴影缓存时，光照方向的变化在容差内会沿用生成缓存时的矩阵
+    DirectX::XMMATRIX GetShadowViewXM() const { return XMLoadFloat4x4(&m_ShadowView); }
+    DirectX::XMMATRIX GetShadowInvViewXM() const { return XMLoadFloat4x4(&m_ShadowInvView); }
+
+    //
+    // 静态阴影缓存
+    //
+
+    ID3D11DepthStencilView* GetStaticCascadeDepthStencilView(size_t cascadeIndex) const { return m_pStaticCSMDepthArray->GetDepthStencil(cascadeIndex); }
+    // 最近一次UpdateFrame后该级联的缓存需要重新绘制的原因
+    ShadowCacheInvalidation GetStaticCacheInvalidation(size_t cascadeIndex) const { return m_StaticCacheInvalidation[cascadeIndex]; }
+    bool IsStaticCacheValid(size_t cascadeIndex) const { return m_StaticCacheInvalidation[cascadeIndex] == ShadowCacheInvalidation::ShadowCacheInvalidation_None; }
+    // 把该级联的静态缓存复制到深度缓冲区，之后再叠加绘制动态物体
+    void ApplyStaticCache(ID3D11DeviceContext* deviceContext, size_t cascadeIndex);
+    // 静态物体发生变化时调用，下一次UpdateFrame会要求重新绘制所有级联的缓存
+    void InvalidateStaticCache();
     DirectX::BoundingOrientedBox GetShadowOBB(size_t cascadeIndex) const {
         DirectX::BoundingOrientedBox obb;
         DirectX::BoundingOrientedBox::CreateFromBoundingBox(obb, GetShadowAABB(cascadeIndex));
@@ -135,14 +169,60 @@ public:
     FitProjection       m_SelectedCascadesFit = FitProjection::FitProjection_ToCascade;
     FitNearFar          m_SelectedNearFarFit = FitNearFar::FitNearFar_SceneAABB_Intersection;
     CascadeSelection    m_SelectedCascadeSelection = CascadeSelection::CascadeSelection_Map;
+
+    // 非手动划分时，UpdateFrame会改写m_CascadePartitionsPercentage
+    CascadePartition    m_SelectedCascadePartition = CascadePartition::CascadePartition_Manual;
+    float               m_PSSMLambda = 0.8f;                // 0为均匀划分，1为对数划分
+
+    bool        m_StaticShadowCache = false;            // 是否缓存静态物体的阴影，修改后需要调用InitResource
+    float       m_StaticCacheGuardBand = 0.1f;          // 缓存向四周额外覆盖的比例
+    float       m_LightDirectionTolerance = 0.25f;      // 沿用缓存时允许光照方向变化的角度
     
 private:
-    void XM_CALLCONV ComputeNearAndFar(float& outNearPlane, float& outFarPlane,
-        DirectX::FXMVECTOR lightCameraOrthographicMinVec,
-        DirectX::FXMVECTOR lightCameraOrthographicMaxVec,
-        DirectX::XMVECTOR pointsInCameraView[]);
+    void UpdateCascadePartitions(float nearZ, float farZ);
+
+    // UpdateFrame的全部输入，只含4字节的成员以便逐字节比较
+    struct FrameInputs
+    {
+        DirectX::XMFLOAT4X4 viewerView;
+        DirectX::XMFLOAT4X4 viewerProj;
+        DirectX::XMFLOAT4X4 lightView;
+        DirectX::XMFLOAT3 sceneCenter;
+        DirectX::XMFLOAT3 sceneExtents;
+        float viewerNearZ;
+        float viewerFarZ;
+        float cascadeStart;
+        float cascadePartitions[8];
+        int cascadeLevels;
+        int shadowSize;
+        int kernelSize;
+        int fixedSizeFrustumAABB;
+        int moveLightTexelSize;
+        int cascadesFit;
+        int nearFarFit;
+        int staticShadowCache;
+        float staticCacheGuardBand;
+        float lightDirectionTolerance;
+    };
 
 private:
+    FrameInputs                     m_FrameInputs{};                    // 上一次计算阴影投影时的输入
+    bool                            m_HasFrameInputs = false;
+    bool                            m_ShadowProjChanged = false;        // 最近一次UpdateFrame是否重新计算了阴影投影
+
+    DirectX::XMFLOAT4X4             m_ShadowView{};
+    DirectX::XMFLOAT4X4             m_ShadowInvView{};
+    DirectX::XMFLOAT3               m_ShadowLightDir{};                 // m_ShadowView对应的光照方向
+    bool                            m_HasShadowView = false;
+
+    ShadowCacheRegion               m_StaticCacheRegions[8]{};          // 各级联的缓存覆盖的光照空间范围
+    bool                            m_StaticCacheValid[8]{};
+    ShadowCacheInvalidation         m_StaticCacheInvalidation[8]{};
+
+    float                           m_CascadeStartPercentage = 0.0f;
+    float                           m_VisibleDepthMin = 0.0f;
+    float                           m_VisibleDepthMax = 0.0f;
+    bool                            m_HasVisibleDepth = false;
 
     float	                        m_CascadePartitionsFrustum[8]{};    // 级联远平面Z值
     DirectX::XMFLOAT4X4             m_ShadowProj[8]{};                  // 阴影正交矩阵
@@ -152,6 +232,7 @@ private:
     std::unique_ptr<Texture2DArray> m_pCSMTextureArray;
     std::unique_ptr<Texture2D> m_pCSMTempTexture;
     std::unique_ptr<Depth2D>   m_pCSMDepthBuffer;
+    std::unique_ptr<Depth2DArray> m_pStaticCSMDepthArray;               // 只含静态物体的深度缓存
 };
 
 #endif
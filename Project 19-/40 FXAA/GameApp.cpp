@@ -168,6 +168,17 @@ void GameApp::UpdateScene(float dt)
             need_gpu_timer_reset = true;
         }
 
+        if (ImGui::Checkbox("Static Shadow Cache", &m_CSManager.m_StaticShadowCache))
+        {
+            m_CSManager.InitResource(m_pd3dDevice.Get());
+            need_gpu_timer_reset = true;
+        }
+        if (m_CSManager.m_StaticShadowCache)
+        {
+            ImGui::SliderFloat("Guard Band", &m_CSManager.m_StaticCacheGuardBand, 0.0f, 0.5f);
+            ImGui::SliderFloat("Light Tolerance", &m_CSManager.m_LightDirectionTolerance, 0.0f, 2.0f, "%.2f deg");
+        }
+
         ImGui::PopItemWidth();
     }
     ImGui::End();
@@ -205,15 +216,14 @@ void GameApp::UpdateScene(float dt)
         ShadowProjRZ.r[2] *= g_XMNegateZ.v;
         ShadowProjRZ.r[3] = XMVectorSetZ(ShadowProjRZ.r[3], 1.0f - XMVectorGetZ(ShadowProjRZ.r[3]));
         
-        m_ForwardEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_ForwardEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
         m_ForwardEffect.SetProjMatrix(ShadowProjRZ);
-        m_SkyboxEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_SkyboxEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
         m_SkyboxEffect.SetProjMatrix(ShadowProjRZ);
     }
         
-    m_ShadowEffect.SetViewMatrix(m_pLightCamera->GetViewMatrixXM());
-
     m_CSManager.UpdateFrame(*m_pViewerCamera, *m_pLightCamera, m_Powerplant.GetModel()->boundingbox);
+    m_ShadowEffect.SetViewMatrix(m_CSManager.GetShadowViewXM());
     m_ForwardEffect.SetLightDir(m_pLightCamera->GetLookAxis());
 }
 
@@ -268,6 +278,23 @@ void GameApp::DrawScene()
         }
 
         ImGui::Text("Total: %.3f ms", total_time * 1000);
+
+        if (m_CSManager.m_StaticShadowCache)
+        {
+            ImGui::Separator();
+            ImGui::Text("Static Shadow Cache");
+            static const char* invalidation_strs[] = {
+                "None",
+                "Empty",
+                "Settings",
+                "Light Direction",
+                "Out of Bounds",
+                "Resolution"
+            };
+            for (int i = 0; i < m_CSManager.m_CascadeLevels; ++i)
+                ImGui::Text("Cascade %d: %u Rebuilds (%s)", i + 1, m_StaticCacheRebuildCounts[i],
+                    invalidation_strs[static_cast<int>(m_StaticCacheLastInvalidations[i])]);
+        }
     }
     ImGui::End();
 
@@ -389,25 +416,57 @@ void GameApp::RenderShadowForAllCascades()
             ID3D11DepthStencilView* depthDSV = m_CSManager.GetDepthBufferDSV();
             ID3D11RenderTargetView* depthRTV = m_CSManager.GetCascadeRenderTargetView(cascadeIdx);
             m_pd3dImmediateContext->ClearRenderTargetView(depthRTV, clearColor);
-            m_pd3dImmediateContext->ClearDepthStencilView(depthDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
-            if (m_CSManager.m_ShadowType != ShadowType::ShadowType_CSM)
+            if (m_CSManager.m_ShadowType != ShadowType::ShadowType_CSM || m_CSManager.m_StaticShadowCache)
                 depthRTV = nullptr;
-            m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, depthDSV);
 
             XMMATRIX shadowProj = m_CSManager.GetShadowProjectionXM(cascadeIdx);
             m_ShadowEffect.SetProjMatrix(shadowProj);
 
             // 更新物体与投影立方体的裁剪
             BoundingOrientedBox obb = m_CSManager.GetShadowOBB(cascadeIdx);
-            obb.Transform(obb, m_pLightCamera->GetLocalToWorldMatrixXM());
-            m_Powerplant.CubeCulling(obb);
+            obb.Transform(obb, m_CSManager.GetShadowInvViewXM());
 
-            m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
-            
+            if (m_CSManager.m_StaticShadowCache)
+            {
+                // 缓存只保存深度，CSM的级联纹理在叠加动态物体后再由深度缓冲区生成
+                m_ShadowEffect.SetRenderDepthOnly();
+                // 静态物体只在缓存失效时重新绘制，之后每帧复制缓存
+                if (!m_CSManager.IsStaticCacheValid(cascadeIdx))
+                {
+                    ID3D11DepthStencilView* staticDSV = m_CSManager.GetStaticCascadeDepthStencilView(cascadeIdx);
+                    m_pd3dImmediateContext->ClearDepthStencilView(staticDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+                    m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, staticDSV);
+                    m_Powerplant.CubeCulling(obb);
+                    m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+
+                    ++m_StaticCacheRebuildCounts[cascadeIdx];
+                    m_StaticCacheLastInvalidations[cascadeIdx] = m_CSManager.GetStaticCacheInvalidation(cascadeIdx);
+                }
+                m_pd3dImmediateContext->OMSetRenderTargets(0, nullptr, nullptr);
+                m_CSManager.ApplyStaticCache(m_pd3dImmediateContext.Get(), cascadeIdx);
+                m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, depthDSV);
+            }
+            else
+            {
+                m_pd3dImmediateContext->ClearDepthStencilView(depthDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+                m_pd3dImmediateContext->OMSetRenderTargets(1, &depthRTV, depthDSV);
+                m_Powerplant.CubeCulling(obb);
+                m_Powerplant.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
+            }
+
+            // 立方体作为动态物体，每帧都要绘制
             m_Cube.CubeCulling(obb);
             m_Cube.Draw(m_pd3dImmediateContext.Get(), m_ShadowEffect);
 
             m_pd3dImmediateContext->OMSetRenderTargets(0, nullptr, nullptr);
+
+            if (m_CSManager.m_StaticShadowCache && m_CSManager.m_ShadowType == ShadowType::ShadowType_CSM)
+            {
+                m_ShadowEffect.RenderDepthToTexture(m_pd3dImmediateContext.Get(),
+                    m_CSManager.GetDepthBufferSRV(),
+                    m_CSManager.GetCascadeRenderTargetView(cascadeIdx),
+                    m_CSManager.GetShadowViewport());
+            }
         }
     }
 
@@ -457,7 +516,7 @@ void GameApp::RenderForward()
         }
         m_ForwardEffect.SetCascadeOffsets(offsets);
         m_ForwardEffect.SetCascadeScales(scales);
-        m_ForwardEffect.SetShadowViewMatrix(m_pLightCamera->GetViewMatrixXM());
+        m_ForwardEffect.SetShadowViewMatrix(m_CSManager.GetShadowViewXM());
         m_ForwardEffect.SetShadowTextureArray(m_CSManager.GetCascadesOutput());
         // 注意：反向Z
         m_ForwardEffect.SetRenderDefault(m_pd3dImmediateContext.Get(), true);
@@ -56,6 +56,8 @@ private:
 
     // 阴影
     CascadedShadowManager m_CSManager;
+    uint32_t m_StaticCacheRebuildCounts[8]{};                      // 各级联静态阴影缓存的重新绘制次数
+    ShadowCacheInvalidation m_StaticCacheLastInvalidations[8]{};   // 各级联最近一次重新绘制的原因
 
     // 各种资源
     TextureManager m_TextureManager;                                // 纹理读取管理
@@ -0,0 +1,595 @@
+#include "BCEncoder.h"
+#include "ThreadPool.h"
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    const int s_BlockPixels = 16;
+
+    int RefineIterations(BCEncoder::Quality quality)
+    {
+        switch (quality)
+        {
+        case BCEncoder::Quality::Normal: return 1;
+        case BCEncoder::Quality::High: return 3;
+        default: return 0;
+        }
+    }
+
+    // 读取4x4块，超出边界的像素钳位到边缘，颜色范围[0, 255]
+    void LoadBlock(const Image::Level& level, uint32_t bx, uint32_t by, XMVECTOR pixels[s_BlockPixels])
+    {
+        for (uint32_t y = 0; y < 4; ++y)
+        {
+            uint32_t sy = (std::min)(by * 4 + y, level.height - 1);
+            const uint8_t* pRow = level.pixels.data() + (size_t)sy * level.rowPitch;
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                uint32_t sx = (std::min)(bx * 4 + x, level.width - 1);
+                pixels[y * 4 + x] = XMLoadUByte4(reinterpret_cast<const XMUBYTE4*>(pRow) + sx);
+            }
+        }
+    }
+
+    //
+    // 端点拟合
+    //
+
+    // 求点集(仅mask中的通道)的均值与主成分方向，点集退化时axis为0
+    void ComputePrincipalAxis(const XMVECTOR* pixels, FXMVECTOR mask, XMVECTOR& mean, XMVECTOR& axis)
+    {
+        XMVECTOR minColor = g_XMFltMax, maxColor = XMVectorNegate(g_XMFltMax);
+        mean = XMVectorZero();
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            XMVECTOR p = XMVectorAndInt(pixels[i], mask);
+            mean = XMVectorAdd(mean, p);
+            minColor = XMVectorMin(minColor, p);
+            maxColor = XMVectorMax(maxColor, p);
+        }
+        mean = XMVectorScale(mean, 1.0f / s_BlockPixels);
+
+        XMMATRIX cov(XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero());
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            XMVECTOR d = XMVectorSubtract(XMVectorAndInt(pixels[i], mask), mean);
+            cov.r[0] = XMVectorMultiplyAdd(d, XMVectorSplatX(d), cov.r[0]);
+            cov.r[1] = XMVectorMultiplyAdd(d, XMVectorSplatY(d), cov.r[1]);
+            cov.r[2] = XMVectorMultiplyAdd(d, XMVectorSplatZ(d), cov.r[2]);
+            cov.r[3] = XMVectorMultiplyAdd(d, XMVectorSplatW(d), cov.r[3]);
+        }
+
+        // 以包围盒对角线为初值做幂迭代，协方差矩阵对称，行向量右乘即为矩阵乘向量
+        axis = XMVectorSubtract(maxColor, minColor);
+        if (XMVectorGetX(XMVector4LengthSq(axis)) < 1e-6f)
+        {
+            axis = XMVectorZero();
+            return;
+        }
+        for (int iter = 0; iter < 8; ++iter)
+        {
+            XMVECTOR next = XMVector4Transform(axis, cov);
+            if (XMVectorGetX(XMVector4LengthSq(next)) < 1e-12f)
+                break;
+            axis = XMVector4Normalize(next);
+        }
+        axis = XMVector4Normalize(axis);
+    }
+
+    // 将点集投影到主轴上，取投影的最小/最大值作为端点
+    void ComputeAxisEndpoints(const XMVECTOR* pixels, FXMVECTOR mask, XMVECTOR& e0, XMVECTOR& e1)
+    {
+        XMVECTOR mean, axis;
+        ComputePrincipalAxis(pixels, mask, mean, axis);
+        float tMin = 0.0f, tMax = 0.0f;
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(XMVectorAndInt(pixels[i], mask), mean), axis));
+            tMin = (std::min)(tMin, t);
+            tMax = (std::max)(tMax, t);
+        }
+        XMVECTOR maxValue = XMVectorReplicate(255.0f);
+        e0 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(tMin), mean), XMVectorZero(), maxValue);
+        e1 = XMVectorClamp(XMVectorMultiplyAdd(axis, XMVectorReplicate(tMax), mean), XMVectorZero(), maxValue);
+    }
+
+    // 已知每个像素在两端点间的插值系数t(像素 = (1 - t) * e0 + t * e1)，求最小二乘意义下的端点
+    bool LeastSquaresEndpoints(const XMVECTOR* pixels, const float* t, FXMVECTOR mask, XMVECTOR& e0, XMVECTOR& e1)
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        XMVECTOR ax = XMVectorZero(), bx = XMVectorZero();
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            float a = 1.0f - t[i], b = t[i];
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            XMVECTOR p = XMVectorAndInt(pixels[i], mask);
+            ax = XMVectorMultiplyAdd(p, XMVectorReplicate(a), ax);
+            bx = XMVectorMultiplyAdd(p, XMVectorReplicate(b), bx);
+        }
+        float det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+            return false;
+        float invDet = 1.0f / det;
+        XMVECTOR maxValue = XMVectorReplicate(255.0f);
+        e0 = XMVectorScale(XMVectorSubtract(XMVectorScale(ax, bb), XMVectorScale(bx, ab)), invDet);
+        e1 = XMVectorScale(XMVectorSubtract(XMVectorScale(bx, aa), XMVectorScale(ax, ab)), invDet);
+        e0 = XMVectorClamp(e0, XMVectorZero(), maxValue);
+        e1 = XMVectorClamp(e1, XMVectorZero(), maxValue);
+        return true;
+    }
+
+    // 为每个像素选择调色板中误差最小的项，返回总的平方误差
+    float SelectIndices(const XMVECTOR* pixels, const XMVECTOR* palette, int paletteSize, FXMVECTOR mask, uint8_t* indices)
+    {
+        float totalError = 0.0f;
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            XMVECTOR p = XMVectorAndInt(pixels[i], mask);
+            float bestError = FLT_MAX;
+            for (int k = 0; k < paletteSize; ++k)
+            {
+                float error = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(p, palette[k])));
+                if (error < bestError)
+                {
+                    bestError = error;
+                    indices[i] = static_cast<uint8_t>(k);
+                }
+            }
+            totalError += bestError;
+        }
+        return totalError;
+    }
+
+    //
+    // BC1
+    //
+
+    uint16_t QuantizeRGB565(FXMVECTOR color)
+    {
+        XMFLOAT4 c;
+        XMStoreFloat4(&c, XMVectorClamp(color, XMVectorZero(), XMVectorReplicate(255.0f)));
+        uint32_t r = static_cast<uint32_t>(c.x * (31.0f / 255.0f) + 0.5f);
+        uint32_t g = static_cast<uint32_t>(c.y * (63.0f / 255.0f) + 0.5f);
+        uint32_t b = static_cast<uint32_t>(c.z * (31.0f / 255.0f) + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    XMVECTOR ExpandRGB565(uint16_t color)
+    {
+        uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+        return XMVectorSet(static_cast<float>((r << 3) | (r >> 2)),
+            static_cast<float>((g << 2) | (g >> 4)),
+            static_cast<float>((b << 3) | (b >> 2)), 0.0f);
+    }
+
+    struct ColorBlock
+    {
+        uint16_t c0 = 0, c1 = 0;
+        uint8_t indices[s_BlockPixels] = {};
+        float error = FLT_MAX;
+    };
+
+    // BC1索引对应的端点插值系数(4色模式)
+    const float s_BC1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    // 使用4色模式(c0 > c1)评估一对端点，BC3的颜色部分也只能使用4色模式
+    ColorBlock EvaluateColorEndpoints(const XMVECTOR* pixels, FXMVECTOR e0, FXMVECTOR e1, FXMVECTOR mask)
+    {
+        ColorBlock block;
+        block.c0 = QuantizeRGB565(e0);
+        block.c1 = QuantizeRGB565(e1);
+        if (block.c0 < block.c1)
+            std::swap(block.c0, block.c1);
+
+        XMVECTOR palette[4];
+        palette[0] = ExpandRGB565(block.c0);
+        palette[1] = ExpandRGB565(block.c1);
+        palette[2] = XMVectorLerp(palette[0], palette[1], s_BC1Weights[2]);
+        palette[3] = XMVectorLerp(palette[0], palette[1], s_BC1Weights[3]);
+        // 两端点相同时只使用索引0，避免解码端进入3色模式
+        block.error = SelectIndices(pixels, palette, block.c0 == block.c1 ? 1 : 4, mask, block.indices);
+        return block;
+    }
+
+    void EncodeColorBlock(const XMVECTOR* pixels, BCEncoder::Quality quality, uint8_t* pOut)
+    {
+        XMVECTOR mask = XMVectorSelectControl(1, 1, 1, 0);
+        XMVECTOR e0, e1;
+        ComputeAxisEndpoints(pixels, mask, e0, e1);
+        ColorBlock best = EvaluateColorEndpoints(pixels, e0, e1, mask);
+
+        int iterations = RefineIterations(quality);
+        for (int iter = 0; iter < iterations && best.error > 0.0f; ++iter)
+        {
+            float t[s_BlockPixels];
+            for (int i = 0; i < s_BlockPixels; ++i)
+                t[i] = s_BC1Weights[best.indices[i]];
+            if (!LeastSquaresEndpoints(pixels, t, mask, e0, e1))
+                break;
+            ColorBlock block = EvaluateColorEndpoints(pixels, e0, e1, mask);
+            if (block.error >= best.error)
+                break;
+            best = block;
+        }
+
+        uint32_t bits = 0;
+        for (int i = 0; i < s_BlockPixels; ++i)
+            bits |= static_cast<uint32_t>(best.indices[i]) << (2 * i);
+        memcpy(pOut, &best.c0, 2);
+        memcpy(pOut + 2, &best.c1, 2);
+        memcpy(pOut + 4, &bits, 4);
+    }
+
+    //
+    // BC4
+    //
+
+    struct AlphaBlock
+    {
+        uint8_t e0 = 0, e1 = 0;
+        uint8_t indices[s_BlockPixels] = {};
+        float error = FLT_MAX;
+    };
+
+    // e0 > e1时为8值模式，否则为6值模式(索引6、7固定为0和255)
+    AlphaBlock EvaluateAlphaEndpoints(const float* values, uint8_t e0, uint8_t e1)
+    {
+        AlphaBlock block;
+        block.e0 = e0;
+        block.e1 = e1;
+        float palette[8];
+        palette[0] = e0;
+        palette[1] = e1;
+        if (e0 > e1)
+        {
+            for (int k = 2; k < 8; ++k)
+                palette[k] = ((8 - k) * e0 + (k - 1) * e1) / 7.0f;
+        }
+        else
+        {
+            for (int k = 2; k < 6; ++k)
+                palette[k] = ((6 - k) * e0 + (k - 1) * e1) / 5.0f;
+            palette[6] = 0.0f;
+            palette[7] = 255.0f;
+        }
+
+        block.error = 0.0f;
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            float bestError = FLT_MAX;
+            for (int k = 0; k < 8; ++k)
+            {
+                float d = values[i] - palette[k];
+                if (d * d < bestError)
+                {
+                    bestError = d * d;
+                    block.indices[i] = static_cast<uint8_t>(k);
+                }
+            }
+            block.error += bestError;
+        }
+        return block;
+    }
+
+    uint8_t RoundToByte(float value)
+    {
+        return static_cast<uint8_t>((std::min)((std::max)(value, 0.0f), 255.0f) + 0.5f);
+    }
+
+    void EncodeAlphaBlock(const float* values, BCEncoder::Quality quality, uint8_t* pOut)
+    {
+        float minValue = 255.0f, maxValue = 0.0f;
+        for (int i = 0; i < s_BlockPixels; ++i)
+        {
+            minValue = (std::min)(minValue, values[i]);
+            maxValue = (std::max)(maxValue, values[i]);
+        }
+        uint8_t e0 = RoundToByte(maxValue), e1 = RoundToByte(minValue);
+        AlphaBlock best = EvaluateAlphaEndpoints(values, e0, e1);
+
+        // 8值模式下的最小二乘优化，标量版本
+        int iterations = RefineIterations(quality);
+        for (int iter = 0; iter < iterations && best.error > 0.0f && best.e0 > best.e1; ++iter)
+        {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax = 0.0f, bx = 0.0f;
+            for (int i = 0; i < s_BlockPixels; ++i)
+            {
+                int k = best.indices[i];
+                float t = k == 0 ? 0.0f : (k == 1 ? 1.0f : (k - 1) / 7.0f);
+                float a = 1.0f - t, b = t;
+                aa += a * a; ab += a * b; bb += b * b;
+                ax += a * values[i]; bx += b * values[i];
+            }
+            float det = aa * bb - ab * ab;
+            if (fabsf(det) < 1e-6f)
+                break;
+            uint8_t n0 = RoundToByte((ax * bb - bx * ab) / det);
+            uint8_t n1 = RoundToByte((bx * aa - ax * ab) / det);
+            if (n0 < n1)
+                std::swap(n0, n1);
+            if (n0 == n1)
+                break;
+            AlphaBlock block = EvaluateAlphaEndpoints(values, n0, n1);
+            if (block.error >= best.error)
+                break;
+            best = block;
+        }
+
+        // 6值模式可以精确表示0和255，对含有完全透明/不透明像素的遮罩更有利
+        if (quality == BCEncoder::Quality::High && best.error > 0.0f)
+        {
+            float innerMin = 255.0f, innerMax = 0.0f;
+            for (int i = 0; i < s_BlockPixels; ++i)
+            {
+                if (values[i] > 0.0f && values[i] < 255.0f)
+                {
+                    innerMin = (std::min)(innerMin, values[i]);
+                    innerMax = (std::max)(innerMax, values[i]);
+                }
+            }
+            if (innerMin <= innerMax)
+            {
+                AlphaBlock block = EvaluateAlphaEndpoints(values, RoundToByte(innerMin), RoundToByte(innerMax));
+                if (block.error < best.error)
+                    best = block;
+            }
+        }
+
+        uint64_t bits = 0;
+        for (int i = 0; i < s_BlockPixels; ++i)
+            bits |= static_cast<uint64_t>(best.indices[i]) << (3 * i);
+        pOut[0] = best.e0;
+        pOut[1] = best.e1;
+        for (int i = 0; i < 6; ++i)
+            pOut[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+
+    void EncodeChannelBlock(const XMVECTOR* pixels, int channel, BCEncoder::Quality quality, uint8_t* pOut)
+    {
+        float values[s_BlockPixels];
+        for (int i = 0; i < s_BlockPixels; ++i)
+            values[i] = XMVectorGetByIndex(pixels[i], channel);
+        EncodeAlphaBlock(values, quality, pOut);
+    }
+
+    //
+    // BC7 模式6：单子集，RGBA端点各7位 + 每端点1个p-bit，4位索引
+    //
+
+    const float s_BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct BC7Block
+    {
+        uint8_t q0[4] = {}, q1[4] = {};     // 7位端点
+        uint8_t p0 = 0, p1 = 0;
+        uint8_t indices[s_BlockPixels] = {};
+        float error = FLT_MAX;
+    };
+
+    XMVECTOR QuantizeBC7Endpoint(FXMVECTOR endpoint, uint32_t pbit, uint8_t q[4])
+    {
+        XMFLOAT4 e;
+        XMStoreFloat4(&e, endpoint);
+        const float* pE = &e.x;
+        float expanded[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            int v = static_cast<int>(floorf((pE[c] - pbit) * 0.5f + 0.5f));
+            q[c] = static_cast<uint8_t>((std::min)((std::max)(v, 0), 127));
+            expanded[c] = static_cast<float>((q[c] << 1) | pbit);
+        }
+        return XMVectorSet(expanded[0], expanded[1], expanded[2], expanded[3]);
+    }
+
+    // 按量化误差为端点选择p-bit
+    uint32_t ChooseBC7PBit(FXMVECTOR endpoint)
+    {
+        uint8_t q[4];
+        float error0 = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(endpoint, QuantizeBC7Endpoint(endpoint, 0, q))));
+        float error1 = XMVectorGetX(XMVector4LengthSq(XMVectorSubtract(endpoint, QuantizeBC7Endpoint(endpoint, 1, q))));
+        return error1 < error0 ? 1 : 0;
+    }
+
+    BC7Block EvaluateBC7Endpoints(const XMVECTOR* pixels, FXMVECTOR e0, FXMVECTOR e1, uint32_t p0, uint32_t p1)
+    {
+        BC7Block block;
+        block.p0 = static_cast<uint8_t>(p0);
+        block.p1 = static_cast<uint8_t>(p1);
+        XMVECTOR c0 = QuantizeBC7Endpoint(e0, p0, block.q0);
+        XMVECTOR c1 = QuantizeBC7Endpoint(e1, p1, block.q1);
+
+        XMVECTOR palette[16];
+        for (int k = 0; k < 16; ++k)
+        {
+            // 与硬件一致：((64 - w) * e0 + w * e1 + 32) >> 6
+            XMVECTOR v = XMVectorScale(XMVectorAdd(XMVectorAdd(XMVectorScale(c0, 64.0f - s_BC7Weights4[k]),
+                XMVectorScale(c1, s_BC7Weights4[k])), XMVectorReplicate(32.0f)), 1.0f / 64.0f);
+            palette[k] = XMVectorFloor(v);
+        }
+        block.error = SelectIndices(pixels, palette, 16, g_XMSelect1111, block.indices);
+        return block;
+    }
+
+    BC7Block FitBC7Endpoints(const XMVECTOR* pixels, FXMVECTOR e0, FXMVECTOR e1, BCEncoder::Quality quality)
+    {
+        if (quality != BCEncoder::Quality::High)
+            return EvaluateBC7Endpoints(pixels, e0, e1, ChooseBC7PBit(e0), ChooseBC7PBit(e1));
+
+        BC7Block best;
+        for (uint32_t p = 0; p < 4; ++p)
+        {
+            BC7Block block = EvaluateBC7Endpoints(pixels, e0, e1, p & 1, p >> 1);
+            if (block.error < best.error)
+                best = block;
+        }
+        return best;
+    }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* pOut) : m_pOut(pOut) {}
+        void Write(uint32_t value, uint32_t numBits)
+        {
+            for (uint32_t i = 0; i < numBits; ++i, ++m_Pos)
+            {
+                if ((value >> i) & 1)
+                    m_pOut[m_Pos >> 3] |= static_cast<uint8_t>(1 << (m_Pos & 7));
+            }
+        }
+    private:
+        uint8_t* m_pOut;
+        uint32_t m_Pos = 0;
+    };
+
+    void EncodeBC7Block(const XMVECTOR* pixels, BCEncoder::Quality quality, uint8_t* pOut)
+    {
+        XMVECTOR e0, e1;
+        ComputeAxisEndpoints(pixels, g_XMSelect1111, e0, e1);
+        BC7Block best = FitBC7Endpoints(pixels, e0, e1, quality);
+
+        int iterations = RefineIterations(quality);
+        for (int iter = 0; iter < iterations && best.error > 0.0f; ++iter)
+        {
+            float t[s_BlockPixels];
+            for (int i = 0; i < s_BlockPixels; ++i)
+                t[i] = s_BC7Weights4[best.indices[i]] / 64.0f;
+            if (!LeastSquaresEndpoints(pixels, t, g_XMSelect1111, e0, e1))
+                break;
+            BC7Block block = FitBC7Endpoints(pixels, e0, e1, quality);
+            if (block.error >= best.error)
+                break;
+            best = block;
+        }
+
+        // 第0个像素的索引最高位隐含为0，否则交换端点并翻转索引
+        if (best.indices[0] & 8)
+        {
+            std::swap(best.q0, best.q1);
+            std::swap(best.p0, best.p1);
+            for (int i = 0; i < s_BlockPixels; ++i)
+                best.indices[i] = static_cast<uint8_t>(15 - best.indices[i]);
+        }
+
+        memset(pOut, 0, 16);
+        BitWriter writer(pOut);
+        writer.Write(1 << 6, 7);
+        for (int c = 0; c < 4; ++c)
+        {
+            writer.Write(best.q0[c], 7);
+            writer.Write(best.q1[c], 7);
+        }
+        writer.Write(best.p0, 1);
+        writer.Write(best.p1, 1);
+        writer.Write(best.indices[0], 3);
+        for (int i = 1; i < s_BlockPixels; ++i)
+            writer.Write(best.indices[i], 4);
+    }
+
+    void EncodeBlock(DXGI_FORMAT format, const XMVECTOR* pixels, BCEncoder::Quality quality, uint8_t* pOut)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            EncodeColorBlock(pixels, quality, pOut);
+            break;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            EncodeChannelBlock(pixels, 3, quality, pOut);
+            EncodeColorBlock(pixels, quality, pOut + 8);
+            break;
+        case DXGI_FORMAT_BC4_UNORM:
+            EncodeChannelBlock(pixels, 0, quality, pOut);
+            break;
+        case DXGI_FORMAT_BC5_UNORM:
+            EncodeChannelBlock(pixels, 0, quality, pOut);
+            EncodeChannelBlock(pixels, 1, quality, pOut + 8);
+            break;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            EncodeBC7Block(pixels, quality, pOut);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool BCEncoder::IsSupportedFormat(DXGI_FORMAT format)
+{
+    switch (format)
+    {
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool BCEncoder::HasAlpha(const Image& image)
+{
+    if (image.levels.empty() || (image.format != DXGI_FORMAT_R8G8B8A8_UNORM && image.format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB))
+        return false;
+    const Image::Level& level = image.levels[0];
+    for (uint32_t y = 0; y < level.height; ++y)
+    {
+        const uint8_t* pRow = level.pixels.data() + (size_t)y * level.rowPitch;
+        for (uint32_t x = 0; x < level.width; ++x)
+        {
+            if (pRow[x * 4 + 3] != 255)
+                return true;
+        }
+    }
+    return false;
+}
+
+bool BCEncoder::Compress(const Image& srcImage, DXGI_FORMAT format, Image& dstImage, Quality quality, ThreadPool* pThreadPool)
+{
+    if (srcImage.levels.empty() || !IsSupportedFormat(format) ||
+        (srcImage.format != DXGI_FORMAT_R8G8B8A8_UNORM && srcImage.format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB))
+        return false;
+
+    ThreadPool& pool = pThreadPool ? *pThreadPool : ThreadPool::GetDefault();
+    Image result;
+    result.format = format;
+    for (auto& srcLevel : srcImage.levels)
+    {
+        Image::Level& dstLevel = result.AddLevel(srcLevel.width, srcLevel.height);
+        uint32_t blocksWide = (std::max)(1u, (srcLevel.width + 3) / 4);
+        uint32_t blocksHigh = (std::max)(1u, (srcLevel.height + 3) / 4);
+        uint32_t blockSize = dstLevel.rowPitch / blocksWide;
+        // 每个块独立编码，按块行分配给线程
+        pool.ParallelFor(0, blocksHigh, 1, [&](uint32_t by0, uint32_t by1) {
+            XMVECTOR pixels[s_BlockPixels];
+            for (uint32_t by = by0; by < by1; ++by)
+            {
+                uint8_t* pRow = dstLevel.pixels.data() + (size_t)by * dstLevel.rowPitch;
+                for (uint32_t bx = 0; bx < blocksWide; ++bx)
+                {
+                    LoadBlock(srcLevel, bx, by, pixels);
+                    EncodeBlock(format, pixels, quality, pRow + bx * blockSize);
+                }
+            }
+        });
+    }
+    dstImage = std::move(result);
+    return true;
+}
@@ -0,0 +1,39 @@
+//***************************************************************************************
+// BCEncoder.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// CPU端的块压缩编码(BC1/BC3/BC4/BC5/BC7)
+// CPU block-compression encoder (BC1/BC3/BC4/BC5/BC7).
+//***************************************************************************************
+
+#pragma once
+
+#ifndef BC_ENCODER_H
+#define BC_ENCODER_H
+
+#include "Image.h"
+
+class ThreadPool;
+
+namespace BCEncoder
+{
+    enum class Quality
+    {
+        Fast,       // 仅使用主成分方向的端点
+        Normal,     // 额外进行一次最小二乘端点优化
+        High        // 多次端点优化，BC7尝试全部p-bit组合，BC4尝试6值模式
+    };
+
+    // 将R8G8B8A8_UNORM(_SRGB)图像的所有mip等级压缩为指定的BC格式
+    // BC1：RGB(忽略Alpha)；BC3：RGB + Alpha；BC4：R通道；BC5：RG通道，适合切线空间法线贴图
+    // BC7：使用单子集的模式6，RGBA
+    // 非4的倍数的尺寸边缘块通过复制边缘像素补齐。注意D3D11要求BC纹理第0级的宽高为4的倍数
+    bool Compress(const Image& srcImage, DXGI_FORMAT format, Image& dstImage,
+        Quality quality = Quality::Normal, ThreadPool* pThreadPool = nullptr);
+
+    bool IsSupportedFormat(DXGI_FORMAT format);
+    // 第0级是否含有不透明度小于1的像素
+    bool HasAlpha(const Image& image);
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include "BlurPyramid.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    // 与D3D11的线性过滤一致：纹素中心位于(i + 0.5) / size，越界的下标钳位到边缘
+    XMVECTOR SampleLinearClamp(const ImageFilter::ImageF& image, float u, float v)
+    {
+        float x = u * image.width - 0.5f, y = v * image.height - 0.5f;
+        float x0f = floorf(x), y0f = floorf(y);
+        XMVECTOR tx = XMVectorReplicate(x - x0f), ty = XMVectorReplicate(y - y0f);
+        int maxX = (int)image.width - 1, maxY = (int)image.height - 1;
+        int x0 = (std::min)((std::max)((int)x0f, 0), maxX), x1 = (std::min)((std::max)((int)x0f + 1, 0), maxX);
+        int y0 = (std::min)((std::max)((int)y0f, 0), maxY), y1 = (std::min)((std::max)((int)y0f + 1, 0), maxY);
+
+        const XMFLOAT4* pRow0 = image.Row(y0);
+        const XMFLOAT4* pRow1 = image.Row(y1);
+        XMVECTOR top = XMVectorLerpV(XMLoadFloat4(pRow0 + x0), XMLoadFloat4(pRow0 + x1), tx);
+        XMVECTOR bottom = XMVectorLerpV(XMLoadFloat4(pRow1 + x0), XMLoadFloat4(pRow1 + x1), tx);
+        return XMVectorLerpV(top, bottom, ty);
+    }
+
+    void ExecutePass(const BlurPyramidPass& pass, const ImageFilter::ImageF& src, ImageFilter::ImageF& dst, ThreadPool* pThreadPool)
+    {
+        dst.Resize(pass.dstWidth, pass.dstHeight);
+        auto func = [&](uint32_t y0, uint32_t y1) {
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                float v = (y + 0.5f) / pass.dstHeight;
+                XMFLOAT4* pOut = dst.Row(y);
+                for (uint32_t x = 0; x < pass.dstWidth; ++x)
+                {
+                    float u = (x + 0.5f) / pass.dstWidth;
+                    XMVECTOR sum = XMVectorZero();
+                    for (uint32_t i = 0; i < pass.tapCount; ++i)
+                    {
+                        const XMFLOAT4& tap = pass.taps[i];
+                        sum = XMVectorMultiplyAdd(XMVectorReplicate(tap.z), SampleLinearClamp(src, u + tap.x, v + tap.y), sum);
+                    }
+                    XMStoreFloat4(pOut + x, sum);
+                }
+            }
+        };
+        if (pThreadPool)
+            pThreadPool->ParallelFor(0, pass.dstHeight, 8, func);
+        else
+            func(0, pass.dstHeight);
+    }
+}
+
+void BlurPyramid::GetLevelSize(uint32_t width, uint32_t height, uint32_t level, uint32_t& levelWidth, uint32_t& levelHeight)
+{
+    levelWidth = (std::max)(width >> level, 1u);
+    levelHeight = (std::max)(height >> level, 1u);
+}
+
+uint32_t BlurPyramid::GetMaxIterations(uint32_t width, uint32_t height)
+{
+    uint32_t iterations = 0;
+    while ((std::min)(width, height) >> (iterations + 1) >= 2)
+        ++iterations;
+    return iterations;
+}
+
+std::vector<BlurPyramidPass> BlurPyramid::BuildSchedule(uint32_t width, uint32_t height, uint32_t iterations, float offset)
+{
+    iterations = (std::min)(iterations, GetMaxIterations(width, height));
+    std::vector<BlurPyramidPass> passes;
+    passes.reserve(2 * iterations);
+
+    auto makePass = [&](bool upsample, uint32_t srcLevel, uint32_t dstLevel) {
+        BlurPyramidPass pass{ upsample, srcLevel, dstLevel };
+        GetLevelSize(width, height, srcLevel, pass.srcWidth, pass.srcHeight);
+        GetLevelSize(width, height, dstLevel, pass.dstWidth, pass.dstHeight);
+        // 源纹理半个纹素对应的纹理坐标偏移
+        float hx = 0.5f * offset / pass.srcWidth, hy = 0.5f * offset / pass.srcHeight;
+        if (!upsample)
+        {
+            pass.tapCount = 5;
+            pass.taps[0] = XMFLOAT4(0.0f, 0.0f, 4.0f / 8.0f, 0.0f);
+            pass.taps[1] = XMFLOAT4(-hx, -hy, 1.0f / 8.0f, 0.0f);
+            pass.taps[2] = XMFLOAT4(hx, -hy, 1.0f / 8.0f, 0.0f);
+            pass.taps[3] = XMFLOAT4(-hx, hy, 1.0f / 8.0f, 0.0f);
+            pass.taps[4] = XMFLOAT4(hx, hy, 1.0f / 8.0f, 0.0f);
+        }
+        else
+        {
+            pass.tapCount = 8;
+            pass.taps[0] = XMFLOAT4(-2.0f * hx, 0.0f, 1.0f / 12.0f, 0.0f);
+            pass.taps[1] = XMFLOAT4(2.0f * hx, 0.0f, 1.0f / 12.0f, 0.0f);
+            pass.taps[2] = XMFLOAT4(0.0f, -2.0f * hy, 1.0f / 12.0f, 0.0f);
+            pass.taps[3] = XMFLOAT4(0.0f, 2.0f * hy, 1.0f / 12.0f, 0.0f);
+            pass.taps[4] = XMFLOAT4(-hx, -hy, 2.0f / 12.0f, 0.0f);
+            pass.taps[5] = XMFLOAT4(hx, -hy, 2.0f / 12.0f, 0.0f);
+            pass.taps[6] = XMFLOAT4(-hx, hy, 2.0f / 12.0f, 0.0f);
+            pass.taps[7] = XMFLOAT4(hx, hy, 2.0f / 12.0f, 0.0f);
+        }
+        return pass;
+    };
+
+    for (uint32_t level = 0; level < iterations; ++level)
+        passes.push_back(makePass(false, level, level + 1));
+    for (uint32_t level = iterations; level > 0; --level)
+        passes.push_back(makePass(true, level, level - 1));
+    return passes;
+}
+
+void BlurPyramid::Execute(const std::vector<BlurPyramidPass>& passes, const ImageFilter::ImageF& src, ImageFilter::ImageF& dst,
+    ThreadPool* pThreadPool)
+{
+    if (passes.empty())
+    {
+        if (&dst != &src)
+            dst = src;
+        return;
+    }
+
+    // levels[0]为原图，上采样的结果写回较大的一层
+    uint32_t numLevels = 1;
+    for (const BlurPyramidPass& pass : passes)
+        numLevels = (std::max)(numLevels, pass.dstLevel + 1);
+    std::vector<ImageFilter::ImageF> levels(numLevels);
+    levels[0] = src;
+    for (const BlurPyramidPass& pass : passes)
+        ExecutePass(pass, levels[pass.srcLevel], levels[pass.dstLevel], pThreadPool);
+    dst = std::move(levels[0]);
+}
+
+float BlurPyramid::EstimateSigma(uint32_t iterations, float offset)
+{
+    // 竖线的响应只与水平方向有关；宽度取得足够大，使响应不会碰到边界
+    uint32_t width = (16u << iterations) * (uint32_t)(std::max)(ceilf(offset), 1.0f);
+    uint32_t height = 2u << iterations;
+    ImageFilter::ImageF image(width, height);
+    for (uint32_t y = 0; y < height; ++y)
+        image.Row(y)[width / 2] = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+
+    Execute(BuildSchedule(width, height, iterations, offset), image, image);
+
+    double sum = 0.0, mean = 0.0, variance = 0.0;
+    const XMFLOAT4* pRow = image.Row(height / 2);
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        sum += pRow[x].x;
+        mean += pRow[x].x * (x + 0.5);
+    }
+    mean /= sum;
+    for (uint32_t x = 0; x < width; ++x)
+        variance += pRow[x].x * (x + 0.5 - mean) * (x + 0.5 - mean);
+    return static_cast<float>(sqrt(variance / sum));
+}
@@ -0,0 +1,57 @@
+//***************************************************************************************
+// BlurPyramid.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 双Kawase模糊金字塔的调度计划与CPU参考实现
+// Dual-Kawase blur pyramid schedule and CPU reference implementation.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef BLUR_PYRAMID_H
+#define BLUR_PYRAMID_H
+
+#include "ImageFilter.h"
+
+//
+// 先逐层下采样到一半大小，再逐层上采样回原图大小，每一趟只有5或8次双线性采样。
+// 模糊范围随层数指数增长，因此即使半径很大，总开销也不超过原图大小的几次全屏处理
+//
+// 下采样：中心权重1/2，四个对角方向各1/8
+// 上采样：四个轴方向(2倍偏移)各1/12，四个对角方向各1/6
+// 偏移以源纹理的半个纹素为单位，再乘以offset
+//
+
+struct BlurPyramidPass
+{
+    static constexpr uint32_t MaxTaps = 8;
+
+    bool upsample;                      // 为false时从srcLevel下采样到srcLevel + 1，否则上采样到srcLevel - 1
+    uint32_t srcLevel;
+    uint32_t dstLevel;
+    uint32_t srcWidth, srcHeight;
+    uint32_t dstWidth, dstHeight;
+    uint32_t tapCount;
+    DirectX::XMFLOAT4 taps[MaxTaps];    // xy为相对目标像素中心的纹理坐标偏移，z为权重，w未使用
+};
+
+namespace BlurPyramid
+{
+    // 第level层的大小，第0层为原图，之后每层宽高减半且不小于1
+    void GetLevelSize(uint32_t width, uint32_t height, uint32_t level, uint32_t& levelWidth, uint32_t& levelHeight);
+    // 最小的一层宽高均不小于2时允许的最大下采样次数
+    uint32_t GetMaxIterations(uint32_t width, uint32_t height);
+
+    // 生成iterations次下采样和同样次数的上采样，结果写回第0层
+    // iterations会被限制在GetMaxIterations之内；offset越大模糊越强，过大时会出现块状瑕疵
+    std::vector<BlurPyramidPass> BuildSchedule(uint32_t width, uint32_t height, uint32_t iterations, float offset = 1.0f);
+
+    // CPU参考实现：与着色器一样以线性过滤、Clamp寻址采样。src与dst可以是同一幅图像
+    void Execute(const std::vector<BlurPyramidPass>& passes, const ImageFilter::ImageF& src, ImageFilter::ImageF& dst,
+        ThreadPool* pThreadPool = nullptr);
+
+    // 用CPU参考实现求一条竖线的响应的标准差(以原图像素为单位)，即效果相近的高斯模糊的sigma
+    float EstimateSigma(uint32_t iterations, float offset = 1.0f);
+}
+
+#endif
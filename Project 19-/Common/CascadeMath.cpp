@@ -0,0 +1,720 @@
+#include "CascadeMath.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    struct Triangle
+    {
+        XMVECTOR point[3];
+        bool isCulled;
+    };
+
+    // 包围盒的12条棱
+    constexpr int s_BoxEdges[12][2] = {
+        {0,1}, {1,2}, {2,3}, {3,0},
+        {4,5}, {5,6}, {6,7}, {7,4},
+        {0,4}, {1,5}, {2,6}, {3,7}
+    };
+
+    // 包围盒的6个面，每个面用一个角点及与它相邻的两个角点表示
+    constexpr int s_BoxFaces[6][3] = {
+        {0,1,3}, {4,5,7},
+        {0,1,4}, {3,2,7},
+        {0,3,4}, {1,2,5}
+    };
+
+    XMVECTOR XM_CALLCONV InRange(FXMVECTOR v, FXMVECTOR minVec, FXMVECTOR maxVec)
+    {
+        return XMVectorAndInt(XMVectorGreaterOrEqual(v, minVec), XMVectorLessOrEqual(v, maxVec));
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// 计算一个准确的近平面/远平面可以减少surface acne和Peter-panning
+// 通常偏移量会用于PCF滤波来解决阴影问题
+// 而准确的近平面/远平面可以提升精度
+// 这个概念并不复杂，但相交测试的代码比较复杂
+//--------------------------------------------------------------------------------------
+void XM_CALLCONV CascadeMath::ComputeNearAndFarReference(
+    float& outNearPlane,
+    float& outFarPlane,
+    FXMVECTOR lightCameraOrthographicMinVec,
+    FXMVECTOR lightCameraOrthographicMaxVec,
+    const XMVECTOR pointsInLightSpace[8])
+{
+    // 核心思想
+    // 1. 对AABB的所有12个三角形进行迭代
+    // 2. 每个三角形分别对正交投影的4个侧面进行裁剪。裁剪过程中可能会出现这些情况：
+    //    - 0个点在该侧面的内部，该三角形可以剔除
+    //    - 1个点在该侧面的内部，计算该点与另外两个点在侧面上的交点得到新三角形
+    //    - 2个点在该侧面的内部，计算这两个点与另一个点在侧面上的交点，分裂得到2个新三角形
+    //    - 3个点都在该侧面的内部
+    //    遍历中的三角形与新生产的三角形都要进行剩余侧面的裁剪
+    // 3. 在这些三角形中找到最小/最大的Z值作为近平面/远平面
+
+    outNearPlane = FLT_MAX;
+    outFarPlane = -FLT_MAX;
+    Triangle triangleList[16]{};
+    int numTriangles;
+
+    //      7----6
+    //     /|   /|
+    //    3-+--2 |
+    //    | 4--|-5
+    //    |/   |/
+    //    0----1
+    static const int all_indices[][3] = {
+        {4,7,6}, {6,5,4},
+        {5,6,2}, {2,1,5},
+        {1,2,3}, {3,0,1},
+        {0,3,7}, {7,4,0},
+        {7,3,2}, {2,6,7},
+        {0,4,5}, {5,1,0}
+    };
+    bool triPointPassCollision[3]{};
+    const float minX = XMVectorGetX(lightCameraOrthographicMinVec);
+    const float maxX = XMVectorGetX(lightCameraOrthographicMaxVec);
+    const float minY = XMVectorGetY(lightCameraOrthographicMinVec);
+    const float maxY = XMVectorGetY(lightCameraOrthographicMaxVec);
+
+    for (auto& indices : all_indices)
+    {
+        triangleList[0].point[0] = pointsInLightSpace[indices[0]];
+        triangleList[0].point[1] = pointsInLightSpace[indices[1]];
+        triangleList[0].point[2] = pointsInLightSpace[indices[2]];
+        numTriangles = 1;
+        triangleList[0].isCulled = false;
+
+        // 每个三角形都需要对4个视锥体侧面进行裁剪
+        for (int planeIdx = 0; planeIdx < 4; ++planeIdx)
+        {
+            float edge;
+            int component;
+            switch (planeIdx)
+            {
+            case 0: edge = minX; component = 0; break;
+            case 1: edge = maxX; component = 0; break;
+            case 2: edge = minY; component = 1; break;
+            case 3: edge = maxY; component = 1; break;
+            default: break;
+            }
+
+            for (int triIdx = 0; triIdx < numTriangles; ++triIdx)
+            {
+                // 跳过裁剪的三角形
+                if (triangleList[triIdx].isCulled)
+                    continue;
+
+                int insideVertexCount = 0;
+
+                for (int triVtxIdx = 0; triVtxIdx < 3; ++triVtxIdx)
+                {
+                    switch (planeIdx)
+                    {
+                    case 0: triPointPassCollision[triVtxIdx] = (XMVectorGetX(triangleList[triIdx].point[triVtxIdx]) > minX); break;
+                    case 1: triPointPassCollision[triVtxIdx] = (XMVectorGetX(triangleList[triIdx].point[triVtxIdx]) < maxX); break;
+                    case 2: triPointPassCollision[triVtxIdx] = (XMVectorGetY(triangleList[triIdx].point[triVtxIdx]) > minY); break;
+                    case 3: triPointPassCollision[triVtxIdx] = (XMVectorGetY(triangleList[triIdx].point[triVtxIdx]) < maxY); break;
+                    default: break;
+                    }
+                    insideVertexCount += triPointPassCollision[triVtxIdx];
+                }
+
+                // 将通过视锥体测试的点挪到数组前面
+                if (triPointPassCollision[1] && !triPointPassCollision[0])
+                {
+                    std::swap(triangleList[triIdx].point[0], triangleList[triIdx].point[1]);
+                    triPointPassCollision[0] = true;
+                    triPointPassCollision[1] = false;
+                }
+                if (triPointPassCollision[2] && !triPointPassCollision[1])
+                {
+                    std::swap(triangleList[triIdx].point[1], triangleList[triIdx].point[2]);
+                    triPointPassCollision[1] = true;
+                    triPointPassCollision[2] = false;
+                }
+                if (triPointPassCollision[1] && !triPointPassCollision[0])
+                {
+                    std::swap(triangleList[triIdx].point[0], triangleList[triIdx].point[1]);
+                    triPointPassCollision[0] = true;
+                    triPointPassCollision[1] = false;
+                }
+
+                // 裁剪测试
+                triangleList[triIdx].isCulled = (insideVertexCount == 0);
+                if (insideVertexCount == 1)
+                {
+                    // 找出三角形与当前平面相交的另外两个点
+                    XMVECTOR v0v1Vec = triangleList[triIdx].point[1] - triangleList[triIdx].point[0];
+                    XMVECTOR v0v2Vec = triangleList[triIdx].point[2] - triangleList[triIdx].point[0];
+
+                    float hitPointRatio = edge - XMVectorGetByIndex(triangleList[triIdx].point[0], component);
+                    float distAlong_v0v1 = hitPointRatio / XMVectorGetByIndex(v0v1Vec, component);
+                    float distAlong_v0v2 = hitPointRatio / XMVectorGetByIndex(v0v2Vec, component);
+                    v0v1Vec = distAlong_v0v1 * v0v1Vec + triangleList[triIdx].point[0];
+                    v0v2Vec = distAlong_v0v2 * v0v2Vec + triangleList[triIdx].point[0];
+
+                    triangleList[triIdx].point[1] = v0v2Vec;
+                    triangleList[triIdx].point[2] = v0v1Vec;
+                }
+                else if (insideVertexCount == 2)
+                {
+                    // 裁剪后需要分开成两个三角形
+
+                    // 把当前三角形后面的三角形(如果存在的话)复制出来，这样
+                    // 我们就可以用算出来的新三角形覆盖它
+                    triangleList[numTriangles] = triangleList[triIdx + 1];
+                    triangleList[triIdx + 1].isCulled = false;
+
+                    // 找出三角形与当前平面相交的另外两个点
+                    XMVECTOR v2v0Vec = triangleList[triIdx].point[0] - triangleList[triIdx].point[2];
+                    XMVECTOR v2v1Vec = triangleList[triIdx].point[1] - triangleList[triIdx].point[2];
+
+                    float hitPointRatio = edge - XMVectorGetByIndex(triangleList[triIdx].point[2], component);
+                    float distAlong_v2v0 = hitPointRatio / XMVectorGetByIndex(v2v0Vec, component);
+                    float distAlong_v2v1 = hitPointRatio / XMVectorGetByIndex(v2v1Vec, component);
+                    v2v0Vec = distAlong_v2v0 * v2v0Vec + triangleList[triIdx].point[2];
+                    v2v1Vec = distAlong_v2v1 * v2v1Vec + triangleList[triIdx].point[2];
+
+                    // 添加三角形
+                    triangleList[triIdx + 1].point[0] = triangleList[triIdx].point[0];
+                    triangleList[triIdx + 1].point[1] = triangleList[triIdx].point[1];
+                    triangleList[triIdx + 1].point[2] = v2v0Vec;
+
+                    triangleList[triIdx].point[0] = triangleList[triIdx + 1].point[1];
+                    triangleList[triIdx].point[1] = triangleList[triIdx + 1].point[2];
+                    triangleList[triIdx].point[2] = v2v1Vec;
+
+                    // 添加三角形数目，跳过我们刚插入的三角形
+                    ++numTriangles;
+                    ++triIdx;
+                }
+            }
+        }
+
+        for (int triIdx = 0; triIdx < numTriangles; ++triIdx)
+        {
+            if (!triangleList[triIdx].isCulled)
+            {
+                for (int vtxIdx = 0; vtxIdx < 3; ++vtxIdx)
+                {
+                    float z = XMVectorGetZ(triangleList[triIdx].point[vtxIdx]);
+
+                    outNearPlane = (std::min)(outNearPlane, z);
+                    outFarPlane = (std::max)(outFarPlane, z);
+                }
+            }
+        }
+    }
+}
+
+void CascadeMath::ComputeNearAndFar(float outNearPlanes[], float outFarPlanes[],
+    const XMFLOAT4 orthographicRects[], uint32_t cascadeCount,
+    const XMVECTOR pointsInLightSpace[8])
+{
+    XMFLOAT3 points[8];
+    for (int i = 0; i < 8; ++i)
+        XMStoreFloat3(points + i, pointsInLightSpace[i]);
+
+    for (uint32_t base = 0; base < cascadeCount; base += 4)
+    {
+        // 转置后每个向量的4个通道对应4个级联，不足4个时重复最后一个级联
+        XMMATRIX rects;
+        for (uint32_t i = 0; i < 4; ++i)
+            rects.r[i] = XMLoadFloat4(orthographicRects + (std::min)(base + i, cascadeCount - 1));
+        rects = XMMatrixTranspose(rects);
+        const XMVECTOR minX = rects.r[0], minY = rects.r[1], maxX = rects.r[2], maxY = rects.r[3];
+
+        XMVECTOR nearVec = g_XMFltMax;
+        XMVECTOR farVec = XMVectorNegate(g_XMFltMax);
+        // 只有mask为真的通道参与最值的计算
+        auto accumulate = [&](const XMVECTOR& mask, const XMVECTOR& z) {
+            nearVec = XMVectorSelect(nearVec, XMVectorMin(nearVec, z), mask);
+            farVec = XMVectorSelect(farVec, XMVectorMax(farVec, z), mask);
+        };
+
+        // 1. 位于XY范围内的角点
+        for (const XMFLOAT3& p : points)
+        {
+            XMVECTOR inside = XMVectorAndInt(
+                InRange(XMVectorReplicate(p.x), minX, maxX),
+                InRange(XMVectorReplicate(p.y), minY, maxY));
+            accumulate(inside, XMVectorReplicate(p.z));
+        }
+
+        // 2. 棱与侧面的交点。a为棱在侧面法线方向上的分量，b为另一个分量；与侧面平行的棱没有交点
+        auto clipEdge = [&](float a0, float da, float b0, float db, float z0, float dz,
+            const XMVECTOR& minA, const XMVECTOR& maxA, const XMVECTOR& minB, const XMVECTOR& maxB) {
+            if (da == 0.0f)
+                return;
+            XMVECTOR invDa = XMVectorReplicate(1.0f / da);
+            XMVECTOR a0Vec = XMVectorReplicate(a0), b0Vec = XMVectorReplicate(b0), z0Vec = XMVectorReplicate(z0);
+            XMVECTOR dbVec = XMVectorReplicate(db), dzVec = XMVectorReplicate(dz);
+            for (XMVECTOR side : { minA, maxA })
+            {
+                XMVECTOR t = XMVectorMultiply(XMVectorSubtract(side, a0Vec), invDa);
+                XMVECTOR b = XMVectorMultiplyAdd(t, dbVec, b0Vec);
+                accumulate(XMVectorAndInt(InRange(t, g_XMZero, g_XMOne), InRange(b, minB, maxB)),
+                    XMVectorMultiplyAdd(t, dzVec, z0Vec));
+            }
+        };
+        for (const auto& edge : s_BoxEdges)
+        {
+            const XMFLOAT3& p0 = points[edge[0]];
+            const XMFLOAT3& p1 = points[edge[1]];
+            float dx = p1.x - p0.x, dy = p1.y - p0.y, dz = p1.z - p0.z;
+            clipEdge(p0.x, dx, p0.y, dy, p0.z, dz, minX, maxX, minY, maxY);
+            clipEdge(p0.y, dy, p0.x, dx, p0.z, dz, minY, maxY, minX, maxX);
+        }
+
+        // 3. XY范围的4个角所在的竖直线与各个面的交点，用面内的参数坐标(s, t)判断是否落在面内
+        const XMVECTOR cornersX[4] = { minX, maxX, minX, maxX };
+        const XMVECTOR cornersY[4] = { minY, minY, maxY, maxY };
+        for (const auto& face : s_BoxFaces)
+        {
+            const XMFLOAT3& o = points[face[0]];
+            XMFLOAT3 u(points[face[1]].x - o.x, points[face[1]].y - o.y, points[face[1]].z - o.z);
+            XMFLOAT3 v(points[face[2]].x - o.x, points[face[2]].y - o.y, points[face[2]].z - o.z);
+            float det = u.x * v.y - u.y * v.x;
+            // 与光线方向平行的面在XY平面上退化成线段，它与竖直线的交点已包含在棱的交点中
+            if (fabsf(det) <= 1e-6f * (fabsf(u.x * v.y) + fabsf(u.y * v.x)))
+                continue;
+
+            float invDet = 1.0f / det;
+            XMVECTOR oxVec = XMVectorReplicate(o.x), oyVec = XMVectorReplicate(o.y), ozVec = XMVectorReplicate(o.z);
+            for (int i = 0; i < 4; ++i)
+            {
+                XMVECTOR px = XMVectorSubtract(cornersX[i], oxVec);
+                XMVECTOR py = XMVectorSubtract(cornersY[i], oyVec);
+                XMVECTOR s = XMVectorScale(XMVectorSubtract(XMVectorScale(px, v.y), XMVectorScale(py, v.x)), invDet);
+                XMVECTOR t = XMVectorScale(XMVectorSubtract(XMVectorScale(py, u.x), XMVectorScale(px, u.y)), invDet);
+                XMVECTOR z = XMVectorMultiplyAdd(s, XMVectorReplicate(u.z), XMVectorMultiplyAdd(t, XMVectorReplicate(v.z), ozVec));
+                accumulate(XMVectorAndInt(InRange(s, g_XMZero, g_XMOne), InRange(t, g_XMZero, g_XMOne)), z);
+            }
+        }
+
+        uint32_t count = (std::min)(cascadeCount - base, 4u);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            outNearPlanes[base + i] = XMVectorGetByIndex(nearVec, i);
+            outFarPlanes[base + i] = XMVectorGetByIndex(farVec, i);
+        }
+    }
+}
+
+void CascadeMath::ComputePracticalSplits(float nearZ, float farZ, uint32_t cascadeCount, float lambda, float outSplits[])
+{
+    for (uint32_t i = 1; i <= cascadeCount; ++i)
+    {
+        float t = (float)i / cascadeCount;
+        float uniformSplit = nearZ + (farZ - nearZ) * t;
+        float logSplit = nearZ * powf(farZ / nearZ, t);
+        outSplits[i - 1] = uniformSplit + (logSplit - uniformSplit) * lambda;
+    }
+    // 避免浮点误差使最后一个分割点偏离farZ
+    if (cascadeCount)
+        outSplits[cascadeCount - 1] = farZ;
+}
+
+void CascadeMath::AccumulateDepthHistogram(const float depths[], size_t count, float minZ, float maxZ,
+    uint32_t binCount, uint32_t histogram[])
+{
+    float logMinZ = logf(minZ);
+    float binScale = binCount / (logf(maxZ) - logMinZ);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float bin = (logf((std::max)(depths[i], minZ)) - logMinZ) * binScale;
+        ++histogram[(std::min)((uint32_t)bin, binCount - 1)];
+    }
+}
+
+bool CascadeMath::ComputeDepthRangeFromHistogram(const uint32_t histogram[], uint32_t binCount, float minZ, float maxZ,
+    float percentile, float& outMinZ, float& outMaxZ)
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < binCount; ++i)
+        total += histogram[i];
+    if (!total)
+        return false;
+
+    // 从两端累加，跳过样本数之和不超过阈值的桶
+    uint64_t threshold = (uint64_t)(total * (std::max)(percentile, 0.0f));
+    uint32_t first = 0, last = binCount - 1;
+    for (uint64_t sum = histogram[first]; sum <= threshold && first < last; sum += histogram[first])
+        ++first;
+    for (uint64_t sum = histogram[last]; sum <= threshold && last > first; sum += histogram[last])
+        --last;
+
+    float ratio = maxZ / minZ;
+    outMinZ = minZ * powf(ratio, (float)first / binCount);
+    outMaxZ = last == binCount - 1 ? maxZ : minZ * powf(ratio, (float)(last + 1) / binCount);
+    return true;
+}
+
+ShadowCacheRegion CascadeMath::BuildShadowCacheRegion(const XMFLOAT4& rect, float nearZ, float farZ,
+    float guardBand, uint32_t shadowSize)
+{
+    ShadowCacheRegion region{ rect, nearZ, farZ };
+    if (guardBand > 0.0f)
+    {
+        float width = rect.z - rect.x, height = rect.w - rect.y;
+        float texelX = width * (1.0f + 2.0f * guardBand) / shadowSize;
+        float texelY = height * (1.0f + 2.0f * guardBand) / shadowSize;
+        if (texelX > 0.0f && texelY > 0.0f)
+        {
+            region.rect.x = floorf((rect.x - guardBand * width) / texelX) * texelX;
+            region.rect.y = floorf((rect.y - guardBand * height) / texelY) * texelY;
+            region.rect.z = ceilf((rect.z + guardBand * width) / texelX) * texelX;
+            region.rect.w = ceilf((rect.w + guardBand * height) / texelY) * texelY;
+        }
+        // 与场景不相交时近/远平面为FLT_MAX/-FLT_MAX，保持原样
+        if (nearZ <= farZ)
+        {
+            float depth = farZ - nearZ;
+            region.nearZ = nearZ - guardBand * depth;
+            region.farZ = farZ + guardBand * depth;
+        }
+    }
+    return region;
+}
+
+ShadowCacheInvalidation CascadeMath::CheckShadowCacheRegion(const ShadowCacheRegion& region, const XMFLOAT4& rect,
+    float nearZ, float farZ, float guardBand)
+{
+    if (rect.x < region.rect.x || rect.y < region.rect.y || rect.z > region.rect.z || rect.w > region.rect.w ||
+        nearZ < region.nearZ || farZ > region.farZ)
+        return ShadowCacheInvalidation::ShadowCacheInvalidation_OutOfBounds;
+
+    // 比如关闭固定大小的AABB后摄像机转向，需要的范围会明显缩小
+    float maxScale = 1.0f + 4.0f * guardBand;
+    if (region.rect.z - region.rect.x > (rect.z - rect.x) * maxScale ||
+        region.rect.w - region.rect.y > (rect.w - rect.y) * maxScale)
+        return ShadowCacheInvalidation::ShadowCacheInvalidation_Resolution;
+
+    return ShadowCacheInvalidation::ShadowCacheInvalidation_None;
+}
+
+bool XM_CALLCONV CascadeMath::IsLightDirectionWithinTolerance(FXMVECTOR cachedLightDir, FXMVECTOR lightDir,
+    float toleranceRadians)
+{
+    float cosAngle = XMVectorGetX(XMVector3Dot(cachedLightDir, lightDir));
+    return cosAngle >= cosf(toleranceRadians);
+}
+
+CascadeNearFarBenchmarkResult RunCascadeNearFarBenchmark(uint32_t numScenes, uint32_t cascadeCount)
+{
+    CascadeNearFarBenchmarkResult result{ numScenes, cascadeCount, 0.0f, 0.0f, 0.0f, 0 };
+
+    // 随机的光照方向与场景包围盒，级联范围有一部分落在场景外
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<XMVECTOR> points((size_t)numScenes * 8);
+    std::vector<XMFLOAT4> rects((size_t)numScenes * cascadeCount);
+    std::vector<float> sceneSizes(numScenes);
+    for (uint32_t i = 0; i < numScenes; ++i)
+    {
+        XMMATRIX lightView = XMMatrixRotationRollPitchYaw(unit(rng) * XM_2PI, unit(rng) * XM_2PI, unit(rng) * XM_2PI);
+        XMFLOAT3 center(unit(rng) * 100.0f - 50.0f, unit(rng) * 100.0f - 50.0f, unit(rng) * 100.0f - 50.0f);
+        XMFLOAT3 extents(1.0f + unit(rng) * 50.0f, 1.0f + unit(rng) * 50.0f, 1.0f + unit(rng) * 50.0f);
+        XMVECTOR minVec = g_XMFltMax, maxVec = XMVectorNegate(g_XMFltMax);
+        for (int j = 0; j < 8; ++j)
+        {
+            // 与BoundingBox::GetCorners的角点顺序一致
+            float sx = (j == 1 || j == 2 || j == 5 || j == 6) ? 1.0f : -1.0f;
+            float sy = (j == 2 || j == 3 || j == 6 || j == 7) ? 1.0f : -1.0f;
+            float sz = j < 4 ? 1.0f : -1.0f;
+            XMVECTOR p = XMVectorSet(center.x + sx * extents.x, center.y + sy * extents.y, center.z + sz * extents.z, 1.0f);
+            p = XMVector3Transform(p, lightView);
+            points[(size_t)i * 8 + j] = p;
+            minVec = XMVectorMin(minVec, p);
+            maxVec = XMVectorMax(maxVec, p);
+        }
+        XMFLOAT3 minPoint, size;
+        XMStoreFloat3(&minPoint, minVec);
+        XMStoreFloat3(&size, XMVectorSubtract(maxVec, minVec));
+        sceneSizes[i] = (std::max)((std::max)(size.x, size.y), size.z);
+
+        for (uint32_t j = 0; j < cascadeCount; ++j)
+        {
+            float cx = minPoint.x + (unit(rng) * 1.4f - 0.2f) * size.x;
+            float cy = minPoint.y + (unit(rng) * 1.4f - 0.2f) * size.y;
+            float hw = (0.05f + unit(rng) * 0.5f) * size.x;
+            float hh = (0.05f + unit(rng) * 0.5f) * size.y;
+            rects[(size_t)i * cascadeCount + j] = XMFLOAT4(cx - hw, cy - hh, cx + hw, cy + hh);
+        }
+    }
+
+    std::vector<float> refNear(rects.size()), refFar(rects.size());
+    std::vector<float> batchNear(rects.size()), batchFar(rects.size());
+    // CpuTimer依赖Windows的性能计数器，这里用标准库计时，便于在其它平台单独编译测试
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    };
+
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < numScenes; ++i)
+    {
+        for (uint32_t j = 0; j < cascadeCount; ++j)
+        {
+            size_t idx = (size_t)i * cascadeCount + j;
+            CascadeMath::ComputeNearAndFarReference(refNear[idx], refFar[idx],
+                XMVectorSet(rects[idx].x, rects[idx].y, 0.0f, 0.0f),
+                XMVectorSet(rects[idx].z, rects[idx].w, 0.0f, 0.0f),
+                points.data() + (size_t)i * 8);
+        }
+    }
+    result.referenceMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (uint32_t i = 0; i < numScenes; ++i)
+    {
+        size_t idx = (size_t)i * cascadeCount;
+        CascadeMath::ComputeNearAndFar(batchNear.data() + idx, batchFar.data() + idx,
+            rects.data() + idx, cascadeCount, points.data() + (size_t)i * 8);
+    }
+    result.batchedMs = elapsedMs(start);
+
+    for (size_t idx = 0; idx < rects.size(); ++idx)
+    {
+        bool refEmpty = refNear[idx] > refFar[idx];
+        bool batchEmpty = batchNear[idx] > batchFar[idx];
+        result.emptyCount += refEmpty;
+        float error = 1.0f;
+        if (refEmpty && batchEmpty)
+            error = 0.0f;
+        else if (!refEmpty && !batchEmpty)
+            error = (std::max)(fabsf(refNear[idx] - batchNear[idx]), fabsf(refFar[idx] - batchFar[idx])) / sceneSizes[idx / cascadeCount];
+        result.maxError = (std::max)(result.maxError, error);
+    }
+    return result;
+}
+
+namespace
+{
+    struct CascadeChecker
+    {
+        CascadeCheckResult result{ 0, 0, nullptr };
+
+        void Check(bool condition, const char* description)
+        {
+            ++result.numChecks;
+            if (condition)
+                return;
+            ++result.numFailed;
+            if (!result.firstFailure)
+                result.firstFailure = description;
+        }
+    };
+
+    // 允许对数/指数运算带来的相对误差
+    bool LessOrNearEqual(float lhs, float rhs)
+    {
+        return lhs <= rhs + 1e-4f * fabsf(rhs);
+    }
+}
+
+CascadeCheckResult RunCascadeSplitTest()
+{
+    CascadeChecker checker;
+
+    //
+    // 级联划分
+    //
+    const float nearFars[][2] = { { 0.1f, 100.0f }, { 0.5f, 300.0f }, { 1.0f, 5000.0f }, { 10.0f, 11.0f } };
+    const float lambdas[] = { 0.0f, 0.25f, 0.5f, 0.8f, 1.0f };
+    float splits[8];
+    for (auto& nearFar : nearFars)
+    {
+        for (float lambda : lambdas)
+        {
+            for (uint32_t cascadeCount = 1; cascadeCount <= 8; ++cascadeCount)
+            {
+                CascadeMath::ComputePracticalSplits(nearFar[0], nearFar[1], cascadeCount, lambda, splits);
+                bool monotonic = splits[0] > nearFar[0];
+                for (uint32_t i = 1; i < cascadeCount; ++i)
+                    monotonic = monotonic && splits[i] > splits[i - 1];
+                checker.Check(monotonic, "Splits: not increasing");
+                checker.Check(splits[cascadeCount - 1] == nearFar[1], "Splits: last split != farZ");
+
+                // 两个端点分别为均匀划分与对数划分
+                float t = 1.0f / cascadeCount;
+                if (lambda == 0.0f)
+                    checker.Check(fabsf(splits[0] - (nearFar[0] + (nearFar[1] - nearFar[0]) * t)) <= 1e-4f * nearFar[1],
+                        "Splits: lambda 0 not uniform");
+                else if (lambda == 1.0f)
+                    checker.Check(fabsf(splits[0] - nearFar[0] * powf(nearFar[1] / nearFar[0], t)) <= 1e-4f * splits[0],
+                        "Splits: lambda 1 not logarithmic");
+            }
+        }
+    }
+
+    //
+    // 深度直方图
+    //
+    constexpr uint32_t binCount = 64;
+    const float minZ = 0.5f, maxZ = 300.0f;
+    auto getBinEdge = [&](uint32_t bin) { return minZ * powf(maxZ / minZ, (float)bin / binCount); };
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> uniformDepths(100000), bimodalDepths(100000), singleBinDepths(1000, 37.0f);
+    for (float& depth : uniformDepths)
+        depth = 20.0f + 60.0f * unit(rng);
+    for (float& depth : bimodalDepths)
+        depth = unit(rng) < 0.5f ? 5.0f + 5.0f * unit(rng) : 100.0f + 20.0f * unit(rng);
+
+    std::vector<float>* depthSets[] = { &uniformDepths, &bimodalDepths, &singleBinDepths };
+    for (std::vector<float>* pDepths : depthSets)
+    {
+        std::vector<float>& depths = *pDepths;
+        uint32_t histogram[binCount] = {};
+        CascadeMath::AccumulateDepthHistogram(depths.data(), depths.size(), minZ, maxZ, binCount, histogram);
+
+        uint64_t total = 0;
+        uint32_t firstOccupied = binCount, lastOccupied = 0;
+        for (uint32_t i = 0; i < binCount; ++i)
+        {
+            total += histogram[i];
+            if (histogram[i])
+            {
+                firstOccupied = (std::min)(firstOccupied, i);
+                lastOccupied = i;
+            }
+        }
+        checker.Check(total == depths.size(), "Histogram: sample count mismatch");
+        if (pDepths == &singleBinDepths)
+            checker.Check(firstOccupied == lastOccupied, "Histogram: single depth spans several bins");
+
+        std::sort(depths.begin(), depths.end());
+        for (float percentile : { 0.0f, 0.01f, 0.1f })
+        {
+            float outMinZ = 0.0f, outMaxZ = 0.0f;
+            bool valid = CascadeMath::ComputeDepthRangeFromHistogram(histogram, binCount, minZ, maxZ, percentile, outMinZ, outMaxZ);
+            checker.Check(valid, "Histogram: non-empty histogram rejected");
+            if (!valid)
+                continue;
+            checker.Check(outMinZ < outMaxZ, "Histogram: empty range");
+            // 保留的样本都在范围内
+            size_t skipped = (size_t)(total * percentile);
+            checker.Check(LessOrNearEqual(outMinZ, depths[skipped]) && LessOrNearEqual(depths[depths.size() - 1 - skipped], outMaxZ),
+                "Histogram: range misses kept samples");
+            // 范围不超出有样本的桶
+            checker.Check(LessOrNearEqual(getBinEdge(firstOccupied), outMinZ) && LessOrNearEqual(outMaxZ, getBinEdge(lastOccupied + 1)),
+                "Histogram: range exceeds occupied bins");
+            // 双峰分布去掉两端的样本后，两个峰都要保留
+            if (pDepths == &bimodalDepths)
+                checker.Check(outMinZ <= 10.0f && outMaxZ >= 100.0f, "Histogram: bimodal range drops a mode");
+        }
+    }
+
+    uint32_t emptyHistogram[binCount] = {};
+    float outMinZ = 0.0f, outMaxZ = 0.0f;
+    checker.Check(!CascadeMath::ComputeDepthRangeFromHistogram(emptyHistogram, binCount, minZ, maxZ, 0.01f, outMinZ, outMaxZ),
+        "Histogram: empty histogram accepted");
+
+    return checker.result;
+}
+
+CascadeCheckResult RunShadowCacheTest()
+{
+    CascadeChecker checker;
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto isNone = [](ShadowCacheInvalidation invalidation) {
+        return invalidation == ShadowCacheInvalidation::ShadowCacheInvalidation_None;
+    };
+
+    //
+    // 摄像机沿对角线平移，需要的范围与近/远平面带有少量抖动
+    //
+    constexpr uint32_t frameCount = 1000;
+    const float width = 50.0f, speed = 0.1f;
+    for (float guardBand : { 0.0f, 0.05f, 0.1f, 0.2f })
+    {
+        ShadowCacheRegion region{};
+        uint32_t rebuilds = 0;
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            float offset = frame * speed;
+            float size = width * (1.0f + 0.02f * (unit(rng) - 0.5f));
+            XMFLOAT4 rect(offset, 0.5f * offset, offset + size, 0.5f * offset + size);
+            float nearZ = 10.0f + unit(rng) - 0.5f, farZ = 200.0f + unit(rng) - 0.5f;
+
+            ShadowCacheInvalidation invalidation = frame ?
+                CascadeMath::CheckShadowCacheRegion(region, rect, nearZ, farZ, guardBand) :
+                ShadowCacheInvalidation::ShadowCacheInvalidation_Empty;
+            if (isNone(invalidation))
+            {
+                checker.Check(rect.x >= region.rect.x && rect.y >= region.rect.y && rect.z <= region.rect.z &&
+                    rect.w <= region.rect.w && nearZ >= region.nearZ && farZ <= region.farZ, "Panning: cache misses needed range");
+                continue;
+            }
+            ++rebuilds;
+            region = CascadeMath::BuildShadowCacheRegion(rect, nearZ, farZ, guardBand, 1024);
+            checker.Check(isNone(CascadeMath::CheckShadowCacheRegion(region, rect, nearZ, farZ, guardBand)),
+                "Panning: fresh region rejected");
+        }
+        // 每平移guardBand * width左右重新绘制一次
+        if (guardBand > 0.0f)
+            checker.Check(rebuilds <= 2.0f * frameCount * speed / (guardBand * width) + 1.0f, "Panning: too many rebuilds");
+    }
+
+    //
+    // 任意范围、分辨率与保护带下，新生成的缓存都可以直接使用
+    //
+    const uint32_t shadowSizes[] = { 512, 1024, 2048, 8192 };
+    for (uint32_t i = 0; i < 4000; ++i)
+    {
+        float guardBand = i % 8 ? 0.001f + 0.5f * unit(rng) : 0.0f;
+        float x = 2000.0f * unit(rng) - 1000.0f, y = 2000.0f * unit(rng) - 1000.0f;
+        XMFLOAT4 rect(x, y, x + 0.1f + 500.0f * unit(rng), y + 0.1f + 500.0f * unit(rng));
+        float nearZ = 1000.0f * unit(rng) - 500.0f, farZ = nearZ + 1000.0f * unit(rng);
+        ShadowCacheRegion region = CascadeMath::BuildShadowCacheRegion(rect, nearZ, farZ, guardBand, shadowSizes[i % 4]);
+        checker.Check(isNone(CascadeMath::CheckShadowCacheRegion(region, rect, nearZ, farZ, guardBand)),
+            "Fresh region rejected");
+    }
+
+    //
+    // 需要的范围缩小到缓存的一半
+    //
+    ShadowCacheRegion region = CascadeMath::BuildShadowCacheRegion(XMFLOAT4(0.0f, 0.0f, 100.0f, 100.0f), 0.0f, 1.0f, 0.1f, 1024);
+    checker.Check(CascadeMath::CheckShadowCacheRegion(region, XMFLOAT4(10.0f, 10.0f, 60.0f, 60.0f), 0.2f, 0.8f, 0.1f) ==
+        ShadowCacheInvalidation::ShadowCacheInvalidation_Resolution, "Shrink: not reported as Resolution");
+
+    //
+    // 与场景不相交的级联
+    //
+    region = CascadeMath::BuildShadowCacheRegion(XMFLOAT4(0.0f, 0.0f, 100.0f, 100.0f), FLT_MAX, -FLT_MAX, 0.1f, 1024);
+    checker.Check(region.nearZ == FLT_MAX && region.farZ == -FLT_MAX, "Empty near/far not preserved");
+    checker.Check(isNone(CascadeMath::CheckShadowCacheRegion(region, XMFLOAT4(0.0f, 0.0f, 100.0f, 100.0f), FLT_MAX, -FLT_MAX, 0.1f)),
+        "Empty near/far rejected");
+
+    //
+    // 光照方向绕垂直轴旋转容差的一半/两倍
+    //
+    for (float toleranceDegrees : { 0.1f, 0.5f, 1.0f, 5.0f, 30.0f })
+    {
+        float tolerance = XMConvertToRadians(toleranceDegrees);
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            XMVECTOR lightDir = XMVector3Normalize(XMVectorSet(unit(rng) - 0.5f, -0.1f - unit(rng), unit(rng) - 0.5f, 0.0f));
+            XMVECTOR axis = XMVector3Normalize(XMVector3Cross(lightDir, XMVectorSet(unit(rng) - 0.5f, 0.0f, 1.0f, 0.0f)));
+            XMVECTOR nearDir = XMVector3Rotate(lightDir, XMQuaternionRotationNormal(axis, 0.5f * tolerance));
+            XMVECTOR farDir = XMVector3Rotate(lightDir, XMQuaternionRotationNormal(axis, 2.0f * tolerance));
+            checker.Check(CascadeMath::IsLightDirectionWithinTolerance(lightDir, lightDir, tolerance), "Light: same direction rejected");
+            checker.Check(CascadeMath::IsLightDirectionWithinTolerance(lightDir, nearDir, tolerance), "Light: half tolerance rejected");
+            checker.Check(!CascadeMath::IsLightDirectionWithinTolerance(lightDir, farDir, tolerance), "Light: twice tolerance accepted");
+        }
+    }
+
+    return checker.result;
+}
@@ -0,0 +1,139 @@
+//***************************************************************************************
+// CascadeMath.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 级联阴影的纯数学部分：近/远平面求解与级联划分
+// Pure math for cascaded shadows: near/far planes and cascade partitioning.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef CASCADE_MATH_H
+#define CASCADE_MATH_H
+
+#include <DirectXMath.h>
+#include <cstdint>
+
+//
+// 场景包围盒的8个角点均位于光照空间，顺序与BoundingBox::GetCorners一致：
+//      7----6
+//     /|   /|
+//    3-+--2 |
+//    | 4--|-5
+//    |/   |/
+//    0----1
+// 其中0-3位于局部z = +1的面，4-7位于z = -1的面。由于光照空间变换是仿射变换，这8个点构成一个平行六面体
+//
+// 正交投影的范围用XMFLOAT4(minX, minY, maxX, maxY)表示，近/远平面为包围盒位于该XY范围内部分的最小/最大z值
+// 若包围盒与该范围不相交，则近平面为FLT_MAX，远平面为-FLT_MAX
+//
+
+//
+// 静态阴影缓存：静态物体只在缓存失效时绘制到缓存中，之后每帧复制缓存再叠加动态物体
+// 缓存生成时向四周多留一圈保护带，并在之后沿用缓存时的正交投影，只要需要的范围仍落在缓存内就不必重新绘制
+//
+
+// 级联的静态阴影缓存失效的原因
+enum class ShadowCacheInvalidation
+{
+    ShadowCacheInvalidation_None,               // 缓存仍然可用
+    ShadowCacheInvalidation_Empty,              // 尚未生成，或资源被重新创建
+    ShadowCacheInvalidation_Settings,           // 场景包围盒或级联配置改变
+    ShadowCacheInvalidation_LightDirection,     // 光照方向的变化超出容差
+    ShadowCacheInvalidation_OutOfBounds,        // 需要的范围超出了缓存的范围
+    ShadowCacheInvalidation_Resolution          // 缓存的范围比需要的大太多，分辨率下降明显
+};
+
+// 静态阴影缓存在光照空间下覆盖的范围
+struct ShadowCacheRegion
+{
+    DirectX::XMFLOAT4 rect;             // (minX, minY, maxX, maxY)
+    float nearZ;
+    float farZ;
+};
+
+namespace CascadeMath
+{
+    // 标量参考实现：把包围盒的12个三角形依次对正交投影的4个侧面进行裁剪，再求剩余三角形的z值范围
+    void XM_CALLCONV ComputeNearAndFarReference(float& outNearPlane, float& outFarPlane,
+        DirectX::FXMVECTOR lightCameraOrthographicMinVec,
+        DirectX::FXMVECTOR lightCameraOrthographicMaxVec,
+        const DirectX::XMVECTOR pointsInLightSpace[8]);
+
+    // 向量化的批量实现，每4个级联占用SIMD的4个通道。
+    // 凸多面体被XY范围截取后，z的极值只会出现在以下三类顶点上，逐类求出即可，不需要维护三角形列表：
+    // 1. 位于XY范围内的包围盒角点
+    // 2. 包围盒的12条棱与4个侧面的交点
+    // 3. XY范围的4个角所在的竖直线与包围盒6个面的交点
+    void ComputeNearAndFar(float outNearPlanes[], float outFarPlanes[],
+        const DirectX::XMFLOAT4 orthographicRects[], uint32_t cascadeCount,
+        const DirectX::XMVECTOR pointsInLightSpace[8]);
+
+    //
+    // 级联划分
+    //
+
+    // 实用划分(PSSM)：把视空间深度区间[nearZ, farZ]分成cascadeCount段，输出各段远端的深度
+    // 第i个分割点为均匀划分与对数划分的混合：lerp(n + (f - n) * i / N, n * (f / n)^(i / N), lambda)
+    // lambda为0时为均匀划分，为1时为对数划分；nearZ需大于0
+    void ComputePracticalSplits(float nearZ, float farZ, uint32_t cascadeCount, float lambda, float outSplits[]);
+
+    // 深度直方图的桶按对数划分：第i个桶统计视空间深度位于[minZ * r^i, minZ * r^(i + 1))的样本，r = (maxZ / minZ)^(1 / binCount)
+    // 这与对数划分一致，近处的桶更窄。minZ需大于0，超出[minZ, maxZ]的样本计入两端的桶
+    void AccumulateDepthHistogram(const float depths[], size_t count, float minZ, float maxZ,
+        uint32_t binCount, uint32_t histogram[]);
+    // 两端各忽略percentile比例的样本，返回剩余样本所在桶的深度范围。直方图为空时返回false
+    bool ComputeDepthRangeFromHistogram(const uint32_t histogram[], uint32_t binCount, float minZ, float maxZ,
+        float percentile, float& outMinZ, float& outMaxZ);
+
+    //
+    // 静态阴影缓存
+    //
+
+    // 由需要的范围生成缓存的范围：XY向四周各扩展guardBand倍的宽高，并对齐到缓存的texel；Z向两端各扩展guardBand倍的深度
+    ShadowCacheRegion BuildShadowCacheRegion(const DirectX::XMFLOAT4& rect, float nearZ, float farZ,
+        float guardBand, uint32_t shadowSize);
+    // 需要的范围完全落在缓存内，且缓存的宽高不超过需要的(1 + 4 * guardBand)倍时，缓存可以继续使用
+    ShadowCacheInvalidation CheckShadowCacheRegion(const ShadowCacheRegion& region, const DirectX::XMFLOAT4& rect,
+        float nearZ, float farZ, float guardBand);
+    // 两个单位长度的光照方向的夹角不超过toleranceRadians
+    bool XM_CALLCONV IsLightDirectionWithinTolerance(DirectX::FXMVECTOR cachedLightDir, DirectX::FXMVECTOR lightDir,
+        float toleranceRadians);
+}
+
+//
+// 性能测试
+//
+
+struct CascadeNearFarBenchmarkResult
+{
+    uint32_t numScenes;
+    uint32_t cascadeCount;
+    float referenceMs;                  // 逐级联调用标量参考实现的总耗时
+    float batchedMs;                    // 一次批量处理所有级联的总耗时
+    float maxError;                     // 两种实现的近/远平面的最大差值(相对于场景大小)
+    uint32_t emptyCount;                // 与场景不相交的级联数目
+};
+
+// 随机生成numScenes组光照方向、场景包围盒与级联范围，对比两种实现的结果与耗时
+CascadeNearFarBenchmarkResult RunCascadeNearFarBenchmark(uint32_t numScenes = 20000, uint32_t cascadeCount = 4);
+
+//
+// 正确性检查
+//
+
+struct CascadeCheckResult
+{
+    uint32_t numChecks;                 // 检查的条件总数
+    uint32_t numFailed;                 // 不满足的条件数目
+    const char* firstFailure;           // 第一个不满足的条件，全部满足时为nullptr
+};
+
+// 检查级联划分与深度直方图：各种lambda下分割点单调递增且最后一个为farZ；
+// 均匀、双峰、单桶与空直方图下，归约的深度范围覆盖保留的样本，且不超出有样本的桶
+CascadeCheckResult RunCascadeSplitTest();
+// 检查静态阴影缓存：摄像机平移时沿用的缓存始终覆盖需要的范围，且重新绘制的次数与保护带宽度相符；
+// 新生成的缓存总能通过检查；需要的范围明显缩小时返回Resolution；与场景不相交时保留空的近/远平面；光照方向的容差
+CascadeCheckResult RunShadowCacheTest();
+
+#endif
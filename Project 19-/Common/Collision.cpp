@@ -1,4 +1,5 @@
 #include "Collision.h"
+#include <algorithm>
 
 using namespace DirectX;
 
@@ -183,6 +184,146 @@ void XM_CALLCONV Collision::FrustumCulling(
     }
 }
 
+namespace
+{
+    const XMFLOAT3& GetPoint(const XMFLOAT3* points, size_t stride, size_t idx)
+    {
+        return *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const uint8_t*>(points) + idx * stride);
+    }
+
+    // 各边加上少量余量，使扁平网格的体积不为0，此时以面积区分优劣
+    float OrientedBoxVolume(const BoundingOrientedBox& box)
+    {
+        float eps = 1e-3f * (std::max)({ box.Extents.x, box.Extents.y, box.Extents.z });
+        return (box.Extents.x + eps) * (box.Extents.y + eps) * (box.Extents.z + eps);
+    }
+
+    // 给定一组正交基，计算点集在该基下的OBB，返回体积
+    float XM_CALLCONV FitOrientedBox(BoundingOrientedBox& box, FXMMATRIX axes, const XMFLOAT3* points, size_t count, size_t stride)
+    {
+        XMVECTOR vMin = g_XMFltMax;
+        XMVECTOR vMax = XMVectorNegate(g_XMFltMax);
+        // axes的行为OBB的三个轴，点乘axes的转置即得到各轴上的投影
+        XMMATRIX toLocal = XMMatrixTranspose(axes);
+        for (size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR P = XMVector3TransformNormal(XMLoadFloat3(&GetPoint(points, stride, i)), toLocal);
+            vMin = XMVectorMin(vMin, P);
+            vMax = XMVectorMax(vMax, P);
+        }
+
+        XMVECTOR localCenter = XMVectorScale(XMVectorAdd(vMin, vMax), 0.5f);
+        XMVECTOR extents = XMVectorScale(XMVectorSubtract(vMax, vMin), 0.5f);
+        XMStoreFloat3(&box.Center, XMVector3TransformNormal(localCenter, axes));
+        XMStoreFloat3(&box.Extents, extents);
+        XMStoreFloat4(&box.Orientation, XMQuaternionNormalize(XMQuaternionRotationMatrix(axes)));
+
+        return OrientedBoxVolume(box);
+    }
+
+    void XM_CALLCONV GrowSphere(XMVECTOR& center, float& radius, FXMVECTOR P)
+    {
+        XMVECTOR diff = XMVectorSubtract(P, center);
+        float dist = XMVectorGetX(XMVector3Length(diff));
+        if (dist <= radius)
+            return;
+        float newRadius = (radius + dist) * 0.5f;
+        center = XMVectorAdd(center, XMVectorScale(diff, (newRadius - radius) / dist));
+        radius = newRadius;
+    }
+}
+
+BoundingOrientedBox Collision::ComputeTightOrientedBox(const DirectX::XMFLOAT3* points, size_t count, size_t stride)
+{
+    BoundingOrientedBox bestBox;
+    if (!points || !count)
+        return bestBox;
+
+    // 初值：PCA(协方差矩阵特征向量)得到的OBB与AABB中较小者
+    BoundingOrientedBox::CreateFromPoints(bestBox, count, points, stride);
+    float bestVolume = OrientedBoxVolume(bestBox);
+    XMMATRIX bestAxes = XMMatrixRotationQuaternion(XMLoadFloat4(&bestBox.Orientation));
+
+    BoundingOrientedBox box;
+    float volume = FitOrientedBox(box, XMMatrixIdentity(), points, count, stride);
+    if (volume < bestVolume)
+    {
+        bestBox = box;
+        bestVolume = volume;
+        bestAxes = XMMatrixIdentity();
+    }
+
+    // 细化：依次绕OBB的三个轴旋转，由粗到细搜索体积最小的角度
+    static const float s_SearchRanges[] = { XM_PIDIV4, XMConvertToRadians(5.0f), XMConvertToRadians(0.5f) };
+    static const int s_SearchSteps = 10;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (float range : s_SearchRanges)
+            {
+                XMMATRIX baseAxes = bestAxes;
+                for (int step = -s_SearchSteps; step <= s_SearchSteps; ++step)
+                {
+                    if (step == 0)
+                        continue;
+                    float angle = range * step / s_SearchSteps;
+                    // 行向量约定下，每个轴右乘旋转矩阵即绕baseAxes.r[axis]旋转
+                    XMMATRIX axes = XMMatrixMultiply(baseAxes, XMMatrixRotationAxis(baseAxes.r[axis], angle));
+                    volume = FitOrientedBox(box, axes, points, count, stride);
+                    if (volume < bestVolume)
+                    {
+                        bestBox = box;
+                        bestVolume = volume;
+                        bestAxes = axes;
+                    }
+                }
+            }
+        }
+    }
+
+    return bestBox;
+}
+
+BoundingSphere Collision::ComputeTightSphere(const DirectX::XMFLOAT3* points, size_t count, size_t stride)
+{
+    BoundingSphere bestSphere;
+    if (!points || !count)
+        return bestSphere;
+
+    // 初值：Ritter包围球
+    BoundingSphere::CreateFromPoints(bestSphere, count, points, stride);
+
+    // 迭代：收缩半径后以随机顺序遍历点集重新扩张，保留最小的结果(Ericson, RTCD 4.3.5)
+    std::vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < (uint32_t)count; ++i)
+        order[i] = i;
+
+    uint32_t seed = 0x9E3779B9u;
+    static const int s_MaxIterations = 8;
+    XMVECTOR center = XMLoadFloat3(&bestSphere.Center);
+    float radius = bestSphere.Radius;
+    for (int iter = 0; iter < s_MaxIterations; ++iter)
+    {
+        radius *= 0.95f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            // 使用固定种子的LCG洗牌，保证结果可复现
+            seed = seed * 1664525u + 1013904223u;
+            size_t j = i + seed % (count - i);
+            std::swap(order[i], order[j]);
+            GrowSphere(center, radius, XMLoadFloat3(&GetPoint(points, stride, order[i])));
+        }
+        if (radius < bestSphere.Radius)
+        {
+            XMStoreFloat3(&bestSphere.Center, center);
+            bestSphere.Radius = radius;
+        }
+    }
+
+    return bestSphere;
+}
+
 Collision::WireFrameData Collision::CreateFromCorners(const DirectX::XMFLOAT3(&corners)[8], const DirectX::XMFLOAT4& color)
 {
 	WireFrameData data;
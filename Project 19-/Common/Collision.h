@@ -68,6 +68,15 @@ public:
         std::vector<Transform>& dest, const std::vector<Transform>& src, 
         const DirectX::BoundingBox& localBox, DirectX::FXMMATRIX View, DirectX::CXMMATRIX Proj);
 
+    //
+    // 紧凑包围体的计算
+    //
+
+    // 以PCA得到的OBB和AABB为初值，再绕各轴旋转搜索体积最小的OBB
+    static DirectX::BoundingOrientedBox ComputeTightOrientedBox(const DirectX::XMFLOAT3* points, size_t count, size_t stride = sizeof(DirectX::XMFLOAT3));
+    // 以Ritter包围球为初值，反复收缩再扩张得到接近最小的包围球
+    static DirectX::BoundingSphere ComputeTightSphere(const DirectX::XMFLOAT3* points, size_t count, size_t stride = sizeof(DirectX::XMFLOAT3));
+
 private:
 	static WireFrameData CreateFromCorners(const DirectX::XMFLOAT3(&corners)[8], const DirectX::XMFLOAT4& color);
 };
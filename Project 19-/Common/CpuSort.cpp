@@ -0,0 +1,339 @@
+#include "CpuSort.h"
+#include "ThreadPool.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#if defined(_XM_SSE_INTRINSICS_)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t NumBuckets = 256;
+    // 不超过该数目时插入排序比基数排序的直方图开销更小
+    constexpr size_t InsertionSortSize = 64;
+    // 并行时每个分块至少包含的元素数
+    constexpr size_t MinParallelChunkSize = 1 << 15;
+
+    using Histogram = std::array<size_t, NumBuckets>;
+
+    template<class Key>
+    uint32_t GetDigit(Key key, uint32_t pass)
+    {
+        return static_cast<uint32_t>(key >> (pass * 8)) & (NumBuckets - 1);
+    }
+
+    template<class Key, bool HasValues>
+    void InsertionSort(Key* pKeys, uint32_t* pValues, size_t count)
+    {
+        for (size_t i = 1; i < count; ++i)
+        {
+            Key key = pKeys[i];
+            uint32_t value = HasValues ? pValues[i] : 0;
+            size_t j = i;
+            for (; j > 0 && key < pKeys[j - 1]; --j)
+            {
+                pKeys[j] = pKeys[j - 1];
+                if (HasValues)
+                    pValues[j] = pValues[j - 1];
+            }
+            pKeys[j] = key;
+            if (HasValues)
+                pValues[j] = value;
+        }
+    }
+
+    template<class Key, bool HasValues>
+    void Scatter(const Key* pSrcKeys, const uint32_t* pSrcValues, Key* pDstKeys, uint32_t* pDstValues,
+        size_t begin, size_t end, uint32_t pass, Histogram& offsets)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            size_t dst = offsets[GetDigit(pSrcKeys[i], pass)]++;
+            pDstKeys[dst] = pSrcKeys[i];
+            if (HasValues)
+                pDstValues[dst] = pSrcValues[i];
+        }
+    }
+
+    template<class Key, bool HasValues>
+    void RadixSortSerial(Key* pKeys, uint32_t* pValues, size_t count)
+    {
+        constexpr uint32_t numPasses = sizeof(Key);
+
+        // 一次遍历统计所有趟的直方图，元素的多重集合在各趟之间不变
+        std::array<Histogram, numPasses> histograms{};
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (uint32_t pass = 0; pass < numPasses; ++pass)
+                ++histograms[pass][GetDigit(pKeys[i], pass)];
+        }
+
+        std::vector<Key> tempKeys(count);
+        std::vector<uint32_t> tempValues(HasValues ? count : 0);
+        Key* pSrcKeys = pKeys, * pDstKeys = tempKeys.data();
+        uint32_t* pSrcValues = pValues, * pDstValues = tempValues.data();
+        for (uint32_t pass = 0; pass < numPasses; ++pass)
+        {
+            const Histogram& histogram = histograms[pass];
+            if (histogram[GetDigit(pSrcKeys[0], pass)] == count)
+                continue;
+
+            Histogram offsets;
+            size_t sum = 0;
+            for (uint32_t b = 0; b < NumBuckets; ++b)
+            {
+                offsets[b] = sum;
+                sum += histogram[b];
+            }
+            Scatter<Key, HasValues>(pSrcKeys, pSrcValues, pDstKeys, pDstValues, 0, count, pass, offsets);
+            std::swap(pSrcKeys, pDstKeys);
+            std::swap(pSrcValues, pDstValues);
+        }
+
+        if (pSrcKeys != pKeys)
+        {
+            memcpy(pKeys, pSrcKeys, count * sizeof(Key));
+            if (HasValues)
+                memcpy(pValues, pSrcValues, count * sizeof(uint32_t));
+        }
+    }
+
+    template<class Key, bool HasValues>
+    void RadixSortParallel(Key* pKeys, uint32_t* pValues, size_t count, ThreadPool& threadPool)
+    {
+        constexpr uint32_t numPasses = sizeof(Key);
+        uint32_t numChunks = static_cast<uint32_t>((std::min)(
+            static_cast<size_t>(threadPool.GetThreadCount() + 1), count / MinParallelChunkSize));
+        if (numChunks <= 1)
+        {
+            RadixSortSerial<Key, HasValues>(pKeys, pValues, count);
+            return;
+        }
+        size_t chunkSize = (count + numChunks - 1) / numChunks;
+
+        // 首次遍历统计每个分块所有趟的直方图，合并后得到各趟的全局直方图
+        std::vector<std::array<Histogram, numPasses>> chunkHistograms(numChunks);
+        threadPool.ParallelFor(0, numChunks, 1, [&](uint32_t c0, uint32_t c1) {
+            for (uint32_t c = c0; c < c1; ++c)
+            {
+                auto& histograms = chunkHistograms[c];
+                histograms = {};
+                size_t end = (std::min)(count, (c + 1) * chunkSize);
+                for (size_t i = c * chunkSize; i < end; ++i)
+                {
+                    for (uint32_t pass = 0; pass < numPasses; ++pass)
+                        ++histograms[pass][GetDigit(pKeys[i], pass)];
+                }
+            }
+        });
+        std::array<Histogram, numPasses> histograms{};
+        for (uint32_t c = 0; c < numChunks; ++c)
+        {
+            for (uint32_t pass = 0; pass < numPasses; ++pass)
+                for (uint32_t b = 0; b < NumBuckets; ++b)
+                    histograms[pass][b] += chunkHistograms[c][pass][b];
+        }
+
+        std::vector<Key> tempKeys(count);
+        std::vector<uint32_t> tempValues(HasValues ? count : 0);
+        Key* pSrcKeys = pKeys, * pDstKeys = tempKeys.data();
+        uint32_t* pSrcValues = pValues, * pDstValues = tempValues.data();
+        std::vector<Histogram> chunkOffsets(numChunks);
+        bool isMoved = false;
+        for (uint32_t pass = 0; pass < numPasses; ++pass)
+        {
+            if (histograms[pass][GetDigit(pSrcKeys[0], pass)] == count)
+                continue;
+
+            // 元素已经被之前的趟移动过，需要重新统计各分块的直方图
+            if (isMoved)
+            {
+                threadPool.ParallelFor(0, numChunks, 1, [&](uint32_t c0, uint32_t c1) {
+                    for (uint32_t c = c0; c < c1; ++c)
+                    {
+                        Histogram& histogram = chunkHistograms[c][pass];
+                        histogram = {};
+                        size_t end = (std::min)(count, (c + 1) * chunkSize);
+                        for (size_t i = c * chunkSize; i < end; ++i)
+                            ++histogram[GetDigit(pSrcKeys[i], pass)];
+                    }
+                });
+            }
+
+            // 桶按序排列，同一个桶内按分块顺序排列，从而保持稳定
+            size_t sum = 0;
+            for (uint32_t b = 0; b < NumBuckets; ++b)
+            {
+                for (uint32_t c = 0; c < numChunks; ++c)
+                {
+                    chunkOffsets[c][b] = sum;
+                    sum += chunkHistograms[c][pass][b];
+                }
+            }
+
+            threadPool.ParallelFor(0, numChunks, 1, [&](uint32_t c0, uint32_t c1) {
+                for (uint32_t c = c0; c < c1; ++c)
+                {
+                    size_t end = (std::min)(count, (c + 1) * chunkSize);
+                    Scatter<Key, HasValues>(pSrcKeys, pSrcValues, pDstKeys, pDstValues,
+                        c * chunkSize, end, pass, chunkOffsets[c]);
+                }
+            });
+            isMoved = true;
+            std::swap(pSrcKeys, pDstKeys);
+            std::swap(pSrcValues, pDstValues);
+        }
+
+        if (pSrcKeys != pKeys)
+        {
+            threadPool.ParallelFor(0, numChunks, 1, [&](uint32_t c0, uint32_t c1) {
+                size_t begin = c0 * chunkSize, end = (std::min)(count, c1 * chunkSize);
+                memcpy(pKeys + begin, pSrcKeys + begin, (end - begin) * sizeof(Key));
+                if (HasValues)
+                    memcpy(pValues + begin, pSrcValues + begin, (end - begin) * sizeof(uint32_t));
+            });
+        }
+    }
+
+    template<class Key, bool HasValues>
+    void RadixSortImpl(Key* pKeys, uint32_t* pValues, size_t count, ThreadPool* pThreadPool)
+    {
+        if (count <= InsertionSortSize)
+            InsertionSort<Key, HasValues>(pKeys, pValues, count);
+        else if (pThreadPool)
+            RadixSortParallel<Key, HasValues>(pKeys, pValues, count, *pThreadPool);
+        else
+            RadixSortSerial<Key, HasValues>(pKeys, pValues, count);
+    }
+
+#if defined(_XM_SSE_INTRINSICS_)
+    // SSE2没有无符号比较，键在载入时翻转最高位后按有符号数比较
+
+    // 逐分量交换使a <= b
+    void CompareExchange(__m128i& a, __m128i& b)
+    {
+        __m128i swapMask = _mm_and_si128(_mm_cmpgt_epi32(a, b), _mm_xor_si128(a, b));
+        a = _mm_xor_si128(a, swapMask);
+        b = _mm_xor_si128(b, swapMask);
+    }
+
+    __m128i Reverse(__m128i v)
+    {
+        return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+
+    // 对双调的4个元素排序
+    __m128i BitonicClean(__m128i v)
+    {
+        // 比较(0, 2)和(1, 3)
+        __m128i lo = v, hi = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+        CompareExchange(lo, hi);
+        v = _mm_unpacklo_epi64(lo, hi);
+        // 比较(0, 1)和(2, 3)
+        lo = v, hi = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+        CompareExchange(lo, hi);
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)),
+            _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    // 合并两个有序的4元素向量
+    void Merge4(__m128i& a, __m128i& b)
+    {
+        b = Reverse(b);
+        CompareExchange(a, b);
+        a = BitonicClean(a);
+        b = BitonicClean(b);
+    }
+
+    // 合并两个有序的8元素序列(a0, a1)与(b0, b1)
+    void Merge8(__m128i& a0, __m128i& a1, __m128i& b0, __m128i& b1)
+    {
+        __m128i r0 = Reverse(b1), r1 = Reverse(b0);
+        CompareExchange(a0, r0);
+        CompareExchange(a1, r1);
+        CompareExchange(a0, a1);
+        CompareExchange(r0, r1);
+        a0 = BitonicClean(a0);
+        a1 = BitonicClean(a1);
+        b0 = BitonicClean(r0);
+        b1 = BitonicClean(r1);
+    }
+#endif
+}
+
+namespace CpuSort
+{
+    void RadixSort(uint32_t* pKeys, size_t count, ThreadPool* pThreadPool)
+    {
+        if (count <= SmallSortSize)
+            SortSmall(pKeys, count);
+        else
+            RadixSortImpl<uint32_t, false>(pKeys, nullptr, count, pThreadPool);
+    }
+
+    void RadixSort(uint64_t* pKeys, size_t count, ThreadPool* pThreadPool)
+    {
+        RadixSortImpl<uint64_t, false>(pKeys, nullptr, count, pThreadPool);
+    }
+
+    void RadixSort(uint32_t* pKeys, uint32_t* pValues, size_t count, ThreadPool* pThreadPool)
+    {
+        RadixSortImpl<uint32_t, true>(pKeys, pValues, count, pThreadPool);
+    }
+
+    void RadixSort(uint64_t* pKeys, uint32_t* pValues, size_t count, ThreadPool* pThreadPool)
+    {
+        RadixSortImpl<uint64_t, true>(pKeys, pValues, count, pThreadPool);
+    }
+
+    void SortSmall(uint32_t* pKeys, size_t count)
+    {
+        count = (std::min)(count, SmallSortSize);
+#if defined(_XM_SSE_INTRINSICS_)
+        if (count <= 1)
+            return;
+
+        // 不足16个时用最大值填充
+        alignas(16) uint32_t keys[16];
+        memcpy(keys, pKeys, count * sizeof(uint32_t));
+        std::fill(keys + count, keys + 16, UINT32_MAX);
+
+        __m128i signBit = _mm_set1_epi32(INT32_MIN);
+        __m128i r0 = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys)), signBit);
+        __m128i r1 = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + 4)), signBit);
+        __m128i r2 = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + 8)), signBit);
+        __m128i r3 = _mm_xor_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(keys + 12)), signBit);
+
+        // 4输入排序网络，4列同时进行
+        CompareExchange(r0, r1);
+        CompareExchange(r2, r3);
+        CompareExchange(r0, r2);
+        CompareExchange(r1, r3);
+        CompareExchange(r1, r2);
+
+        // 转置后每个向量为一列，均已有序
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t2 = _mm_unpackhi_epi32(r0, r1), t3 = _mm_unpackhi_epi32(r2, r3);
+        r0 = _mm_unpacklo_epi64(t0, t1);
+        r1 = _mm_unpackhi_epi64(t0, t1);
+        r2 = _mm_unpacklo_epi64(t2, t3);
+        r3 = _mm_unpackhi_epi64(t2, t3);
+
+        // 4+4 -> 8，8+8 -> 16
+        Merge4(r0, r1);
+        Merge4(r2, r3);
+        Merge8(r0, r1, r2, r3);
+
+        _mm_store_si128(reinterpret_cast<__m128i*>(keys), _mm_xor_si128(r0, signBit));
+        _mm_store_si128(reinterpret_cast<__m128i*>(keys + 4), _mm_xor_si128(r1, signBit));
+        _mm_store_si128(reinterpret_cast<__m128i*>(keys + 8), _mm_xor_si128(r2, signBit));
+        _mm_store_si128(reinterpret_cast<__m128i*>(keys + 12), _mm_xor_si128(r3, signBit));
+        memcpy(pKeys, keys, count * sizeof(uint32_t));
+#else
+        InsertionSort<uint32_t, false>(pKeys, nullptr, count);
+#endif
+    }
+}
@@ -0,0 +1,52 @@
+//***************************************************************************************
+// CpuSort.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// CPU端的基数排序与小规模排序网络
+// CPU radix sort and small sorting networks.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef CPU_SORT_H
+#define CPU_SORT_H
+
+#include <cstdint>
+#include <cstring>
+
+class ThreadPool;
+
+namespace CpuSort
+{
+    // 不超过该数目时使用排序网络
+    constexpr size_t SmallSortSize = 16;
+
+    // 升序的LSD基数排序，每趟8位，所有键都相同的趟会被跳过
+    // 排序是稳定的，键值对版本中值随键一起移动
+    // pThreadPool不为空时按线程数分块并行统计直方图与分发，结果与单线程相同
+    void RadixSort(uint32_t* pKeys, size_t count, ThreadPool* pThreadPool = nullptr);
+    void RadixSort(uint64_t* pKeys, size_t count, ThreadPool* pThreadPool = nullptr);
+    void RadixSort(uint32_t* pKeys, uint32_t* pValues, size_t count, ThreadPool* pThreadPool = nullptr);
+    void RadixSort(uint64_t* pKeys, uint32_t* pValues, size_t count, ThreadPool* pThreadPool = nullptr);
+
+    // 对不超过SmallSortSize个键排序：SSE2下使用4x4列排序网络加双调合并，否则退化为插入排序
+    void SortSmall(uint32_t* pKeys, size_t count);
+
+    // 把浮点数映射为保序的无符号整数，用于按深度等浮点键排序(-0.0f排在0.0f之前)
+    inline uint32_t FloatToKey(float f)
+    {
+        uint32_t u;
+        memcpy(&u, &f, sizeof u);
+        return u ^ ((u & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u);
+    }
+
+    inline float KeyToFloat(uint32_t key)
+    {
+        uint32_t u = key ^ ((key & 0x80000000u) ? 0x80000000u : 0xFFFFFFFFu);
+        float f;
+        memcpy(&f, &u, sizeof f);
+        return f;
+    }
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "FFT.h"
+#include "ThreadPool.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    XMVECTOR LoadFloat4(const float* p)
+    {
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p));
+    }
+
+    void XM_CALLCONV StoreFloat4(float* p, FXMVECTOR v)
+    {
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(p), v);
+    }
+}
+
+void FFT2D::Init(uint32_t size)
+{
+    assert(size >= 4 && (size & (size - 1)) == 0);
+    m_Size = size;
+
+    uint32_t log2Size = 0;
+    while ((1u << log2Size) < size)
+        ++log2Size;
+    m_BitReverse.resize(size);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        uint32_t r = 0;
+        for (uint32_t b = 0; b < log2Size; ++b)
+            r |= ((i >> b) & 1) << (log2Size - 1 - b);
+        m_BitReverse[i] = r;
+    }
+
+    m_Cos.resize(size / 2);
+    m_Sin.resize(size / 2);
+    for (uint32_t k = 0; k < size / 2; ++k)
+    {
+        double theta = 2.0 * 3.14159265358979323846 * k / size;
+        m_Cos[k] = static_cast<float>(cos(theta));
+        m_Sin[k] = static_cast<float>(sin(theta));
+    }
+}
+
+void FFT2D::Transform(float* pReal, float* pImag, bool inverse) const
+{
+    TransformColumns(pReal, pImag, inverse);
+    Transpose(pReal);
+    Transpose(pImag);
+    TransformColumns(pReal, pImag, inverse);
+    Transpose(pReal);
+    Transpose(pImag);
+}
+
+void FFT2D::TransformColumns(float* pReal, float* pImag, bool inverse) const
+{
+    uint32_t N = m_Size;
+    float sinSign = inverse ? 1.0f : -1.0f;
+
+    // 每个任务负责最多64列，蝶形运算时在行内连续访问这些列
+    ThreadPool::GetDefault().ParallelFor(0, N / 4, 16, [&](uint32_t g0, uint32_t g1) {
+        size_t c0 = g0 * 4, c1 = g1 * 4;
+
+        // 位反转置换
+        for (uint32_t i = 0; i < N; ++i)
+        {
+            uint32_t r = m_BitReverse[i];
+            if (i >= r)
+                continue;
+            for (size_t c = c0; c < c1; ++c)
+            {
+                std::swap(pReal[i * N + c], pReal[r * N + c]);
+                std::swap(pImag[i * N + c], pImag[r * N + c]);
+            }
+        }
+
+        for (uint32_t half = 1; half < N; half *= 2)
+        {
+            uint32_t step = N / (2 * half);
+            for (uint32_t start = 0; start < N; start += 2 * half)
+            {
+                for (uint32_t k = 0; k < half; ++k)
+                {
+                    XMVECTOR wr = XMVectorReplicate(m_Cos[k * step]);
+                    XMVECTOR wi = XMVectorReplicate(sinSign * m_Sin[k * step]);
+                    float* pAr = pReal + (size_t)(start + k) * N;
+                    float* pAi = pImag + (size_t)(start + k) * N;
+                    float* pBr = pReal + (size_t)(start + k + half) * N;
+                    float* pBi = pImag + (size_t)(start + k + half) * N;
+                    for (size_t c = c0; c < c1; c += 4)
+                    {
+                        XMVECTOR br = LoadFloat4(pBr + c), bi = LoadFloat4(pBi + c);
+                        XMVECTOR tr = XMVectorNegativeMultiplySubtract(wi, bi, XMVectorMultiply(wr, br));
+                        XMVECTOR ti = XMVectorMultiplyAdd(wi, br, XMVectorMultiply(wr, bi));
+                        XMVECTOR ar = LoadFloat4(pAr + c), ai = LoadFloat4(pAi + c);
+                        StoreFloat4(pAr + c, XMVectorAdd(ar, tr));
+                        StoreFloat4(pAi + c, XMVectorAdd(ai, ti));
+                        StoreFloat4(pBr + c, XMVectorSubtract(ar, tr));
+                        StoreFloat4(pBi + c, XMVectorSubtract(ai, ti));
+                    }
+                }
+            }
+        }
+    });
+}
+
+void FFT2D::Transpose(float* pData) const
+{
+    // 按32x32分块，每个任务负责一行块及其关于对角线对称的块
+    uint32_t N = m_Size;
+    uint32_t blockSize = (std::min)(N, 32u);
+    uint32_t numBlocks = N / blockSize;
+    ThreadPool::GetDefault().ParallelFor(0, numBlocks, 1, [&](uint32_t b0, uint32_t b1) {
+        for (uint32_t bi = b0; bi < b1; ++bi)
+        {
+            for (uint32_t bj = bi; bj < numBlocks; ++bj)
+            {
+                for (uint32_t i = bi * blockSize; i < (bi + 1) * blockSize; ++i)
+                {
+                    uint32_t jBegin = bi == bj ? i + 1 : bj * blockSize;
+                    for (uint32_t j = jBegin; j < (bj + 1) * blockSize; ++j)
+                        std::swap(pData[(size_t)i * N + j], pData[(size_t)j * N + i]);
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,42 @@
+//***************************************************************************************
+// FFT.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 多线程SIMD的二维复数FFT
+// Multithreaded SIMD 2D complex FFT.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <cstdint>
+#include <vector>
+
+// 对边长为N(2的幂且不小于4)的方阵做原址基2 FFT，实部与虚部分别按行优先存放在两个数组中
+// 列方向的变换一次处理相邻4列，行方向先转置成列方向再变换，列块分给线程池并行
+class FFT2D
+{
+public:
+    FFT2D() = default;
+    explicit FFT2D(uint32_t size) { Init(size); }
+
+    void Init(uint32_t size);
+    uint32_t GetSize() const { return m_Size; }
+
+    // 正变换使用e^{-i}核，逆变换使用e^{+i}核，结果均不做归一化
+    void Transform(float* pReal, float* pImag, bool inverse) const;
+    // 只沿列方向(即对每一列)做一维变换
+    void TransformColumns(float* pReal, float* pImag, bool inverse) const;
+    // 原址转置
+    void Transpose(float* pData) const;
+
+private:
+    uint32_t m_Size = 0;
+    std::vector<uint32_t> m_BitReverse;
+    std::vector<float> m_Cos;           // cos(2πk/N), k < N/2
+    std::vector<float> m_Sin;           // sin(2πk/N), k < N/2
+};
+
+#endif
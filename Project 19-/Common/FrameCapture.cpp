@@ -0,0 +1,190 @@
+#include "FrameCapture.h"
+#include "DDSLayout.h"
+#include "ScreenGrab11.h"
+#include "ThreadPool.h"
+#include <wincodec.h>
+#include <objbase.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace Microsoft::WRL;
+
+FrameCapture::~FrameCapture()
+{
+    if (m_pThreadPool)
+        m_pThreadPool->Wait();
+}
+
+void FrameCapture::Init(ID3D11Device* device, uint32_t ringSize, uint32_t latencyFrames, uint32_t numThreads)
+{
+    if (m_pThreadPool)
+        m_pThreadPool->Wait();
+
+    m_pDevice = device;
+    m_pResolveTexture.Reset();
+    m_Slots.clear();
+    m_Slots.resize((std::max)(ringSize, 1u));
+    m_pThreadPool = std::make_unique<ThreadPool>((std::max)(numThreads, 1u));
+    m_NextSlot = m_OldestSlot = 0;
+    m_LatencyFrames = latencyFrames;
+    // 限制已读回但尚未写完的帧数，避免写文件跟不上时内存无限增长
+    m_MaxPendingWrites = 2 * static_cast<uint32_t>(m_Slots.size());
+    m_FrameIndex = 0;
+    m_NumCaptured = m_NumDropped = m_NumBusySlots = 0;
+    m_NumWritten = m_NumFailed = m_NumWriting = 0;
+}
+
+bool FrameCapture::Capture(ID3D11DeviceContext* deviceContext, ID3D11Resource* pSource,
+    std::wstring_view fileName, FileFormat format)
+{
+    if (!m_pDevice || !deviceContext || !pSource)
+        return false;
+
+    ComPtr<ID3D11Texture2D> pTexture;
+    if (FAILED(pSource->QueryInterface(IID_PPV_ARGS(pTexture.GetAddressOf()))))
+        return false;
+
+    Slot& slot = m_Slots[m_NextSlot];
+    if (slot.busy || m_NumWriting >= m_MaxPendingWrites)
+    {
+        ++m_NumDropped;
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    pTexture->GetDesc(&desc);
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.MiscFlags = 0;
+
+    if (desc.SampleDesc.Count > 1)
+    {
+        // 多重采样的纹理需要先解析到单采样纹理
+        D3D11_TEXTURE2D_DESC resolveDesc = desc;
+        resolveDesc.SampleDesc = { 1, 0 };
+        resolveDesc.Usage = D3D11_USAGE_DEFAULT;
+        resolveDesc.BindFlags = 0;
+        resolveDesc.CPUAccessFlags = 0;
+
+        D3D11_TEXTURE2D_DESC currDesc{};
+        if (m_pResolveTexture)
+            m_pResolveTexture->GetDesc(&currDesc);
+        if (!m_pResolveTexture || currDesc.Width != desc.Width || currDesc.Height != desc.Height ||
+            currDesc.Format != desc.Format)
+        {
+            m_pResolveTexture.Reset();
+            if (FAILED(m_pDevice->CreateTexture2D(&resolveDesc, nullptr, m_pResolveTexture.GetAddressOf())))
+                return false;
+        }
+        deviceContext->ResolveSubresource(m_pResolveTexture.Get(), 0, pTexture.Get(), 0, desc.Format);
+        pTexture = m_pResolveTexture;
+        desc.SampleDesc = { 1, 0 };
+    }
+
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    // 尺寸或格式变化时重建staging纹理
+    if (!slot.pStaging || slot.desc.Width != desc.Width || slot.desc.Height != desc.Height ||
+        slot.desc.Format != desc.Format)
+    {
+        slot.pStaging.Reset();
+        if (FAILED(m_pDevice->CreateTexture2D(&desc, nullptr, slot.pStaging.GetAddressOf())))
+            return false;
+        slot.desc = desc;
+    }
+
+    deviceContext->CopySubresourceRegion(slot.pStaging.Get(), 0, 0, 0, 0, pTexture.Get(), 0, nullptr);
+    slot.fileName = fileName;
+    slot.format = format;
+    slot.copyFrame = m_FrameIndex;
+    slot.busy = true;
+
+    m_NextSlot = (m_NextSlot + 1) % static_cast<uint32_t>(m_Slots.size());
+    ++m_NumBusySlots;
+    ++m_NumCaptured;
+    return true;
+}
+
+void FrameCapture::Update(ID3D11DeviceContext* deviceContext)
+{
+    ReadBack(deviceContext, false);
+    ++m_FrameIndex;
+}
+
+void FrameCapture::Flush(ID3D11DeviceContext* deviceContext)
+{
+    ReadBack(deviceContext, true);
+    if (m_pThreadPool)
+        m_pThreadPool->Wait();
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+    Stats stats;
+    stats.numCaptured = m_NumCaptured;
+    stats.numWritten = m_NumWritten;
+    stats.numDropped = m_NumDropped;
+    stats.numFailed = m_NumFailed;
+    stats.numPending = m_NumBusySlots + m_NumWriting;
+    return stats;
+}
+
+void FrameCapture::ReadBack(ID3D11DeviceContext* deviceContext, bool wait)
+{
+    while (m_NumBusySlots)
+    {
+        Slot& slot = m_Slots[m_OldestSlot];
+        if (!wait && slot.copyFrame + m_LatencyFrames > m_FrameIndex)
+            break;
+
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        HRESULT hr = deviceContext->Map(slot.pStaging.Get(), 0, D3D11_MAP_READ,
+            wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+        // GPU还没完成拷贝，后面的槽更不可能完成，下一帧再试
+        if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+            break;
+
+        if (SUCCEEDED(hr))
+        {
+            size_t numRows = 0;
+            DDSLayout::GetSurfaceInfo(slot.desc.Width, slot.desc.Height, slot.desc.Format, nullptr, nullptr, &numRows);
+            std::vector<uint8_t> pixels(static_cast<size_t>(mapped.RowPitch) * numRows);
+            memcpy(pixels.data(), mapped.pData, pixels.size());
+            deviceContext->Unmap(slot.pStaging.Get(), 0);
+
+            ++m_NumWriting;
+            m_pThreadPool->Submit([this, desc = slot.desc, pixels = std::move(pixels), rowPitch = mapped.RowPitch,
+                fileName = std::move(slot.fileName), format = slot.format]() {
+                // WIC要求调用线程已初始化COM
+                HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+                HRESULT hrSave = E_FAIL;
+                switch (format)
+                {
+                case FileFormat::DDS: hrSave = DirectX::SaveDDSPixelsToFile(desc, pixels.data(), rowPitch, fileName.c_str()); break;
+                case FileFormat::PNG: hrSave = DirectX::SaveWICPixelsToFile(desc, pixels.data(), rowPitch, GUID_ContainerFormatPng, fileName.c_str()); break;
+                case FileFormat::JPEG: hrSave = DirectX::SaveWICPixelsToFile(desc, pixels.data(), rowPitch, GUID_ContainerFormatJpeg, fileName.c_str()); break;
+                case FileFormat::BMP: hrSave = DirectX::SaveWICPixelsToFile(desc, pixels.data(), rowPitch, GUID_ContainerFormatBmp, fileName.c_str()); break;
+                }
+                if (SUCCEEDED(hrCom))
+                    CoUninitialize();
+
+                if (SUCCEEDED(hrSave))
+                    ++m_NumWritten;
+                else
+                    ++m_NumFailed;
+                --m_NumWriting;
+            });
+        }
+        else
+        {
+            ++m_NumFailed;
+        }
+
+        slot.busy = false;
+        slot.fileName.clear();
+        m_OldestSlot = (m_OldestSlot + 1) % static_cast<uint32_t>(m_Slots.size());
+        --m_NumBusySlots;
+    }
+}
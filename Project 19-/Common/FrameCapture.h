@@ -0,0 +1,108 @@
+//***************************************************************************************
+// FrameCapture.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 基于staging纹理环形缓冲区的异步截图
+// Asynchronous frame capture with a ring of staging textures.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include "WinMin.h"
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ThreadPool;
+
+// 截图流程：
+// 1. Capture把源纹理拷贝到空闲的staging纹理后立即返回，不等待GPU
+// 2. 至少经过latencyFrames帧后，Update以D3D11_MAP_FLAG_DO_NOT_WAIT尝试Map，
+//    GPU尚未完成时留到下一帧再试，因此渲染线程不会被阻塞
+// 3. Map成功后把像素拷到内存中并立即归还staging纹理，编码和写文件交给后台线程
+// 没有空闲的staging纹理，或者待写入的帧过多时，新的截图会被丢弃而不是等待
+class FrameCapture
+{
+public:
+    enum class FileFormat
+    {
+        DDS,
+        PNG,
+        JPEG,
+        BMP
+    };
+
+    struct Stats
+    {
+        uint32_t numCaptured = 0;       // 已拷贝到staging纹理的帧数
+        uint32_t numWritten = 0;        // 已写入文件的帧数
+        uint32_t numDropped = 0;        // 因资源不足而丢弃的帧数
+        uint32_t numFailed = 0;         // Map或编码写入失败的帧数
+        uint32_t numPending = 0;        // 尚在GPU或后台线程中的帧数
+    };
+
+    FrameCapture() = default;
+    // 等待后台线程写完已经读回的帧，尚未读回的帧会被丢弃，需要的话先调用Flush
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // ringSize: staging纹理的数目
+    // latencyFrames: 拷贝后等待多少帧才开始尝试Map
+    // numThreads: 负责编码写文件的后台线程数，为1时文件按截图顺序写出
+    void Init(ID3D11Device* device, uint32_t ringSize = 4, uint32_t latencyFrames = 2, uint32_t numThreads = 1);
+
+    // 截取pSource的第0个子资源，多重采样的纹理会先解析
+    // 保存为PNG/JPEG/BMP时格式需要能被WIC编码；typeless格式只能保存为DDS
+    // 截图被丢弃时返回false
+    bool Capture(ID3D11DeviceContext* deviceContext, ID3D11Resource* pSource,
+        std::wstring_view fileName, FileFormat format = FileFormat::PNG);
+    // 每帧调用一次
+    void Update(ID3D11DeviceContext* deviceContext);
+    // 阻塞直到所有截图写入完毕
+    void Flush(ID3D11DeviceContext* deviceContext);
+
+    Stats GetStats() const;
+
+private:
+    struct Slot
+    {
+        Microsoft::WRL::ComPtr<ID3D11Texture2D> pStaging;
+        D3D11_TEXTURE2D_DESC desc{};
+        std::wstring fileName;
+        FileFormat format = FileFormat::PNG;
+        uint64_t copyFrame = 0;
+        bool busy = false;
+    };
+
+    // 按截图顺序读回已就绪的staging纹理，wait为true时阻塞等待GPU
+    void ReadBack(ID3D11DeviceContext* deviceContext, bool wait);
+
+    Microsoft::WRL::ComPtr<ID3D11Device> m_pDevice;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> m_pResolveTexture;
+    std::vector<Slot> m_Slots;
+    std::unique_ptr<ThreadPool> m_pThreadPool;
+
+    uint32_t m_NextSlot = 0;            // 下一次Capture使用的槽
+    uint32_t m_OldestSlot = 0;          // 最早的尚未读回的槽
+    uint32_t m_LatencyFrames = 2;
+    uint32_t m_MaxPendingWrites = 8;
+    uint64_t m_FrameIndex = 0;
+
+    uint32_t m_NumCaptured = 0;
+    uint32_t m_NumDropped = 0;
+    uint32_t m_NumBusySlots = 0;
+    std::atomic<uint32_t> m_NumWritten{};
+    std::atomic<uint32_t> m_NumFailed{};
+    std::atomic<uint32_t> m_NumWriting{};
+};
+
+#endif
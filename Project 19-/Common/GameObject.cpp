@@ -2,6 +2,9 @@
 #include "GameObject.h"
 #include "DXTrace.h"
 #include "ModelManager.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cfloat>
 
 using namespace DirectX;
 
@@ -11,6 +14,63 @@ struct InstancedData
     XMMATRIX worldInvTranspose;
 };
 
+GameObject::~GameObject()
+{
+    SetModel(nullptr);
+}
+
+GameObject::GameObject(const GameObject& other)
+    : m_SubModelInFrustum(other.m_SubModelInFrustum),
+    m_SubModelCascadeMasks(other.m_SubModelCascadeMasks),
+    m_CascadeMask(other.m_CascadeMask),
+    m_Transform(other.m_Transform),
+    m_InFrustum(other.m_InFrustum)
+{
+    SetModel(other.m_pModel);
+}
+
+GameObject& GameObject::operator=(const GameObject& other)
+{
+    if (this != &other)
+    {
+        SetModel(other.m_pModel);
+        m_SubModelInFrustum = other.m_SubModelInFrustum;
+        m_SubModelCascadeMasks = other.m_SubModelCascadeMasks;
+        m_CascadeMask = other.m_CascadeMask;
+        m_Transform = other.m_Transform;
+        m_InFrustum = other.m_InFrustum;
+    }
+    return *this;
+}
+
+GameObject::GameObject(GameObject&& other) noexcept
+    : m_pModel(other.m_pModel),
+    m_SubModelInFrustum(std::move(other.m_SubModelInFrustum)),
+    m_SubModelCascadeMasks(std::move(other.m_SubModelCascadeMasks)),
+    m_CascadeMask(other.m_CascadeMask),
+    m_Transform(std::move(other.m_Transform)),
+    m_InFrustum(other.m_InFrustum)
+{
+    // 引用随之转移
+    other.m_pModel = nullptr;
+}
+
+GameObject& GameObject::operator=(GameObject&& other) noexcept
+{
+    if (this != &other)
+    {
+        SetModel(nullptr);
+        m_pModel = other.m_pModel;
+        other.m_pModel = nullptr;
+        m_SubModelInFrustum = std::move(other.m_SubModelInFrustum);
+        m_SubModelCascadeMasks = std::move(other.m_SubModelCascadeMasks);
+        m_CascadeMask = other.m_CascadeMask;
+        m_Transform = std::move(other.m_Transform);
+        m_InFrustum = other.m_InFrustum;
+    }
+    return *this;
+}
+
 Transform& GameObject::GetTransform()
 {
     return m_Transform;
@@ -26,12 +86,23 @@ void GameObject::FrustumCulling(const BoundingFrustum& frustumInWorld)
     size_t sz = m_pModel->meshdatas.size();
     m_InFrustum = false;
     m_SubModelInFrustum.resize(sz);
+    XMMATRIX W = m_Transform.GetLocalToWorldMatrixXM();
     for (size_t i = 0; i < sz; ++i)
     {
-        BoundingOrientedBox box;
-        BoundingOrientedBox::CreateFromBoundingBox(box, m_pModel->meshdatas[i].m_BoundingBox);
-        box.Transform(box, m_Transform.GetLocalToWorldMatrixXM());
-        m_SubModelInFrustum[i] = frustumInWorld.Intersects(box);
+        const MeshData& meshData = m_pModel->meshdatas[i];
+        // 使用OBB和包围球中较紧凑的那个
+        if (meshData.m_UseBoundingSphere)
+        {
+            BoundingSphere sphere;
+            meshData.m_BoundingSphere.Transform(sphere, W);
+            m_SubModelInFrustum[i] = frustumInWorld.Intersects(sphere);
+        }
+        else
+        {
+            BoundingOrientedBox box;
+            meshData.m_BoundingOrientedBox.Transform(box, W);
+            m_SubModelInFrustum[i] = frustumInWorld.Intersects(box);
+        }
         m_InFrustum = m_InFrustum || m_SubModelInFrustum[i];
     }
 }
@@ -41,12 +112,22 @@ void GameObject::CubeCulling(const DirectX::BoundingOrientedBox& obbInWorld)
     size_t sz = m_pModel->meshdatas.size();
     m_InFrustum = false;
     m_SubModelInFrustum.resize(sz);
+    XMMATRIX W = m_Transform.GetLocalToWorldMatrixXM();
     for (size_t i = 0; i < sz; ++i)
     {
-        BoundingOrientedBox box;
-        BoundingOrientedBox::CreateFromBoundingBox(box, m_pModel->meshdatas[i].m_BoundingBox);
-        box.Transform(box, m_Transform.GetLocalToWorldMatrixXM());
-        m_SubModelInFrustum[i] = obbInWorld.Intersects(box);
+        const MeshData& meshData = m_pModel->meshdatas[i];
+        if (meshData.m_UseBoundingSphere)
+        {
+            BoundingSphere sphere;
+            meshData.m_BoundingSphere.Transform(sphere, W);
+            m_SubModelInFrustum[i] = obbInWorld.Intersects(sphere);
+        }
+        else
+        {
+            BoundingOrientedBox box;
+            meshData.m_BoundingOrientedBox.Transform(box, W);
+            m_SubModelInFrustum[i] = obbInWorld.Intersects(box);
+        }
         m_InFrustum = m_InFrustum || m_SubModelInFrustum[i];
     }
 }
@@ -56,17 +137,126 @@ void GameObject::CubeCulling(const DirectX::BoundingBox& aabbInWorld)
     size_t sz = m_pModel->meshdatas.size();
     m_InFrustum = false;
     m_SubModelInFrustum.resize(sz);
+    XMMATRIX W = m_Transform.GetLocalToWorldMatrixXM();
     for (size_t i = 0; i < sz; ++i)
     {
-        BoundingBox box;
-        m_pModel->meshdatas[i].m_BoundingBox.Transform(box, m_Transform.GetLocalToWorldMatrixXM());
-        m_SubModelInFrustum[i] = aabbInWorld.Intersects(box);
+        const MeshData& meshData = m_pModel->meshdatas[i];
+        if (meshData.m_UseBoundingSphere)
+        {
+            BoundingSphere sphere;
+            meshData.m_BoundingSphere.Transform(sphere, W);
+            m_SubModelInFrustum[i] = aabbInWorld.Intersects(sphere);
+        }
+        else
+        {
+            BoundingOrientedBox box;
+            meshData.m_BoundingOrientedBox.Transform(box, W);
+            m_SubModelInFrustum[i] = aabbInWorld.Intersects(box);
+        }
         m_InFrustum = m_InFrustum || m_SubModelInFrustum[i];
     }
 }
 
+size_t GameObject::GetSubModelInFrustumCount() const
+{
+    return std::count(m_SubModelInFrustum.begin(), m_SubModelInFrustum.end(), true);
+}
+
+size_t GameObject::CountInFrustumAABB(const DirectX::BoundingFrustum& frustumInWorld) const
+{
+    if (!m_pModel)
+        return 0;
+    size_t count = 0;
+    XMMATRIX W = m_Transform.GetLocalToWorldMatrixXM();
+    for (auto& meshData : m_pModel->meshdatas)
+    {
+        BoundingOrientedBox box;
+        BoundingOrientedBox::CreateFromBoundingBox(box, meshData.m_BoundingBox);
+        box.Transform(box, W);
+        count += frustumInWorld.Intersects(box);
+    }
+    return count;
+}
+
+void XM_CALLCONV GameObject::CascadeCulling(FXMMATRIX worldToLight, const BoundingBox cascadeBoxesInLight[],
+    uint32_t cascadeCount, bool sweepTowardLight)
+{
+    if (!m_pModel)
+        return;
+
+    size_t sz = m_pModel->meshdatas.size();
+    m_SubModelCascadeMasks.resize(sz);
+    m_CascadeMask = 0;
+
+    cascadeCount = (std::min)(cascadeCount, 32u);
+    XMVECTOR cascadeMins[32], cascadeMaxs[32];
+    for (uint32_t c = 0; c < cascadeCount; ++c)
+    {
+        XMVECTOR center = XMLoadFloat3(&cascadeBoxesInLight[c].Center);
+        XMVECTOR extents = XMLoadFloat3(&cascadeBoxesInLight[c].Extents);
+        cascadeMins[c] = XMVectorSubtract(center, extents);
+        cascadeMaxs[c] = XMVectorAdd(center, extents);
+        if (sweepTowardLight)
+            cascadeMins[c] = XMVectorSetZ(cascadeMins[c], -FLT_MAX);
+    }
+
+    XMMATRIX WL = m_Transform.GetLocalToWorldMatrixXM() * worldToLight;
+    // 包围球的半径按最大的缩放放大
+    XMVECTOR maxScaleVec = XMVectorSqrt(XMVectorMax(XMVectorMax(XMVector3LengthSq(WL.r[0]),
+        XMVector3LengthSq(WL.r[1])), XMVector3LengthSq(WL.r[2])));
+    for (size_t i = 0; i < sz; ++i)
+    {
+        const MeshData& meshData = m_pModel->meshdatas[i];
+        XMVECTOR center, extents;
+        if (meshData.m_UseBoundingSphere)
+        {
+            center = XMVector3Transform(XMLoadFloat3(&meshData.m_BoundingSphere.Center), WL);
+            extents = XMVectorScale(maxScaleVec, meshData.m_BoundingSphere.Radius);
+        }
+        else
+        {
+            // OBB在光照空间下的AABB：半长为OBB三个轴向半长的绝对值之和
+            const BoundingOrientedBox& box = meshData.m_BoundingOrientedBox;
+            XMMATRIX R = XMMatrixRotationQuaternion(XMLoadFloat4(&box.Orientation)) * WL;
+            center = XMVector3Transform(XMLoadFloat3(&box.Center), WL);
+            extents = XMVectorAbs(XMVectorScale(R.r[0], box.Extents.x));
+            extents = XMVectorAdd(extents, XMVectorAbs(XMVectorScale(R.r[1], box.Extents.y)));
+            extents = XMVectorAdd(extents, XMVectorAbs(XMVectorScale(R.r[2], box.Extents.z)));
+        }
+        XMVECTOR minVec = XMVectorSubtract(center, extents);
+        XMVECTOR maxVec = XMVectorAdd(center, extents);
+
+        uint32_t mask = 0;
+        for (uint32_t c = 0; c < cascadeCount; ++c)
+        {
+            if (XMVector3LessOrEqual(minVec, cascadeMaxs[c]) && XMVector3GreaterOrEqual(maxVec, cascadeMins[c]))
+                mask |= 1u << c;
+        }
+        m_SubModelCascadeMasks[i] = mask;
+        m_CascadeMask |= mask;
+    }
+}
+
+void GameObject::SelectCascade(uint32_t cascadeIndex)
+{
+    size_t sz = m_SubModelCascadeMasks.size();
+    m_SubModelInFrustum.resize(sz);
+    uint32_t bit = 1u << cascadeIndex;
+    for (size_t i = 0; i < sz; ++i)
+        m_SubModelInFrustum[i] = (m_SubModelCascadeMasks[i] & bit) != 0;
+    m_InFrustum = (m_CascadeMask & bit) != 0;
+}
+
 void GameObject::SetModel(const Model* pModel)
 {
+    if (pModel == m_pModel)
+        return;
+    // ModelManager可能先于GameObject析构
+    if (ModelManager::HasInstance())
+    {
+        ModelManager::Get().AddRef(pModel);
+        ModelManager::Get().Release(m_pModel);
+    }
     m_pModel = pModel;
 }
 
@@ -82,7 +272,7 @@ BoundingBox GameObject::GetLocalBoundingBox() const
 
 BoundingBox GameObject::GetLocalBoundingBox(size_t idx) const
 {
-    if (!m_pModel || m_pModel->meshdatas.size() >= idx)
+    if (!m_pModel || idx >= m_pModel->meshdatas.size())
         return DirectX::BoundingBox(DirectX::XMFLOAT3(), DirectX::XMFLOAT3());
     return m_pModel->meshdatas[idx].m_BoundingBox;
 }
@@ -98,7 +288,7 @@ BoundingBox GameObject::GetBoundingBox() const
 
 BoundingBox GameObject::GetBoundingBox(size_t idx) const
 {
-    if (!m_pModel || m_pModel->meshdatas.size() >= idx)
+    if (!m_pModel || idx >= m_pModel->meshdatas.size())
         return DirectX::BoundingBox(DirectX::XMFLOAT3(), DirectX::XMFLOAT3());
     BoundingBox box = m_pModel->meshdatas[idx].m_BoundingBox;
     box.Transform(box, m_Transform.GetLocalToWorldMatrixXM());
@@ -110,26 +300,82 @@ BoundingOrientedBox GameObject::GetBoundingOrientedBox() const
     if (!m_pModel)
         return DirectX::BoundingOrientedBox(DirectX::XMFLOAT3(), DirectX::XMFLOAT3(), DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
     BoundingOrientedBox obb;
-    BoundingOrientedBox::CreateFromBoundingBox(obb, m_pModel->boundingbox);
-    obb.Transform(obb, m_Transform.GetLocalToWorldMatrixXM());
+    m_pModel->boundingorientedbox.Transform(obb, m_Transform.GetLocalToWorldMatrixXM());
     return obb;
 }
+
 BoundingOrientedBox GameObject::GetBoundingOrientedBox(size_t idx) const
 {
-    if (!m_pModel || m_pModel->meshdatas.size() >= idx)
+    if (!m_pModel || idx >= m_pModel->meshdatas.size())
         return DirectX::BoundingOrientedBox(DirectX::XMFLOAT3(), DirectX::XMFLOAT3(), DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
     BoundingOrientedBox obb;
-    BoundingOrientedBox::CreateFromBoundingBox(obb, m_pModel->meshdatas[idx].m_BoundingBox);
-    obb.Transform(obb, m_Transform.GetLocalToWorldMatrixXM());
+    m_pModel->meshdatas[idx].m_BoundingOrientedBox.Transform(obb, m_Transform.GetLocalToWorldMatrixXM());
     return obb;
 }
 
+BoundingSphere GameObject::GetBoundingSphere() const
+{
+    if (!m_pModel)
+        return DirectX::BoundingSphere(DirectX::XMFLOAT3(), 0.0f);
+    BoundingSphere sphere;
+    m_pModel->boundingsphere.Transform(sphere, m_Transform.GetLocalToWorldMatrixXM());
+    return sphere;
+}
+
+BoundingSphere GameObject::GetBoundingSphere(size_t idx) const
+{
+    if (!m_pModel || idx >= m_pModel->meshdatas.size())
+        return DirectX::BoundingSphere(DirectX::XMFLOAT3(), 0.0f);
+    BoundingSphere sphere;
+    m_pModel->meshdatas[idx].m_BoundingSphere.Transform(sphere, m_Transform.GetLocalToWorldMatrixXM());
+    return sphere;
+}
+
+void GameObject::RequestTextureMips(const XMFLOAT3& eyePos, float projScale) const
+{
+    if (!m_pModel || !m_InFrustum)
+        return;
+
+    // UV密度在局部空间计算，需要换算到世界空间
+    XMFLOAT3 scale = m_Transform.GetScale();
+    float maxScale = (std::max)((std::max)(fabsf(scale.x), fabsf(scale.y)), fabsf(scale.z));
+    if (maxScale <= 0.0f)
+        return;
+
+    TextureManager& textureManager = TextureManager::Get();
+    XMVECTOR eyePosVec = XMLoadFloat3(&eyePos);
+    size_t sz = m_pModel->meshdatas.size();
+    size_t fsz = m_SubModelInFrustum.size();
+    for (size_t i = 0; i < sz; ++i)
+    {
+        const MeshData& meshData = m_pModel->meshdatas[i];
+        if ((i < fsz && !m_SubModelInFrustum[i]) || meshData.m_UVDensity <= 0.0f)
+            continue;
+
+        // 以包围球上离相机最近的点估算屏幕覆盖
+        BoundingSphere sphere = GetBoundingSphere(i);
+        float dist = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&sphere.Center), eyePosVec)));
+        dist = (std::max)(dist - sphere.Radius, 0.1f);
+        float uvPerPixel = meshData.m_UVDensity / maxScale * dist / projScale;
+
+        const Material& material = m_pModel->materials[meshData.m_MaterialIndex];
+        for (const char* key : Model::TextureKeys)
+        {
+            if (auto pStr = material.TryGet<std::string>(key))
+                textureManager.RequestMip(*pStr, uvPerPixel);
+        }
+    }
+}
+
 void GameObject::Draw(ID3D11DeviceContext * deviceContext, IEffect& effect)
 {
     if (!m_InFrustum || !deviceContext)
         return;
     size_t sz = m_pModel->meshdatas.size();
     size_t fsz = m_SubModelInFrustum.size();
+
+    // 合并后的子网格共享同一组缓冲区，连续绘制时只需要改变DrawIndexed的偏移
+    MeshDataInput lastInput;
     for (size_t i = 0; i < sz; ++i)
     {
         if (i < fsz && !m_SubModelInFrustum[i])
@@ -149,18 +395,59 @@ void GameObject::Draw(ID3D11DeviceContext * deviceContext, IEffect& effect)
 
         effect.Apply(deviceContext);
 
-        MeshDataInput input = pEffectMeshData->GetInputData(m_pModel->meshdatas[i]);
+        const MeshData& meshData = m_pModel->meshdatas[i];
+        MeshDataInput input = pEffectMeshData->GetInputData(meshData);
         {
-            deviceContext->IASetInputLayout(input.pInputLayout);
-            deviceContext->IASetPrimitiveTopology(input.topology);
-            deviceContext->IASetVertexBuffers(0, (uint32_t)input.pVertexBuffers.size(), 
-                input.pVertexBuffers.data(), input.strides.data(), input.offsets.data());
-            deviceContext->IASetIndexBuffer(input.pIndexBuffer, input.indexCount > 65535 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
+            if (input.pInputLayout != lastInput.pInputLayout)
+                deviceContext->IASetInputLayout(input.pInputLayout);
+            if (input.topology != lastInput.topology)
+                deviceContext->IASetPrimitiveTopology(input.topology);
+            if (input.pVertexBuffers != lastInput.pVertexBuffers || input.strides != lastInput.strides ||
+                input.offsets != lastInput.offsets)
+            {
+                deviceContext->IASetVertexBuffers(0, (uint32_t)input.pVertexBuffers.size(),
+                    input.pVertexBuffers.data(), input.strides.data(), input.offsets.data());
+            }
+            bool index32 = input.indexCount > 65535;
+            if (input.pIndexBuffer != lastInput.pIndexBuffer || index32 != (lastInput.indexCount > 65535))
+                deviceContext->IASetIndexBuffer(input.pIndexBuffer, index32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
 
-            deviceContext->DrawIndexed(input.indexCount, 0, 0);
+            deviceContext->DrawIndexed(input.indexCount, meshData.m_StartIndex, meshData.m_BaseVertex);
         }
-        
+        lastInput = std::move(input);
     }
 }
 
+void GameObject::DrawSubMesh(ID3D11DeviceContext* deviceContext, IEffect& effect, size_t idx,
+    uint32_t startIndex, uint32_t indexCount)
+{
+    if (!m_pModel || !deviceContext || idx >= m_pModel->meshdatas.size())
+        return;
+
+    IEffectMeshData* pEffectMeshData = dynamic_cast<IEffectMeshData*>(&effect);
+    if (!pEffectMeshData)
+        return;
 
+    const MeshData& meshData = m_pModel->meshdatas[idx];
+    IEffectMaterial* pEffectMaterial = dynamic_cast<IEffectMaterial*>(&effect);
+    if (pEffectMaterial)
+        pEffectMaterial->SetMaterial(m_pModel->materials[meshData.m_MaterialIndex]);
+
+    IEffectTransform* pEffectTransform = dynamic_cast<IEffectTransform*>(&effect);
+    if (pEffectTransform)
+        pEffectTransform->SetWorldMatrix(m_Transform.GetLocalToWorldMatrixXM());
+
+    effect.Apply(deviceContext);
+
+    MeshDataInput input = pEffectMeshData->GetInputData(meshData);
+    deviceContext->IASetInputLayout(input.pInputLayout);
+    deviceContext->IASetPrimitiveTopology(input.topology);
+    deviceContext->IASetVertexBuffers(0, (uint32_t)input.pVertexBuffers.size(),
+        input.pVertexBuffers.data(), input.strides.data(), input.offsets.data());
+    deviceContext->IASetIndexBuffer(input.pIndexBuffer, input.indexCount > 65535 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
+
+    if (startIndex >= input.indexCount)
+        return;
+    indexCount = (std::min)(indexCount, input.indexCount - startIndex);
+    deviceContext->DrawIndexed(indexCount, meshData.m_StartIndex + startIndex, meshData.m_BaseVertex);
+}
@@ -26,14 +26,15 @@ public:
     using ComPtr = Microsoft::WRL::ComPtr<T>;
 
 
+    // 持有模型期间会在ModelManager中增加其引用计数，使其不会被回收
     GameObject() = default;
-    ~GameObject() = default;
+    ~GameObject();
 
-    GameObject(const GameObject&) = default;
-    GameObject& operator=(const GameObject&) = default;
+    GameObject(const GameObject& other);
+    GameObject& operator=(const GameObject& other);
 
-    GameObject(GameObject&&) = default;
-    GameObject& operator=(GameObject&&) = default;
+    GameObject(GameObject&& other) noexcept;
+    GameObject& operator=(GameObject&& other) noexcept;
 
     // 获取物体变换
     Transform& GetTransform();
@@ -47,6 +48,21 @@ public:
     void CubeCulling(const DirectX::BoundingOrientedBox& obbInWorld);
     void CubeCulling(const DirectX::BoundingBox& aabbInWorld);
     bool InFrustum() const { return m_InFrustum; }
+    bool IsSubModelInFrustum(size_t idx) const { return idx >= m_SubModelInFrustum.size() || m_SubModelInFrustum[idx]; }
+    // 上一次裁剪后可见的子网格数目
+    size_t GetSubModelInFrustumCount() const;
+    // 使用AABB裁剪时可见的子网格数目，用于统计紧凑包围体减少的误判
+    size_t CountInFrustumAABB(const DirectX::BoundingFrustum& frustumInWorld) const;
+
+    // 一次性对所有级联进行阴影投射体裁剪。级联的范围是光照空间下的AABB，每个子网格的包围体只变换一次到光照空间，
+    // 求出AABB后与各级联比较，得到子网格的级联位掩码(最多32个级联)
+    // sweepTowardLight为true时，级联的范围沿-z方向(朝向光源)延伸到无穷远，位于级联与光源之间的投射体也会保留
+    void XM_CALLCONV CascadeCulling(DirectX::FXMMATRIX worldToLight, const DirectX::BoundingBox cascadeBoxesInLight[],
+        uint32_t cascadeCount, bool sweepTowardLight = false);
+    // 根据CascadeCulling的结果设置可见性，之后Draw只会绘制与第cascadeIndex个级联相交的子网格
+    void SelectCascade(uint32_t cascadeIndex);
+    uint32_t GetCascadeMask() const { return m_CascadeMask; }
+    uint32_t GetSubModelCascadeMask(size_t idx) const { return idx < m_SubModelCascadeMasks.size() ? m_SubModelCascadeMasks[idx] : 0; }
 
     //
     // 模型
@@ -60,6 +76,8 @@ public:
     DirectX::BoundingBox GetBoundingBox(size_t idx) const;
     DirectX::BoundingOrientedBox GetBoundingOrientedBox() const;
     DirectX::BoundingOrientedBox GetBoundingOrientedBox(size_t idx) const;
+    DirectX::BoundingSphere GetBoundingSphere() const;
+    DirectX::BoundingSphere GetBoundingSphere(size_t idx) const;
     //
     // 绘制
     //
@@ -71,10 +89,19 @@ public:
 
     // 绘制对象
     void Draw(ID3D11DeviceContext* deviceContext, IEffect& effect);
+    // 绘制第idx个子网格中从startIndex(相对于子网格)开始的indexCount个索引，不考虑裁剪结果
+    void DrawSubMesh(ID3D11DeviceContext* deviceContext, IEffect& effect, size_t idx,
+        uint32_t startIndex = 0, uint32_t indexCount = UINT32_MAX);
+
+    // 根据各可见子网格的屏幕覆盖与UV密度，向TextureManager请求材质纹理所需的mip等级
+    // projScale为视口高度 / (2 * tan(fovY / 2))，即单位距离处每单位长度对应的像素数
+    void RequestTextureMips(const DirectX::XMFLOAT3& eyePos, float projScale) const;
 
 protected:
     const Model* m_pModel = nullptr;
     std::vector<bool> m_SubModelInFrustum;
+    std::vector<uint32_t> m_SubModelCascadeMasks;
+    uint32_t m_CascadeMask = 0;
     Transform m_Transform = {};
     bool m_InFrustum = true;
 };
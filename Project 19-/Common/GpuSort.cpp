@@ -0,0 +1,100 @@
+#include "GpuSort.h"
+#include <d3dcompiler.h>
+#include <cstring>
+
+HRESULT GpuSort::InitResource(ID3D11Device* device, uint32_t maxCount, bool keyValue)
+{
+    m_Capacity = GpuSortSchedule::GetCapacity(maxCount);
+    m_KeyValue = keyValue;
+    m_ScheduleCount = 0;
+    m_Schedule.clear();
+
+    HRESULT hr;
+    m_pConstantBuffer = std::make_unique<Buffer>(device,
+        CD3D11_BUFFER_DESC(sizeof(CB), D3D11_BIND_CONSTANT_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE));
+    if (!m_pConstantBuffer->GetBuffer())
+        return E_FAIL;
+
+    // 创建数据缓冲区及其视图
+    for (auto& pDataBuffer : m_pDataBuffers)
+    {
+        if (keyValue)
+            pDataBuffer = std::make_unique<StructuredBuffer<GpuSortKeyValue>>(device, m_Capacity);
+        else
+            pDataBuffer = std::make_unique<TypedBuffer<DXGI_FORMAT_R32_UINT>>(device, m_Capacity);
+        if (!pDataBuffer->GetShaderResource() || !pDataBuffer->GetUnorderedAccess())
+            return E_FAIL;
+    }
+    m_pDataBuffers[0]->SetDebugObjectName("GpuSortDataBuffer");
+    m_pDataBuffers[1]->SetDebugObjectName("GpuSortTempBuffer");
+
+    // 创建计算着色器
+    struct { const wchar_t* name; ID3D11ComputeShader** ppCS; } shaders[] = {
+        { keyValue ? L"Shaders\\BitonicSortKV_CS.cso" : L"Shaders\\BitonicSort_CS.cso", m_pBitonicSort_CS.ReleaseAndGetAddressOf() },
+        { keyValue ? L"Shaders\\MatrixTransposeKV_CS.cso" : L"Shaders\\MatrixTranspose_CS.cso", m_pMatrixTranspose_CS.ReleaseAndGetAddressOf() },
+        { keyValue ? L"Shaders\\BitonicMergeKV_CS.cso" : L"Shaders\\BitonicMerge_CS.cso", m_pBitonicMerge_CS.ReleaseAndGetAddressOf() },
+    };
+    ComPtr<ID3DBlob> blob;
+    for (auto& shader : shaders)
+    {
+        if (FAILED(hr = D3DReadFileToBlob(shader.name, blob.ReleaseAndGetAddressOf())))
+            return hr;
+        if (FAILED(hr = device->CreateComputeShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, shader.ppCS)))
+            return hr;
+    }
+
+    return S_OK;
+}
+
+void GpuSort::Sort(ID3D11DeviceContext* deviceContext, uint32_t count, bool descending)
+{
+    if (count < 2 || count > m_Capacity)
+        return;
+
+    if (m_ScheduleCount != count)
+    {
+        m_Schedule = GpuSortSchedule::Build(count);
+        m_ScheduleCount = count;
+    }
+
+    ID3D11ShaderResourceView* nullSRV = nullptr;
+    ID3D11UnorderedAccessView* nullUAV = nullptr;
+    ID3D11Buffer* pConstantBuffer = m_pConstantBuffer->GetBuffer();
+    deviceContext->CSSetConstantBuffers(0, 1, &pConstantBuffer);
+    for (const GpuSortPass& pass : m_Schedule)
+    {
+        SetConstants(deviceContext, pass, descending);
+        // 先解除SRV绑定，避免同一缓冲区同时作为输入和输出
+        deviceContext->CSSetShaderResources(0, 1, &nullSRV);
+        ID3D11UnorderedAccessView* pDstUAV = m_pDataBuffers[pass.dstBuffer]->GetUnorderedAccess();
+        deviceContext->CSSetUnorderedAccessViews(0, 1, &pDstUAV, nullptr);
+        switch (pass.type)
+        {
+        case GpuSortPass::Type::Sort:
+            deviceContext->CSSetShader(m_pBitonicSort_CS.Get(), nullptr, 0);
+            break;
+        case GpuSortPass::Type::Transpose:
+        {
+            ID3D11ShaderResourceView* pSrcSRV = m_pDataBuffers[pass.srcBuffer]->GetShaderResource();
+            deviceContext->CSSetShader(m_pMatrixTranspose_CS.Get(), nullptr, 0);
+            deviceContext->CSSetShaderResources(0, 1, &pSrcSRV);
+            break;
+        }
+        case GpuSortPass::Type::Merge:
+            deviceContext->CSSetShader(m_pBitonicMerge_CS.Get(), nullptr, 0);
+            break;
+        }
+        deviceContext->Dispatch(pass.threadGroupsX, pass.threadGroupsY, 1);
+    }
+
+    deviceContext->CSSetShaderResources(0, 1, &nullSRV);
+    deviceContext->CSSetUnorderedAccessViews(0, 1, &nullUAV, nullptr);
+}
+
+void GpuSort::SetConstants(ID3D11DeviceContext* deviceContext, const GpuSortPass& pass, bool descending)
+{
+    CB cb = { pass.level, pass.descendMask, pass.matrixWidth, pass.matrixHeight,
+        pass.count, descending ? 1u : 0u, pass.step, 0 };
+    memcpy_s(m_pConstantBuffer->MapDiscard(deviceContext), sizeof cb, &cb, sizeof cb);
+    m_pConstantBuffer->Unmap(deviceContext);
+}
@@ -0,0 +1,75 @@
+//***************************************************************************************
+// GpuSort.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 基于双调排序的GPU排序，支持任意元素数目、键值对与升降序
+// GPU bitonic sort supporting arbitrary counts, key-value pairs and both orders.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef GPU_SORT_H
+#define GPU_SORT_H
+
+#include <memory>
+#include "WinMin.h"
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include "Buffer.h"
+#include "GpuSortSchedule.h"
+
+// 着色器位于Common/Shaders，使用者需要把它们编译到自己的Shaders目录下
+class GpuSort
+{
+public:
+    template <class T>
+    using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+    // keyValue为true时元素为(键, 值)的StructuredBuffer<uint2>，否则为R32_UINT的Buffer<uint>
+    // 缓冲区容量为GpuSortSchedule::GetCapacity(maxCount)
+    HRESULT InitResource(ID3D11Device* device, uint32_t maxCount, bool keyValue);
+
+    // 对数据缓冲区中前count个元素排序，结果仍位于前count个元素
+    // 之后的元素会被填充值覆盖
+    void Sort(ID3D11DeviceContext* deviceContext, uint32_t count, bool descending = false);
+
+    // 数据缓冲区，可用CopySubresourceRegion写入/读出，或绑定到其它着色器
+    ID3D11Buffer* GetBuffer() const { return m_pDataBuffers[0]->GetBuffer(); }
+    ID3D11ShaderResourceView* GetShaderResource() const { return m_pDataBuffers[0]->GetShaderResource(); }
+    ID3D11UnorderedAccessView* GetUnorderedAccess() const { return m_pDataBuffers[0]->GetUnorderedAccess(); }
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetElementSize() const { return m_KeyValue ? sizeof(GpuSortKeyValue) : sizeof(uint32_t); }
+    bool IsKeyValue() const { return m_KeyValue; }
+
+private:
+    struct CB
+    {
+        UINT level;
+        UINT descendMask;
+        UINT matrixWidth;
+        UINT matrixHeight;
+        UINT count;
+        UINT sortDescending;
+        UINT step;
+        UINT pad;
+    };
+
+    void SetConstants(ID3D11DeviceContext* deviceContext, const GpuSortPass& pass, bool descending);
+
+private:
+    uint32_t m_Capacity = 0;
+    bool m_KeyValue = false;
+
+    uint32_t m_ScheduleCount = 0;                           // m_Schedule对应的元素数目
+    std::vector<GpuSortPass> m_Schedule;
+
+    std::unique_ptr<Buffer> m_pConstantBuffer;              // 常量缓冲区
+    std::unique_ptr<Buffer> m_pDataBuffers[2];              // 数据缓冲区与转置用的缓冲区
+
+    ComPtr<ID3D11ComputeShader> m_pBitonicSort_CS;
+    ComPtr<ID3D11ComputeShader> m_pMatrixTranspose_CS;
+    ComPtr<ID3D11ComputeShader> m_pBitonicMerge_CS;
+};
+
+#endif
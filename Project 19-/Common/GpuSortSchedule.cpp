@@ -0,0 +1,195 @@
+#include "GpuSortSchedule.h"
+#include <algorithm>
+
+namespace
+{
+    GpuSortPass MakeSortPass(uint32_t capacity, uint32_t level, uint32_t descendMask, uint32_t buffer)
+    {
+        return GpuSortPass{ GpuSortPass::Type::Sort, level, descendMask, 0, 0, capacity, 0, buffer, buffer,
+            capacity / BITONIC_BLOCK_SIZE, 1 };
+    }
+
+    inline bool IsOrdered(uint32_t lhs, uint32_t rhs)
+    {
+        return lhs <= rhs;
+    }
+
+    inline bool IsOrdered(const GpuSortKeyValue& lhs, const GpuSortKeyValue& rhs)
+    {
+        return lhs.key < rhs.key || (lhs.key == rhs.key && lhs.value <= rhs.value);
+    }
+
+    inline void GetPadElement(bool descending, uint32_t& elem)
+    {
+        elem = descending ? 0 : UINT32_MAX;
+    }
+
+    inline void GetPadElement(bool descending, GpuSortKeyValue& elem)
+    {
+        elem.key = elem.value = descending ? 0 : UINT32_MAX;
+    }
+
+    // 与BitonicSort_CS一致：每个线程先读取同一份共享数据再同时写回
+    template<class T>
+    void SimulateSort(const GpuSortPass& pass, T* pData, bool descending)
+    {
+        T shared[BITONIC_BLOCK_SIZE], results[BITONIC_BLOCK_SIZE];
+        for (uint32_t group = 0; group < pass.threadGroupsX; ++group)
+        {
+            uint32_t base = group * BITONIC_BLOCK_SIZE;
+            for (uint32_t GI = 0; GI < BITONIC_BLOCK_SIZE; ++GI)
+            {
+                if (base + GI < pass.count)
+                    shared[GI] = pData[base + GI];
+                else
+                    GetPadElement(descending, shared[GI]);
+            }
+
+            for (uint32_t j = pass.level >> 1; j > 0; j >>= 1)
+            {
+                for (uint32_t GI = 0; GI < BITONIC_BLOCK_SIZE; ++GI)
+                {
+                    uint32_t smallerIndex = GI & ~j;
+                    uint32_t largerIndex = GI | j;
+                    bool isSmallerIndex = (GI == smallerIndex);
+                    bool isDescending = ((pass.descendMask & (base + GI)) != 0) != descending;
+                    results[GI] = (IsOrdered(shared[smallerIndex], shared[largerIndex]) == (isDescending == isSmallerIndex)) ?
+                        shared[largerIndex] : shared[smallerIndex];
+                }
+                std::copy(results, results + BITONIC_BLOCK_SIZE, shared);
+            }
+
+            std::copy(shared, shared + BITONIC_BLOCK_SIZE, pData + base);
+        }
+    }
+
+    // 与MatrixTranspose_CS一致
+    template<class T>
+    void SimulateTranspose(const GpuSortPass& pass, const T* pInput, T* pData)
+    {
+        uint32_t width = pass.threadGroupsX * TRANSPOSE_BLOCK_SIZE;
+        uint32_t height = pass.threadGroupsY * TRANSPOSE_BLOCK_SIZE;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint32_t outX = y % pass.matrixHeight + x / pass.matrixHeight * pass.matrixHeight;
+                uint32_t outY = x % pass.matrixHeight + y / pass.matrixHeight * pass.matrixHeight;
+                pData[outY * pass.matrixWidth + outX] = pInput[y * pass.matrixWidth + x];
+            }
+        }
+    }
+
+    // 与BitonicMerge_CS一致：每个线程负责下标第step位为0的元素与其对应元素的比较交换
+    template<class T>
+    void SimulateMerge(const GpuSortPass& pass, T* pData, bool descending)
+    {
+        uint32_t numThreads = pass.threadGroupsX * BITONIC_BLOCK_SIZE;
+        for (uint32_t t = 0; t < numThreads; ++t)
+        {
+            uint32_t lowBits = t & (pass.step - 1);
+            uint32_t smallerIndex = ((t - lowBits) << 1) | lowBits;
+            uint32_t largerIndex = smallerIndex | pass.step;
+            bool isDescending = ((pass.descendMask & smallerIndex) != 0) != descending;
+            T& a = pData[smallerIndex];
+            T& b = pData[largerIndex];
+            if (isDescending ? !IsOrdered(b, a) : !IsOrdered(a, b))
+                std::swap(a, b);
+        }
+    }
+
+    template<class T>
+    void SimulateImpl(const std::vector<GpuSortPass>& passes, T* pBuffers[2], bool descending)
+    {
+        for (const GpuSortPass& pass : passes)
+        {
+            switch (pass.type)
+            {
+            case GpuSortPass::Type::Sort: SimulateSort(pass, pBuffers[pass.dstBuffer], descending); break;
+            case GpuSortPass::Type::Transpose: SimulateTranspose(pass, pBuffers[pass.srcBuffer], pBuffers[pass.dstBuffer]); break;
+            case GpuSortPass::Type::Merge: SimulateMerge(pass, pBuffers[pass.dstBuffer], descending); break;
+            }
+        }
+    }
+}
+
+uint32_t GpuSortSchedule::GetCapacity(uint32_t count)
+{
+    uint32_t capacity = BITONIC_BLOCK_SIZE;
+    while (capacity < count)
+        capacity *= 2;
+    return capacity;
+}
+
+std::vector<GpuSortPass> GpuSortSchedule::Build(uint32_t count)
+{
+    uint32_t size = GetCapacity(count);
+    std::vector<GpuSortPass> passes;
+
+    // 先在线程组内排序level <= BLOCK_SIZE 的所有情况，第一趟顺便填充count之后的元素
+    for (uint32_t level = 2; level <= BITONIC_BLOCK_SIZE; level *= 2)
+    {
+        passes.push_back(MakeSortPass(size, level, level, 0));
+        if (level == 2)
+            passes.back().count = count;
+    }
+
+    // 计算相近的矩阵宽高(宽>=高且需要都为2的次幂)
+    uint32_t matrixWidth = 2, matrixHeight = 2;
+    while (matrixWidth * matrixWidth < size)
+        matrixWidth *= 2;
+    matrixHeight = size / matrixWidth;
+
+    if (matrixWidth <= BITONIC_BLOCK_SIZE)
+    {
+        // 转置后列方向的比较变为线程组内的比较
+        for (uint32_t level = BITONIC_BLOCK_SIZE * 2; level <= size; level *= 2)
+        {
+            GpuSortPass transpose{ GpuSortPass::Type::Transpose, level / matrixWidth,
+                level == size ? level : level / matrixWidth, matrixWidth, matrixHeight, size, 0, 0, 1,
+                matrixWidth / TRANSPOSE_BLOCK_SIZE, matrixHeight / TRANSPOSE_BLOCK_SIZE };
+            passes.push_back(transpose);
+            passes.push_back(transpose);
+            passes.back().type = GpuSortPass::Type::Sort;
+            passes.back().srcBuffer = 1;
+            passes.back().threadGroupsX = size / BITONIC_BLOCK_SIZE;
+            passes.back().threadGroupsY = 1;
+
+            // 转置回来后排序剩余的行数据
+            transpose.level = matrixWidth;
+            transpose.descendMask = level;
+            transpose.srcBuffer = 1;
+            transpose.dstBuffer = 0;
+            passes.push_back(transpose);
+            passes.push_back(MakeSortPass(size, matrixWidth, level, 0));
+            passes.back().matrixWidth = matrixWidth;
+            passes.back().matrixHeight = matrixHeight;
+        }
+    }
+    else
+    {
+        // 大于BLOCK_SIZE的步长在全局内存中逐步比较交换，其余步长在线程组内完成
+        for (uint32_t level = BITONIC_BLOCK_SIZE * 2; level <= size; level *= 2)
+        {
+            for (uint32_t step = level / 2; step >= BITONIC_BLOCK_SIZE; step /= 2)
+            {
+                GpuSortPass merge{ GpuSortPass::Type::Merge, level, level, 0, 0, size, step, 0, 0,
+                    size / 2 / BITONIC_BLOCK_SIZE, 1 };
+                passes.push_back(merge);
+            }
+            passes.push_back(MakeSortPass(size, BITONIC_BLOCK_SIZE, level, 0));
+        }
+    }
+
+    return passes;
+}
+
+void GpuSortSchedule::Simulate(const std::vector<GpuSortPass>& passes, uint32_t* pBuffers[2], bool descending)
+{
+    SimulateImpl(passes, pBuffers, descending);
+}
+
+void GpuSortSchedule::Simulate(const std::vector<GpuSortPass>& passes, GpuSortKeyValue* pBuffers[2], bool descending)
+{
+    SimulateImpl(passes, pBuffers, descending);
+}
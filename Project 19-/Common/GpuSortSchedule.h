@@ -0,0 +1,67 @@
+//***************************************************************************************
+// GpuSortSchedule.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// GPU双调排序的调度计划，以及按着色器逻辑执行的CPU模拟
+// Dispatch schedule of the GPU bitonic sort and its scalar CPU simulation.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef GPU_SORT_SCHEDULE_H
+#define GPU_SORT_SCHEDULE_H
+
+#include <cstdint>
+#include <vector>
+
+// 与着色器中的定义保持一致
+constexpr uint32_t BITONIC_BLOCK_SIZE = 512;
+constexpr uint32_t TRANSPOSE_BLOCK_SIZE = 16;
+
+struct GpuSortPass
+{
+    enum class Type
+    {
+        Sort,           // 线程组内对BITONIC_BLOCK_SIZE个元素从步长level/2开始做双调合并
+        Transpose,      // 以matrixHeight x matrixHeight的方块为单位转置
+        Merge           // 全局的一步比较交换，步长为step
+    };
+
+    Type type;
+    // 与着色器常量缓冲区中的字段一一对应
+    uint32_t level;
+    uint32_t descendMask;       // 下标与其相与不为0的元素处于降序序列
+    uint32_t matrixWidth;
+    uint32_t matrixHeight;
+    uint32_t count;             // 不小于该下标的元素视为填充，仅第一趟小于容量
+    uint32_t step;
+    // Transpose从srcBuffer读取，所有类型都写入dstBuffer
+    uint32_t srcBuffer;
+    uint32_t dstBuffer;
+    uint32_t threadGroupsX;
+    uint32_t threadGroupsY;
+};
+
+struct GpuSortKeyValue
+{
+    uint32_t key;
+    uint32_t value;
+};
+
+namespace GpuSortSchedule
+{
+    // 排序时实际使用的元素数目：不小于count的2的次幂，且不小于BITONIC_BLOCK_SIZE
+    uint32_t GetCapacity(uint32_t count);
+
+    // 生成对前count个元素排序的所有趟，结果位于缓冲区0
+    // 容量不超过BITONIC_BLOCK_SIZE^2时使用矩阵转置把大步长的比较变为线程组内的比较，
+    // 否则大于BITONIC_BLOCK_SIZE的步长逐步在全局内存中比较交换
+    std::vector<GpuSortPass> Build(uint32_t count);
+
+    // 按着色器的逻辑逐趟执行，pBuffers[0]与pBuffers[1]均有GetCapacity(count)个元素
+    // 键值对先比较键再比较值；填充元素在升序时为最大值，降序时为0
+    void Simulate(const std::vector<GpuSortPass>& passes, uint32_t* pBuffers[2], bool descending);
+    void Simulate(const std::vector<GpuSortPass>& passes, GpuSortKeyValue* pBuffers[2], bool descending);
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "Image.h"
+#include "DDSLayout.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+bool Image::Initialize(DXGI_FORMAT fmt, uint32_t width, uint32_t height, const void* pixels, uint32_t srcRowPitch)
+{
+    format = fmt;
+    levels.clear();
+    uint32_t rowPitch, slicePitch;
+    if (!width || !height || !ComputePitch(format, width, height, rowPitch, slicePitch))
+        return false;
+
+    Level& level = AddLevel(width, height);
+    if (pixels)
+    {
+        uint32_t numRows = slicePitch / rowPitch;
+        if (!srcRowPitch)
+            srcRowPitch = rowPitch;
+        for (uint32_t y = 0; y < numRows; ++y)
+            memcpy(level.pixels.data() + (size_t)y * rowPitch,
+                reinterpret_cast<const uint8_t*>(pixels) + (size_t)y * srcRowPitch, rowPitch);
+    }
+    return true;
+}
+
+Image::Level& Image::AddLevel(uint32_t width, uint32_t height)
+{
+    Level level;
+    uint32_t slicePitch = 0;
+    level.width = width;
+    level.height = height;
+    ComputePitch(format, width, height, level.rowPitch, slicePitch);
+    level.pixels.resize(slicePitch);
+    levels.push_back(std::move(level));
+    return levels.back();
+}
+
+size_t Image::GetByteSize() const
+{
+    size_t bytes = 0;
+    for (auto& level : levels)
+        bytes += level.pixels.size();
+    return bytes;
+}
+
+bool Image::ComputePitch(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t& rowPitch, uint32_t& slicePitch)
+{
+    size_t numBytes = 0, rowBytes = 0;
+    if (FAILED(DDSLayout::GetSurfaceInfo(width, height, format, &numBytes, &rowBytes, nullptr)) ||
+        numBytes > UINT32_MAX)
+        return false;
+    rowPitch = static_cast<uint32_t>(rowBytes);
+    slicePitch = static_cast<uint32_t>(numBytes);
+    return true;
+}
+
+bool Image::IsCompressed(DXGI_FORMAT format)
+{
+    return format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM ||
+        format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB;
+}
+
+uint32_t Image::CountMips(uint32_t width, uint32_t height)
+{
+    uint32_t mipLevels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = (std::max)(1u, width / 2);
+        height = (std::max)(1u, height / 2);
+        ++mipLevels;
+    }
+    return mipLevels;
+}
+
+HRESULT SaveImageToDDSFile(const Image& image, const wchar_t* fileName)
+{
+    if (!fileName || image.levels.empty())
+        return E_INVALIDARG;
+
+    DDS_HEADER header{};
+    header.size = sizeof(DDS_HEADER);
+    header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
+    header.width = image.GetWidth();
+    header.height = image.GetHeight();
+    header.depth = 1;
+    header.mipMapCount = image.GetMipLevels();
+    header.caps = DDS_SURFACE_FLAGS_TEXTURE | (image.GetMipLevels() > 1 ? DDS_SURFACE_FLAGS_MIPMAP : 0);
+    if (Image::IsCompressed(image.format))
+    {
+        header.flags |= DDS_HEADER_FLAGS_LINEARSIZE;
+        header.pitchOrLinearSize = static_cast<uint32_t>(image.levels[0].pixels.size());
+    }
+    else
+    {
+        header.flags |= DDS_HEADER_FLAGS_PITCH;
+        header.pitchOrLinearSize = image.levels[0].rowPitch;
+    }
+    header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+    header.ddspf.flags = DDS_FOURCC;
+    header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+
+    DDS_HEADER_DXT10 headerDX10{};
+    headerDX10.dxgiFormat = image.format;
+    headerDX10.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+    headerDX10.arraySize = 1;
+
+    std::ofstream fout(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fout.is_open())
+        return HRESULT_FROM_WIN32(ERROR_ACCESS_DENIED);
+
+    fout.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+    for (auto& level : image.levels)
+        fout.write(reinterpret_cast<const char*>(level.pixels.data()), level.pixels.size());
+
+    return fout.good() ? S_OK : E_FAIL;
+}
@@ -0,0 +1,52 @@
+//***************************************************************************************
+// Image.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// CPU端的图像数据(含mip链)及DDS文件的写出
+// CPU-side image data (with mip chain) and DDS file output.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "WinMin.h"
+#include <dxgiformat.h>
+#include <cstdint>
+#include <vector>
+
+struct Image
+{
+    struct Level
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t rowPitch = 0;          // 对于块压缩格式，为一行块的字节数
+        std::vector<uint8_t> pixels;
+    };
+
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    std::vector<Level> levels;
+
+    // 以给定的像素数据作为第0级创建图像，rowPitch为0时视为紧密排列
+    bool Initialize(DXGI_FORMAT format, uint32_t width, uint32_t height, const void* pixels, uint32_t rowPitch = 0);
+    // 按格式分配一个空的mip等级
+    Level& AddLevel(uint32_t width, uint32_t height);
+
+    uint32_t GetWidth() const { return levels.empty() ? 0 : levels[0].width; }
+    uint32_t GetHeight() const { return levels.empty() ? 0 : levels[0].height; }
+    uint32_t GetMipLevels() const { return static_cast<uint32_t>(levels.size()); }
+    size_t GetByteSize() const;
+
+    // 计算一行/一个mip等级的字节数，不支持的格式返回false
+    static bool ComputePitch(DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t& rowPitch, uint32_t& slicePitch);
+    static bool IsCompressed(DXGI_FORMAT format);
+    // 完整mip链的等级数
+    static uint32_t CountMips(uint32_t width, uint32_t height);
+};
+
+// 将图像的所有mip等级写出为DDS文件(使用DX10扩展头)
+HRESULT SaveImageToDDSFile(const Image& image, const wchar_t* fileName);
+
+#endif
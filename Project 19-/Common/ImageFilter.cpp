@@ -0,0 +1,516 @@
+#include "ImageFilter.h"
+#include "ThreadPool.h"
+#include "CpuTimer.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace ImageFilter
+{
+    namespace
+    {
+        constexpr uint32_t RowsPerTask = 8;
+        constexpr uint32_t ColumnsPerTask = 64;
+
+        inline XMVECTOR LoadPixel(const XMFLOAT4& pixel)
+        {
+            return XMLoadFloat4(&pixel);
+        }
+
+        inline XMVECTOR LoadPixel(const XMUBYTEN4& pixel)
+        {
+            return XMLoadUByteN4(&pixel);
+        }
+
+        inline void XM_CALLCONV StorePixel(XMFLOAT4& pixel, FXMVECTOR v)
+        {
+            XMStoreFloat4(&pixel, v);
+        }
+
+        // 与GPU写入UNORM纹理时一样四舍五入
+        inline void XM_CALLCONV StorePixel(XMUBYTEN4& pixel, FXMVECTOR v)
+        {
+            static const XMVECTORF32 s_UByteMax = { { { 255.0f, 255.0f, 255.0f, 255.0f } } };
+            XMUBYTE4 result;
+            XMStoreUByte4(&result, XMVectorRound(XMVectorMultiply(XMVectorSaturate(v), s_UByteMax)));
+            pixel.v = result.v;
+        }
+
+        void ParallelRange(ThreadPool* pThreadPool, uint32_t begin, uint32_t end, uint32_t grain,
+            const std::function<void(uint32_t, uint32_t)>& func)
+        {
+            if (begin >= end)
+                return;
+            if (pThreadPool)
+                pThreadPool->ParallelFor(begin, end, grain, func);
+            else
+                func(begin, end);
+        }
+
+        inline uint32_t ClampIndex(int i, uint32_t size)
+        {
+            return (uint32_t)(std::min)((std::max)(i, 0), (int)size - 1);
+        }
+
+        // 把一行读到pOut[radius, radius + width)，两侧各radius个像素取钳位后的边缘像素
+        template<class Pixel>
+        void LoadClampedRow(const Pixel* pRow, uint32_t width, int radius, XMFLOAT4* pOut)
+        {
+            XMVECTOR left = LoadPixel(pRow[0]), right = LoadPixel(pRow[width - 1]);
+            for (int i = 0; i < radius; ++i)
+            {
+                XMStoreFloat4(pOut + i, left);
+                XMStoreFloat4(pOut + radius + width + i, right);
+            }
+            for (uint32_t x = 0; x < width; ++x)
+                XMStoreFloat4(pOut + radius + x, LoadPixel(pRow[x]));
+        }
+
+        template<class Pixel>
+        void ConvertImpl(const ImageBuffer<Pixel>& src, ImageF& dst, ThreadPool* pThreadPool)
+        {
+            dst.Resize(src.width, src.height);
+            ParallelRange(pThreadPool, 0, src.height, RowsPerTask * 4, [&](uint32_t y0, uint32_t y1) {
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    const Pixel* pIn = src.Row(y);
+                    XMFLOAT4* pOut = dst.Row(y);
+                    for (uint32_t x = 0; x < src.width; ++x)
+                        XMStoreFloat4(pOut + x, LoadPixel(pIn[x]));
+                }
+            });
+        }
+
+        template<class Pixel>
+        void GaussianBlurImpl(const ImageBuffer<Pixel>& src, ImageBuffer<Pixel>& dst, float sigma, int radius,
+            ThreadPool* pThreadPool)
+        {
+            uint32_t width = src.width, height = src.height;
+            std::vector<float> weights = GenerateGaussianWeights(sigma, radius);
+            radius = (int)weights.size() / 2;
+            if (!width || !height)
+            {
+                dst.Resize(width, height);
+                return;
+            }
+
+            // 水平方向：每行先补齐边缘，内层循环不再需要判断边界
+            ImageF temp(width, height);
+            ParallelRange(pThreadPool, 0, height, RowsPerTask, [&](uint32_t y0, uint32_t y1) {
+                thread_local std::vector<XMFLOAT4> row;
+                row.resize(width + 2 * radius);
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    LoadClampedRow(src.Row(y), width, radius, row.data());
+                    XMFLOAT4* pOut = temp.Row(y);
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        XMVECTOR sum = XMVectorZero();
+                        for (int k = 0; k <= 2 * radius; ++k)
+                            sum = XMVectorMultiplyAdd(XMVectorReplicate(weights[k]), XMLoadFloat4(&row[x + k]), sum);
+                        XMStoreFloat4(pOut + x, sum);
+                    }
+                }
+            });
+
+            // 竖直方向：逐行累加到线程私有的一行中，按行顺序访问内存
+            dst.Resize(width, height);
+            ParallelRange(pThreadPool, 0, height, RowsPerTask, [&](uint32_t y0, uint32_t y1) {
+                thread_local std::vector<XMFLOAT4> sums;
+                sums.resize(width);
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    std::fill(sums.begin(), sums.end(), XMFLOAT4());
+                    for (int k = -radius; k <= radius; ++k)
+                    {
+                        const XMFLOAT4* pIn = temp.Row(ClampIndex((int)y + k, height));
+                        XMVECTOR weight = XMVectorReplicate(weights[k + radius]);
+                        for (uint32_t x = 0; x < width; ++x)
+                            XMStoreFloat4(&sums[x], XMVectorMultiplyAdd(weight, XMLoadFloat4(pIn + x), XMLoadFloat4(&sums[x])));
+                    }
+                    Pixel* pOut = dst.Row(y);
+                    for (uint32_t x = 0; x < width; ++x)
+                        StorePixel(pOut[x], XMLoadFloat4(&sums[x]));
+                }
+            });
+        }
+
+        template<class Pixel>
+        void BoxBlurImpl(const ImageBuffer<Pixel>& src, ImageBuffer<Pixel>& dst, int radius, ThreadPool* pThreadPool)
+        {
+            uint32_t width = src.width, height = src.height;
+            radius = (std::max)(radius, 0);
+            if (!width || !height)
+            {
+                dst.Resize(width, height);
+                return;
+            }
+
+            // 水平方向：窗口右移一个像素时加上新进入的像素，减去移出的像素
+            ImageF temp(width, height);
+            ParallelRange(pThreadPool, 0, height, RowsPerTask, [&](uint32_t y0, uint32_t y1) {
+                thread_local std::vector<XMFLOAT4> row;
+                row.resize(width + 2 * radius);
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    LoadClampedRow(src.Row(y), width, radius, row.data());
+                    XMVECTOR sum = XMVectorZero();
+                    for (int k = 0; k < 2 * radius; ++k)
+                        sum = XMVectorAdd(sum, XMLoadFloat4(&row[k]));
+                    XMFLOAT4* pOut = temp.Row(y);
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        sum = XMVectorAdd(sum, XMLoadFloat4(&row[x + 2 * radius]));
+                        XMStoreFloat4(pOut + x, sum);
+                        sum = XMVectorSubtract(sum, XMLoadFloat4(&row[x]));
+                    }
+                }
+            });
+
+            // 竖直方向：按列分块并行，每块自上而下滑动窗口
+            dst.Resize(width, height);
+            XMVECTOR scale = XMVectorReplicate(1.0f / ((2 * radius + 1) * (2 * radius + 1)));
+            uint32_t numBlocks = (width + ColumnsPerTask - 1) / ColumnsPerTask;
+            ParallelRange(pThreadPool, 0, numBlocks, 1, [&](uint32_t b0, uint32_t b1) {
+                XMFLOAT4 sums[ColumnsPerTask];
+                for (uint32_t b = b0; b < b1; ++b)
+                {
+                    uint32_t x0 = b * ColumnsPerTask, count = (std::min)(width - x0, ColumnsPerTask);
+                    std::fill(sums, sums + count, XMFLOAT4());
+                    for (int k = -radius; k < radius; ++k)
+                    {
+                        const XMFLOAT4* pIn = temp.Row(ClampIndex(k, height)) + x0;
+                        for (uint32_t x = 0; x < count; ++x)
+                            XMStoreFloat4(&sums[x], XMVectorAdd(XMLoadFloat4(&sums[x]), XMLoadFloat4(pIn + x)));
+                    }
+                    for (uint32_t y = 0; y < height; ++y)
+                    {
+                        const XMFLOAT4* pIn = temp.Row(ClampIndex((int)y + radius, height)) + x0;
+                        const XMFLOAT4* pOutgoing = temp.Row(ClampIndex((int)y - radius, height)) + x0;
+                        Pixel* pOut = dst.Row(y) + x0;
+                        for (uint32_t x = 0; x < count; ++x)
+                        {
+                            XMVECTOR sum = XMVectorAdd(XMLoadFloat4(&sums[x]), XMLoadFloat4(pIn + x));
+                            StorePixel(pOut[x], XMVectorMultiply(sum, scale));
+                            XMStoreFloat4(&sums[x], XMVectorSubtract(sum, XMLoadFloat4(pOutgoing + x)));
+                        }
+                    }
+                }
+            });
+        }
+
+        template<class Pixel>
+        void SobelImpl(const ImageBuffer<Pixel>& src, ImageBuffer<Pixel>& dst, ThreadPool* pThreadPool)
+        {
+            uint32_t width = src.width, height = src.height;
+            if (!width || !height)
+            {
+                dst.Resize(width, height);
+                return;
+            }
+
+            // 输出依赖上下两行的输入，先转换成浮点图像以支持原地处理
+            ImageF input;
+            ConvertImpl(src, input, pThreadPool);
+            dst.Resize(width, height);
+
+            static const XMVECTORF32 s_GrayWeights = { { { 0.212671f, 0.715160f, 0.072169f, 0.0f } } };
+            ParallelRange(pThreadPool, 0, height, RowsPerTask, [&](uint32_t y0, uint32_t y1) {
+                // 图像外的像素为0，每行左右各补一个
+                thread_local std::vector<XMFLOAT4> rows[3];
+                for (auto& row : rows)
+                    row.assign(width + 2, XMFLOAT4());
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    for (int i = 0; i < 3; ++i)
+                    {
+                        int srcY = (int)y - 1 + i;
+                        if (srcY >= 0 && srcY < (int)height)
+                            std::copy_n(input.Row(srcY), width, rows[i].data() + 1);
+                        else
+                            std::fill(rows[i].begin() + 1, rows[i].end() - 1, XMFLOAT4());
+                    }
+
+                    Pixel* pOut = dst.Row(y);
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        const XMFLOAT4* r0 = rows[0].data() + x;
+                        const XMFLOAT4* r1 = rows[1].data() + x;
+                        const XMFLOAT4* r2 = rows[2].data() + x;
+                        XMVECTOR c00 = XMLoadFloat4(r0), c01 = XMLoadFloat4(r0 + 1), c02 = XMLoadFloat4(r0 + 2);
+                        XMVECTOR c10 = XMLoadFloat4(r1), c12 = XMLoadFloat4(r1 + 2);
+                        XMVECTOR c20 = XMLoadFloat4(r2), c21 = XMLoadFloat4(r2 + 1), c22 = XMLoadFloat4(r2 + 2);
+
+                        XMVECTOR gx = XMVectorSubtract(XMVectorAdd(XMVectorAdd(c02, c22), XMVectorAdd(c12, c12)),
+                            XMVectorAdd(XMVectorAdd(c00, c20), XMVectorAdd(c10, c10)));
+                        XMVECTOR gy = XMVectorSubtract(XMVectorAdd(XMVectorAdd(c00, c02), XMVectorAdd(c01, c01)),
+                            XMVectorAdd(XMVectorAdd(c20, c22), XMVectorAdd(c21, c21)));
+                        XMVECTOR mag = XMVectorSqrt(XMVectorMultiplyAdd(gx, gx, XMVectorMultiply(gy, gy)));
+                        XMVECTOR gray = XMVectorSaturate(XMVector3Dot(mag, s_GrayWeights));
+                        StorePixel(pOut[x], XMVectorSetW(XMVectorSubtract(g_XMOne, gray), 1.0f));
+                    }
+                }
+            });
+        }
+
+        template<class Pixel>
+        void BilateralBlurImpl(const ImageBuffer<Pixel>& src, ImageBuffer<Pixel>& dst, float spatialSigma, float rangeSigma,
+            int radius, ThreadPool* pThreadPool)
+        {
+            uint32_t width = src.width, height = src.height;
+            if (radius < 0)
+                radius = GetGaussianRadius(spatialSigma);
+            if (!width || !height)
+            {
+                dst.Resize(width, height);
+                return;
+            }
+
+            // 补齐边缘后的浮点图像
+            uint32_t paddedWidth = width + 2 * radius, paddedHeight = height + 2 * radius;
+            ImageF padded(paddedWidth, paddedHeight);
+            ParallelRange(pThreadPool, 0, paddedHeight, RowsPerTask * 4, [&](uint32_t y0, uint32_t y1) {
+                for (uint32_t y = y0; y < y1; ++y)
+                    LoadClampedRow(src.Row(ClampIndex((int)y - radius, height)), width, radius, padded.Row(y));
+            });
+            dst.Resize(width, height);
+
+            int windowSize = 2 * radius + 1;
+            std::vector<float> spatialWeights((size_t)windowSize * windowSize, 1.0f);
+            if (spatialSigma > 0.0f)
+            {
+                for (int i = -radius; i <= radius; ++i)
+                    for (int j = -radius; j <= radius; ++j)
+                        spatialWeights[(size_t)(i + radius) * windowSize + j + radius] =
+                            expf(-(float)(i * i + j * j) / (2.0f * spatialSigma * spatialSigma));
+            }
+            float rangeScale = rangeSigma > 0.0f ? -1.0f / (2.0f * rangeSigma * rangeSigma) : 0.0f;
+            XMVECTOR vRangeScale = XMVectorReplicate(rangeScale);
+
+            ParallelRange(pThreadPool, 0, height, RowsPerTask, [&](uint32_t y0, uint32_t y1) {
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    Pixel* pOut = dst.Row(y);
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        XMVECTOR center = XMLoadFloat4(padded.Row(y + radius) + x + radius);
+                        XMVECTOR sum = XMVectorZero(), weightSum = XMVectorZero();
+                        float tailWeightSum = 0.0f;
+                        for (int i = 0; i < windowSize; ++i)
+                        {
+                            const XMFLOAT4* pIn = padded.Row(y + i) + x;
+                            const float* pSpatial = spatialWeights.data() + (size_t)i * windowSize;
+                            int j = 0;
+                            // 每次求4个邻域像素的颜色距离，一起计算指数
+                            for (; j + 4 <= windowSize; j += 4)
+                            {
+                                XMVECTOR n0 = XMLoadFloat4(pIn + j), n1 = XMLoadFloat4(pIn + j + 1);
+                                XMVECTOR n2 = XMLoadFloat4(pIn + j + 2), n3 = XMLoadFloat4(pIn + j + 3);
+                                XMVECTOR d01 = XMVectorMergeXY(XMVector3LengthSq(XMVectorSubtract(n0, center)),
+                                    XMVector3LengthSq(XMVectorSubtract(n1, center)));
+                                XMVECTOR d23 = XMVectorMergeXY(XMVector3LengthSq(XMVectorSubtract(n2, center)),
+                                    XMVector3LengthSq(XMVectorSubtract(n3, center)));
+                                XMVECTOR distSq = XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_1X, XM_PERMUTE_1Y>(d01, d23);
+                                XMVECTOR weights = XMVectorMultiply(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(pSpatial + j)),
+                                    XMVectorExpE(XMVectorMultiply(distSq, vRangeScale)));
+                                weightSum = XMVectorAdd(weightSum, weights);
+                                sum = XMVectorMultiplyAdd(XMVectorSplatX(weights), n0, sum);
+                                sum = XMVectorMultiplyAdd(XMVectorSplatY(weights), n1, sum);
+                                sum = XMVectorMultiplyAdd(XMVectorSplatZ(weights), n2, sum);
+                                sum = XMVectorMultiplyAdd(XMVectorSplatW(weights), n3, sum);
+                            }
+                            for (; j < windowSize; ++j)
+                            {
+                                XMVECTOR n = XMLoadFloat4(pIn + j);
+                                float weight = pSpatial[j] * expf(XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(n, center))) * rangeScale);
+                                tailWeightSum += weight;
+                                sum = XMVectorMultiplyAdd(XMVectorReplicate(weight), n, sum);
+                            }
+                        }
+                        // 中心像素的权重为1，总权重不会为0
+                        float totalWeight = XMVectorGetX(XMVectorSum(weightSum)) + tailWeightSum;
+                        StorePixel(pOut[x], XMVectorScale(sum, 1.0f / totalWeight));
+                    }
+                }
+            });
+        }
+    }
+
+    void Convert(const ImageRGBA8& src, ImageF& dst, ThreadPool* pThreadPool)
+    {
+        ConvertImpl(src, dst, pThreadPool);
+    }
+
+    void Convert(const ImageF& src, ImageRGBA8& dst, ThreadPool* pThreadPool)
+    {
+        dst.Resize(src.width, src.height);
+        ParallelRange(pThreadPool, 0, src.height, RowsPerTask * 4, [&](uint32_t y0, uint32_t y1) {
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                const XMFLOAT4* pIn = src.Row(y);
+                XMUBYTEN4* pOut = dst.Row(y);
+                for (uint32_t x = 0; x < src.width; ++x)
+                    StorePixel(pOut[x], XMLoadFloat4(pIn + x));
+            }
+        });
+    }
+
+    int GetGaussianRadius(float sigma)
+    {
+        return sigma > 0.0f ? (int)ceilf(3.0f * sigma) : 0;
+    }
+
+    std::vector<float> GenerateGaussianWeights(float sigma, int radius)
+    {
+        if (radius < 0)
+            radius = GetGaussianRadius(sigma);
+        std::vector<float> weights(2 * radius + 1, 0.0f);
+        if (sigma <= 0.0f)
+        {
+            weights[radius] = 1.0f;
+            return weights;
+        }
+
+        float twoSigmaSq = 2.0f * sigma * sigma;
+        float sum = 0.0f;
+        for (int i = -radius; i <= radius; ++i)
+        {
+            float x = (float)i;
+            weights[radius + i] = expf(-x * x / twoSigmaSq);
+            sum += weights[radius + i];
+        }
+
+        // 标准化权值使得权值和为1.0
+        for (float& weight : weights)
+            weight /= sum;
+        return weights;
+    }
+
+    void GaussianBlur(const ImageF& src, ImageF& dst, float sigma, int radius, ThreadPool* pThreadPool)
+    {
+        GaussianBlurImpl(src, dst, sigma, radius, pThreadPool);
+    }
+
+    void GaussianBlur(const ImageRGBA8& src, ImageRGBA8& dst, float sigma, int radius, ThreadPool* pThreadPool)
+    {
+        GaussianBlurImpl(src, dst, sigma, radius, pThreadPool);
+    }
+
+    void BoxBlur(const ImageF& src, ImageF& dst, int radius, ThreadPool* pThreadPool)
+    {
+        BoxBlurImpl(src, dst, radius, pThreadPool);
+    }
+
+    void BoxBlur(const ImageRGBA8& src, ImageRGBA8& dst, int radius, ThreadPool* pThreadPool)
+    {
+        BoxBlurImpl(src, dst, radius, pThreadPool);
+    }
+
+    void Sobel(const ImageF& src, ImageF& dst, ThreadPool* pThreadPool)
+    {
+        SobelImpl(src, dst, pThreadPool);
+    }
+
+    void Sobel(const ImageRGBA8& src, ImageRGBA8& dst, ThreadPool* pThreadPool)
+    {
+        SobelImpl(src, dst, pThreadPool);
+    }
+
+    void BilateralBlur(const ImageF& src, ImageF& dst, float spatialSigma, float rangeSigma, int radius, ThreadPool* pThreadPool)
+    {
+        BilateralBlurImpl(src, dst, spatialSigma, rangeSigma, radius, pThreadPool);
+    }
+
+    void BilateralBlur(const ImageRGBA8& src, ImageRGBA8& dst, float spatialSigma, float rangeSigma, int radius, ThreadPool* pThreadPool)
+    {
+        BilateralBlurImpl(src, dst, spatialSigma, rangeSigma, radius, pThreadPool);
+    }
+}
+
+namespace
+{
+    template<class Pixel, class Func>
+    ImageFilterBenchmarkResult BenchmarkFilter(const char* filterName, const char* formatName,
+        const ImageFilter::ImageBuffer<Pixel>& src, Func&& func)
+    {
+        constexpr int numRuns = 3;
+        ImageFilterBenchmarkResult result{};
+        result.filterName = filterName;
+        result.formatName = formatName;
+        result.width = src.width;
+        result.height = src.height;
+        ImageFilter::ImageBuffer<Pixel> dst;
+        CpuTimer timer;
+
+        // 先运行一次，分配好输出与线程私有的缓冲区
+        func(src, dst, nullptr);
+        timer.Reset();
+        timer.Start();
+        for (int i = 0; i < numRuns; ++i)
+            func(src, dst, nullptr);
+        timer.Tick();
+        timer.Stop();
+        result.singleThreadMs = timer.TotalTime() * 1000.0f / numRuns;
+
+        ThreadPool* pThreadPool = &ThreadPool::GetDefault();
+        func(src, dst, pThreadPool);
+        timer.Reset();
+        timer.Start();
+        for (int i = 0; i < numRuns; ++i)
+            func(src, dst, pThreadPool);
+        timer.Tick();
+        timer.Stop();
+        result.multiThreadMs = timer.TotalTime() * 1000.0f / numRuns;
+
+        float megaPixels = src.width * src.height / 1e6f;
+        result.singleThreadMPixels = megaPixels / (result.singleThreadMs / 1000.0f);
+        result.multiThreadMPixels = megaPixels / (result.multiThreadMs / 1000.0f);
+        return result;
+    }
+
+    template<class Pixel>
+    void BenchmarkFormat(std::vector<ImageFilterBenchmarkResult>& results, const char* formatName,
+        const ImageFilter::ImageBuffer<Pixel>& src, float sigma, int radius)
+    {
+        using ImageType = ImageFilter::ImageBuffer<Pixel>;
+        results.push_back(BenchmarkFilter("Gaussian", formatName, src, [=](const ImageType& in, ImageType& out, ThreadPool* pThreadPool) {
+            ImageFilter::GaussianBlur(in, out, sigma, radius, pThreadPool);
+        }));
+        results.push_back(BenchmarkFilter("Box", formatName, src, [=](const ImageType& in, ImageType& out, ThreadPool* pThreadPool) {
+            ImageFilter::BoxBlur(in, out, radius, pThreadPool);
+        }));
+        results.push_back(BenchmarkFilter("Sobel", formatName, src, [=](const ImageType& in, ImageType& out, ThreadPool* pThreadPool) {
+            ImageFilter::Sobel(in, out, pThreadPool);
+        }));
+        results.push_back(BenchmarkFilter("Bilateral", formatName, src, [=](const ImageType& in, ImageType& out, ThreadPool* pThreadPool) {
+            ImageFilter::BilateralBlur(in, out, sigma, 0.1f, radius, pThreadPool);
+        }));
+    }
+}
+
+std::vector<ImageFilterBenchmarkResult> RunImageFilterBenchmark(uint32_t width, uint32_t height, float sigma, int radius)
+{
+    // 带噪声的渐变与棋盘格，让双边滤波的颜色权重不至于全为1
+    ImageFilter::ImageRGBA8 image8(width, height);
+    uint32_t seed = 12345;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint8_t noise = (uint8_t)(seed >> 27);
+            uint8_t checker = ((x / 32 + y / 32) & 1) ? 160 : 32;
+            image8.Row(y)[x] = XMUBYTEN4((uint8_t)(x * 255 / width), (uint8_t)(checker + noise), (uint8_t)(y * 255 / height), 255);
+        }
+    }
+    ImageFilter::ImageF imageF;
+    ImageFilter::Convert(image8, imageF);
+
+    std::vector<ImageFilterBenchmarkResult> results;
+    BenchmarkFormat(results, "RGBA8", image8, sigma, radius);
+    BenchmarkFormat(results, "RGBA32F", imageF, sigma, radius);
+    return results;
+}
@@ -0,0 +1,97 @@
+//***************************************************************************************
+// ImageFilter.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// CPU端的图像滤波：高斯模糊、盒式模糊、索贝尔算子与双边滤波
+// CPU image filters: Gaussian blur, box blur, Sobel operator and bilateral filter.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef IMAGE_FILTER_H
+#define IMAGE_FILTER_H
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+//
+// 每个像素的RGBA四个通道作为一个向量参与SIMD运算，按行划分给线程池并行
+// 边界处理与"30 Blur and Sobel"中的计算着色器一致：模糊时钳位到边缘像素，索贝尔算子在图像外取0
+// RGBA8图像按UNORM读写，中间结果均为浮点数
+// 所有滤波函数的src与dst可以是同一幅图像；pThreadPool为空时在调用线程上单线程执行
+//
+
+namespace ImageFilter
+{
+    template<class Pixel>
+    struct ImageBuffer
+    {
+        ImageBuffer() = default;
+        ImageBuffer(uint32_t w, uint32_t h) { Resize(w, h); }
+
+        void Resize(uint32_t w, uint32_t h) { width = w; height = h; pixels.resize((size_t)w * h); }
+        Pixel* Row(uint32_t y) { return pixels.data() + (size_t)y * width; }
+        const Pixel* Row(uint32_t y) const { return pixels.data() + (size_t)y * width; }
+
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<Pixel> pixels;      // 按行优先紧密存放
+    };
+
+    using ImageF = ImageBuffer<DirectX::XMFLOAT4>;
+    using ImageRGBA8 = ImageBuffer<DirectX::PackedVector::XMUBYTEN4>;
+
+    void Convert(const ImageRGBA8& src, ImageF& dst, ThreadPool* pThreadPool = nullptr);
+    void Convert(const ImageF& src, ImageRGBA8& dst, ThreadPool* pThreadPool = nullptr);
+
+    // 覆盖约99.7%权重的半径ceil(3 * sigma)
+    int GetGaussianRadius(float sigma);
+    // 生成2 * radius + 1个和为1的高斯权重，radius小于0时取GetGaussianRadius(sigma)
+    // sigma不大于0时只有中心权重为1
+    std::vector<float> GenerateGaussianWeights(float sigma, int radius = -1);
+
+    // 可分离的高斯模糊，先水平后竖直，与Blur_Horz_CS/Blur_Vert_CS的结果一致
+    void GaussianBlur(const ImageF& src, ImageF& dst, float sigma, int radius = -1, ThreadPool* pThreadPool = nullptr);
+    void GaussianBlur(const ImageRGBA8& src, ImageRGBA8& dst, float sigma, int radius = -1, ThreadPool* pThreadPool = nullptr);
+
+    // (2 * radius + 1)^2的盒式模糊，使用滑动窗口求和，每个像素的开销与半径无关
+    void BoxBlur(const ImageF& src, ImageF& dst, int radius, ThreadPool* pThreadPool = nullptr);
+    void BoxBlur(const ImageRGBA8& src, ImageRGBA8& dst, int radius, ThreadPool* pThreadPool = nullptr);
+
+    // 与Sobel_CS一致：RGB为1 - saturate(梯度大小的亮度)，边缘处为黑色，Alpha为1
+    void Sobel(const ImageF& src, ImageF& dst, ThreadPool* pThreadPool = nullptr);
+    void Sobel(const ImageRGBA8& src, ImageRGBA8& dst, ThreadPool* pThreadPool = nullptr);
+
+    // 双边滤波：权重为空间高斯与RGB颜色距离高斯之积，在平滑的同时保留边缘
+    // radius小于0时取GetGaussianRadius(spatialSigma)
+    void BilateralBlur(const ImageF& src, ImageF& dst, float spatialSigma, float rangeSigma,
+        int radius = -1, ThreadPool* pThreadPool = nullptr);
+    void BilateralBlur(const ImageRGBA8& src, ImageRGBA8& dst, float spatialSigma, float rangeSigma,
+        int radius = -1, ThreadPool* pThreadPool = nullptr);
+}
+
+//
+// 性能测试
+//
+
+struct ImageFilterBenchmarkResult
+{
+    const char* filterName;
+    const char* formatName;             // "RGBA8" 或 "RGBA32F"
+    uint32_t width;
+    uint32_t height;
+    float singleThreadMs;
+    float multiThreadMs;
+    float singleThreadMPixels;          // 每秒处理的百万像素数
+    float multiThreadMPixels;
+};
+
+// 在width x height的测试图像上测量各滤波在单线程与线程池下的耗时，参数与示例的默认值相近
+std::vector<ImageFilterBenchmarkResult> RunImageFilterBenchmark(uint32_t width = 1280, uint32_t height = 720,
+    float sigma = 2.5f, int radius = 5);
+
+#endif
@@ -0,0 +1,272 @@
+#include "MeshBufferPool.h"
+#include "MeshData.h"
+#include "DXTrace.h"
+
+using namespace DirectX;
+
+//
+// RangeAllocator
+//
+
+void RangeAllocator::Reset(uint32_t capacity)
+{
+    m_FreeRanges.clear();
+    m_Capacity = capacity;
+    m_UsedSize = 0;
+    if (capacity)
+        m_FreeRanges[0] = capacity;
+}
+
+uint32_t RangeAllocator::Allocate(uint32_t size)
+{
+    if (size == 0)
+        return InvalidOffset;
+
+    for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+
+        uint32_t offset = it->first;
+        uint32_t remain = it->second - size;
+        m_FreeRanges.erase(it);
+        if (remain)
+            m_FreeRanges[offset + size] = remain;
+        m_UsedSize += size;
+        return offset;
+    }
+    return InvalidOffset;
+}
+
+void RangeAllocator::Free(uint32_t offset, uint32_t size)
+{
+    if (size == 0)
+        return;
+
+    m_UsedSize -= size;
+
+    auto next = m_FreeRanges.lower_bound(offset);
+    // 与后一个空闲区间合并
+    if (next != m_FreeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = m_FreeRanges.erase(next);
+    }
+    // 与前一个空闲区间合并
+    if (next != m_FreeRanges.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += size;
+            return;
+        }
+    }
+    m_FreeRanges[offset] = size;
+}
+
+uint32_t RangeAllocator::GetLargestFreeRange() const
+{
+    uint32_t largest = 0;
+    for (auto& [offset, size] : m_FreeRanges)
+        largest = (std::max)(largest, size);
+    return largest;
+}
+
+//
+// MeshStreamData
+//
+
+uint32_t MeshStreamData::GetLayoutKey() const
+{
+    uint32_t key = 0;
+    if (positions) key |= MeshStream_Position;
+    if (normals) key |= MeshStream_Normal;
+    if (tangents) key |= MeshStream_Tangent;
+    if (bitangents) key |= MeshStream_Bitangent;
+    if (colors) key |= MeshStream_Color;
+    if (index32) key |= MeshStream_Index32;
+    key |= numTexcoords << MeshStream_UVShift;
+    return key;
+}
+
+//
+// MeshBufferPool
+//
+
+void MeshBufferPool::Init(ID3D11Device* device)
+{
+    m_pDevice = device;
+    m_pDevice->GetImmediateContext(m_pDeviceContext.ReleaseAndGetAddressOf());
+}
+
+void MeshBufferPool::SetPageCapacity(uint32_t vertexCount, uint32_t indexCount)
+{
+    m_PageVertexCapacity = vertexCount;
+    m_PageIndexCapacity = indexCount;
+}
+
+uint32_t MeshBufferPool::GetVertexStride(uint32_t layoutKey)
+{
+    uint32_t stride = 0;
+    if (layoutKey & MeshStream_Position) stride += sizeof(XMFLOAT3);
+    if (layoutKey & MeshStream_Normal) stride += sizeof(XMFLOAT3);
+    if (layoutKey & MeshStream_Tangent) stride += sizeof(XMFLOAT4);
+    if (layoutKey & MeshStream_Bitangent) stride += sizeof(XMFLOAT4);
+    if (layoutKey & MeshStream_Color) stride += sizeof(XMFLOAT4);
+    stride += ((layoutKey >> MeshStream_UVShift) & 0xF) * sizeof(XMFLOAT2);
+    return stride;
+}
+
+MeshBufferPool::Page* MeshBufferPool::CreatePage(uint32_t layoutKey, XID ownerID, uint32_t vertexCount, uint32_t indexCount)
+{
+    auto pPage = std::make_unique<Page>();
+    pPage->layoutKey = layoutKey;
+    pPage->ownerID = ownerID;
+    pPage->vertexRanges.Reset(vertexCount);
+    pPage->indexRanges.Reset(indexCount);
+
+    // 每种数据流单独一个缓冲区，与非合并路径的输入布局保持一致
+    auto CreateStream = [&](ComPtr<ID3D11Buffer>& buffer, uint32_t stride, uint32_t count, uint32_t bindFlags) {
+        CD3D11_BUFFER_DESC bufferDesc(stride * count, bindFlags);
+        HR(m_pDevice->CreateBuffer(&bufferDesc, nullptr, buffer.GetAddressOf()));
+    };
+
+    if (layoutKey & MeshStream_Position)
+        CreateStream(pPage->pVertices, sizeof(XMFLOAT3), vertexCount, D3D11_BIND_VERTEX_BUFFER);
+    if (layoutKey & MeshStream_Normal)
+        CreateStream(pPage->pNormals, sizeof(XMFLOAT3), vertexCount, D3D11_BIND_VERTEX_BUFFER);
+    if (layoutKey & MeshStream_Tangent)
+        CreateStream(pPage->pTangents, sizeof(XMFLOAT4), vertexCount, D3D11_BIND_VERTEX_BUFFER);
+    if (layoutKey & MeshStream_Bitangent)
+        CreateStream(pPage->pBitangents, sizeof(XMFLOAT4), vertexCount, D3D11_BIND_VERTEX_BUFFER);
+    if (layoutKey & MeshStream_Color)
+        CreateStream(pPage->pColors, sizeof(XMFLOAT4), vertexCount, D3D11_BIND_VERTEX_BUFFER);
+    uint32_t numUVs = (layoutKey >> MeshStream_UVShift) & 0xF;
+    for (uint32_t i = 0; i < numUVs; ++i)
+        CreateStream(pPage->pTexcoordArrays[i], sizeof(XMFLOAT2), vertexCount, D3D11_BIND_VERTEX_BUFFER);
+    CreateStream(pPage->pIndices, (layoutKey & MeshStream_Index32) ? sizeof(uint32_t) : sizeof(uint16_t),
+        indexCount, D3D11_BIND_INDEX_BUFFER);
+
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+    std::string baseStr = "MeshBufferPool[" + std::to_string(m_Pages.size()) + "].";
+    if (pPage->pVertices)
+        ::SetDebugObjectName(pPage->pVertices.Get(), baseStr + "vertices");
+    if (pPage->pNormals)
+        ::SetDebugObjectName(pPage->pNormals.Get(), baseStr + "normals");
+    if (pPage->pTangents)
+        ::SetDebugObjectName(pPage->pTangents.Get(), baseStr + "tangents");
+    if (pPage->pBitangents)
+        ::SetDebugObjectName(pPage->pBitangents.Get(), baseStr + "bitangents");
+    if (pPage->pColors)
+        ::SetDebugObjectName(pPage->pColors.Get(), baseStr + "colors");
+    for (uint32_t i = 0; i < numUVs; ++i)
+        ::SetDebugObjectName(pPage->pTexcoordArrays[i].Get(), baseStr + "uv" + std::to_string(i));
+    ::SetDebugObjectName(pPage->pIndices.Get(), baseStr + "indices");
+#endif
+
+    m_Pages.push_back(std::move(pPage));
+    return m_Pages.back().get();
+}
+
+bool MeshBufferPool::Allocate(MeshData& meshData, const MeshStreamData& data, XID ownerID)
+{
+    if (!m_pDevice || !data.positions || !data.indices || !data.vertexCount || !data.indexCount)
+        return false;
+
+    uint32_t layoutKey = data.GetLayoutKey();
+
+    // 先在已有的页中查找足够的空间
+    Page* pPage = nullptr;
+    uint32_t vertexOffset = RangeAllocator::InvalidOffset;
+    uint32_t indexOffset = RangeAllocator::InvalidOffset;
+    for (auto& page : m_Pages)
+    {
+        if (page->layoutKey != layoutKey || page->ownerID != ownerID)
+            continue;
+        if (page->vertexRanges.GetLargestFreeRange() < data.vertexCount ||
+            page->indexRanges.GetLargestFreeRange() < data.indexCount)
+            continue;
+        pPage = page.get();
+        break;
+    }
+    if (!pPage)
+    {
+        pPage = CreatePage(layoutKey, ownerID,
+            (std::max)(m_PageVertexCapacity, data.vertexCount),
+            (std::max)(m_PageIndexCapacity, data.indexCount));
+    }
+    vertexOffset = pPage->vertexRanges.Allocate(data.vertexCount);
+    indexOffset = pPage->indexRanges.Allocate(data.indexCount);
+
+    // 上传到对应的区间
+    auto UploadStream = [&](ID3D11Buffer* buffer, const void* pData, uint32_t stride, uint32_t offset, uint32_t count) {
+        D3D11_BOX box{ offset * stride, 0, 0, (offset + count) * stride, 1, 1 };
+        m_pDeviceContext->UpdateSubresource(buffer, 0, &box, pData, 0, 0);
+    };
+
+    UploadStream(pPage->pVertices.Get(), data.positions, sizeof(XMFLOAT3), vertexOffset, data.vertexCount);
+    if (data.normals)
+        UploadStream(pPage->pNormals.Get(), data.normals, sizeof(XMFLOAT3), vertexOffset, data.vertexCount);
+    if (data.tangents)
+        UploadStream(pPage->pTangents.Get(), data.tangents, sizeof(XMFLOAT4), vertexOffset, data.vertexCount);
+    if (data.bitangents)
+        UploadStream(pPage->pBitangents.Get(), data.bitangents, sizeof(XMFLOAT4), vertexOffset, data.vertexCount);
+    if (data.colors)
+        UploadStream(pPage->pColors.Get(), data.colors, sizeof(XMFLOAT4), vertexOffset, data.vertexCount);
+    for (uint32_t i = 0; i < data.numTexcoords; ++i)
+        UploadStream(pPage->pTexcoordArrays[i].Get(), data.texcoords[i], sizeof(XMFLOAT2), vertexOffset, data.vertexCount);
+    UploadStream(pPage->pIndices.Get(), data.indices, data.index32 ? sizeof(uint32_t) : sizeof(uint16_t),
+        indexOffset, data.indexCount);
+
+    meshData.m_pVertices = pPage->pVertices;
+    meshData.m_pNormals = pPage->pNormals;
+    meshData.m_pTangents = pPage->pTangents;
+    meshData.m_pBitangents = pPage->pBitangents;
+    meshData.m_pColors = pPage->pColors;
+    meshData.m_pTexcoordArrays.assign(pPage->pTexcoordArrays, pPage->pTexcoordArrays + data.numTexcoords);
+    meshData.m_pIndices = pPage->pIndices;
+    meshData.m_VertexCount = data.vertexCount;
+    meshData.m_IndexCount = data.indexCount;
+    meshData.m_BaseVertex = static_cast<int32_t>(vertexOffset);
+    meshData.m_StartIndex = indexOffset;
+
+    ++pPage->numMeshes;
+    return true;
+}
+
+void MeshBufferPool::Free(const MeshData& meshData)
+{
+    for (auto& page : m_Pages)
+    {
+        if (page->pIndices.Get() != meshData.m_pIndices.Get())
+            continue;
+        page->vertexRanges.Free(static_cast<uint32_t>(meshData.m_BaseVertex), meshData.m_VertexCount);
+        page->indexRanges.Free(meshData.m_StartIndex, meshData.m_IndexCount);
+        --page->numMeshes;
+        return;
+    }
+}
+
+void MeshBufferPool::Trim()
+{
+    m_Pages.erase(std::remove_if(m_Pages.begin(), m_Pages.end(),
+        [](const std::unique_ptr<Page>& page) { return page->numMeshes == 0; }), m_Pages.end());
+}
+
+MeshBufferPool::Stats MeshBufferPool::GetStats() const
+{
+    Stats stats;
+    stats.numPages = static_cast<uint32_t>(m_Pages.size());
+    for (auto& page : m_Pages)
+    {
+        uint32_t vertexStride = GetVertexStride(page->layoutKey);
+        uint32_t indexStride = (page->layoutKey & MeshStream_Index32) ? sizeof(uint32_t) : sizeof(uint16_t);
+        stats.numMeshes += page->numMeshes;
+        stats.allocatedBytes += (size_t)page->vertexRanges.GetCapacity() * vertexStride +
+            (size_t)page->indexRanges.GetCapacity() * indexStride;
+        stats.usedBytes += (size_t)page->vertexRanges.GetUsedSize() * vertexStride +
+            (size_t)page->indexRanges.GetUsedSize() * indexStride;
+    }
+    return stats;
+}
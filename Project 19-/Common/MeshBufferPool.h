@@ -0,0 +1,140 @@
+//***************************************************************************************
+// MeshBufferPool.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 将顶点布局相同的子网格合并到共享的大顶点/索引缓冲区中
+// Pack submeshes sharing a vertex layout into shared large vertex/index buffers.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef MESH_BUFFER_POOL_H
+#define MESH_BUFFER_POOL_H
+
+#include "WinMin.h"
+#include "XUtil.h"
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+struct MeshData;
+
+// 简单的一维区间分配器(首次适配)，释放时合并相邻空闲区间
+class RangeAllocator
+{
+public:
+    static constexpr uint32_t InvalidOffset = UINT32_MAX;
+
+    RangeAllocator() = default;
+    explicit RangeAllocator(uint32_t capacity) { Reset(capacity); }
+
+    void Reset(uint32_t capacity);
+    // 失败时返回InvalidOffset
+    uint32_t Allocate(uint32_t size);
+    void Free(uint32_t offset, uint32_t size);
+
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetUsedSize() const { return m_UsedSize; }
+    uint32_t GetLargestFreeRange() const;
+
+private:
+    std::map<uint32_t, uint32_t> m_FreeRanges;  // offset -> size
+    uint32_t m_Capacity = 0;
+    uint32_t m_UsedSize = 0;
+};
+
+// 子网格使用的顶点数据流
+enum MeshStreamFlags : uint32_t
+{
+    MeshStream_Position   = 0x1,
+    MeshStream_Normal     = 0x2,
+    MeshStream_Tangent    = 0x4,
+    MeshStream_Bitangent  = 0x8,
+    MeshStream_Color      = 0x10,
+    MeshStream_Index32    = 0x20,   // 索引格式为R32_UINT，否则为R16_UINT
+    MeshStream_UVShift    = 8,      // 第8~11位存放纹理坐标的组数
+};
+
+// 一个子网格上传到池中所需的CPU数据，不存在的数据流置为nullptr
+struct MeshStreamData
+{
+    const DirectX::XMFLOAT3* positions = nullptr;
+    const DirectX::XMFLOAT3* normals = nullptr;
+    const DirectX::XMFLOAT4* tangents = nullptr;
+    const DirectX::XMFLOAT4* bitangents = nullptr;
+    const DirectX::XMFLOAT4* colors = nullptr;
+    const DirectX::XMFLOAT2* texcoords[8] = {};
+    uint32_t numTexcoords = 0;
+    const void* indices = nullptr;
+    bool index32 = false;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    uint32_t GetLayoutKey() const;
+};
+
+class MeshBufferPool
+{
+public:
+    template <class T>
+    using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+    struct Stats
+    {
+        uint32_t numPages = 0;
+        uint32_t numMeshes = 0;
+        size_t allocatedBytes = 0;      // 缓冲区总字节数
+        size_t usedBytes = 0;           // 已被子网格占用的字节数
+    };
+
+    MeshBufferPool() = default;
+    ~MeshBufferPool() = default;
+    MeshBufferPool(const MeshBufferPool&) = delete;
+    MeshBufferPool& operator=(const MeshBufferPool&) = delete;
+    MeshBufferPool(MeshBufferPool&&) = default;
+    MeshBufferPool& operator=(MeshBufferPool&&) = default;
+
+    void Init(ID3D11Device* device);
+    // 每页默认的顶点/索引容量，单个子网格超出时会按需创建更大的页
+    void SetPageCapacity(uint32_t vertexCount, uint32_t indexCount);
+
+    // 将子网格数据写入池中，并设置meshData的缓冲区、m_BaseVertex和m_StartIndex
+    // ownerID相同且布局相同的子网格共享缓冲区，传0表示所有模型共享
+    bool Allocate(MeshData& meshData, const MeshStreamData& data, XID ownerID = 0);
+    // 归还meshData占用的区间
+    void Free(const MeshData& meshData);
+    // 释放没有任何子网格使用的页
+    void Trim();
+
+    Stats GetStats() const;
+
+private:
+    struct Page
+    {
+        uint32_t layoutKey = 0;
+        XID ownerID = 0;
+        uint32_t numMeshes = 0;
+        RangeAllocator vertexRanges;
+        RangeAllocator indexRanges;
+        ComPtr<ID3D11Buffer> pVertices;
+        ComPtr<ID3D11Buffer> pNormals;
+        ComPtr<ID3D11Buffer> pTangents;
+        ComPtr<ID3D11Buffer> pBitangents;
+        ComPtr<ID3D11Buffer> pColors;
+        ComPtr<ID3D11Buffer> pTexcoordArrays[8];
+        ComPtr<ID3D11Buffer> pIndices;
+    };
+
+    Page* CreatePage(uint32_t layoutKey, XID ownerID, uint32_t vertexCount, uint32_t indexCount);
+    static uint32_t GetVertexStride(uint32_t layoutKey);
+
+    ComPtr<ID3D11Device> m_pDevice;
+    ComPtr<ID3D11DeviceContext> m_pDeviceContext;
+    std::vector<std::unique_ptr<Page>> m_Pages;
+    uint32_t m_PageVertexCapacity = 1 << 18;
+    uint32_t m_PageIndexCapacity = 3 << 18;
+};
+
+#endif
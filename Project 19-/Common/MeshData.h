@@ -17,6 +17,14 @@
 
 struct ID3D11Buffer;
 
+// 子网格中一段连续的索引，用于透明物体按簇排序绘制
+struct MeshCluster
+{
+    uint32_t startIndex = 0;            // 相对于子网格起始索引的偏移
+    uint32_t indexCount = 0;
+    DirectX::BoundingSphere boundingSphere;
+};
+
 struct MeshData
 {
     // 使用模板别名(C++11)简化类型名
@@ -34,9 +42,17 @@ struct MeshData
     uint32_t m_VertexCount = 0;
     uint32_t m_IndexCount = 0;
     uint32_t m_MaterialIndex = 0;
+    // 使用共享缓冲区(MeshBufferPool)时的起始索引和基准顶点
+    uint32_t m_StartIndex = 0;
+    int32_t m_BaseVertex = 0;
 
     DirectX::BoundingBox m_BoundingBox;
+    DirectX::BoundingOrientedBox m_BoundingOrientedBox;
+    DirectX::BoundingSphere m_BoundingSphere;
+    bool m_UseBoundingSphere = false;   // 包围球比OBB更紧凑时，裁剪使用包围球
+    float m_UVDensity = 0.0f;           // 局部空间中每单位长度对应的UV长度，用于估算纹理所需的mip等级，无UV时为0
     bool m_InFrustum = true;
+    std::vector<MeshCluster> m_Clusters;    // 为空时整个子网格视为一个簇
 };
 
 
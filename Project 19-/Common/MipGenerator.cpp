@@ -0,0 +1,509 @@
+#include "MipGenerator.h"
+#include "ThreadPool.h"
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    // 线性空间的RGBA浮点图像
+    struct FloatImage
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<XMFLOAT4A> pixels;
+
+        void Resize(uint32_t w, uint32_t h)
+        {
+            width = w;
+            height = h;
+            pixels.resize((size_t)w * h);
+        }
+    };
+
+    // 一维重采样的权重表，第i个目标像素使用taps[offsets[i], offsets[i + 1])
+    struct FilterWeights
+    {
+        struct Tap
+        {
+            uint32_t index;
+            float weight;
+        };
+        std::vector<uint32_t> offsets;
+        std::vector<Tap> taps;
+    };
+
+    const float s_FilterRadius = 3.0f;
+    const float s_KaiserAlpha = 4.0f;
+
+    float Sinc(float x)
+    {
+        if (fabsf(x) < 1e-6f)
+            return 1.0f;
+        x *= XM_PI;
+        return sinf(x) / x;
+    }
+
+    // 第一类零阶修正贝塞尔函数
+    float BesselI0(float x)
+    {
+        float sum = 1.0f, term = 1.0f;
+        float halfX = x * 0.5f;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1e-8f)
+                break;
+        }
+        return sum;
+    }
+
+    float EvaluateFilter(MipGenerator::Filter filter, float x)
+    {
+        x = fabsf(x);
+        if (x >= s_FilterRadius)
+            return 0.0f;
+        switch (filter)
+        {
+        case MipGenerator::Filter::Kaiser:
+        {
+            float t = x / s_FilterRadius;
+            return Sinc(x) * BesselI0(s_KaiserAlpha * sqrtf(1.0f - t * t)) / BesselI0(s_KaiserAlpha);
+        }
+        case MipGenerator::Filter::Lanczos:
+            return Sinc(x) * Sinc(x / s_FilterRadius);
+        default:
+            return x < 0.5f ? 1.0f : 0.0f;
+        }
+    }
+
+    FilterWeights BuildWeights(MipGenerator::Filter filter, uint32_t srcSize, uint32_t dstSize)
+    {
+        FilterWeights weights;
+        weights.offsets.reserve(dstSize + 1);
+        float scale = static_cast<float>(srcSize) / dstSize;
+        for (uint32_t d = 0; d < dstSize; ++d)
+        {
+            weights.offsets.push_back(static_cast<uint32_t>(weights.taps.size()));
+            size_t first = weights.taps.size();
+            float sum = 0.0f;
+            if (filter == MipGenerator::Filter::Box)
+            {
+                // 目标像素覆盖源区间[lo, hi)，按重叠长度加权，可处理非整数缩放比例
+                float lo = d * scale, hi = (d + 1) * scale;
+                int i0 = static_cast<int>(floorf(lo));
+                int i1 = (std::min)(static_cast<int>(ceilf(hi)), static_cast<int>(srcSize));
+                for (int i = i0; i < i1; ++i)
+                {
+                    float w = (std::min)(hi, i + 1.0f) - (std::max)(lo, static_cast<float>(i));
+                    if (w <= 0.0f)
+                        continue;
+                    weights.taps.push_back({ static_cast<uint32_t>(i), w });
+                    sum += w;
+                }
+            }
+            else
+            {
+                // 缩小时滤波核按缩放比例展开，边界处钳位到边缘像素
+                float center = (d + 0.5f) * scale;
+                float support = s_FilterRadius * scale;
+                int i0 = static_cast<int>(floorf(center - support));
+                int i1 = static_cast<int>(ceilf(center + support));
+                for (int i = i0; i <= i1; ++i)
+                {
+                    float w = EvaluateFilter(filter, (i + 0.5f - center) / scale);
+                    if (w == 0.0f)
+                        continue;
+                    uint32_t idx = static_cast<uint32_t>((std::min)((std::max)(i, 0), static_cast<int>(srcSize) - 1));
+                    weights.taps.push_back({ idx, w });
+                    sum += w;
+                }
+            }
+            for (size_t t = first; t < weights.taps.size(); ++t)
+                weights.taps[t].weight /= sum;
+        }
+        weights.offsets.push_back(static_cast<uint32_t>(weights.taps.size()));
+        return weights;
+    }
+
+    float SRGBToLinear(float c)
+    {
+        return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSRGB(float c)
+    {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    uint8_t ToUNorm8(float c)
+    {
+        c = (std::min)((std::max)(c, 0.0f), 1.0f);
+        return static_cast<uint8_t>(c * 255.0f + 0.5f);
+    }
+
+    uint32_t RowGrain(uint32_t width)
+    {
+        return (std::max)(1u, 16384u / (std::max)(width, 1u));
+    }
+
+    void LoadLevel(FloatImage& dst, const Image::Level& level, DXGI_FORMAT format, ThreadPool& pool)
+    {
+        dst.Resize(level.width, level.height);
+
+        float srgbTable[256];
+        for (int i = 0; i < 256; ++i)
+            srgbTable[i] = SRGBToLinear(i / 255.0f);
+
+        pool.ParallelFor(0, level.height, RowGrain(level.width), [&](uint32_t y0, uint32_t y1) {
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                const uint8_t* pRow = level.pixels.data() + (size_t)y * level.rowPitch;
+                XMFLOAT4A* pDst = dst.pixels.data() + (size_t)y * level.width;
+                for (uint32_t x = 0; x < level.width; ++x)
+                {
+                    switch (format)
+                    {
+                    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+                    {
+                        const uint8_t* p = pRow + x * 4;
+                        pDst[x] = XMFLOAT4A(srgbTable[p[0]], srgbTable[p[1]], srgbTable[p[2]], p[3] / 255.0f);
+                        break;
+                    }
+                    case DXGI_FORMAT_R8G8B8A8_UNORM:
+                    {
+                        const uint8_t* p = pRow + x * 4;
+                        pDst[x] = XMFLOAT4A(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f, p[3] / 255.0f);
+                        break;
+                    }
+                    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                        XMStoreFloat4A(&pDst[x], XMLoadHalf4(reinterpret_cast<const XMHALF4*>(pRow) + x));
+                        break;
+                    case DXGI_FORMAT_R32_FLOAT:
+                        pDst[x] = XMFLOAT4A(reinterpret_cast<const float*>(pRow)[x], 0.0f, 0.0f, 1.0f);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    void StoreLevel(Image::Level& level, const FloatImage& src, DXGI_FORMAT format, ThreadPool& pool)
+    {
+        pool.ParallelFor(0, level.height, RowGrain(level.width), [&](uint32_t y0, uint32_t y1) {
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                uint8_t* pRow = level.pixels.data() + (size_t)y * level.rowPitch;
+                const XMFLOAT4A* pSrc = src.pixels.data() + (size_t)y * level.width;
+                for (uint32_t x = 0; x < level.width; ++x)
+                {
+                    const XMFLOAT4A& c = pSrc[x];
+                    switch (format)
+                    {
+                    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+                    {
+                        uint8_t* p = pRow + x * 4;
+                        p[0] = ToUNorm8(LinearToSRGB((std::max)(c.x, 0.0f)));
+                        p[1] = ToUNorm8(LinearToSRGB((std::max)(c.y, 0.0f)));
+                        p[2] = ToUNorm8(LinearToSRGB((std::max)(c.z, 0.0f)));
+                        p[3] = ToUNorm8(c.w);
+                        break;
+                    }
+                    case DXGI_FORMAT_R8G8B8A8_UNORM:
+                    {
+                        uint8_t* p = pRow + x * 4;
+                        p[0] = ToUNorm8(c.x);
+                        p[1] = ToUNorm8(c.y);
+                        p[2] = ToUNorm8(c.z);
+                        p[3] = ToUNorm8(c.w);
+                        break;
+                    }
+                    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                        XMStoreHalf4(reinterpret_cast<XMHALF4*>(pRow) + x, XMLoadFloat4A(&c));
+                        break;
+                    case DXGI_FORMAT_R32_FLOAT:
+                        reinterpret_cast<float*>(pRow)[x] = c.x;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    // 可分离重采样：先水平缩小到tmp，再竖直缩小到dst，每个像素的4个通道用一个XMVECTOR并行计算
+    void Downsample(FloatImage& dst, FloatImage& tmp, const FloatImage& src, MipGenerator::Filter filter, ThreadPool& pool)
+    {
+        FilterWeights horz = BuildWeights(filter, src.width, dst.width);
+        FilterWeights vert = BuildWeights(filter, src.height, dst.height);
+        tmp.Resize(dst.width, src.height);
+
+        pool.ParallelFor(0, src.height, RowGrain(src.width), [&](uint32_t y0, uint32_t y1) {
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                const XMFLOAT4A* pSrc = src.pixels.data() + (size_t)y * src.width;
+                XMFLOAT4A* pDst = tmp.pixels.data() + (size_t)y * tmp.width;
+                for (uint32_t x = 0; x < dst.width; ++x)
+                {
+                    XMVECTOR acc = XMVectorZero();
+                    for (uint32_t t = horz.offsets[x]; t < horz.offsets[x + 1]; ++t)
+                    {
+                        const FilterWeights::Tap& tap = horz.taps[t];
+                        acc = XMVectorMultiplyAdd(XMLoadFloat4A(&pSrc[tap.index]), XMVectorReplicate(tap.weight), acc);
+                    }
+                    XMStoreFloat4A(&pDst[x], acc);
+                }
+            }
+        });
+
+        pool.ParallelFor(0, dst.height, RowGrain(dst.width), [&](uint32_t y0, uint32_t y1) {
+            for (uint32_t y = y0; y < y1; ++y)
+            {
+                XMFLOAT4A* pDst = dst.pixels.data() + (size_t)y * dst.width;
+                std::fill(pDst, pDst + dst.width, XMFLOAT4A(0.0f, 0.0f, 0.0f, 0.0f));
+                // 逐行累加，保证访存连续
+                for (uint32_t t = vert.offsets[y]; t < vert.offsets[y + 1]; ++t)
+                {
+                    const FilterWeights::Tap& tap = vert.taps[t];
+                    const XMFLOAT4A* pSrc = tmp.pixels.data() + (size_t)tap.index * tmp.width;
+                    XMVECTOR weight = XMVectorReplicate(tap.weight);
+                    for (uint32_t x = 0; x < dst.width; ++x)
+                        XMStoreFloat4A(&pDst[x], XMVectorMultiplyAdd(XMLoadFloat4A(&pSrc[x]), weight, XMLoadFloat4A(&pDst[x])));
+                }
+            }
+        });
+    }
+}
+
+bool MipGenerator::IsSupportedFormat(DXGI_FORMAT format)
+{
+    return format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+        format == DXGI_FORMAT_R16G16B16A16_FLOAT || format == DXGI_FORMAT_R32_FLOAT;
+}
+
+bool MipGenerator::Generate(Image& image, Filter filter, uint32_t maxLevels, ThreadPool* pThreadPool)
+{
+    if (image.levels.empty() || !IsSupportedFormat(image.format))
+        return false;
+
+    ThreadPool& pool = pThreadPool ? *pThreadPool : ThreadPool::GetDefault();
+    uint32_t numLevels = Image::CountMips(image.GetWidth(), image.GetHeight());
+    if (maxLevels)
+        numLevels = (std::min)(numLevels, maxLevels);
+
+    image.levels.resize(1);
+    // 中间结果保持在线性浮点空间，每一级由上一级的浮点结果滤波得到，避免量化误差累积
+    FloatImage curr, next, tmp;
+    LoadLevel(curr, image.levels[0], image.format, pool);
+    for (uint32_t mip = 1; mip < numLevels; ++mip)
+    {
+        next.Resize((std::max)(1u, curr.width / 2), (std::max)(1u, curr.height / 2));
+        Downsample(next, tmp, curr, filter, pool);
+        StoreLevel(image.AddLevel(next.width, next.height), next, image.format, pool);
+        std::swap(curr, next);
+    }
+    return true;
+}
+
+namespace
+{
+    struct MipChecker
+    {
+        MipGeneratorTestResult result{ 0, 0, nullptr };
+
+        void Check(bool condition, const char* description)
+        {
+            ++result.numChecks;
+            if (condition)
+                return;
+            ++result.numFailed;
+            if (!result.firstFailure)
+                result.firstFailure = description;
+        }
+    };
+
+    // 标量参考实现：逐像素按源区间的覆盖长度加权，先水平后竖直，累加顺序与Downsample一致
+    std::vector<XMFLOAT4> ReferenceBoxDownsample(const std::vector<XMFLOAT4>& src, uint32_t srcWidth, uint32_t srcHeight,
+        uint32_t dstWidth, uint32_t dstHeight)
+    {
+        auto getTaps = [](uint32_t srcSize, uint32_t dstSize, uint32_t d, std::vector<std::pair<uint32_t, float>>& taps) {
+            taps.clear();
+            float scale = static_cast<float>(srcSize) / dstSize;
+            float lo = d * scale, hi = (d + 1) * scale, sum = 0.0f;
+            for (uint32_t i = 0; i < srcSize; ++i)
+            {
+                float w = (std::min)(hi, i + 1.0f) - (std::max)(lo, static_cast<float>(i));
+                if (w > 0.0f)
+                {
+                    taps.emplace_back(i, w);
+                    sum += w;
+                }
+            }
+            for (auto& tap : taps)
+                tap.second /= sum;
+        };
+
+        std::vector<std::pair<uint32_t, float>> taps;
+        std::vector<XMFLOAT4> tmp((size_t)dstWidth * srcHeight), dst((size_t)dstWidth * dstHeight);
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            getTaps(srcWidth, dstWidth, x, taps);
+            for (uint32_t y = 0; y < srcHeight; ++y)
+            {
+                XMVECTOR acc = XMVectorZero();
+                for (auto& [index, weight] : taps)
+                    acc = XMVectorMultiplyAdd(XMLoadFloat4(&src[(size_t)y * srcWidth + index]), XMVectorReplicate(weight), acc);
+                XMStoreFloat4(&tmp[(size_t)y * dstWidth + x], acc);
+            }
+        }
+        for (uint32_t y = 0; y < dstHeight; ++y)
+        {
+            getTaps(srcHeight, dstHeight, y, taps);
+            for (uint32_t x = 0; x < dstWidth; ++x)
+            {
+                XMVECTOR acc = XMVectorZero();
+                for (auto& [index, weight] : taps)
+                    acc = XMVectorMultiplyAdd(XMLoadFloat4(&tmp[(size_t)index * dstWidth + x]), XMVectorReplicate(weight), acc);
+                XMStoreFloat4(&dst[(size_t)y * dstWidth + x], acc);
+            }
+        }
+        return dst;
+    }
+
+    bool IsSameLevel(const Image::Level& lhs, const Image::Level& rhs)
+    {
+        return lhs.width == rhs.width && lhs.height == rhs.height && lhs.pixels == rhs.pixels;
+    }
+}
+
+MipGeneratorTestResult RunMipGeneratorTest()
+{
+    MipChecker checker;
+    std::mt19937 rng(29);
+    ThreadPool singleThread(1), fourThreads(4);
+
+    //
+    // 随机图像：尺寸、盒式滤波的参考实现与线程数无关
+    //
+    const uint32_t sizes[][2] = { { 1, 1 }, { 2, 2 }, { 5, 3 }, { 7, 7 }, { 9, 1 }, { 1, 6 }, { 13, 10 }, { 64, 33 }, { 255, 17 } };
+    const DXGI_FORMAT formats[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB };
+    const MipGenerator::Filter filters[] = { MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser, MipGenerator::Filter::Lanczos };
+    for (auto& size : sizes)
+    {
+        std::vector<uint8_t> pixels((size_t)size[0] * size[1] * 4);
+        for (auto& c : pixels)
+            c = static_cast<uint8_t>(rng() & 0xFF);
+
+        for (DXGI_FORMAT format : formats)
+        {
+            bool isSRGB = format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+            for (MipGenerator::Filter filter : filters)
+            {
+                Image image, imageST;
+                image.Initialize(format, size[0], size[1], pixels.data());
+                imageST.Initialize(format, size[0], size[1], pixels.data());
+                checker.Check(MipGenerator::Generate(image, filter, 0, &fourThreads) &&
+                    MipGenerator::Generate(imageST, filter, 0, &singleThread), "Generate failed");
+
+                checker.Check(image.GetMipLevels() == Image::CountMips(size[0], size[1]), "Wrong mip count");
+                bool sameAcrossThreads = image.GetMipLevels() == imageST.GetMipLevels();
+                for (uint32_t mip = 1; mip < image.GetMipLevels(); ++mip)
+                {
+                    const Image::Level& prev = image.levels[mip - 1];
+                    const Image::Level& level = image.levels[mip];
+                    checker.Check(level.width == (std::max)(1u, prev.width / 2) && level.height == (std::max)(1u, prev.height / 2),
+                        "Wrong mip size");
+                    sameAcrossThreads = sameAcrossThreads && IsSameLevel(level, imageST.levels[mip]);
+                }
+                checker.Check(sameAcrossThreads, "Result depends on thread count");
+
+                if (filter != MipGenerator::Filter::Box)
+                    continue;
+                // 参考实现同样在线性浮点空间中逐级滤波，只在写出时量化
+                std::vector<XMFLOAT4> curr((size_t)size[0] * size[1]);
+                for (size_t i = 0; i < curr.size(); ++i)
+                {
+                    const uint8_t* p = pixels.data() + i * 4;
+                    auto toLinear = [&](uint8_t c) { return isSRGB ? SRGBToLinear(c / 255.0f) : c / 255.0f; };
+                    curr[i] = XMFLOAT4(toLinear(p[0]), toLinear(p[1]), toLinear(p[2]), p[3] / 255.0f);
+                }
+                uint32_t width = size[0], height = size[1];
+                bool bitExact = true;
+                for (uint32_t mip = 1; mip < image.GetMipLevels(); ++mip)
+                {
+                    uint32_t nextWidth = (std::max)(1u, width / 2), nextHeight = (std::max)(1u, height / 2);
+                    curr = ReferenceBoxDownsample(curr, width, height, nextWidth, nextHeight);
+                    width = nextWidth;
+                    height = nextHeight;
+                    const Image::Level& level = image.levels[mip];
+                    for (uint32_t y = 0; y < height; ++y)
+                    {
+                        for (uint32_t x = 0; x < width; ++x)
+                        {
+                            const XMFLOAT4& c = curr[(size_t)y * width + x];
+                            auto toStored = [&](float v) { return ToUNorm8(isSRGB ? LinearToSRGB((std::max)(v, 0.0f)) : v); };
+                            const uint8_t* p = level.pixels.data() + (size_t)y * level.rowPitch + x * 4;
+                            bitExact = bitExact && p[0] == toStored(c.x) && p[1] == toStored(c.y) && p[2] == toStored(c.z) &&
+                                p[3] == ToUNorm8(c.w);
+                        }
+                    }
+                }
+                checker.Check(bitExact, "Box filter differs from reference");
+            }
+        }
+    }
+
+    //
+    // sRGB与Alpha：黑白棋盘格在线性空间平均为0.5，对应sRGB的188；Alpha不做伽马转换
+    //
+    for (DXGI_FORMAT format : formats)
+    {
+        uint8_t checkerboard[4][4] = {
+            { 0, 0, 0, 0 }, { 255, 255, 255, 255 },
+            { 255, 255, 255, 255 }, { 0, 0, 0, 0 }
+        };
+        Image image;
+        image.Initialize(format, 2, 2, checkerboard);
+        MipGenerator::Generate(image);
+        const uint8_t* p = image.levels.back().pixels.data();
+        uint8_t expectedRGB = format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ? 188 : 128;
+        checker.Check(image.GetMipLevels() == 2 && p[0] == expectedRGB && p[1] == expectedRGB && p[2] == expectedRGB,
+            "Checkerboard RGB not averaged in linear space");
+        checker.Check(image.GetMipLevels() == 2 && p[3] == 128, "Checkerboard alpha not averaged linearly");
+    }
+
+    //
+    // 常量图像：各滤波器的权重之和为1，奇数尺寸的边界钳位也不改变颜色
+    //
+    for (DXGI_FORMAT format : formats)
+    {
+        for (MipGenerator::Filter filter : filters)
+        {
+            std::vector<uint32_t> pixels(37 * 23, 0x80C8255Au);
+            Image image;
+            image.Initialize(format, 37, 23, pixels.data());
+            MipGenerator::Generate(image, filter);
+            bool constant = true;
+            for (uint32_t mip = 1; mip < image.GetMipLevels(); ++mip)
+            {
+                const Image::Level& level = image.levels[mip];
+                for (uint32_t y = 0; y < level.height; ++y)
+                    for (uint32_t x = 0; x < level.width; ++x)
+                        constant = constant && memcmp(level.pixels.data() + (size_t)y * level.rowPitch + x * 4, pixels.data(), 4) == 0;
+            }
+            checker.Check(constant, "Constant image changed");
+        }
+    }
+
+    return checker.result;
+}
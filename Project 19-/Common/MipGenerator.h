@@ -0,0 +1,52 @@
+//***************************************************************************************
+// MipGenerator.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// CPU端的mip链生成
+// CPU mip chain generation.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include "Image.h"
+
+class ThreadPool;
+
+namespace MipGenerator
+{
+    enum class Filter
+    {
+        Box,        // 按覆盖面积加权的盒式滤波
+        Kaiser,     // Kaiser窗sinc，半径3
+        Lanczos     // Lanczos3
+    };
+
+    // 保留image的第0级并重新生成其余mip等级，maxLevels为0时生成完整mip链
+    // 支持R8G8B8A8_UNORM(_SRGB)、R16G16B16A16_FLOAT和R32_FLOAT
+    // sRGB格式先转换到线性空间再滤波；非2的幂尺寸时下一级尺寸向下取整，滤波核按实际缩放比例展开
+    // 每个像素的累加顺序固定，结果与线程数无关
+    bool Generate(Image& image, Filter filter = Filter::Box, uint32_t maxLevels = 0, ThreadPool* pThreadPool = nullptr);
+
+    bool IsSupportedFormat(DXGI_FORMAT format);
+}
+
+//
+// 正确性检查
+//
+
+struct MipGeneratorTestResult
+{
+    uint32_t numChecks;                 // 检查的条件总数
+    uint32_t numFailed;                 // 不满足的条件数目
+    const char* firstFailure;           // 第一个不满足的条件，全部满足时为nullptr
+};
+
+// 对奇数尺寸、非方形及1像素宽/高的随机RGBA8图像生成mip链：
+// 各级尺寸按向下取整减半；盒式滤波的结果与逐像素的标量参考实现逐位一致，且与线程数无关；
+// sRGB黑白棋盘格缩小后RGB为188(线性空间的0.5)而Alpha为128；常量图像在三种滤波下保持不变
+MipGeneratorTestResult RunMipGeneratorTest();
+
+#endif
@@ -2,6 +2,9 @@
 #include "ModelManager.h"
 #include "TextureManager.h"
 #include "ImGuiLog.h"
+#include "MeshBufferPool.h"
+#include "Collision.h"
+#include "CpuSort.h"
 
 #include <filesystem>
 
@@ -10,8 +13,9 @@
 #include <assimp/scene.h>
 
 using namespace DirectX;
+using namespace Microsoft::WRL;
 
-void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view filename)
+void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view filename, MeshBufferPool* pPool, XID poolOwnerID)
 {
     using namespace Assimp;
     namespace fs = std::filesystem;
@@ -19,6 +23,8 @@ void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view
     model.materials.clear();
     model.meshdatas.clear();
     model.boundingbox = BoundingBox();
+    model.boundingorientedbox = BoundingOrientedBox();
+    model.boundingsphere = BoundingSphere();
 
     Importer importer;
     // 去掉里面的点、线图元
@@ -34,21 +40,22 @@ void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view
     {
         model.meshdatas.resize(pAssimpScene->mNumMeshes);
         model.materials.resize(pAssimpScene->mNumMaterials);
+        std::vector<XMFLOAT3> modelPositions;
         for (uint32_t i = 0; i < pAssimpScene->mNumMeshes; ++i)
         {
             auto& mesh = model.meshdatas[i];
 
             auto pAiMesh = pAssimpScene->mMeshes[i];
             uint32_t numVertices = pAiMesh->mNumVertices;
+            mesh.m_VertexCount = numVertices;
+
+            MeshStreamData streamData;
+            streamData.vertexCount = numVertices;
 
-            CD3D11_BUFFER_DESC bufferDesc(0, D3D11_BIND_VERTEX_BUFFER);
-            D3D11_SUBRESOURCE_DATA initData{ nullptr, 0, 0 };
             // 位置
             if (pAiMesh->mNumVertices > 0)
             {
-                initData.pSysMem = pAiMesh->mVertices;
-                bufferDesc.ByteWidth = numVertices * sizeof(XMFLOAT3);
-                device->CreateBuffer(&bufferDesc, &initData, mesh.m_pVertices.GetAddressOf());
+                streamData.positions = reinterpret_cast<const XMFLOAT3*>(pAiMesh->mVertices);
 
                 BoundingBox::CreateFromPoints(mesh.m_BoundingBox, numVertices,
                     (const XMFLOAT3*)pAiMesh->mVertices, sizeof(XMFLOAT3));
@@ -56,36 +63,30 @@ void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view
                     model.boundingbox = mesh.m_BoundingBox;
                 else
                     model.boundingbox.CreateMerged(model.boundingbox, model.boundingbox, mesh.m_BoundingBox);
+
+                ComputeTightBoundingVolumes(mesh, streamData.positions, numVertices);
+                modelPositions.insert(modelPositions.end(), streamData.positions, streamData.positions + numVertices);
             }
 
             // 法线
             if (pAiMesh->HasNormals())
-            {
-                initData.pSysMem = pAiMesh->mNormals;
-                bufferDesc.ByteWidth = numVertices * sizeof(XMFLOAT3);
-                device->CreateBuffer(&bufferDesc, &initData, mesh.m_pNormals.GetAddressOf());
-            }
+                streamData.normals = reinterpret_cast<const XMFLOAT3*>(pAiMesh->mNormals);
 
             // 切线和副切线
+            std::vector<XMFLOAT4> tangents, bitangents;
             if (pAiMesh->HasTangentsAndBitangents())
             {
-                std::vector<XMFLOAT4> tangents(numVertices, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+                tangents.assign(numVertices, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+                bitangents.assign(numVertices, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
                 for (uint32_t i = 0; i < pAiMesh->mNumVertices; ++i)
                 {
                     memcpy_s(&tangents[i], sizeof(XMFLOAT3),
                         pAiMesh->mTangents + i, sizeof(XMFLOAT3));
-                }
-
-                initData.pSysMem = tangents.data();
-                bufferDesc.ByteWidth = pAiMesh->mNumVertices * sizeof(XMFLOAT4);
-                device->CreateBuffer(&bufferDesc, &initData, mesh.m_pTangents.GetAddressOf());
-
-                for (uint32_t i = 0; i < pAiMesh->mNumVertices; ++i)
-                {
-                    memcpy_s(&tangents[i], sizeof(XMFLOAT3),
+                    memcpy_s(&bitangents[i], sizeof(XMFLOAT3),
                         pAiMesh->mBitangents + i, sizeof(XMFLOAT3));
                 }
-                device->CreateBuffer(&bufferDesc, &initData, mesh.m_pBitangents.GetAddressOf());
+                streamData.tangents = tangents.data();
+                streamData.bitangents = bitangents.data();
             }
 
             // 纹理坐标
@@ -93,52 +94,85 @@ void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view
             while (numUVs && !pAiMesh->HasTextureCoords(numUVs - 1))
                 numUVs--;
 
-            if (numUVs > 0)
+            std::vector<std::vector<XMFLOAT2>> uvArrays(numUVs);
+            for (uint32_t i = 0; i < numUVs; ++i)
             {
-                mesh.m_pTexcoordArrays.resize(numUVs);
-                for (uint32_t i = 0; i < numUVs; ++i)
+                uvArrays[i].resize(numVertices);
+                for (uint32_t j = 0; j < numVertices; ++j)
                 {
-                    std::vector<XMFLOAT2> uvs(numVertices);
-                    for (uint32_t j = 0; j < numVertices; ++j)
-                    {
-                        memcpy_s(&uvs[j], sizeof(XMFLOAT2),
-                            pAiMesh->mTextureCoords[i] + j, sizeof(XMFLOAT2));
-                    }
-                    initData.pSysMem = uvs.data();
-                    bufferDesc.ByteWidth = numVertices * sizeof(XMFLOAT2);
-                    device->CreateBuffer(&bufferDesc, &initData, mesh.m_pTexcoordArrays[i].GetAddressOf());
+                    memcpy_s(&uvArrays[i][j], sizeof(XMFLOAT2),
+                        pAiMesh->mTextureCoords[i] + j, sizeof(XMFLOAT2));
                 }
+                streamData.texcoords[i] = uvArrays[i].data();
             }
+            streamData.numTexcoords = numUVs;
 
             // 索引
             uint32_t numFaces = pAiMesh->mNumFaces;
             uint32_t numIndices = numFaces * 3;
+            std::vector<uint16_t> indices16;
+            std::vector<uint32_t> indices32;
             if (numFaces > 0)
             {
                 mesh.m_IndexCount = numIndices;
-                if (numIndices < 65535)
+                if (numIndices <= 65535)
                 {
-                    std::vector<uint16_t> indices(numIndices);
+                    indices16.resize(numIndices);
                     for (size_t i = 0; i < numFaces; ++i)
                     {
-                        indices[i * 3] = static_cast<uint16_t>(pAiMesh->mFaces[i].mIndices[0]);
-                        indices[i * 3 + 1] = static_cast<uint16_t>(pAiMesh->mFaces[i].mIndices[1]);
-                        indices[i * 3 + 2] = static_cast<uint16_t>(pAiMesh->mFaces[i].mIndices[2]);
+                        indices16[i * 3] = static_cast<uint16_t>(pAiMesh->mFaces[i].mIndices[0]);
+                        indices16[i * 3 + 1] = static_cast<uint16_t>(pAiMesh->mFaces[i].mIndices[1]);
+                        indices16[i * 3 + 2] = static_cast<uint16_t>(pAiMesh->mFaces[i].mIndices[2]);
                     }
-                    bufferDesc = CD3D11_BUFFER_DESC(numIndices * sizeof(uint16_t), D3D11_BIND_INDEX_BUFFER);
-                    initData.pSysMem = indices.data();
-                    device->CreateBuffer(&bufferDesc, &initData, mesh.m_pIndices.GetAddressOf());
+                    streamData.indices = indices16.data();
                 }
                 else
                 {
-                    std::vector<uint32_t> indices(numIndices);
+                    indices32.resize(numIndices);
                     for (size_t i = 0; i < numFaces; ++i)
                     {
-                        memcpy_s(indices.data() + i * 3, sizeof(uint32_t) * 3,
+                        memcpy_s(indices32.data() + i * 3, sizeof(uint32_t) * 3,
                             pAiMesh->mFaces[i].mIndices, sizeof(uint32_t) * 3);
                     }
-                    bufferDesc = CD3D11_BUFFER_DESC(numIndices * sizeof(uint32_t), D3D11_BIND_INDEX_BUFFER);
-                    initData.pSysMem = indices.data();
+                    streamData.indices = indices32.data();
+                    streamData.index32 = true;
+                }
+                streamData.indexCount = numIndices;
+
+                if (streamData.positions && numUVs)
+                    mesh.m_UVDensity = ComputeUVDensity(streamData.positions, streamData.texcoords[0],
+                        streamData.indices, streamData.index32, numIndices);
+            }
+
+            // 合并到共享缓冲区，失败时退回到独立缓冲区
+            if (!pPool || !pPool->Allocate(mesh, streamData, poolOwnerID))
+            {
+                CD3D11_BUFFER_DESC bufferDesc(0, D3D11_BIND_VERTEX_BUFFER);
+                D3D11_SUBRESOURCE_DATA initData{ nullptr, 0, 0 };
+                auto CreateStream = [&](const void* pData, uint32_t stride, ComPtr<ID3D11Buffer>& buffer) {
+                    initData.pSysMem = pData;
+                    bufferDesc.ByteWidth = numVertices * stride;
+                    device->CreateBuffer(&bufferDesc, &initData, buffer.GetAddressOf());
+                };
+
+                if (streamData.positions)
+                    CreateStream(streamData.positions, sizeof(XMFLOAT3), mesh.m_pVertices);
+                if (streamData.normals)
+                    CreateStream(streamData.normals, sizeof(XMFLOAT3), mesh.m_pNormals);
+                if (streamData.tangents)
+                {
+                    CreateStream(streamData.tangents, sizeof(XMFLOAT4), mesh.m_pTangents);
+                    CreateStream(streamData.bitangents, sizeof(XMFLOAT4), mesh.m_pBitangents);
+                }
+                mesh.m_pTexcoordArrays.resize(numUVs);
+                for (uint32_t i = 0; i < numUVs; ++i)
+                    CreateStream(streamData.texcoords[i], sizeof(XMFLOAT2), mesh.m_pTexcoordArrays[i]);
+
+                if (streamData.indices)
+                {
+                    bufferDesc = CD3D11_BUFFER_DESC(numIndices * (streamData.index32 ? 4u : 2u),
+                        D3D11_BIND_INDEX_BUFFER);
+                    initData.pSysMem = streamData.indices;
                     device->CreateBuffer(&bufferDesc, &initData, mesh.m_pIndices.GetAddressOf());
                 }
             }
@@ -147,6 +181,12 @@ void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view
             mesh.m_MaterialIndex = pAiMesh->mMaterialIndex;
         }
 
+        if (!modelPositions.empty())
+        {
+            model.boundingorientedbox = Collision::ComputeTightOrientedBox(modelPositions.data(), modelPositions.size());
+            model.boundingsphere = Collision::ComputeTightSphere(modelPositions.data(), modelPositions.size());
+        }
+
 
         for (uint32_t i = 0; i < pAssimpScene->mNumMaterials; ++i)
         {
@@ -231,7 +271,8 @@ void Model::CreateFromFile(Model& model, ID3D11Device* device, std::string_view
     }
 }
 
-void Model::CreateFromGeometry(Model& model, ID3D11Device* device, const GeometryData& data, bool isDynamic)
+void Model::CreateFromGeometry(Model& model, ID3D11Device* device, const GeometryData& data, bool isDynamic,
+    uint32_t trianglesPerCluster)
 {
     // 默认材质
     model.materials = { Material{} };
@@ -247,6 +288,16 @@ void Model::CreateFromGeometry(Model& model, ID3D11Device* device, const Geometr
     model.meshdatas[0].m_IndexCount = (uint32_t)(!data.indices16.empty() ? data.indices16.size() : data.indices32.size());
     model.meshdatas[0].m_MaterialIndex = 0;
 
+    if (!data.vertices.empty())
+    {
+        BoundingBox::CreateFromPoints(model.meshdatas[0].m_BoundingBox, data.vertices.size(),
+            data.vertices.data(), sizeof(XMFLOAT3));
+        ComputeTightBoundingVolumes(model.meshdatas[0], data.vertices.data(), data.vertices.size());
+        model.boundingbox = model.meshdatas[0].m_BoundingBox;
+        model.boundingorientedbox = model.meshdatas[0].m_BoundingOrientedBox;
+        model.boundingsphere = model.meshdatas[0].m_BoundingSphere;
+    }
+
     CD3D11_BUFFER_DESC bufferDesc(0,
         D3D11_BIND_VERTEX_BUFFER,
         isDynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT,
@@ -278,22 +329,164 @@ void Model::CreateFromGeometry(Model& model, ID3D11Device* device, const Geometr
         device->CreateBuffer(&bufferDesc, &initData, model.meshdatas[0].m_pTangents.GetAddressOf());
     }
 
+    // 分簇时需要重排索引
+    std::vector<uint16_t> clusteredIndices16;
+    std::vector<uint32_t> clusteredIndices32;
+    const void* pIndices = !data.indices16.empty() ? (const void*)data.indices16.data() : data.indices32.data();
+    if (trianglesPerCluster > 0 && !data.vertices.empty())
+    {
+        if (!data.indices16.empty())
+        {
+            clusteredIndices16 = data.indices16;
+            pIndices = clusteredIndices16.data();
+            BuildClusters(model.meshdatas[0], data.vertices.data(), clusteredIndices16.data(), false,
+                model.meshdatas[0].m_IndexCount, trianglesPerCluster);
+        }
+        else
+        {
+            clusteredIndices32 = data.indices32;
+            pIndices = clusteredIndices32.data();
+            BuildClusters(model.meshdatas[0], data.vertices.data(), clusteredIndices32.data(), true,
+                model.meshdatas[0].m_IndexCount, trianglesPerCluster);
+        }
+    }
+
     bufferDesc.Usage = D3D11_USAGE_DEFAULT;
     bufferDesc.CPUAccessFlags = 0;
+    initData.pSysMem = pIndices;
     if (!data.indices16.empty())
     {
-        initData.pSysMem = data.indices16.data();
         bufferDesc = CD3D11_BUFFER_DESC((uint16_t)data.indices16.size() * sizeof(uint16_t), D3D11_BIND_INDEX_BUFFER);
         device->CreateBuffer(&bufferDesc, &initData, model.meshdatas[0].m_pIndices.GetAddressOf());
     }
     else
     {
-        initData.pSysMem = data.indices32.data();
         bufferDesc = CD3D11_BUFFER_DESC((uint32_t)data.indices32.size() * sizeof(uint32_t), D3D11_BIND_INDEX_BUFFER);
         device->CreateBuffer(&bufferDesc, &initData, model.meshdatas[0].m_pIndices.GetAddressOf());
     }
 }
 
+void Model::ComputeTightBoundingVolumes(MeshData& meshData, const DirectX::XMFLOAT3* positions, size_t count)
+{
+    meshData.m_BoundingOrientedBox = Collision::ComputeTightOrientedBox(positions, count);
+    meshData.m_BoundingSphere = Collision::ComputeTightSphere(positions, count);
+
+    const XMFLOAT3& e = meshData.m_BoundingOrientedBox.Extents;
+    float obbVolume = 8.0f * e.x * e.y * e.z;
+    float r = meshData.m_BoundingSphere.Radius;
+    float sphereVolume = 4.0f / 3.0f * XM_PI * r * r * r;
+    meshData.m_UseBoundingSphere = sphereVolume < obbVolume;
+}
+
+float Model::ComputeUVDensity(const DirectX::XMFLOAT3* positions, const DirectX::XMFLOAT2* texcoords,
+    const void* indices, bool index32, uint32_t indexCount)
+{
+    double worldArea = 0.0, uvArea = 0.0;
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        uint32_t idx[3];
+        for (uint32_t j = 0; j < 3; ++j)
+            idx[j] = index32 ? static_cast<const uint32_t*>(indices)[i + j] : static_cast<const uint16_t*>(indices)[i + j];
+
+        XMVECTOR P0 = XMLoadFloat3(positions + idx[0]);
+        XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(positions + idx[1]), P0);
+        XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(positions + idx[2]), P0);
+        worldArea += 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(e1, e2)));
+
+        XMFLOAT2 t0 = texcoords[idx[0]], t1 = texcoords[idx[1]], t2 = texcoords[idx[2]];
+        uvArea += 0.5f * fabsf((t1.x - t0.x) * (t2.y - t0.y) - (t2.x - t0.x) * (t1.y - t0.y));
+    }
+    return worldArea > 0.0 ? static_cast<float>(sqrt(uvArea / worldArea)) : 0.0f;
+}
+
+void Model::BuildClusters(MeshData& meshData, const DirectX::XMFLOAT3* positions,
+    void* indices, bool index32, uint32_t indexCount, uint32_t trianglesPerCluster)
+{
+    meshData.m_Clusters.clear();
+    uint32_t triangleCount = indexCount / 3;
+    if (trianglesPerCluster == 0 || triangleCount == 0)
+        return;
+
+    auto GetIndex = [&](uint32_t i) -> uint32_t {
+        return index32 ? static_cast<uint32_t*>(indices)[i] : static_cast<uint16_t*>(indices)[i];
+    };
+    // 把10位整数的各位间隔两位展开，用于交织成30位的Morton码
+    auto ExpandBits = [](uint32_t v) -> uint64_t {
+        v = (v * 0x00010001u) & 0xFF0000FFu;
+        v = (v * 0x00000101u) & 0x0F00F00Fu;
+        v = (v * 0x00000011u) & 0xC30C30C3u;
+        v = (v * 0x00000005u) & 0x49249249u;
+        return v;
+    };
+
+    std::vector<XMFLOAT3> centroids(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        XMVECTOR sum = XMVectorAdd(XMVectorAdd(XMLoadFloat3(positions + GetIndex(3 * t)),
+            XMLoadFloat3(positions + GetIndex(3 * t + 1))), XMLoadFloat3(positions + GetIndex(3 * t + 2)));
+        XMStoreFloat3(&centroids[t], XMVectorScale(sum, 1.0f / 3.0f));
+    }
+    BoundingBox centroidBox;
+    BoundingBox::CreateFromPoints(centroidBox, triangleCount, centroids.data(), sizeof(XMFLOAT3));
+    XMVECTOR boxMin = XMVectorSubtract(XMLoadFloat3(&centroidBox.Center), XMLoadFloat3(&centroidBox.Extents));
+    XMVECTOR invSize = XMVectorReciprocal(XMVectorMax(XMVectorScale(XMLoadFloat3(&centroidBox.Extents), 2.0f),
+        XMVectorReplicate(1e-6f)));
+
+    // 键的高位为法线主方向(0~5)，低30位为重心的Morton码
+    std::vector<uint64_t> keys(triangleCount);
+    std::vector<uint32_t> order(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        XMVECTOR P0 = XMLoadFloat3(positions + GetIndex(3 * t));
+        XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(positions + GetIndex(3 * t + 1)), P0);
+        XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(positions + GetIndex(3 * t + 2)), P0);
+        XMFLOAT3 n;
+        XMStoreFloat3(&n, XMVector3Cross(e1, e2));
+        float absN[3] = { fabsf(n.x), fabsf(n.y), fabsf(n.z) };
+        uint32_t axis = absN[0] >= absN[1] ? (absN[0] >= absN[2] ? 0 : 2) : (absN[1] >= absN[2] ? 1 : 2);
+        uint32_t dir = axis * 2 + ((&n.x)[axis] < 0.0f ? 1 : 0);
+
+        XMFLOAT3 p;
+        XMStoreFloat3(&p, XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&centroids[t]), boxMin), invSize));
+        auto Quantize = [](float f) { return (uint32_t)(std::min)((std::max)(f, 0.0f) * 1023.0f, 1023.0f); };
+        uint64_t morton = (ExpandBits(Quantize(p.x)) << 2) | (ExpandBits(Quantize(p.y)) << 1) | ExpandBits(Quantize(p.z));
+        keys[t] = ((uint64_t)dir << 30) | morton;
+        order[t] = t;
+    }
+    CpuSort::RadixSort(keys.data(), order.data(), triangleCount);
+
+    // 按新的顺序重排三角形
+    std::vector<uint32_t> oldIndices(indexCount);
+    for (uint32_t i = 0; i < indexCount; ++i)
+        oldIndices[i] = GetIndex(i);
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            uint32_t idx = oldIndices[3 * order[t] + j];
+            if (index32)
+                static_cast<uint32_t*>(indices)[3 * t + j] = idx;
+            else
+                static_cast<uint16_t*>(indices)[3 * t + j] = (uint16_t)idx;
+        }
+    }
+
+    std::vector<XMFLOAT3> clusterPoints;
+    for (uint32_t first = 0; first < triangleCount; first += trianglesPerCluster)
+    {
+        uint32_t last = (std::min)(first + trianglesPerCluster, triangleCount);
+        clusterPoints.clear();
+        for (uint32_t i = 3 * first; i < 3 * last; ++i)
+            clusterPoints.push_back(positions[GetIndex(i)]);
+
+        MeshCluster cluster;
+        cluster.startIndex = 3 * first;
+        cluster.indexCount = 3 * (last - first);
+        BoundingSphere::CreateFromPoints(cluster.boundingSphere, clusterPoints.size(), clusterPoints.data(), sizeof(XMFLOAT3));
+        meshData.m_Clusters.push_back(cluster);
+    }
+}
+
 void Model::SetDebugObjectName(std::string_view name)
 {
 #if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
@@ -345,6 +538,13 @@ ModelManager::ModelManager()
 
 ModelManager::~ModelManager()
 {
+    if (s_pInstance == this)
+        s_pInstance = nullptr;
+}
+
+bool ModelManager::HasInstance()
+{
+    return s_pInstance != nullptr;
 }
 
 ModelManager& ModelManager::Get()
@@ -358,6 +558,12 @@ void ModelManager::Init(ID3D11Device* device)
 {
     m_pDevice = device;
     m_pDevice->GetImmediateContext(m_pDeviceContext.ReleaseAndGetAddressOf());
+    m_MeshBufferPool.Init(device);
+}
+
+void ModelManager::SetMeshMergeMode(MeshMergeMode mode)
+{
+    m_MeshMergeMode = mode;
 }
 
 Model* ModelManager::CreateFromFile(std::string_view filename)
@@ -369,15 +575,24 @@ Model* ModelManager::CreateFromFile(std::string_view name, std::string_view file
 {
     XID modelID = StringToID(name);
     auto& model = m_Models[modelID];
-    Model::CreateFromFile(model, m_pDevice.Get(), filename);
+    ReleaseMeshBuffers(model);
+    if (m_MeshMergeMode == MeshMergeMode::None)
+        Model::CreateFromFile(model, m_pDevice.Get(), filename);
+    else
+        Model::CreateFromFile(model, m_pDevice.Get(), filename, &m_MeshBufferPool,
+            m_MeshMergeMode == MeshMergeMode::PerModel ? modelID : 0);
+    TrackModel(modelID, model, MemoryCategory_File);
     return &model;
 }
 
-Model* ModelManager::CreateFromGeometry(std::string_view name, const GeometryData& data, bool isDynamic)
+Model* ModelManager::CreateFromGeometry(std::string_view name, const GeometryData& data, bool isDynamic,
+    uint32_t trianglesPerCluster)
 {
     XID modelID = StringToID(name);
     auto& model = m_Models[modelID];
-    Model::CreateFromGeometry(model, m_pDevice.Get(), data, isDynamic);
+    ReleaseMeshBuffers(model);
+    Model::CreateFromGeometry(model, m_pDevice.Get(), data, isDynamic, trianglesPerCluster);
+    TrackModel(modelID, model, isDynamic ? MemoryCategory_Dynamic : MemoryCategory_Geometry);
 
     return &model;
 }
@@ -393,7 +608,150 @@ const Model* ModelManager::GetModel(std::string_view name) const
 Model* ModelManager::GetModel(std::string_view name)
 {
     XID nameID = StringToID(name);
-    if (m_Models.count(nameID))
-        return &m_Models[nameID];
-    return nullptr;
+    auto it = m_Models.find(nameID);
+    if (it == m_Models.end())
+        return nullptr;
+    m_Budget.Touch(nameID);
+    return &it->second;
+}
+
+void ModelManager::RemoveModel(std::string_view name)
+{
+    XID nameID = StringToID(name);
+    if (auto it = m_Models.find(nameID); it != m_Models.end())
+    {
+        // 仍被GameObject引用的模型被移除后，这些引用随之失效
+        UntrackModel(nameID, false);
+        ReleaseMeshBuffers(it->second);
+        m_Models.erase(it);
+        m_MeshBufferPool.Trim();
+    }
+}
+
+MeshBufferPool::Stats ModelManager::GetMeshBufferPoolStats() const
+{
+    return m_MeshBufferPool.GetStats();
+}
+
+void ModelManager::ReleaseMeshBuffers(Model& model)
+{
+    // 独立缓冲区在MeshData析构时释放，这里只需归还共享缓冲区中的区间
+    for (auto& mesh : model.meshdatas)
+        m_MeshBufferPool.Free(mesh);
+}
+
+void ModelManager::AddRef(const Model* pModel)
+{
+    if (auto it = m_ModelIDs.find(pModel); it != m_ModelIDs.end())
+        m_Budget.AddRef(it->second);
+}
+
+void ModelManager::Release(const Model* pModel)
+{
+    if (auto it = m_ModelIDs.find(pModel); it != m_ModelIDs.end())
+        m_Budget.Release(it->second);
+}
+
+void ModelManager::SetMaterialTexture(Model& model, Material& material, std::string_view key, std::string_view name)
+{
+    std::string oldName = material.Has<std::string>(key) ? material.Get<std::string>(key) : std::string();
+    material.Set<std::string>(key, std::string(name));
+
+    auto idIt = m_ModelIDs.find(&model);
+    if (idIt == m_ModelIDs.end())
+        return;
+    // 记录中替换一个旧名字，移除或回收模型时释放的就是新纹理
+    auto& textures = m_ModelTextures[idIt->second];
+    auto it = std::find(textures.begin(), textures.end(), oldName);
+    if (it != textures.end())
+    {
+        TextureManager::Get().Release(*it);
+        *it = name;
+    }
+    else
+    {
+        textures.emplace_back(name);
+    }
+    TextureManager::Get().AddRef(name);
+}
+
+void ModelManager::SetMemoryBudget(size_t bytes)
+{
+    m_Budget.SetBudget(bytes);
+}
+
+std::string ModelManager::GetMemoryReport() const
+{
+    static const char* s_CategoryNames[MemoryCategory_Count] = { "File", "Geometry", "Dynamic" };
+    return m_Budget.FormatReport("Models", s_CategoryNames);
+}
+
+void ModelManager::Update()
+{
+    std::vector<XID> evicted;
+    m_Budget.CollectEvictions(evicted);
+    for (XID id : evicted)
+    {
+        auto it = m_Models.find(id);
+        UntrackModel(id, false);
+        ReleaseMeshBuffers(it->second);
+        m_Models.erase(it);
+    }
+    if (!evicted.empty())
+        m_MeshBufferPool.Trim();
+    m_Budget.NextFrame();
+}
+
+void ModelManager::TrackModel(XID id, const Model& model, MemoryCategory category)
+{
+    // 重新创建同名模型时，先释放旧材质对纹理的引用，GameObject的引用保持不变
+    auto& textures = m_ModelTextures[id];
+    for (auto& name : textures)
+        TextureManager::Get().Release(name);
+    textures.clear();
+    for (auto& material : model.materials)
+    {
+        for (const char* key : Model::TextureKeys)
+        {
+            if (material.Has<std::string>(key))
+                textures.push_back(material.Get<std::string>(key));
+        }
+    }
+    for (auto& name : textures)
+        TextureManager::Get().AddRef(name);
+
+    m_ModelIDs[&model] = id;
+    m_Budget.Track(id, ComputeModelBytes(model), category);
+}
+
+void ModelManager::UntrackModel(XID id, bool keepRefCount)
+{
+    if (auto it = m_ModelTextures.find(id); it != m_ModelTextures.end())
+    {
+        for (auto& name : it->second)
+            TextureManager::Get().Release(name);
+        m_ModelTextures.erase(it);
+    }
+    if (auto it = m_Models.find(id); it != m_Models.end())
+        m_ModelIDs.erase(&it->second);
+    m_Budget.Untrack(id, keepRefCount);
+}
+
+size_t ModelManager::ComputeModelBytes(const Model& model)
+{
+    size_t bytes = 0;
+    for (auto& mesh : model.meshdatas)
+    {
+        size_t vertexStride = 0;
+        vertexStride += mesh.m_pVertices ? sizeof(XMFLOAT3) : 0;
+        vertexStride += mesh.m_pNormals ? sizeof(XMFLOAT3) : 0;
+        vertexStride += mesh.m_pTangents ? sizeof(XMFLOAT4) : 0;
+        vertexStride += mesh.m_pBitangents ? sizeof(XMFLOAT4) : 0;
+        vertexStride += mesh.m_pColors ? sizeof(XMFLOAT4) : 0;
+        for (auto& pTexcoords : mesh.m_pTexcoordArrays)
+            vertexStride += pTexcoords ? sizeof(XMFLOAT2) : 0;
+        bytes += vertexStride * mesh.m_VertexCount;
+        bytes += (size_t)mesh.m_IndexCount * (mesh.m_IndexCount > 65535 ? 4 : 2);
+    }
+    return bytes;
 }
@@ -15,6 +15,8 @@
 #include "Geometry.h"
 #include "Material.h"
 #include "MeshData.h"
+#include "MeshBufferPool.h"
+#include "ResourceBudget.h"
 #include <d3d11_1.h>
 #include <wrl/client.h>
 
@@ -27,16 +29,45 @@ struct Model
     Model(Model&&) = default;
     Model& operator=(Model&&) = default;
 
+    // 读取模型文件时材质中可能出现的纹理属性
+    static constexpr const char* TextureKeys[] = {
+        "$Diffuse", "$Normal", "$Albedo", "$NormalCamera", "$Metalness", "$Roughness", "$AmbientOcclusion"
+    };
+
     std::vector<Material> materials;
     std::vector<MeshData> meshdatas;
     DirectX::BoundingBox boundingbox;
-    static void CreateFromFile(Model& model, ID3D11Device* device, std::string_view filename);
-    static void CreateFromGeometry(Model& model, ID3D11Device* device, const GeometryData& data, bool isDynamic = false);
+    DirectX::BoundingOrientedBox boundingorientedbox;
+    DirectX::BoundingSphere boundingsphere;
+    // pPool不为空时，子网格会被合并到共享的顶点/索引缓冲区中
+    static void CreateFromFile(Model& model, ID3D11Device* device, std::string_view filename,
+        MeshBufferPool* pPool = nullptr, XID poolOwnerID = 0);
+    // trianglesPerCluster不为0时重排三角形并把子网格划分为簇
+    static void CreateFromGeometry(Model& model, ID3D11Device* device, const GeometryData& data, bool isDynamic = false,
+        uint32_t trianglesPerCluster = 0);
     
     void SetDebugObjectName(std::string_view name);
+
+    // 计算子网格的紧凑OBB和包围球，并选择其中较紧凑者用于裁剪
+    static void ComputeTightBoundingVolumes(MeshData& meshData, const DirectX::XMFLOAT3* positions, size_t count);
+    // 按三角形面积加权的sqrt(UV面积 / 局部空间面积)
+    static float ComputeUVDensity(const DirectX::XMFLOAT3* positions, const DirectX::XMFLOAT2* texcoords,
+        const void* indices, bool index32, uint32_t indexCount);
+    // 按三角形法线的主方向和重心的Morton码重排索引，再每trianglesPerCluster个三角形划为一簇
+    // 使同一簇中的三角形朝向相近且空间上相邻
+    static void BuildClusters(MeshData& meshData, const DirectX::XMFLOAT3* positions,
+        void* indices, bool index32, uint32_t indexCount, uint32_t trianglesPerCluster);
 };
 
 
+// 子网格缓冲区的合并方式
+enum class MeshMergeMode
+{
+    None,       // 每个子网格独立的顶点/索引缓冲区
+    PerModel,   // 同一模型中布局相同的子网格共享缓冲区
+    Global      // 所有模型中布局相同的子网格共享缓冲区
+};
+
 class ModelManager
 {
 public:
@@ -49,16 +80,61 @@ public:
 
     static ModelManager& Get();
     void Init(ID3D11Device* device);
+    // 仅影响之后通过文件读取的模型，动态几何体始终使用独立缓冲区
+    void SetMeshMergeMode(MeshMergeMode mode);
     Model* CreateFromFile(std::string_view filename);
     Model* CreateFromFile(std::string_view name, std::string_view filename);
-    Model* CreateFromGeometry(std::string_view name, const GeometryData& data, bool isDynamic = false);
+    Model* CreateFromGeometry(std::string_view name, const GeometryData& data, bool isDynamic = false,
+        uint32_t trianglesPerCluster = 0);
 
     const Model* GetModel(std::string_view name) const;
     Model* GetModel(std::string_view name);
+    void RemoveModel(std::string_view name);
+
+    MeshBufferPool::Stats GetMeshBufferPoolStats() const;
+
+    //
+    // 内存统计与回收
+    //
+
+    enum MemoryCategory
+    {
+        MemoryCategory_File,            // 从文件读取的模型
+        MemoryCategory_Geometry,        // 静态几何体
+        MemoryCategory_Dynamic,         // 动态几何体
+        MemoryCategory_Count
+    };
+
+    static bool HasInstance();
+    // 引用计数，GameObject::SetModel会自动增减；不是由ModelManager创建的模型忽略
+    void AddRef(const Model* pModel);
+    void Release(const Model* pModel);
+    // 把模型材质中key对应的纹理改为name，ModelManager创建的模型同时转移其对纹理的引用
+    void SetMaterialTexture(Model& model, Material& material, std::string_view key, std::string_view name);
+    // 顶点/索引数据的预算，0表示不限制。超出预算时，Update会回收没有引用、
+    // 且上一帧之后没有被GetModel访问的模型，同时释放其对材质纹理的引用
+    void SetMemoryBudget(size_t bytes);
+    size_t GetMemoryUsage() const { return m_Budget.GetTotalBytes(); }
+    std::string GetMemoryReport() const;
+    // 每帧调用一次
+    void Update();
+
 private:
+    void ReleaseMeshBuffers(Model& model);
+    // 统计模型的字节数，并为材质中的纹理增加引用
+    void TrackModel(XID id, const Model& model, MemoryCategory category);
+    void UntrackModel(XID id, bool keepRefCount);
+    // 按顶点数和索引数估算，合并到共享缓冲区的子网格只计算自己占用的部分
+    static size_t ComputeModelBytes(const Model& model);
+
     Microsoft::WRL::ComPtr<ID3D11Device> m_pDevice;
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_pDeviceContext;
     std::unordered_map<size_t, Model> m_Models;
+    MeshBufferPool m_MeshBufferPool;
+    MeshMergeMode m_MeshMergeMode = MeshMergeMode::None;
+    ResourceBudget m_Budget{ MemoryCategory_Count };
+    std::unordered_map<const Model*, XID> m_ModelIDs;
+    std::unordered_map<XID, std::vector<std::string>> m_ModelTextures;     // 模型增加了引用的纹理
 };
 
 
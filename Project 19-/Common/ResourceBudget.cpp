@@ -0,0 +1,133 @@
+#include "ResourceBudget.h"
+#include <algorithm>
+#include <cstdio>
+
+void ResourceBudget::Track(XID id, size_t bytes, uint32_t category)
+{
+    Entry& entry = m_Entries[id];
+    if (entry.tracked)
+        m_TotalBytes -= entry.bytes;
+    entry.bytes = bytes;
+    entry.category = (std::min)(category, m_NumCategories - 1);
+    entry.lastUsedFrame = m_FrameIndex;
+    entry.tracked = true;
+    m_TotalBytes += bytes;
+}
+
+void ResourceBudget::Untrack(XID id, bool keepRefCount)
+{
+    auto it = m_Entries.find(id);
+    if (it == m_Entries.end())
+        return;
+    if (it->second.tracked)
+        m_TotalBytes -= it->second.bytes;
+    if (keepRefCount && it->second.refCount)
+    {
+        it->second.bytes = 0;
+        it->second.tracked = false;
+    }
+    else
+    {
+        m_Entries.erase(it);
+    }
+}
+
+bool ResourceBudget::IsTracked(XID id) const
+{
+    auto it = m_Entries.find(id);
+    return it != m_Entries.end() && it->second.tracked;
+}
+
+void ResourceBudget::AddRef(XID id)
+{
+    ++m_Entries[id].refCount;
+}
+
+void ResourceBudget::Release(XID id)
+{
+    auto it = m_Entries.find(id);
+    if (it == m_Entries.end() || !it->second.refCount)
+        return;
+    // 引用归零时视为刚刚用过，避免在同一帧内被立即回收
+    it->second.lastUsedFrame = m_FrameIndex;
+    if (--it->second.refCount == 0 && !it->second.tracked)
+        m_Entries.erase(it);
+}
+
+uint32_t ResourceBudget::GetRefCount(XID id) const
+{
+    auto it = m_Entries.find(id);
+    return it != m_Entries.end() ? it->second.refCount : 0;
+}
+
+void ResourceBudget::Touch(XID id)
+{
+    auto it = m_Entries.find(id);
+    if (it != m_Entries.end())
+        it->second.lastUsedFrame = m_FrameIndex;
+}
+
+void ResourceBudget::CollectEvictions(std::vector<XID>& evicted)
+{
+    evicted.clear();
+    if (!m_BudgetBytes || m_TotalBytes <= m_BudgetBytes)
+        return;
+
+    std::vector<std::pair<uint64_t, XID>> candidates;
+    for (auto& [id, entry] : m_Entries)
+    {
+        if (entry.tracked && !entry.refCount && entry.lastUsedFrame + 1 < m_FrameIndex)
+            candidates.emplace_back(entry.lastUsedFrame, id);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (auto& [lastUsedFrame, id] : candidates)
+    {
+        if (m_TotalBytes <= m_BudgetBytes)
+            break;
+        Untrack(id);
+        evicted.push_back(id);
+        ++m_EvictedCount;
+    }
+}
+
+std::vector<ResourceBudget::CategoryUsage> ResourceBudget::GetCategoryUsage() const
+{
+    std::vector<CategoryUsage> usages(m_NumCategories);
+    for (auto& [id, entry] : m_Entries)
+    {
+        if (!entry.tracked)
+            continue;
+        CategoryUsage& usage = usages[entry.category];
+        ++usage.count;
+        usage.bytes += entry.bytes;
+        if (entry.refCount)
+        {
+            ++usage.referencedCount;
+            usage.referencedBytes += entry.bytes;
+        }
+    }
+    return usages;
+}
+
+std::string ResourceBudget::FormatReport(const char* title, const char* const* categoryNames) const
+{
+    char buffer[256];
+    std::string report;
+    if (m_BudgetBytes)
+        snprintf(buffer, sizeof buffer, "%s: %.2fMB / %.2fMB, %u evicted\n", title,
+            m_TotalBytes / 1048576.0, m_BudgetBytes / 1048576.0, m_EvictedCount);
+    else
+        snprintf(buffer, sizeof buffer, "%s: %.2fMB (no budget)\n", title, m_TotalBytes / 1048576.0);
+    report += buffer;
+
+    auto usages = GetCategoryUsage();
+    for (uint32_t i = 0; i < m_NumCategories; ++i)
+    {
+        const CategoryUsage& usage = usages[i];
+        snprintf(buffer, sizeof buffer, "  %-10s %4u (%u referenced)  %8.2fMB (%.2fMB referenced)\n", categoryNames[i],
+            usage.count, usage.referencedCount, usage.bytes / 1048576.0, usage.referencedBytes / 1048576.0);
+        report += buffer;
+    }
+    return report;
+}
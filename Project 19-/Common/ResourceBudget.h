@@ -0,0 +1,79 @@
+//***************************************************************************************
+// ResourceBudget.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 资源的字节统计、引用计数与LRU回收
+// Byte accounting, reference counting and LRU eviction of cached resources.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef RESOURCE_BUDGET_H
+#define RESOURCE_BUDGET_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "XUtil.h"
+
+class ResourceBudget
+{
+public:
+    struct CategoryUsage
+    {
+        uint32_t count = 0;
+        uint32_t referencedCount = 0;
+        size_t bytes = 0;
+        size_t referencedBytes = 0;
+    };
+
+    explicit ResourceBudget(uint32_t numCategories = 1) : m_NumCategories(numCategories) {}
+
+    // 0表示不限制
+    void SetBudget(size_t bytes) { m_BudgetBytes = bytes; }
+    size_t GetBudget() const { return m_BudgetBytes; }
+
+    // 新增资源或更新其字节数与类别，不改变引用计数
+    void Track(XID id, size_t bytes, uint32_t category);
+    // 资源被移除。keepRefCount为true且仍有引用时保留引用计数，以便重新载入后继续生效
+    void Untrack(XID id, bool keepRefCount = true);
+    bool IsTracked(XID id) const;
+
+    // 资源尚未被Track时也可以先增加引用
+    void AddRef(XID id);
+    void Release(XID id);
+    uint32_t GetRefCount(XID id) const;
+    void Touch(XID id);
+
+    // 每帧调用一次
+    void NextFrame() { ++m_FrameIndex; }
+    // 总字节超出预算时，从最久未使用的资源开始挑选无引用、且上一帧之后没有被访问过的资源，
+    // 直到回到预算之内。挑出的资源会从统计中移除，由调用方负责释放
+    void CollectEvictions(std::vector<XID>& evicted);
+
+    size_t GetTotalBytes() const { return m_TotalBytes; }
+    uint32_t GetEvictedCount() const { return m_EvictedCount; }
+    std::vector<CategoryUsage> GetCategoryUsage() const;
+    // 形如"title: total / budget"，随后每个类别一行
+    std::string FormatReport(const char* title, const char* const* categoryNames) const;
+
+private:
+    struct Entry
+    {
+        size_t bytes = 0;
+        uint64_t lastUsedFrame = 0;
+        uint32_t refCount = 0;
+        uint32_t category = 0;
+        bool tracked = false;
+    };
+
+    std::unordered_map<XID, Entry> m_Entries;
+    uint64_t m_FrameIndex = 1;
+    size_t m_TotalBytes = 0;
+    size_t m_BudgetBytes = 0;
+    uint32_t m_EvictedCount = 0;
+    uint32_t m_NumCategories = 1;
+};
+
+#endif
@@ -802,6 +802,31 @@ HRESULT DirectX::SaveDDSTextureToFile(
     if (FAILED(hr))
         return hr;
 
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    hr = pContext->Map(pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+    if (FAILED(hr))
+        return hr;
+
+    hr = SaveDDSPixelsToFile(desc, mapped.pData, mapped.RowPitch, fileName);
+
+    pContext->Unmap(pStaging.Get(), 0);
+
+    return hr;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveDDSPixelsToFile(
+    const D3D11_TEXTURE2D_DESC& desc,
+    const void* pPixels,
+    size_t srcRowPitch,
+    const wchar_t* fileName) noexcept
+{
+    if (!pPixels || !fileName)
+        return E_INVALIDARG;
+
+    HRESULT hr = S_OK;
+
     // Create file
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
     ScopedHandle hFile(safe_handle(CreateFile2(fileName,
@@ -910,30 +935,17 @@ HRESULT DirectX::SaveDDSTextureToFile(
     if (!pixels)
         return E_OUTOFMEMORY;
 
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    hr = pContext->Map(pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
-    if (FAILED(hr))
-        return hr;
-
-    auto sptr = static_cast<const uint8_t*>(mapped.pData);
-    if (!sptr)
-    {
-        pContext->Unmap(pStaging.Get(), 0);
-        return E_POINTER;
-    }
-
+    auto sptr = static_cast<const uint8_t*>(pPixels);
     uint8_t* dptr = pixels.get();
 
-    const size_t msize = std::min<size_t>(rowPitch, mapped.RowPitch);
+    const size_t msize = std::min<size_t>(rowPitch, srcRowPitch);
     for (size_t h = 0; h < rowCount; ++h)
     {
         memcpy_s(dptr, rowPitch, sptr, msize);
-        sptr += mapped.RowPitch;
+        sptr += srcRowPitch;
         dptr += rowPitch;
     }
 
-    pContext->Unmap(pStaging.Get(), 0);
-
     // Write header & pixels
     DWORD bytesWritten;
     if (!WriteFile(hFile.get(), fileHeader, static_cast<DWORD>(headerSize), &bytesWritten, nullptr))
@@ -973,6 +985,36 @@ HRESULT DirectX::SaveWICTextureToFile(
     if (FAILED(hr))
         return hr;
 
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    hr = pContext->Map(pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+    if (FAILED(hr))
+        return hr;
+
+    hr = SaveWICPixelsToFile(desc, mapped.pData, mapped.RowPitch, guidContainerFormat, fileName,
+        targetFormat, setCustomProps, forceSRGB);
+
+    pContext->Unmap(pStaging.Get(), 0);
+
+    return hr;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveWICPixelsToFile(
+    const D3D11_TEXTURE2D_DESC& desc,
+    const void* pPixels,
+    size_t rowPitch,
+    REFGUID guidContainerFormat,
+    const wchar_t* fileName,
+    const GUID* targetFormat,
+    std::function<void(IPropertyBag2*)> setCustomProps,
+    bool forceSRGB)
+{
+    if (!pPixels || !fileName)
+        return E_INVALIDARG;
+
+    HRESULT hr = S_OK;
+
     // Determine source format's WIC equivalent
     WICPixelFormatGUID pfGuid = {};
     bool sRGB = forceSRGB;
@@ -1182,17 +1224,12 @@ HRESULT DirectX::SaveWICTextureToFile(
         }
     }
 
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    hr = pContext->Map(pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped);
-    if (FAILED(hr))
-        return hr;
+    if (rowPitch > UINT32_MAX)
+        return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
 
-    const uint64_t imageSize = uint64_t(mapped.RowPitch) * uint64_t(desc.Height);
+    const uint64_t imageSize = uint64_t(rowPitch) * uint64_t(desc.Height);
     if (imageSize > UINT32_MAX)
-    {
-        pContext->Unmap(pStaging.Get(), 0);
         return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
-    }
 
     if (memcmp(&targetGuid, &pfGuid, sizeof(WICPixelFormatGUID)) != 0)
     {
@@ -1200,36 +1237,24 @@ HRESULT DirectX::SaveWICTextureToFile(
         ComPtr<IWICBitmap> source;
         hr = pWIC->CreateBitmapFromMemory(desc.Width, desc.Height,
             pfGuid,
-            mapped.RowPitch, static_cast<UINT>(imageSize),
-            static_cast<BYTE*>(mapped.pData), source.GetAddressOf());
+            static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize),
+            static_cast<BYTE*>(const_cast<void*>(pPixels)), source.GetAddressOf());
         if (FAILED(hr))
-        {
-            pContext->Unmap(pStaging.Get(), 0);
             return hr;
-        }
 
         ComPtr<IWICFormatConverter> FC;
         hr = pWIC->CreateFormatConverter(FC.GetAddressOf());
         if (FAILED(hr))
-        {
-            pContext->Unmap(pStaging.Get(), 0);
             return hr;
-        }
 
         BOOL canConvert = FALSE;
         hr = FC->CanConvert(pfGuid, targetGuid, &canConvert);
         if (FAILED(hr) || !canConvert)
-        {
-            pContext->Unmap(pStaging.Get(), 0);
             return E_UNEXPECTED;
-        }
 
         hr = FC->Initialize(source.Get(), targetGuid, WICBitmapDitherTypeNone, nullptr, 0, WICBitmapPaletteTypeMedianCut);
         if (FAILED(hr))
-        {
-            pContext->Unmap(pStaging.Get(), 0);
             return hr;
-        }
 
         WICRect rect = { 0, 0, static_cast<INT>(desc.Width), static_cast<INT>(desc.Height) };
         hr = frame->WriteSource(FC.Get(), &rect);
@@ -1238,12 +1263,10 @@ HRESULT DirectX::SaveWICTextureToFile(
     {
         // No conversion required
         hr = frame->WritePixels(desc.Height,
-            mapped.RowPitch, static_cast<UINT>(imageSize),
-            static_cast<BYTE*>(mapped.pData));
+            static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize),
+            static_cast<BYTE*>(const_cast<void*>(pPixels)));
     }
 
-    pContext->Unmap(pStaging.Get(), 0);
-
     if (FAILED(hr))
         return hr;
 
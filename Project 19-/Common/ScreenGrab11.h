@@ -43,4 +43,24 @@ namespace DirectX
         _In_opt_ const GUID* targetFormat = nullptr,
         _In_opt_ std::function<void __cdecl(IPropertyBag2*)> setCustomProps = nullptr,
         _In_ bool forceSRGB = false);
+
+    // Variants that write the top-level image from CPU memory (e.g. an already mapped
+    // staging texture copied out by the caller). They do not touch the device and can
+    // be called from a worker thread; the WIC variant requires COM to be initialized
+    // on the calling thread.
+    HRESULT __cdecl SaveDDSPixelsToFile(
+        _In_ const D3D11_TEXTURE2D_DESC& desc,
+        _In_ const void* pPixels,
+        _In_ size_t rowPitch,
+        _In_z_ const wchar_t* fileName) noexcept;
+
+    HRESULT __cdecl SaveWICPixelsToFile(
+        _In_ const D3D11_TEXTURE2D_DESC& desc,
+        _In_ const void* pPixels,
+        _In_ size_t rowPitch,
+        _In_ REFGUID guidContainerFormat,
+        _In_z_ const wchar_t* fileName,
+        _In_opt_ const GUID* targetFormat = nullptr,
+        _In_opt_ std::function<void __cdecl(IPropertyBag2*)> setCustomProps = nullptr,
+        _In_ bool forceSRGB = false);
 }
@@ -0,0 +1,2 @@
+#define SORT_KEY_VALUE
+#include "BitonicMerge_CS.hlsl"
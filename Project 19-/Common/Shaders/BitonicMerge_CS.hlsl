@@ -0,0 +1,21 @@
+#include "BitonicSort.hlsli"
+
+#define BITONIC_BLOCK_SIZE 512
+
+// 每个线程负责下标第g_Step位为0的元素与其对应元素的比较交换
+[numthreads(BITONIC_BLOCK_SIZE, 1, 1)]
+void CS(uint3 DTid : SV_DispatchThreadID)
+{
+    uint lowBits = DTid.x & (g_Step - 1);
+    uint smallerIndex = ((DTid.x - lowBits) << 1) | lowBits;
+    uint largerIndex = smallerIndex | g_Step;
+    bool isDescending = (bool) (g_DescendMask & smallerIndex) != (bool) g_SortDescending;
+    
+    Element a = g_Data[smallerIndex];
+    Element b = g_Data[largerIndex];
+    if (isDescending ? !IsOrdered(b, a) : !IsOrdered(a, b))
+    {
+        g_Data[smallerIndex] = b;
+        g_Data[largerIndex] = a;
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef BITONIC_SORT_HLSLI
+#define BITONIC_SORT_HLSLI
+
+// 定义SORT_KEY_VALUE时对(键, 值)排序，先比较键再比较值
+#ifdef SORT_KEY_VALUE
+typedef uint2 Element;
+StructuredBuffer<uint2> g_Input : register(t0);
+RWStructuredBuffer<uint2> g_Data : register(u0);
+#else
+typedef uint Element;
+Buffer<uint> g_Input : register(t0);
+RWBuffer<uint> g_Data : register(u0);
+#endif
+
+cbuffer CB : register(b0)
+{
+    uint g_Level;        // 2^需要排序趟数
+    uint g_DescendMask;  // 下降序列掩码
+    uint g_MatrixWidth;  // 矩阵宽度(要求宽度>=高度且都为2的倍数)
+    uint g_MatrixHeight; // 矩阵高度
+    uint g_Count;        // 有效元素数目，之后的元素读取时视为填充
+    uint g_SortDescending; // 整体按降序排列
+    uint g_Step;         // 全局比较交换的步长
+    uint g_Pad;
+}
+
+// a与b的顺序为升序(或相等)时返回true
+bool IsOrdered(Element a, Element b)
+{
+#ifdef SORT_KEY_VALUE
+    return a.x < b.x || (a.x == b.x && a.y <= b.y);
+#else
+    return a <= b;
+#endif
+}
+
+// 填充元素总是排在最后
+Element GetPadElement()
+{
+    uint pad = g_SortDescending ? 0 : 0xFFFFFFFF;
+#ifdef SORT_KEY_VALUE
+    return uint2(pad, pad);
+#else
+    return pad;
+#endif
+}
+
+#endif
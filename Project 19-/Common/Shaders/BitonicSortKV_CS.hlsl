@@ -0,0 +1,2 @@
+#define SORT_KEY_VALUE
+#include "BitonicSort_CS.hlsl"
@@ -2,7 +2,7 @@
 
 #define BITONIC_BLOCK_SIZE 512
 
-groupshared uint shared_data[BITONIC_BLOCK_SIZE];
+groupshared Element shared_data[BITONIC_BLOCK_SIZE];
 
 [numthreads(BITONIC_BLOCK_SIZE, 1, 1)]
 void CS(uint3 Gid : SV_GroupID,
@@ -11,7 +11,7 @@ void CS(uint3 Gid : SV_GroupID,
     uint GI : SV_GroupIndex)
 {
     // 写入共享数据
-    shared_data[GI] = g_Data[DTid.x];
+    shared_data[GI] = DTid.x < g_Count ? g_Data[DTid.x] : GetPadElement();
     GroupMemoryBarrierWithGroupSync();
     
     // 进行排序
@@ -30,8 +30,8 @@ void CS(uint3 Gid : SV_GroupID,
         uint smallerIndex = GI & ~j;
         uint largerIndex = GI | j;
         bool isSmallerIndex = (GI == smallerIndex);
-        bool isDescending = (bool) (g_DescendMask & DTid.x);
-        uint result = ((shared_data[smallerIndex] <= shared_data[largerIndex]) == (isDescending == isSmallerIndex)) ?
+        bool isDescending = (bool) (g_DescendMask & DTid.x) != (bool) g_SortDescending;
+        Element result = (IsOrdered(shared_data[smallerIndex], shared_data[largerIndex]) == (isDescending == isSmallerIndex)) ?
             shared_data[largerIndex] : shared_data[smallerIndex];
         GroupMemoryBarrierWithGroupSync();
 
@@ -0,0 +1,76 @@
+#include "StencilEngine.h"
+#include "CpuTimer.h"
+#include <cmath>
+
+namespace
+{
+    template<class Kernel>
+    StencilBenchmarkResult BenchmarkKernel(const char* name, const Kernel& kernel, const StencilTiling& tiling,
+        uint32_t size, uint32_t bytesPerCell)
+    {
+        size_t numCells = (size_t)size * size;
+        // 让每个规模的总计算量相近，步数取stepsPerPass的整数倍
+        uint32_t stepsPerPass = (std::max)(tiling.stepsPerPass, 1u);
+        uint32_t numSteps = (std::max)(stepsPerPass, (1u << 26) / size / size / stepsPerPass * stepsPerPass);
+
+        std::vector<float> initPrev(numCells), initCurr(numCells);
+        for (size_t k = 0; k < numCells; ++k)
+        {
+            initCurr[k] = (k % 97 == 0) ? 0.5f : 0.0f;
+            initPrev[k] = initCurr[k];
+        }
+
+        StencilEngine2D<Kernel> engine(kernel, tiling);
+        StencilBenchmarkResult result{ name, size };
+        CpuTimer timer;
+
+        std::vector<float> naivePrev = initPrev, naiveCurr = initCurr;
+        timer.Reset();
+        timer.Start();
+        engine.StepNaive(naivePrev, naiveCurr, size, size, numSteps);
+        timer.Tick();
+        timer.Stop();
+        result.naiveMs = timer.TotalTime() * 1000.0f / numSteps;
+
+        std::vector<float> tiledPrev = initPrev, tiledCurr = initCurr;
+        // 先分配好输出缓冲区
+        engine.Step(tiledPrev, tiledCurr, size, size, 0);
+        timer.Reset();
+        timer.Start();
+        engine.Step(tiledPrev, tiledCurr, size, size, numSteps);
+        timer.Tick();
+        timer.Stop();
+        result.tiledMs = timer.TotalTime() * 1000.0f / numSteps;
+
+        double bytesPerStep = (double)bytesPerCell * numCells;
+        result.naiveGBps = static_cast<float>(bytesPerStep / (result.naiveMs * 1e6));
+        result.tiledGBps = static_cast<float>(bytesPerStep / (result.tiledMs * 1e6));
+
+        result.maxError = 0.0f;
+        for (size_t k = 0; k < numCells; ++k)
+            result.maxError = (std::max)(result.maxError, fabsf(naiveCurr[k] - tiledCurr[k]));
+        return result;
+    }
+}
+
+std::vector<StencilBenchmarkResult> RunStencilBenchmark(uint32_t minSize, uint32_t maxSize, const StencilTiling& tiling)
+{
+    // 与28 Waves中CPU水波的默认参数相同
+    float timeStep = 0.03f, spatialStep = 0.625f, waveSpeed = 2.0f, damping = 0.2f;
+    float d = damping * timeStep + 2.0f;
+    float e = (waveSpeed * waveSpeed) * (timeStep * timeStep) / (spatialStep * spatialStep);
+    WaveStencilKernel waveKernel{};
+    waveKernel.k1 = (damping * timeStep - 2.0f) / d;
+    waveKernel.k2 = (4.0f - 8.0f * e) / d;
+    waveKernel.k3 = (2.0f * e) / d;
+
+    std::vector<StencilBenchmarkResult> results;
+    for (uint32_t size = (std::max)(minSize, 16u); size <= maxSize; size *= 2)
+    {
+        // 逐步遍历时每个格点每一步需要读写的字节数
+        results.push_back(BenchmarkKernel("Waves", waveKernel, tiling, size, 12));
+        results.push_back(BenchmarkKernel("Heat", HeatStencilKernel{}, tiling, size, 8));
+        results.push_back(BenchmarkKernel("Blur", BlurStencilKernel{}, tiling, size, 8));
+    }
+    return results;
+}
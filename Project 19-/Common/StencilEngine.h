@@ -0,0 +1,299 @@
+//***************************************************************************************
+// StencilEngine.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 时间分块+缓存分块的二维模板计算
+// Temporal-blocked, cache-tiled 2D stencil engine.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef STENCIL_ENGINE_H
+#define STENCIL_ENGINE_H
+
+#include "ThreadPool.h"
+#include <DirectXMath.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+//
+// 模板核
+//
+// 网格由prev、curr两个缓冲区表示，每一步由核根据curr(以及dst中原有的值)求出新值写入dst，
+// 然后交换两者的角色。只需要一个时间层的核(如模糊、热扩散)直接忽略dst中原有的值即可
+//
+// 核需要提供:
+//   static constexpr uint32_t Radius;      // 模板半径，离网格边界不足Radius的格点保持不变
+//   static constexpr bool UsesPrev;        // 是否读取dst中原有的值，为false时时间分块不读写prev
+//   void operator()(float* pDst, const float* pSrc, size_t stride, uint32_t count) const;
+//                                          // 计算从pDst/pSrc开始同一行中连续count个格点
+//
+
+namespace StencilDetail
+{
+    inline DirectX::XMVECTOR LoadFloat4(const float* p)
+    {
+        return DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(p));
+    }
+
+    inline void XM_CALLCONV StoreFloat4(float* p, DirectX::FXMVECTOR v)
+    {
+        DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(p), v);
+    }
+}
+
+// 带阻尼的二维波动方程: next = k1 * prev + k2 * curr + k3 * (上下左右之和)
+struct WaveStencilKernel
+{
+    static constexpr uint32_t Radius = 1;
+    static constexpr bool UsesPrev = true;
+    float k1 = 0.0f, k2 = 0.0f, k3 = 0.0f;
+
+    void operator()(float* pDst, const float* pSrc, size_t stride, uint32_t count) const
+    {
+        using namespace DirectX;
+        using namespace StencilDetail;
+        XMVECTOR vK1 = XMVectorReplicate(k1), vK2 = XMVectorReplicate(k2), vK3 = XMVectorReplicate(k3);
+        uint32_t j = 0;
+        for (; j + 4 <= count; j += 4)
+        {
+            const float* p = pSrc + j;
+            XMVECTOR sum = XMVectorAdd(XMVectorAdd(LoadFloat4(p - stride), LoadFloat4(p + stride)),
+                XMVectorAdd(LoadFloat4(p - 1), LoadFloat4(p + 1)));
+            XMVECTOR v = XMVectorMultiplyAdd(vK1, LoadFloat4(pDst + j), XMVectorMultiply(vK2, LoadFloat4(p)));
+            StoreFloat4(pDst + j, XMVectorMultiplyAdd(vK3, sum, v));
+        }
+        for (; j < count; ++j)
+        {
+            const float* p = pSrc + j;
+            float sum = (p[-(ptrdiff_t)stride] + p[stride]) + (p[-1] + p[1]);
+            pDst[j] = k3 * sum + (k1 * pDst[j] + k2 * p[0]);
+        }
+    }
+};
+
+// 显式热扩散: next = curr + alpha * (上下左右之和 - 4 * curr)，alpha不超过0.25时稳定
+struct HeatStencilKernel
+{
+    static constexpr uint32_t Radius = 1;
+    static constexpr bool UsesPrev = false;
+    float alpha = 0.2f;
+
+    void operator()(float* pDst, const float* pSrc, size_t stride, uint32_t count) const
+    {
+        using namespace DirectX;
+        using namespace StencilDetail;
+        XMVECTOR vAlpha = XMVectorReplicate(alpha), vFour = XMVectorReplicate(4.0f);
+        uint32_t j = 0;
+        for (; j + 4 <= count; j += 4)
+        {
+            const float* p = pSrc + j;
+            XMVECTOR c = LoadFloat4(p);
+            XMVECTOR sum = XMVectorAdd(XMVectorAdd(LoadFloat4(p - stride), LoadFloat4(p + stride)),
+                XMVectorAdd(LoadFloat4(p - 1), LoadFloat4(p + 1)));
+            XMVECTOR lap = XMVectorNegativeMultiplySubtract(vFour, c, sum);
+            StoreFloat4(pDst + j, XMVectorMultiplyAdd(vAlpha, lap, c));
+        }
+        for (; j < count; ++j)
+        {
+            const float* p = pSrc + j;
+            float sum = (p[-(ptrdiff_t)stride] + p[stride]) + (p[-1] + p[1]);
+            pDst[j] = alpha * (sum - 4.0f * p[0]) + p[0];
+        }
+    }
+};
+
+// 3x3高斯模糊，权重为(1 2 1)^T(1 2 1)/16，反复迭代可近似更大半径的模糊
+struct BlurStencilKernel
+{
+    static constexpr uint32_t Radius = 1;
+    static constexpr bool UsesPrev = false;
+
+    void operator()(float* pDst, const float* pSrc, size_t stride, uint32_t count) const
+    {
+        using namespace DirectX;
+        using namespace StencilDetail;
+        XMVECTOR vTwo = XMVectorReplicate(2.0f), vScale = XMVectorReplicate(1.0f / 16.0f);
+        uint32_t j = 0;
+        for (; j + 4 <= count; j += 4)
+        {
+            const float* p = pSrc + j;
+            // 先在竖直方向上求1-2-1加权，再在水平方向上求
+            XMVECTOR left = XMVectorMultiplyAdd(vTwo, LoadFloat4(p - 1), XMVectorAdd(LoadFloat4(p - stride - 1), LoadFloat4(p + stride - 1)));
+            XMVECTOR mid = XMVectorMultiplyAdd(vTwo, LoadFloat4(p), XMVectorAdd(LoadFloat4(p - stride), LoadFloat4(p + stride)));
+            XMVECTOR right = XMVectorMultiplyAdd(vTwo, LoadFloat4(p + 1), XMVectorAdd(LoadFloat4(p - stride + 1), LoadFloat4(p + stride + 1)));
+            StoreFloat4(pDst + j, XMVectorMultiply(XMVectorMultiplyAdd(vTwo, mid, XMVectorAdd(left, right)), vScale));
+        }
+        for (; j < count; ++j)
+        {
+            const float* p = pSrc + j;
+            auto column = [=](ptrdiff_t k) { return 2.0f * p[k] + (p[k - (ptrdiff_t)stride] + p[k + stride]); };
+            pDst[j] = (2.0f * column(0) + (column(-1) + column(1))) * (1.0f / 16.0f);
+        }
+    }
+};
+
+struct StencilTiling
+{
+    uint32_t tileWidth = 256;           // 每个块的列数
+    uint32_t tileHeight = 64;           // 每个块的行数
+    uint32_t stepsPerPass = 4;          // 每个块一次推进的步数，为1时退化为普通的空间分块
+};
+
+//
+// 时间分块：把网格划分为若干块，每个块连同宽为(步数*半径)的边缘一起拷贝到线程私有的缓冲区中，
+// 在缓冲区内连续推进若干步(计算范围每步向内收缩一个半径)后只写回块本身。块之间互不依赖，
+// 因此可以并行，代价是边缘部分的重复计算。块和边缘能放进L2缓存时，每推进stepsPerPass步
+// 只需要读写一次整个网格，而逐步遍历则每一步都要读写一次
+//
+// 标量与SIMD路径的运算顺序一致，因此结果与逐步遍历(StepNaive)相同
+//
+template<class Kernel>
+class StencilEngine2D
+{
+public:
+    StencilEngine2D() = default;
+    explicit StencilEngine2D(const Kernel& kernel, const StencilTiling& tiling = StencilTiling{})
+        : m_Kernel(kernel), m_Tiling(tiling) {}
+
+    Kernel& GetKernel() { return m_Kernel; }
+    const Kernel& GetKernel() const { return m_Kernel; }
+    void SetKernel(const Kernel& kernel) { m_Kernel = kernel; }
+    const StencilTiling& GetTiling() const { return m_Tiling; }
+    void SetTiling(const StencilTiling& tiling) { m_Tiling = tiling; }
+
+    // 推进numSteps步，结束后curr为最新的结果，prev为上一步的结果
+    // prev与curr均为rows行cols列、按行优先存放的网格，两者在网格边界上的值应当相同
+    // 核的UsesPrev为false时只读写curr，prev的内容不做保证
+    void Step(std::vector<float>& prev, std::vector<float>& curr, uint32_t rows, uint32_t cols, uint32_t numSteps)
+    {
+        if (rows <= 2 * Kernel::Radius || cols <= 2 * Kernel::Radius)
+            return;
+
+        size_t numCells = (size_t)rows * cols;
+        if (Kernel::UsesPrev)
+            m_OutPrev.resize(numCells);
+        m_OutCurr.resize(numCells);
+        uint32_t stepsPerPass = (std::max)(m_Tiling.stepsPerPass, 1u);
+        while (numSteps)
+        {
+            uint32_t steps = (std::min)(numSteps, stepsPerPass);
+            RunPass(prev.data(), curr.data(), rows, cols, steps);
+            if (Kernel::UsesPrev)
+                prev.swap(m_OutPrev);
+            curr.swap(m_OutCurr);
+            numSteps -= steps;
+        }
+    }
+
+    // 逐步遍历整个网格，每一步按行并行
+    void StepNaive(std::vector<float>& prev, std::vector<float>& curr, uint32_t rows, uint32_t cols, uint32_t numSteps) const
+    {
+        const uint32_t R = Kernel::Radius;
+        if (rows <= 2 * R || cols <= 2 * R)
+            return;
+
+        for (uint32_t s = 0; s < numSteps; ++s)
+        {
+            float* pDst = prev.data();
+            const float* pSrc = curr.data();
+            ThreadPool::GetDefault().ParallelFor(R, rows - R, 16, [&](uint32_t i0, uint32_t i1) {
+                for (uint32_t i = i0; i < i1; ++i)
+                    m_Kernel(pDst + (size_t)i * cols + R, pSrc + (size_t)i * cols + R, cols, cols - 2 * R);
+            });
+            prev.swap(curr);
+        }
+    }
+
+private:
+    // 从pPrev/pCurr推进steps步，写入m_OutPrev/m_OutCurr
+    void RunPass(const float* pPrev, const float* pCurr, uint32_t rows, uint32_t cols, uint32_t steps)
+    {
+        const uint32_t R = Kernel::Radius;
+        uint32_t tileWidth = (std::max)(m_Tiling.tileWidth, 1u);
+        uint32_t tileHeight = (std::max)(m_Tiling.tileHeight, 1u);
+        uint32_t numTilesX = (cols + tileWidth - 1) / tileWidth;
+        uint32_t numTilesY = (rows + tileHeight - 1) / tileHeight;
+        uint32_t halo = steps * R;
+        float* pOutPrev = m_OutPrev.data();
+        float* pOutCurr = m_OutCurr.data();
+
+        ThreadPool::GetDefault().ParallelFor(0, numTilesX * numTilesY, 1, [&](uint32_t t0, uint32_t t1) {
+            thread_local std::vector<float> scratch;
+            for (uint32_t t = t0; t < t1; ++t)
+            {
+                uint32_t y0 = t / numTilesX * tileHeight, y1 = (std::min)(y0 + tileHeight, rows);
+                uint32_t x0 = t % numTilesX * tileWidth, x1 = (std::min)(x0 + tileWidth, cols);
+                // 带边缘的范围，落在网格外的部分裁掉
+                uint32_t ey0 = y0 > halo ? y0 - halo : 0, ey1 = (std::min)(y1 + halo, rows);
+                uint32_t ex0 = x0 > halo ? x0 - halo : 0, ex1 = (std::min)(x1 + halo, cols);
+                size_t stride = ex1 - ex0, height = ey1 - ey0;
+
+                scratch.resize(2 * stride * height);
+                float* pDst = scratch.data();
+                float* pSrc = pDst + stride * height;
+                for (uint32_t i = ey0; i < ey1; ++i)
+                    memcpy(pSrc + (i - ey0) * stride, pCurr + (size_t)i * cols + ex0, stride * sizeof(float));
+                // 不需要prev时用curr填充，保证网格边界上的值正确
+                if (Kernel::UsesPrev)
+                {
+                    for (uint32_t i = ey0; i < ey1; ++i)
+                        memcpy(pDst + (i - ey0) * stride, pPrev + (size_t)i * cols + ex0, stride * sizeof(float));
+                }
+                else
+                {
+                    memcpy(pDst, pSrc, stride * height * sizeof(float));
+                }
+
+                for (uint32_t s = 1; s <= steps; ++s)
+                {
+                    // 边缘上的格点每一步失效一个半径；网格边界上的格点保持不变，不会失效
+                    uint32_t cy0 = ey0 ? ey0 + s * R : R, cy1 = ey1 < rows ? ey1 - s * R : rows - R;
+                    uint32_t cx0 = ex0 ? ex0 + s * R : R, cx1 = ex1 < cols ? ex1 - s * R : cols - R;
+                    for (uint32_t i = cy0; i < cy1; ++i)
+                    {
+                        size_t offset = (i - ey0) * stride + (cx0 - ex0);
+                        m_Kernel(pDst + offset, pSrc + offset, stride, cx1 - cx0);
+                    }
+                    std::swap(pDst, pSrc);
+                }
+
+                // 只写回块本身
+                for (uint32_t i = y0; i < y1; ++i)
+                {
+                    size_t offset = (i - ey0) * stride + (x0 - ex0);
+                    if (Kernel::UsesPrev)
+                        memcpy(pOutPrev + (size_t)i * cols + x0, pDst + offset, (x1 - x0) * sizeof(float));
+                    memcpy(pOutCurr + (size_t)i * cols + x0, pSrc + offset, (x1 - x0) * sizeof(float));
+                }
+            }
+        });
+    }
+
+    Kernel m_Kernel{};
+    StencilTiling m_Tiling;
+    std::vector<float> m_OutPrev;
+    std::vector<float> m_OutCurr;
+};
+
+//
+// 性能测试
+//
+
+struct StencilBenchmarkResult
+{
+    const char* kernelName;
+    uint32_t gridSize;
+    float naiveMs;                      // 逐步遍历每一步的耗时
+    float tiledMs;                      // 时间分块每一步的耗时
+    float naiveGBps;                    // 逐步遍历的等效带宽
+    float tiledGBps;                    // 时间分块的等效带宽(按逐步遍历需要读写的字节数计算)
+    float maxError;                     // 两种方式结果的最大差异，应当为0
+};
+
+// 对波动方程、热扩散、模糊三种核，在各个网格规模(每次翻倍)下比较逐步遍历与时间分块
+std::vector<StencilBenchmarkResult> RunStencilBenchmark(uint32_t minSize = 256, uint32_t maxSize = 4096,
+    const StencilTiling& tiling = StencilTiling{});
+
+#endif
@@ -0,0 +1,291 @@
+#include "SummedAreaTable.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // 小数端点t处的前缀和由floor(t)与floor(t) + 1两处插值得到
+    struct Endpoint
+    {
+        uint32_t index[2];
+        float weight[2];
+    };
+
+    Endpoint SplitEndpoint(float t, uint32_t size)
+    {
+        float f = floorf(t);
+        Endpoint endpoint;
+        endpoint.index[0] = (uint32_t)f;
+        endpoint.index[1] = (std::min)(endpoint.index[0] + 1, size);
+        endpoint.weight[1] = t - f;
+        endpoint.weight[0] = 1.0f - endpoint.weight[1];
+        return endpoint;
+    }
+
+    // 矩形钳位到图像范围内，面积为0时返回false
+    bool ClampRect(uint32_t width, uint32_t height, float& x0, float& y0, float& x1, float& y1)
+    {
+        x0 = (std::max)(x0, 0.0f);
+        y0 = (std::max)(y0, 0.0f);
+        x1 = (std::min)(x1, (float)width);
+        y1 = (std::min)(y1, (float)height);
+        return x0 < x1 && y0 < y1;
+    }
+
+    // [0, i) x [0, j)内第c个通道的和
+    template<class T>
+    T Cumulative(const T* sat, uint32_t width, uint32_t channels, uint32_t i, uint32_t j, uint32_t c)
+    {
+        if (i == 0 || j == 0)
+            return T(0);
+        return sat[((size_t)(j - 1) * width + (i - 1)) * channels + c];
+    }
+
+    template<class T>
+    void PrefixSum(T* dst, uint32_t width, uint32_t height, uint32_t channels)
+    {
+        size_t rowPitch = (size_t)width * channels;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            T* pRow = dst + y * rowPitch;
+            for (size_t i = channels; i < rowPitch; ++i)
+                pRow[i] += pRow[i - channels];
+        }
+        for (uint32_t y = 1; y < height; ++y)
+        {
+            T* pRow = dst + y * rowPitch;
+            const T* pPrevRow = pRow - rowPitch;
+            for (size_t i = 0; i < rowPitch; ++i)
+                pRow[i] += pPrevRow[i];
+        }
+    }
+}
+
+uint32_t SummedAreaTable::GetFractionBits(float maxFilterWidth)
+{
+    uint32_t span = (uint32_t)ceilf((std::max)(maxFilterWidth, 1.0f)) + 1;
+    uint32_t area = span * span;
+    uint32_t log2Area = 0;
+    while (area >> (log2Area + 1))
+        ++log2Area;
+    // area < 2^(log2Area + 1)，因此area * 2^fractionBits < 2^31
+    return log2Area < 30 ? 30 - log2Area : 0;
+}
+
+float SummedAreaTable::GetMaxEVSMExponent(uint32_t fractionBits)
+{
+    return fractionBits * logf(2.0f) / 4.0f;
+}
+
+void SummedAreaTable::GetEVSMScales(float posExp, float negExp, float outScales[4])
+{
+    // 正指数项e^(c(2d - 1))的最大值为e^c，负指数项-e^(-c(2d - 1))的最小值为-e^c
+    outScales[0] = expf(-posExp);
+    outScales[1] = expf(-2.0f * posExp);
+    outScales[2] = -expf(-negExp);
+    outScales[3] = expf(-2.0f * negExp);
+}
+
+void SummedAreaTable::Build(const float* src, uint32_t width, uint32_t height, uint32_t channels,
+    const float scales[], uint32_t fractionBits, uint32_t* dst)
+{
+    float quantScale = (float)(1u << fractionBits);
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            float value = (std::min)((std::max)(src[i * channels + c] * scales[c], 0.0f), 1.0f);
+            dst[i * channels + c] = (uint32_t)(value * quantScale + 0.5f);
+        }
+    }
+    PrefixSum(dst, width, height, channels);
+}
+
+void SummedAreaTable::BoxFilter(const uint32_t* sat, uint32_t width, uint32_t height, uint32_t channels,
+    const float scales[], uint32_t fractionBits, float x0, float y0, float x1, float y1, float out[])
+{
+    if (!ClampRect(width, height, x0, y0, x1, y1))
+    {
+        std::fill(out, out + channels, 0.0f);
+        return;
+    }
+
+    Endpoint ex0 = SplitEndpoint(x0, width), ex1 = SplitEndpoint(x1, width);
+    Endpoint ey0 = SplitEndpoint(y0, height), ey1 = SplitEndpoint(y1, height);
+    float normalization = (x1 - x0) * (y1 - y0) * (float)(1u << fractionBits);
+    for (uint32_t c = 0; c < channels; ++c)
+    {
+        float sum = 0.0f;
+        for (int a = 0; a < 2; ++a)
+        {
+            for (int b = 0; b < 2; ++b)
+            {
+                for (int d = 0; d < 2; ++d)
+                {
+                    for (int e = 0; e < 2; ++e)
+                    {
+                        float weight = ex0.weight[a] * ex1.weight[b] * ey0.weight[d] * ey1.weight[e];
+                        if (weight == 0.0f)
+                            continue;
+                        uint32_t xa = ex0.index[a], xb = ex1.index[b];
+                        uint32_t ya = ey0.index[d], yb = ey1.index[e];
+                        // 矩形很窄时xa可能大于xb，按有符号数解释即为负的和
+                        uint32_t box = Cumulative(sat, width, channels, xb, yb, c) - Cumulative(sat, width, channels, xa, yb, c)
+                            - Cumulative(sat, width, channels, xb, ya, c) + Cumulative(sat, width, channels, xa, ya, c);
+                        sum += weight * (float)(int32_t)box;
+                    }
+                }
+            }
+        }
+        out[c] = sum / normalization / scales[c];
+    }
+}
+
+void SummedAreaTable::BuildFloat(const float* src, uint32_t width, uint32_t height, uint32_t channels,
+    const float offsets[], float* dst)
+{
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (uint32_t c = 0; c < channels; ++c)
+            dst[i * channels + c] = src[i * channels + c] - (offsets ? offsets[c] : 0.0f);
+    }
+    PrefixSum(dst, width, height, channels);
+}
+
+void SummedAreaTable::BoxFilterFloat(const float* sat, uint32_t width, uint32_t height, uint32_t channels,
+    const float offsets[], float x0, float y0, float x1, float y1, float out[])
+{
+    if (!ClampRect(width, height, x0, y0, x1, y1))
+    {
+        std::fill(out, out + channels, 0.0f);
+        return;
+    }
+
+    Endpoint ex[2] = { SplitEndpoint(x0, width), SplitEndpoint(x1, width) };
+    Endpoint ey[2] = { SplitEndpoint(y0, height), SplitEndpoint(y1, height) };
+    float area = (x1 - x0) * (y1 - y0);
+    for (uint32_t c = 0; c < channels; ++c)
+    {
+        // 四个角处插值后的前缀和
+        float corners[2][2];
+        for (int i = 0; i < 2; ++i)
+        {
+            for (int j = 0; j < 2; ++j)
+            {
+                corners[i][j] = 0.0f;
+                for (int a = 0; a < 2; ++a)
+                {
+                    for (int b = 0; b < 2; ++b)
+                        corners[i][j] += ex[i].weight[a] * ey[j].weight[b] *
+                            Cumulative(sat, width, channels, ex[i].index[a], ey[j].index[b], c);
+                }
+            }
+        }
+        float box = corners[1][1] - corners[0][1] - corners[1][0] + corners[0][0];
+        out[c] = box / area + (offsets ? offsets[c] : 0.0f);
+    }
+}
+
+SATPrecisionTestResult RunSATPrecisionTest(uint32_t size, float maxFilterWidth, uint32_t numQueries)
+{
+    SATPrecisionTestResult result{};
+    result.size = size;
+    result.numQueries = numQueries;
+    result.fractionBits = SummedAreaTable::GetFractionBits(maxFilterWidth);
+
+    // 地面的深度沿y方向线性增长，遮挡物为更靠近光源的方块
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> depths((size_t)size * size);
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+            depths[(size_t)y * size + x] = 0.4f + 0.5f * (y + 0.5f) / size + 0.02f * (x + 0.5f) / size;
+    }
+    for (int i = 0; i < 200; ++i)
+    {
+        uint32_t w = 8 + (uint32_t)(unit(rng) * 120), h = 8 + (uint32_t)(unit(rng) * 120);
+        uint32_t left = (uint32_t)(unit(rng) * (size - w)), top = (uint32_t)(unit(rng) * (size - h));
+        float depth = 0.1f + 0.3f * unit(rng);
+        for (uint32_t y = top; y < top + h; ++y)
+        {
+            for (uint32_t x = left; x < left + w; ++x)
+                depths[(size_t)y * size + x] = (std::min)(depths[(size_t)y * size + x], depth);
+        }
+    }
+
+    std::vector<float> moments(depths.size() * 2);
+    double means[2] = {};
+    for (size_t i = 0; i < depths.size(); ++i)
+    {
+        moments[i * 2] = depths[i];
+        moments[i * 2 + 1] = depths[i] * depths[i];
+        means[0] += moments[i * 2];
+        means[1] += moments[i * 2 + 1];
+    }
+    float scales[2] = { 1.0f, 1.0f };
+    float offsets[2] = { (float)(means[0] / depths.size()), (float)(means[1] / depths.size()) };
+
+    std::vector<uint32_t> fixedSAT(moments.size());
+    std::vector<float> floatSAT(moments.size()), offsetSAT(moments.size());
+    // 用标准库计时，便于在其它平台单独编译测试
+    auto start = std::chrono::steady_clock::now();
+    SummedAreaTable::Build(moments.data(), size, size, 2, scales, result.fractionBits, fixedSAT.data());
+    result.fixedBuildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    SummedAreaTable::BuildFloat(moments.data(), size, size, 2, nullptr, floatSAT.data());
+    SummedAreaTable::BuildFloat(moments.data(), size, size, 2, offsets, offsetSAT.data());
+
+    auto updateError = [](const float m[2], const double ref[2], float& meanError, float& varianceError) {
+        double variance = m[1] - (double)m[0] * m[0];
+        double refVariance = ref[1] - ref[0] * ref[0];
+        meanError = (std::max)(meanError, (float)fabs(m[0] - ref[0]));
+        varianceError = (std::max)(varianceError, (float)fabs(variance - refVariance));
+    };
+
+    float maxWidth = (std::max)(1.0f, (std::min)(maxFilterWidth, (float)size));
+    for (uint32_t i = 0; i < numQueries; ++i)
+    {
+        float w = 1.0f + unit(rng) * (maxWidth - 1.0f), h = 1.0f + unit(rng) * (maxWidth - 1.0f);
+        float x0 = unit(rng) * (size - w), y0 = unit(rng) * (size - h);
+        float x1 = x0 + w, y1 = y0 + h;
+
+        // 双精度下按覆盖面积直接求和
+        double ref[2] = {};
+        for (uint32_t y = (uint32_t)y0; y < (uint32_t)ceilf(y1); ++y)
+        {
+            double coverY = (std::min)((double)y1, y + 1.0) - (std::max)((double)y0, (double)y);
+            for (uint32_t x = (uint32_t)x0; x < (uint32_t)ceilf(x1); ++x)
+            {
+                double cover = coverY * ((std::min)((double)x1, x + 1.0) - (std::max)((double)x0, (double)x));
+                ref[0] += cover * moments[((size_t)y * size + x) * 2];
+                ref[1] += cover * moments[((size_t)y * size + x) * 2 + 1];
+            }
+        }
+        double area = (double)(x1 - x0) * (y1 - y0);
+        ref[0] /= area;
+        ref[1] /= area;
+
+        float m[2];
+        SummedAreaTable::BoxFilter(fixedSAT.data(), size, size, 2, scales, result.fractionBits, x0, y0, x1, y1, m);
+        updateError(m, ref, result.fixedMaxMeanError, result.fixedMaxVarianceError);
+        SummedAreaTable::BoxFilterFloat(floatSAT.data(), size, size, 2, nullptr, x0, y0, x1, y1, m);
+        updateError(m, ref, result.floatMaxMeanError, result.floatMaxVarianceError);
+        SummedAreaTable::BoxFilterFloat(offsetSAT.data(), size, size, 2, offsets, x0, y0, x1, y1, m);
+        updateError(m, ref, result.offsetMaxMeanError, result.offsetMaxVarianceError);
+    }
+
+    // 每个texel的量化误差不超过半个量化单位，平均后仍是如此；方差E[d^2] - E[d]^2的误差约为1.5个量化单位
+    // 小数位数较多时，量化单位比转为float后插值的舍入误差还小，再额外留出几个FLT_EPSILON
+    float quantum = ldexpf(1.0f, -(int)result.fractionBits);
+    result.meanErrorLimit = quantum + 4.0f * FLT_EPSILON;
+    result.varianceErrorLimit = 4.0f * quantum + 8.0f * FLT_EPSILON;
+    result.passed = result.fixedMaxMeanError <= result.meanErrorLimit &&
+        result.fixedMaxVarianceError <= result.varianceErrorLimit;
+    return result;
+}
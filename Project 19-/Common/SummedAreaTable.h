@@ -0,0 +1,75 @@
+//***************************************************************************************
+// SummedAreaTable.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 阴影矩的求和面积表(SAT)：定点数构造、任意宽度的盒式滤波与精度测试
+// Summed-area tables for shadow moments: fixed-point construction, arbitrary-width box filtering and precision test.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef SUMMED_AREA_TABLE_H
+#define SUMMED_AREA_TABLE_H
+
+#include <cstdint>
+
+//
+// SAT中(x, y)处保存[0, x] x [0, y]内所有texel之和，任意矩形的和只需要4次读取，滤波开销与宽度无关
+//
+// 浮点数的前缀和越往右下越大，而小矩形的和是几个大数之差，舍入误差随图像大小增长，方差E[d^2] - E[d]^2更会被抵消殆尽
+// 因此各通道先乘以scale映射到[0, 1]，再量化为fractionBits位小数的定点数，以32位无符号整数求前缀和：
+// 溢出按2^32回绕，只要矩形内的和不超过2^31，相减并按有符号数解释后的结果就是精确的，误差只来自输入的量化
+// 与SummedAreaTable.hlsl中的实现一致
+//
+
+namespace SummedAreaTable
+{
+    // 盒式滤波的最大宽度(texel)对应的小数位数：保证(ceil(maxFilterWidth) + 1)^2个值为1的texel之和小于2^31
+    uint32_t GetFractionBits(float maxFilterWidth);
+    // EVSM映射到[0, 1]后，二阶矩的最小值为e^(-4c)，令其不小于一个量化单位时允许的最大指数c
+    float GetMaxEVSMExponent(uint32_t fractionBits);
+    // EVSM各通道(正指数项、其平方、负指数项、其平方)映射到[0, 1]的缩放
+    void GetEVSMScales(float posExp, float negExp, float outScales[4]);
+
+    // 输入为width * height个texel、每个texel有channels个通道的矩；各通道乘以scales并钳位到[0, 1]，
+    // 四舍五入为定点数，再先按行、后按列求前缀和
+    void Build(const float* src, uint32_t width, uint32_t height, uint32_t channels,
+        const float scales[], uint32_t fractionBits, uint32_t* dst);
+    // 以texel为单位的矩形[x0, x1) x [y0, y1)内各通道的平均值(已除以scales)，端点可以是小数
+    // 矩形先钳位到图像范围内；小数端点处的前缀和按线性插值处理，拆成16个整数矩形，每个整数矩形在定点数下相减后才转为浮点数
+    void BoxFilter(const uint32_t* sat, uint32_t width, uint32_t height, uint32_t channels,
+        const float scales[], uint32_t fractionBits, float x0, float y0, float x1, float y1, float out[]);
+
+    // 以float累加的前缀和，用于对比精度。各通道先减去offsets再累加，offsets为空时不减
+    void BuildFloat(const float* src, uint32_t width, uint32_t height, uint32_t channels,
+        const float offsets[], float* dst);
+    void BoxFilterFloat(const float* sat, uint32_t width, uint32_t height, uint32_t channels,
+        const float offsets[], float x0, float y0, float x1, float y1, float out[]);
+}
+
+//
+// 精度测试
+//
+
+struct SATPrecisionTestResult
+{
+    uint32_t size;
+    uint32_t fractionBits;
+    uint32_t numQueries;
+    float fixedMaxMeanError;            // 定点数SAT的一阶矩最大误差
+    float fixedMaxVarianceError;        // 定点数SAT的方差最大误差
+    float floatMaxMeanError;            // 直接以float累加
+    float floatMaxVarianceError;
+    float offsetMaxMeanError;           // 减去整幅图的平均值后以float累加
+    float offsetMaxVarianceError;
+    float fixedBuildMs;                 // 定点数SAT的构造耗时
+    float meanErrorLimit;               // 定点数SAT允许的误差，由量化单位2^-fractionBits得出
+    float varianceErrorLimit;
+    bool passed;                        // 定点数SAT的误差均在允许范围内
+};
+
+// 生成size x size的VSM矩(斜坡地面加随机方块遮挡)，随机取宽度在[1, maxFilterWidth]之间、端点为小数的矩形，
+// 与双精度直接求和的结果对比三种SAT的平均值与方差。定点数SAT的平均值误差不超过1个量化单位、方差误差不超过4个(另加float的舍入误差)时通过
+SATPrecisionTestResult RunSATPrecisionTest(uint32_t size = 1024, float maxFilterWidth = 32.0f, uint32_t numQueries = 10000);
+
+#endif
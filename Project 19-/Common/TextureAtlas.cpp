@@ -0,0 +1,303 @@
+#include "TextureAtlas.h"
+#include "TextureManager.h"
+#include "ModelManager.h"
+#include "Image.h"
+#include "DXTrace.h"
+#include <algorithm>
+#include <map>
+
+// imgui_draw.cpp中的实现是static的，这里需要自己实例化一份
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+using namespace DirectX;
+using namespace Microsoft::WRL;
+
+namespace
+{
+    struct AtlasEntry
+    {
+        std::string name;
+        ComPtr<ID3D11Texture2D> pTexture;
+        D3D11_TEXTURE2D_DESC desc{};
+    };
+}
+
+void TextureAtlas::SetLimits(uint32_t maxAtlasSize, uint32_t maxTextureSize, uint32_t maxMipLevels)
+{
+    m_MaxAtlasSize = (std::min)((std::max)(maxAtlasSize, 4u), (uint32_t)D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION);
+    m_MaxTextureSize = maxTextureSize;
+    m_MaxMipLevels = (std::max)(maxMipLevels, 1u);
+}
+
+void TextureAtlas::AddTexture(std::string_view name)
+{
+    if (std::find(m_Names.begin(), m_Names.end(), name) == m_Names.end())
+        m_Names.emplace_back(name);
+}
+
+void TextureAtlas::AddModel(const Model& model, std::string_view texKey)
+{
+    for (auto& material : model.materials)
+    {
+        if (material.Has<std::string>(texKey))
+            AddTexture(material.Get<std::string>(texKey));
+    }
+}
+
+uint32_t TextureAtlas::Build(std::string_view prefix)
+{
+    TextureManager& tm = TextureManager::Get();
+    ID3D11ShaderResourceView* pNullSRV = tm.GetNullTexture();
+
+    // 纹理格式与SRV格式都相同的纹理才能通过CopySubresourceRegion放入同一个图集
+    std::map<std::pair<DXGI_FORMAT, DXGI_FORMAT>, std::vector<AtlasEntry>> groups;
+    for (auto& name : m_Names)
+    {
+        if (m_Regions.count(StringToID(name)))
+            continue;
+
+        ID3D11ShaderResourceView* pSRV = tm.GetTexture(name);
+        if (!pSRV || pSRV == pNullSRV)
+        {
+            ++m_Stats.numRejected;
+            continue;
+        }
+
+        AtlasEntry entry;
+        entry.name = name;
+        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
+        ComPtr<ID3D11Resource> pResource;
+        pSRV->GetDesc(&srvDesc);
+        pSRV->GetResource(pResource.GetAddressOf());
+        if (srvDesc.ViewDimension != D3D11_SRV_DIMENSION_TEXTURE2D || FAILED(pResource.As(&entry.pTexture)))
+        {
+            ++m_Stats.numRejected;
+            continue;
+        }
+        entry.pTexture->GetDesc(&entry.desc);
+
+        const D3D11_TEXTURE2D_DESC& desc = entry.desc;
+        uint32_t blockSize = Image::IsCompressed(desc.Format) ? 4 : 1;
+        if (desc.ArraySize != 1 || desc.SampleDesc.Count != 1 || srvDesc.Texture2D.MostDetailedMip != 0 ||
+            desc.Width > m_MaxTextureSize || desc.Height > m_MaxTextureSize ||
+            desc.Width % blockSize || desc.Height % blockSize)
+        {
+            ++m_Stats.numRejected;
+            continue;
+        }
+        groups[{ desc.Format, srvDesc.Format }].push_back(std::move(entry));
+    }
+
+    uint32_t numAtlases = 0;
+    for (auto& [formats, entries] : groups)
+    {
+        if (entries.size() < 2)
+        {
+            m_Stats.numRejected += (uint32_t)entries.size();
+            continue;
+        }
+
+        // 子区域的位置和尺寸按align对齐，保证每一级mip的偏移都落在块边界上
+        // 四周的间隔也取align，使得最低一级mip仍留有一个块的间隔
+        uint32_t blockSize = Image::IsCompressed(formats.first) ? 4 : 1;
+        uint32_t mipLevels = m_MaxMipLevels;
+        for (auto& entry : entries)
+            mipLevels = (std::min)(mipLevels, entry.desc.MipLevels);
+        auto misaligned = [&](const AtlasEntry& entry) {
+            uint32_t align = blockSize << (mipLevels - 1);
+            return entry.desc.Width % align || entry.desc.Height % align;
+        };
+        while (mipLevels > 1 && std::any_of(entries.begin(), entries.end(), misaligned))
+            --mipLevels;
+        uint32_t align = blockSize << (mipLevels - 1);
+
+        // 以align为单位打包，每个矩形带上两侧的间隔
+        int maxUnits = (int)(m_MaxAtlasSize / align);
+        std::vector<stbrp_rect> rects;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            stbrp_rect rect{};
+            rect.id = (int)i;
+            rect.w = (int)(entries[i].desc.Width / align) + 2;
+            rect.h = (int)(entries[i].desc.Height / align) + 2;
+            if (rect.w > maxUnits || rect.h > maxUnits)
+                ++m_Stats.numRejected;
+            else
+                rects.push_back(rect);
+        }
+
+        std::vector<stbrp_node> nodes(maxUnits);
+        while (!rects.empty())
+        {
+            // 从能容纳总面积的最小2的幂开始尝试，放不下时加倍
+            size_t area = 0;
+            int size = 1, maxSide = 0;
+            for (auto& rect : rects)
+            {
+                area += (size_t)rect.w * rect.h;
+                maxSide = (std::max)({ maxSide, rect.w, rect.h });
+            }
+            while (size < maxSide || (size_t)size * size < area)
+                size *= 2;
+            size = (std::min)(size, maxUnits);
+
+            stbrp_context context;
+            bool allPacked = false;
+            for (;;)
+            {
+                stbrp_init_target(&context, size, size, nodes.data(), size);
+                allPacked = stbrp_pack_rects(&context, rects.data(), (int)rects.size()) != 0;
+                if (allPacked || size == maxUnits)
+                    break;
+                size = (std::min)(size * 2, maxUnits);
+            }
+
+            auto mid = std::stable_partition(rects.begin(), rects.end(),
+                [](const stbrp_rect& rect) { return rect.was_packed != 0; });
+            std::vector<stbrp_rect> packed(rects.begin(), mid);
+            rects.erase(rects.begin(), mid);
+            // 单独一张纹理放进图集没有意义，剩下的纹理也已经无法两两合并
+            if (packed.size() < 2)
+            {
+                m_Stats.numRejected += (uint32_t)(packed.size() + rects.size());
+                break;
+            }
+
+            // 裁掉图集中未使用的部分
+            uint32_t atlasWidth = 0, atlasHeight = 0;
+            for (auto& rect : packed)
+            {
+                atlasWidth = (std::max)(atlasWidth, (uint32_t)(rect.x + rect.w) * align);
+                atlasHeight = (std::max)(atlasHeight, (uint32_t)(rect.y + rect.h) * align);
+            }
+
+            ComPtr<ID3D11Device> device;
+            ComPtr<ID3D11DeviceContext> deviceContext;
+            entries[0].pTexture->GetDevice(device.GetAddressOf());
+            device->GetImmediateContext(deviceContext.GetAddressOf());
+
+            ComPtr<ID3D11Texture2D> pAtlas;
+            ComPtr<ID3D11ShaderResourceView> pAtlasSRV;
+            CD3D11_TEXTURE2D_DESC texDesc(formats.first, atlasWidth, atlasHeight, 1, mipLevels, D3D11_BIND_SHADER_RESOURCE);
+            CD3D11_SHADER_RESOURCE_VIEW_DESC srvDesc(D3D11_SRV_DIMENSION_TEXTURE2D, formats.second);
+            if (FAILED(device->CreateTexture2D(&texDesc, nullptr, pAtlas.GetAddressOf())) ||
+                FAILED(device->CreateShaderResourceView(pAtlas.Get(), &srvDesc, pAtlasSRV.GetAddressOf())))
+            {
+                m_Stats.numRejected += (uint32_t)packed.size();
+                continue;
+            }
+
+            std::string atlasName = std::string(prefix) + "#" + std::to_string(m_Stats.numAtlases);
+            for (auto& rect : packed)
+            {
+                const AtlasEntry& entry = entries[rect.id];
+                for (uint32_t mip = 0; mip < mipLevels; ++mip)
+                {
+                    UINT dstSubresource = D3D11CalcSubresource(mip, 0, mipLevels);
+                    UINT srcSubresource = D3D11CalcSubresource(mip, 0, entry.desc.MipLevels);
+                    UINT width = entry.desc.Width >> mip, height = entry.desc.Height >> mip;
+                    UINT gutter = align >> mip;
+                    UINT x = ((UINT)rect.x * align >> mip) + gutter;
+                    UINT y = ((UINT)rect.y * align >> mip) + gutter;
+                    auto copyBox = [&](UINT left, UINT top, UINT right, UINT bottom, UINT dstX, UINT dstY) {
+                        D3D11_BOX box = { left, top, 0, right, bottom, 1 };
+                        deviceContext->CopySubresourceRegion(pAtlas.Get(), dstSubresource, dstX, dstY, 0,
+                            entry.pTexture.Get(), srcSubresource, &box);
+                    };
+
+                    copyBox(0, 0, width, height, x, y);
+                    // 用边缘的一列/一行块填充间隔
+                    UINT b = blockSize;
+                    for (UINT i = 0; i < gutter; i += b)
+                    {
+                        copyBox(0, 0, b, height, x - gutter + i, y);
+                        copyBox(width - b, 0, width, height, x + width + i, y);
+                        copyBox(0, 0, width, b, x, y - gutter + i);
+                        copyBox(0, height - b, width, height, x, y + height + i);
+                        for (UINT j = 0; j < gutter; j += b)
+                        {
+                            copyBox(0, 0, b, b, x - gutter + i, y - gutter + j);
+                            copyBox(width - b, 0, width, b, x + width + i, y - gutter + j);
+                            copyBox(0, height - b, b, height, x - gutter + i, y + height + j);
+                            copyBox(width - b, height - b, width, height, x + width + i, y + height + j);
+                        }
+                    }
+                }
+
+                Region& region = m_Regions[StringToID(entry.name)];
+                region.atlasName = atlasName;
+                region.scaleOffset = XMFLOAT4(
+                    (float)entry.desc.Width / atlasWidth,
+                    (float)entry.desc.Height / atlasHeight,
+                    (float)(rect.x * align + align) / atlasWidth,
+                    (float)(rect.y * align + align) / atlasHeight);
+                m_UsedTexels += (size_t)entry.desc.Width * entry.desc.Height;
+            }
+
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+            SetDebugObjectName(pAtlas.Get(), atlasName);
+#endif
+            tm.AddTexture(atlasName, pAtlasSRV.Get());
+
+            for (uint32_t mip = 0; mip < mipLevels; ++mip)
+            {
+                uint32_t rowPitch, slicePitch;
+                if (Image::ComputePitch(formats.first, (std::max)(atlasWidth >> mip, 1u), (std::max)(atlasHeight >> mip, 1u), rowPitch, slicePitch))
+                    m_Stats.atlasBytes += slicePitch;
+            }
+            m_AtlasTexels += (size_t)atlasWidth * atlasHeight;
+            m_Stats.numPacked += (uint32_t)packed.size();
+            ++m_Stats.numAtlases;
+            ++numAtlases;
+        }
+    }
+
+    m_Stats.occupancy = m_AtlasTexels ? (float)m_UsedTexels / m_AtlasTexels : 0.0f;
+    // 已打包的纹理记录在m_Regions中，未能打包的不再重复尝试
+    m_Names.clear();
+    return numAtlases;
+}
+
+void TextureAtlas::ApplyToModel(Model& model, std::string_view texKey) const
+{
+    std::string scaleOffsetKey = std::string(texKey) + "ScaleOffset";
+    for (auto& material : model.materials)
+    {
+        if (!material.Has<std::string>(texKey))
+            continue;
+        const Region* pRegion = GetRegion(material.Get<std::string>(texKey));
+        if (!pRegion)
+            continue;
+        // 由ModelManager转移模型对纹理的引用，原纹理无其它引用时可被预算回收
+        if (ModelManager::HasInstance())
+            ModelManager::Get().SetMaterialTexture(model, material, texKey, pRegion->atlasName);
+        else
+            material.Set<std::string>(texKey, pRegion->atlasName);
+        material.Set<XMFLOAT4>(scaleOffsetKey, pRegion->scaleOffset);
+    }
+
+    // 共享图集的子网格连续绘制，减少SRV切换
+    auto getTexture = [&](const MeshData& meshData) -> std::string_view {
+        const Material& material = model.materials[meshData.m_MaterialIndex];
+        return material.Has<std::string>(texKey) ? std::string_view(material.Get<std::string>(texKey)) : std::string_view();
+    };
+    std::stable_sort(model.meshdatas.begin(), model.meshdatas.end(),
+        [&](const MeshData& lhs, const MeshData& rhs) { return getTexture(lhs) < getTexture(rhs); });
+}
+
+const TextureAtlas::Region* TextureAtlas::GetRegion(std::string_view name) const
+{
+    auto it = m_Regions.find(StringToID(name));
+    return it != m_Regions.end() ? &it->second : nullptr;
+}
+
+void TextureAtlas::Clear()
+{
+    // 已注册到TextureManager的图集由调用方移除
+    m_Names.clear();
+    m_Regions.clear();
+    m_Stats = Stats{};
+    m_UsedTexels = m_AtlasTexels = 0;
+}
@@ -0,0 +1,86 @@
+//***************************************************************************************
+// TextureAtlas.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 将格式相同的小纹理打包为图集，减少绘制之间的SRV切换
+// Pack small textures sharing a format into atlases to reduce SRV switches between draws.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include "WinMin.h"
+#include <d3d11_1.h>
+#include <DirectXMath.h>
+#include <wrl/client.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "XUtil.h"
+
+struct Model;
+
+// 图集中的纹理通过 frac(uv) * scaleOffset.xy + scaleOffset.zw 采样，
+// 需要使用SampleGrad并把梯度乘以scaleOffset.xy，以保持原有的mip选择
+// 每个子区域的四周留有间隔，在间隔中复制边缘的像素(块压缩格式按4x4块复制)，
+// 间隔宽度保证图集最低的mip等级仍至少有一个块，从而避免mip采样时串色
+// 注意：重复平铺的纹理在接缝处会退化为钳位采样
+class TextureAtlas
+{
+public:
+    struct Region
+    {
+        std::string atlasName;
+        DirectX::XMFLOAT4 scaleOffset;
+    };
+
+    struct Stats
+    {
+        uint32_t numAtlases = 0;
+        uint32_t numPacked = 0;         // 已放入图集的纹理数目
+        uint32_t numRejected = 0;       // 尺寸、格式不符或没有同格式纹理可合并的数目
+        size_t atlasBytes = 0;
+        float occupancy = 0.0f;         // 有效纹素占图集纹素的比例
+    };
+
+    TextureAtlas() = default;
+    ~TextureAtlas() = default;
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+    TextureAtlas(TextureAtlas&&) = default;
+    TextureAtlas& operator=(TextureAtlas&&) = default;
+
+    // maxAtlasSize: 图集的最大边长
+    // maxTextureSize: 宽或高超过该值的纹理不参与打包
+    // maxMipLevels: 图集保留的最大mip等级数，越大间隔越宽
+    void SetLimits(uint32_t maxAtlasSize, uint32_t maxTextureSize, uint32_t maxMipLevels);
+
+    // 纹理需要已经通过TextureManager同步载入
+    void AddTexture(std::string_view name);
+    // 收集模型材质中texKey对应的纹理
+    void AddModel(const Model& model, std::string_view texKey = "$Diffuse");
+    // 按SRV格式分组打包，图集以"<prefix>#<序号>"的名字注册到TextureManager，返回图集数目
+    uint32_t Build(std::string_view prefix);
+    // 将材质中texKey对应的纹理替换为图集，并写入"<texKey>ScaleOffset"属性
+    // 然后按纹理稳定排序子网格，使共享图集的子网格连续绘制
+    void ApplyToModel(Model& model, std::string_view texKey = "$Diffuse") const;
+
+    const Region* GetRegion(std::string_view name) const;
+    const Stats& GetStats() const { return m_Stats; }
+    void Clear();
+
+private:
+    std::vector<std::string> m_Names;
+    std::unordered_map<XID, Region> m_Regions;
+    Stats m_Stats;
+    size_t m_UsedTexels = 0;
+    size_t m_AtlasTexels = 0;
+    uint32_t m_MaxAtlasSize = 2048;
+    uint32_t m_MaxTextureSize = 512;
+    uint32_t m_MaxMipLevels = 4;
+};
+
+#endif
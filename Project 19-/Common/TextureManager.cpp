@@ -4,8 +4,15 @@
 #include "XUtil.h"
 #include "DXTrace.h"
 #include "ImGuiLog.h"
+#include "ThreadPool.h"
+#include "DDSLayout.h"
 #include <DDSTextureLoader11.h>
 #include <filesystem>
+#include <fstream>
+#include <deque>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 
 using namespace Microsoft::WRL;
 
@@ -13,8 +20,174 @@ namespace
 {
     // TextureManager单例
     TextureManager* s_pInstance = nullptr;
+
+    // SRV所引用纹理的全部子资源字节数
+    size_t ComputeTextureBytes(ID3D11ShaderResourceView* pSRV, uint32_t& category)
+    {
+        ComPtr<ID3D11Resource> pResource;
+        pSRV->GetResource(pResource.GetAddressOf());
+        D3D11_RESOURCE_DIMENSION dim;
+        pResource->GetType(&dim);
+
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        uint32_t width = 1, height = 1, depth = 1, mipLevels = 1, arraySize = 1;
+        category = TextureManager::MemoryCategory_Other;
+        if (dim == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+        {
+            ComPtr<ID3D11Texture2D> pTex;
+            pResource.As(&pTex);
+            D3D11_TEXTURE2D_DESC desc;
+            pTex->GetDesc(&desc);
+            format = desc.Format, width = desc.Width, height = desc.Height;
+            mipLevels = desc.MipLevels, arraySize = desc.ArraySize;
+            if (desc.MiscFlags & D3D11_RESOURCE_MISC_TEXTURECUBE)
+                category = TextureManager::MemoryCategory_TextureCube;
+            else if (arraySize == 1)
+                category = Image::IsCompressed(format) ? TextureManager::MemoryCategory_Compressed : TextureManager::MemoryCategory_Texture2D;
+        }
+        else if (dim == D3D11_RESOURCE_DIMENSION_TEXTURE3D)
+        {
+            ComPtr<ID3D11Texture3D> pTex;
+            pResource.As(&pTex);
+            D3D11_TEXTURE3D_DESC desc;
+            pTex->GetDesc(&desc);
+            format = desc.Format, width = desc.Width, height = desc.Height, depth = desc.Depth;
+            mipLevels = desc.MipLevels;
+        }
+        else if (dim == D3D11_RESOURCE_DIMENSION_TEXTURE1D)
+        {
+            ComPtr<ID3D11Texture1D> pTex;
+            pResource.As(&pTex);
+            D3D11_TEXTURE1D_DESC desc;
+            pTex->GetDesc(&desc);
+            format = desc.Format, width = desc.Width;
+            mipLevels = desc.MipLevels, arraySize = desc.ArraySize;
+        }
+        else
+        {
+            return 0;
+        }
+
+        size_t bytes = 0;
+        for (uint32_t mip = 0; mip < mipLevels; ++mip)
+        {
+            uint32_t rowPitch, slicePitch;
+            if (Image::ComputePitch(format, (std::max)(width >> mip, 1u), (std::max)(height >> mip, 1u), rowPitch, slicePitch))
+                bytes += (size_t)slicePitch * (std::max)(depth >> mip, 1u);
+        }
+        return bytes * arraySize;
+    }
 }
 
+// 工作线程的解码结果
+struct TextureManager::DecodedTexture
+{
+    XID id = 0;
+    std::string name;
+    std::vector<uint8_t> ddsData;       // DDS文件直接交给DDSTextureLoader
+    Image image;                        // 其余格式解码为RGBA8，可能已包含CPU生成的mip链
+    bool enableMips = false;
+    bool forceSRGB = false;
+    bool fromFile = false;
+    bool cpuMips = false;
+    bool cacheMips = false;
+    bool compress = false;
+    bool cacheCompressed = false;
+    bool useBC7 = false;
+    MipGenerator::Filter mipFilter = MipGenerator::Filter::Box;
+    BCEncoder::Quality compressQuality = BCEncoder::Quality::Normal;
+
+    size_t GetByteSize() const { return ddsData.size() + image.GetByteSize(); }
+};
+
+struct TextureManager::AsyncLoader
+{
+    explicit AsyncLoader(uint32_t numThreads) : pThreadPool(std::make_unique<ThreadPool>(numThreads)) {}
+
+    ~AsyncLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        queueCV.notify_all();
+        // 等待工作线程退出
+        pThreadPool.reset();
+    }
+
+    // 有界队列：排队的字节数超过上限时，解码线程在此等待
+    void Push(DecodedTexture&& decoded)
+    {
+        size_t bytes = decoded.GetByteSize();
+        std::unique_lock<std::mutex> lock(mutex);
+        queueCV.wait(lock, [&] { return stop || uploadQueue.empty() || queuedBytes + bytes <= maxQueuedBytes; });
+        if (stop)
+            return;
+        queuedBytes += bytes;
+        uploadQueue.push_back(std::move(decoded));
+    }
+
+    bool TryPop(DecodedTexture& decoded)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (uploadQueue.empty())
+                return false;
+            decoded = std::move(uploadQueue.front());
+            uploadQueue.pop_front();
+            queuedBytes -= decoded.GetByteSize();
+        }
+        queueCV.notify_all();
+        return true;
+    }
+
+    std::mutex mutex;
+    std::condition_variable queueCV;
+    std::deque<DecodedTexture> uploadQueue;
+    size_t queuedBytes = 0;
+    size_t maxQueuedBytes = 256 << 20;
+    size_t uploadBudget = 32 << 20;
+    bool stop = false;
+    std::unique_ptr<ThreadPool> pThreadPool;
+};
+
+// 参与流送的纹理
+struct TextureManager::StreamedTexture
+{
+    std::wstring fileName;
+    DDSLayout::TextureInfo info;
+    bool forceSRGB = false;
+    uint32_t residentMip = 0;           // 当前驻留的最精细mip
+    uint32_t baseMip = 0;               // 初始载入的mip，始终驻留
+    uint32_t targetMip = 0;
+    float requestedMip = FLT_MAX;       // 本帧请求的最精细mip
+    uint64_t lastRequestFrame = 0;
+
+    // [firstMip, mipCount)的总字节数
+    size_t GetByteSize(uint32_t firstMip) const
+    {
+        size_t bytes = 0;
+        for (uint32_t mip = firstMip; mip < info.mipCount; ++mip)
+        {
+            size_t numBytes = 0;
+            DDSLayout::GetSurfaceInfo((std::max)(1u, info.width >> mip), (std::max)(1u, info.height >> mip),
+                info.format, &numBytes, nullptr, nullptr);
+            bytes += numBytes;
+        }
+        return bytes;
+    }
+};
+
+struct TextureManager::Streamer
+{
+    std::unordered_map<XID, StreamedTexture> textures;
+    size_t budgetBytes = 256 << 20;
+    size_t uploadBytesPerFrame = 16 << 20;
+    uint32_t initialSize = 64;
+    uint64_t frameIndex = 1;
+    StreamingStats stats;
+};
+
 TextureManager::TextureManager()
 {
     if (s_pInstance)
@@ -58,38 +231,27 @@ ID3D11ShaderResourceView* TextureManager::CreateFromFile(std::string_view filena
     if (m_TextureSRVs.count(fileID))
         return m_TextureSRVs[fileID].Get();
 
+    if (m_pStreamer && CreateStreamed(fileID, filename, forceSRGB))
+        return m_TextureSRVs[fileID].Get();
+
+    if (m_pAsyncLoader)
+    {
+        SubmitAsync(MakeDecodeJob(fileID, filename, true, enableMips, forceSRGB), {});
+        return m_TextureSRVs[fileID].Get();
+    }
+
     auto& res = m_TextureSRVs[fileID];
-    ComPtr<ID3D11Texture2D> pTex;
     std::wstring wstr = UTF8ToWString(filename);
     if (FAILED(DirectX::CreateDDSTextureFromFileEx(m_pDevice.Get(),
         enableMips ? m_pDeviceContext.Get() : nullptr,
         wstr.c_str(), 0, D3D11_USAGE_DEFAULT,
-        D3D11_BIND_SHADER_RESOURCE, 0, 0, 
+        D3D11_BIND_SHADER_RESOURCE, 0, 0,
         forceSRGB, nullptr, res.ReleaseAndGetAddressOf())))
     {
-        int width, height, comp;
-        
-        stbi_uc* img_data = stbi_load(filename.data(), &width, &height, &comp, STBI_rgb_alpha);
-        if (img_data)
-        {
-            CD3D11_TEXTURE2D_DESC texDesc(forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM, 
-                width, height, 1,
-                enableMips ? 0 : 1, 
-                D3D11_BIND_SHADER_RESOURCE | (enableMips ? D3D11_BIND_RENDER_TARGET : 0),
-                D3D11_USAGE_DEFAULT, 0, 1, 0, 
-                enableMips ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0);
-            Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
-            HR(m_pDevice->CreateTexture2D(&texDesc, nullptr, tex.GetAddressOf()));
-            // 上传纹理数据
-            m_pDeviceContext->UpdateSubresource(tex.Get(), 0, nullptr, img_data, width * sizeof(uint32_t), 0);
-            CD3D11_SHADER_RESOURCE_VIEW_DESC srvDesc(D3D11_SRV_DIMENSION_TEXTURE2D, 
-                forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM);
-            // 创建SRV
-            HR(m_pDevice->CreateShaderResourceView(tex.Get(), &srvDesc, res.ReleaseAndGetAddressOf()));
-            // 生成mipmap
-            if (enableMips)
-                m_pDeviceContext->GenerateMips(res.Get());
-            stbi_image_free(img_data);
+        DecodedTexture decoded = MakeDecodeJob(fileID, filename, true, enableMips, forceSRGB);
+        DecodeTexture(decoded, nullptr, 0);
+        if (CreateFromDecoded(decoded, res))
+        {
 #if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
             SetDebugObjectName(res.Get(), std::filesystem::path(filename).filename().string());
 #endif
@@ -99,16 +261,7 @@ ID3D11ShaderResourceView* TextureManager::CreateFromFile(std::string_view filena
             std::string warning = "[Warning]: TextureManager::CreateFromFile, couldn't find \"";
             warning += filename;
             warning += "\"\n";
-
-            if (ImGuiLog::HasInstance())
-            {
-                ImGuiLog::Get().AddLog(warning.c_str());
-            }
-            else
-            {
-                OutputDebugStringA(warning.c_str());
-            }
-            
+            LogWarning(warning);
         }
     }
 
@@ -121,29 +274,19 @@ ID3D11ShaderResourceView* TextureManager::CreateFromMemory(std::string_view name
     if (m_TextureSRVs.count(fileID))
         return m_TextureSRVs[fileID].Get();
 
+    if (m_pAsyncLoader)
+    {
+        // 数据的生命周期由调用方管理，需要先拷贝一份
+        auto pBytes = reinterpret_cast<const uint8_t*>(data);
+        SubmitAsync(MakeDecodeJob(fileID, name, false, enableMips, forceSRGB), std::vector<uint8_t>(pBytes, pBytes + byteWidth));
+        return m_TextureSRVs[fileID].Get();
+    }
+
     auto& res = m_TextureSRVs[fileID];
-    int width, height, comp;
-    stbi_uc* img_data = stbi_load_from_memory(reinterpret_cast<stbi_uc*>(data), (int)byteWidth, &width, &height, &comp, STBI_rgb_alpha);
-    if (img_data)
-    {
-        CD3D11_TEXTURE2D_DESC texDesc(forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM,
-            width, height, 1,
-            enableMips ? 0 : 1,
-            D3D11_BIND_SHADER_RESOURCE | (enableMips ? D3D11_BIND_RENDER_TARGET : 0),
-            D3D11_USAGE_DEFAULT, 0, 1, 0,
-            enableMips ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0);
-        Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
-        HR(m_pDevice->CreateTexture2D(&texDesc, nullptr, tex.GetAddressOf()));
-        // 上传纹理数据
-        m_pDeviceContext->UpdateSubresource(tex.Get(), 0, nullptr, img_data, width * sizeof(uint32_t), 0);
-        CD3D11_SHADER_RESOURCE_VIEW_DESC srvDesc(D3D11_SRV_DIMENSION_TEXTURE2D,
-            forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM);
-        // 创建SRV
-        HR(m_pDevice->CreateShaderResourceView(tex.Get(), &srvDesc, res.ReleaseAndGetAddressOf()));
-        // 生成mipmap
-        if (enableMips)
-            m_pDeviceContext->GenerateMips(res.Get());
-        stbi_image_free(img_data);
+    DecodedTexture decoded = MakeDecodeJob(fileID, name, false, enableMips, forceSRGB);
+    DecodeTexture(decoded, reinterpret_cast<const uint8_t*>(data), byteWidth);
+    if (CreateFromDecoded(decoded, res))
+    {
 #if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
         SetDebugObjectName(res.Get(), name);
 #endif
@@ -168,17 +311,506 @@ void TextureManager::RemoveTexture(std::string_view name)
 {
     XID nameID = StringToID(name);
     m_TextureSRVs.erase(nameID);
+    m_TrackedSRVs.erase(nameID);
+    m_Budget.Untrack(nameID);
+    // 仍在解码的纹理在上传时会被丢弃
+    m_PendingTextures.erase(nameID);
+    if (m_pStreamer)
+        m_pStreamer->textures.erase(nameID);
 }
 
 ID3D11ShaderResourceView* TextureManager::GetTexture(std::string_view filename)
 {
     XID fileID = StringToID(filename);
-    if (m_TextureSRVs.count(fileID))
-        return m_TextureSRVs[fileID].Get();
-    return nullptr;
+    auto it = m_TextureSRVs.find(fileID);
+    if (it == m_TextureSRVs.end())
+        return nullptr;
+    m_Budget.Touch(fileID);
+    return it->second.Get();
 }
 
 ID3D11ShaderResourceView* TextureManager::GetNullTexture()
 {
     return m_TextureSRVs[0].Get();
 }
+
+void TextureManager::SetAsyncLoading(bool enable, uint32_t numThreads)
+{
+    if (enable && !m_pAsyncLoader)
+        m_pAsyncLoader = std::make_unique<AsyncLoader>(numThreads);
+    else if (!enable && m_pAsyncLoader)
+    {
+        // 关闭前把剩余的纹理全部上传
+        while (!m_PendingTextures.empty())
+        {
+            Update();
+            std::this_thread::yield();
+        }
+        m_pAsyncLoader.reset();
+    }
+}
+
+void TextureManager::SetUploadBudget(size_t bytesPerFrame, size_t maxQueuedBytes)
+{
+    if (!m_pAsyncLoader)
+        return;
+    std::lock_guard<std::mutex> lock(m_pAsyncLoader->mutex);
+    m_pAsyncLoader->uploadBudget = bytesPerFrame;
+    m_pAsyncLoader->maxQueuedBytes = maxQueuedBytes;
+    m_pAsyncLoader->queueCV.notify_all();
+}
+
+void TextureManager::Update()
+{
+    if (m_pStreamer)
+        UpdateStreaming();
+
+    // 每帧至少上传一张，避免大纹理超出预算后永远无法上传
+    size_t uploadedBytes = 0;
+    DecodedTexture decoded;
+    while (m_pAsyncLoader && uploadedBytes < m_pAsyncLoader->uploadBudget && m_pAsyncLoader->TryPop(decoded))
+    {
+        uploadedBytes += decoded.GetByteSize();
+        // 已经被移除的纹理直接丢弃
+        if (!m_PendingTextures.erase(decoded.id))
+            continue;
+
+        ComPtr<ID3D11ShaderResourceView> res;
+        if (!CreateFromDecoded(decoded, res))
+        {
+            std::string warning = decoded.fromFile ?
+                "[Warning]: TextureManager::CreateFromFile, couldn't find \"" :
+                "[Warning]: TextureManager::CreateFromMemory, failed to create texture \"";
+            warning += decoded.name;
+            warning += "\"\n";
+            LogWarning(warning);
+            continue;
+        }
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+        SetDebugObjectName(res.Get(), decoded.fromFile ?
+            std::filesystem::path(decoded.name).filename().string() : decoded.name);
+#endif
+        m_TextureSRVs[decoded.id] = res;
+    }
+
+    SyncMemoryUsage();
+    std::vector<XID> evicted;
+    m_Budget.CollectEvictions(evicted);
+    for (XID id : evicted)
+    {
+        m_TextureSRVs.erase(id);
+        m_TrackedSRVs.erase(id);
+        if (m_pStreamer)
+            m_pStreamer->textures.erase(id);
+    }
+    m_Budget.NextFrame();
+}
+
+void TextureManager::SetMemoryBudget(size_t bytes)
+{
+    m_Budget.SetBudget(bytes);
+}
+
+void TextureManager::AddRef(std::string_view name)
+{
+    m_Budget.AddRef(StringToID(name));
+}
+
+void TextureManager::Release(std::string_view name)
+{
+    m_Budget.Release(StringToID(name));
+}
+
+std::string TextureManager::GetMemoryReport()
+{
+    static const char* s_CategoryNames[MemoryCategory_Count] = { "2D", "2D (BC)", "Cube", "Other" };
+    SyncMemoryUsage();
+    return m_Budget.FormatReport("Textures", s_CategoryNames);
+}
+
+void TextureManager::SyncMemoryUsage()
+{
+    ID3D11ShaderResourceView* pNullSRV = GetNullTexture();
+    for (auto& [id, pSRV] : m_TextureSRVs)
+    {
+        // 空纹理与尚未上传完成的纹理不计入
+        if (!pSRV || pSRV.Get() == pNullSRV)
+            continue;
+        auto& pTrackedSRV = m_TrackedSRVs[id];
+        if (pTrackedSRV == pSRV.Get())
+            continue;
+        pTrackedSRV = pSRV.Get();
+        uint32_t category = 0;
+        size_t bytes = ComputeTextureBytes(pSRV.Get(), category);
+        m_Budget.Track(id, bytes, category);
+    }
+}
+
+void TextureManager::SetCpuMipGeneration(bool enable, MipGenerator::Filter filter, bool cacheToDDS)
+{
+    m_CpuMips = enable;
+    m_MipFilter = filter;
+    m_CacheMips = enable && cacheToDDS;
+}
+
+void TextureManager::SetBlockCompression(bool enable, BCEncoder::Quality quality, bool useBC7, bool cacheToDDS)
+{
+    m_Compress = enable;
+    m_CompressQuality = quality;
+    m_UseBC7 = useBC7;
+    m_CacheCompressed = enable && cacheToDDS;
+}
+
+void TextureManager::SetStreaming(bool enable, size_t budgetBytes, uint32_t initialSize, size_t uploadBytesPerFrame)
+{
+    if (!enable)
+    {
+        // 已经载入的纹理保持当前的精度
+        m_pStreamer.reset();
+        return;
+    }
+    if (!m_pStreamer)
+        m_pStreamer = std::make_unique<Streamer>();
+    m_pStreamer->budgetBytes = budgetBytes;
+    m_pStreamer->initialSize = (std::max)(initialSize, 1u);
+    m_pStreamer->uploadBytesPerFrame = uploadBytesPerFrame;
+}
+
+void TextureManager::RequestMip(std::string_view filename, float uvPerPixel)
+{
+    if (!m_pStreamer)
+        return;
+    auto it = m_pStreamer->textures.find(StringToID(filename));
+    if (it == m_pStreamer->textures.end())
+        return;
+
+    StreamedTexture& tex = it->second;
+    float texelsPerPixel = (std::max)(tex.info.width, tex.info.height) * uvPerPixel;
+    float mip = texelsPerPixel > 1.0f ? log2f(texelsPerPixel) : 0.0f;
+    tex.requestedMip = (std::min)(tex.requestedMip, mip);
+    tex.lastRequestFrame = m_pStreamer->frameIndex;
+}
+
+TextureManager::StreamingStats TextureManager::GetStreamingStats() const
+{
+    return m_pStreamer ? m_pStreamer->stats : StreamingStats{};
+}
+
+bool TextureManager::CreateStreamed(XID id, std::string_view filename, bool forceSRGB)
+{
+    // 只读取文件头判断是否适合流送
+    StreamedTexture tex;
+    tex.fileName = UTF8ToWString(filename);
+    tex.forceSRGB = forceSRGB;
+    uint8_t headerData[sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)] = {};
+    std::ifstream fin(tex.fileName, std::ios::in | std::ios::binary);
+    if (!fin.is_open())
+        return false;
+    fin.read(reinterpret_cast<char*>(headerData), sizeof(headerData));
+
+    const DDS_HEADER* pHeader = nullptr;
+    const uint8_t* pBitData = nullptr;
+    size_t bitSize = 0;
+    if (FAILED(DDSLayout::ParseHeader(headerData, static_cast<size_t>(fin.gcount()), &pHeader, &pBitData, &bitSize)) ||
+        FAILED(DDSLayout::GetTextureInfo(pHeader, tex.info)))
+        return false;
+    if (tex.info.resourceDimension != DDS_DIMENSION_TEXTURE2D || tex.info.arraySize != 1 || tex.info.mipCount <= 1)
+        return false;
+
+    // 初始载入尺寸不超过initialSize的第一个mip
+    tex.baseMip = tex.info.mipCount - 1;
+    for (uint32_t mip = 0; mip < tex.info.mipCount; ++mip)
+    {
+        if ((std::max)(tex.info.width >> mip, tex.info.height >> mip) <= m_pStreamer->initialSize)
+        {
+            tex.baseMip = mip;
+            break;
+        }
+    }
+    if (!LoadStreamedMips(id, tex, tex.baseMip))
+        return false;
+
+    // 不记为本帧请求，否则尚未请求的纹理会以完整精度为目标
+    tex.targetMip = tex.baseMip;
+    m_pStreamer->textures[id] = std::move(tex);
+    return true;
+}
+
+bool TextureManager::LoadStreamedMips(XID id, StreamedTexture& tex, uint32_t firstMip)
+{
+    // 借助DDSTextureLoader的maxsize跳过更精细的mip，文件经过内存映射，只有用到的部分会被读取
+    size_t maxSize = (std::max)(1u, (std::max)(tex.info.width >> firstMip, tex.info.height >> firstMip));
+    ComPtr<ID3D11ShaderResourceView> res;
+    if (FAILED(DirectX::CreateDDSTextureFromFileEx(m_pDevice.Get(), tex.fileName.c_str(), maxSize,
+        D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, tex.forceSRGB, nullptr, res.GetAddressOf())))
+        return false;
+
+#if (defined(DEBUG) || defined(_DEBUG)) && (GRAPHICS_DEBUGGER_OBJECT_NAME)
+    SetDebugObjectName(res.Get(), std::filesystem::path(tex.fileName).filename().string());
+#endif
+    m_TextureSRVs[id] = res;
+    tex.residentMip = firstMip;
+    return true;
+}
+
+void TextureManager::UpdateStreaming()
+{
+    Streamer& streamer = *m_pStreamer;
+    StreamingStats& stats = streamer.stats;
+    stats = StreamingStats{};
+    stats.budgetBytes = streamer.budgetBytes;
+    stats.numTextures = static_cast<uint32_t>(streamer.textures.size());
+
+    // 本帧被请求的纹理以请求为目标，其余纹理保持当前精度，只在超出预算时回收
+    std::vector<std::pair<XID, StreamedTexture*>> lruOrder;
+    lruOrder.reserve(streamer.textures.size());
+    size_t targetBytes = 0;
+    for (auto& [id, tex] : streamer.textures)
+    {
+        if (tex.lastRequestFrame == streamer.frameIndex)
+        {
+            // 未请求时requestedMip为FLT_MAX，转换前先钳位到有效的mip范围
+            float clampedMip = (std::min)((std::max)(tex.requestedMip, 0.0f), static_cast<float>(tex.info.mipCount - 1));
+            uint32_t requested = static_cast<uint32_t>(clampedMip);
+            tex.targetMip = (std::min)(requested, tex.baseMip);
+            stats.requestedBytes += tex.GetByteSize(tex.targetMip);
+        }
+        else
+        {
+            tex.targetMip = tex.residentMip;
+        }
+        targetBytes += tex.GetByteSize(tex.targetMip);
+        lruOrder.emplace_back(id, &tex);
+    }
+
+    // 超出预算时，从最久未被请求的纹理开始逐级丢弃最精细的mip
+    if (targetBytes > streamer.budgetBytes)
+    {
+        std::sort(lruOrder.begin(), lruOrder.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second->lastRequestFrame < rhs.second->lastRequestFrame;
+        });
+        for (auto& [id, pTex] : lruOrder)
+        {
+            while (targetBytes > streamer.budgetBytes && pTex->targetMip < pTex->baseMip)
+            {
+                targetBytes -= pTex->GetByteSize(pTex->targetMip) - pTex->GetByteSize(pTex->targetMip + 1);
+                ++pTex->targetMip;
+            }
+            if (targetBytes <= streamer.budgetBytes)
+                break;
+        }
+    }
+
+    // 先回收再载入。载入时优先处理缺失mip最多的纹理，每帧至少载入一张
+    std::vector<std::pair<XID, StreamedTexture*>> upgrades;
+    for (auto& [id, pTex] : lruOrder)
+    {
+        if (pTex->targetMip > pTex->residentMip)
+            LoadStreamedMips(id, *pTex, pTex->targetMip);
+        else if (pTex->targetMip < pTex->residentMip)
+            upgrades.emplace_back(id, pTex);
+    }
+    std::sort(upgrades.begin(), upgrades.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second->residentMip - lhs.second->targetMip > rhs.second->residentMip - rhs.second->targetMip;
+    });
+    size_t uploadedBytes = 0;
+    for (auto& [id, pTex] : upgrades)
+    {
+        if (uploadedBytes >= streamer.uploadBytesPerFrame)
+            break;
+        uploadedBytes += pTex->GetByteSize(pTex->targetMip);
+        LoadStreamedMips(id, *pTex, pTex->targetMip);
+    }
+
+    for (auto& [id, tex] : streamer.textures)
+    {
+        stats.residentBytes += tex.GetByteSize(tex.residentMip);
+        stats.numPendingMips += tex.targetMip < tex.residentMip ? tex.residentMip - tex.targetMip : 0;
+        tex.requestedMip = FLT_MAX;
+    }
+    ++streamer.frameIndex;
+}
+
+TextureManager::DecodedTexture TextureManager::MakeDecodeJob(XID id, std::string_view name, bool fromFile, bool enableMips, bool forceSRGB) const
+{
+    DecodedTexture job;
+    job.id = id;
+    job.name = name;
+    job.enableMips = enableMips;
+    job.forceSRGB = forceSRGB;
+    job.fromFile = fromFile;
+    job.cpuMips = m_CpuMips;
+    job.cacheMips = m_CacheMips && fromFile;
+    job.cacheCompressed = m_CacheCompressed && fromFile;
+    job.compress = m_Compress;
+    job.useBC7 = m_UseBC7;
+    job.mipFilter = m_MipFilter;
+    job.compressQuality = m_CompressQuality;
+    return job;
+}
+
+void TextureManager::SubmitAsync(DecodedTexture&& job, std::vector<uint8_t>&& memoryData)
+{
+    // 完成之前先绑定空纹理
+    m_TextureSRVs[job.id] = GetNullTexture();
+    m_PendingTextures.insert(job.id);
+
+    AsyncLoader* pLoader = m_pAsyncLoader.get();
+    pLoader->pThreadPool->Submit([pLoader, job = std::move(job), data = std::move(memoryData)]() mutable {
+        DecodeTexture(job, data.empty() ? nullptr : data.data(), data.size());
+        // 失败时也需要入队，由设备线程输出警告
+        pLoader->Push(std::move(job));
+    });
+}
+
+void TextureManager::DecodeTexture(DecodedTexture& job, const uint8_t* pData, size_t byteWidth)
+{
+    namespace fs = std::filesystem;
+
+    auto readFile = [](const fs::path& path, std::vector<uint8_t>& bytes) {
+        std::ifstream fin(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!fin.is_open())
+            return false;
+        bytes.resize(static_cast<size_t>(fin.tellg()));
+        fin.seekg(0);
+        fin.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        return true;
+    };
+
+    // BC格式无法使用GenerateMips，压缩时总是在CPU生成mip链
+    bool generateMips = job.enableMips && (job.cpuMips || job.compress);
+    fs::path srcPath, cachePath;
+    std::vector<uint8_t> fileData;
+    if (job.fromFile)
+    {
+        srcPath = UTF8ToWString(job.name);
+        // 压缩与mip链各自使用自己的缓存，压缩时不读取未压缩的mip链缓存
+        bool useCache = job.compress ? job.cacheCompressed : (generateMips && job.cacheMips);
+        if (useCache)
+        {
+            // 缓存比源文件新时直接使用缓存
+            cachePath = srcPath;
+            if (job.forceSRGB)
+                cachePath += L".srgb";
+            if (job.compress)
+                cachePath += job.useBC7 ? L".bc7.dds" : L".bc.dds";
+            else
+                cachePath += L".mips.dds";
+            std::error_code ec, ec2;
+            auto cacheTime = fs::last_write_time(cachePath, ec);
+            auto srcTime = fs::last_write_time(srcPath, ec2);
+            if (!ec && !ec2 && cacheTime >= srcTime && readFile(cachePath, job.ddsData))
+                return;
+            job.ddsData.clear();
+        }
+        if (readFile(srcPath, fileData))
+        {
+            pData = fileData.data();
+            byteWidth = fileData.size();
+        }
+    }
+    if (!pData || !byteWidth)
+        return;
+
+    const uint32_t ddsMagic = 0x20534444; // "DDS "
+    if (byteWidth > sizeof(uint32_t) && *reinterpret_cast<const uint32_t*>(pData) == ddsMagic)
+    {
+        if (fileData.empty())
+            job.ddsData.assign(pData, pData + byteWidth);
+        else
+            job.ddsData = std::move(fileData);
+        return;
+    }
+
+    int width, height, comp;
+    stbi_uc* pixels = stbi_load_from_memory(pData, (int)byteWidth, &width, &height, &comp, STBI_rgb_alpha);
+    if (!pixels)
+        return;
+    job.image.Initialize(job.forceSRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM, width, height, pixels);
+    stbi_image_free(pixels);
+
+    if (generateMips)
+        MipGenerator::Generate(job.image, job.mipFilter);
+
+    bool compressed = false;
+    if (job.compress && job.image.GetWidth() % 4 == 0 && job.image.GetHeight() % 4 == 0)
+    {
+        DXGI_FORMAT format;
+        if (job.useBC7)
+            format = job.forceSRGB ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+        else if (BCEncoder::HasAlpha(job.image))
+            format = job.forceSRGB ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+        else
+            format = job.forceSRGB ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+        compressed = BCEncoder::Compress(job.image, format, job.image, job.compressQuality);
+    }
+
+    // 未能压缩的纹理不写入.bc[7].dds，否则之后会被当作压缩结果读取
+    if (!cachePath.empty() && (!job.compress || compressed))
+        SaveImageToDDSFile(job.image, cachePath.c_str());
+}
+
+bool TextureManager::CreateFromDecoded(const DecodedTexture& decoded, ComPtr<ID3D11ShaderResourceView>& res)
+{
+    if (!decoded.ddsData.empty())
+    {
+        DirectX::CreateDDSTextureFromMemoryEx(m_pDevice.Get(),
+            decoded.enableMips ? m_pDeviceContext.Get() : nullptr,
+            decoded.ddsData.data(), decoded.ddsData.size(), 0, D3D11_USAGE_DEFAULT,
+            D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            decoded.forceSRGB, nullptr, res.ReleaseAndGetAddressOf());
+    }
+    else if (!decoded.image.levels.empty())
+    {
+        CreateFromImage(res, decoded.image, decoded.enableMips);
+    }
+    return res != nullptr;
+}
+
+void TextureManager::CreateFromImage(ComPtr<ID3D11ShaderResourceView>& res, const Image& image, bool enableMips)
+{
+    // 图像已带有mip链时一次性上传所有等级，否则按需使用GPU生成
+    bool generateMips = enableMips && image.GetMipLevels() == 1 && !Image::IsCompressed(image.format);
+    CD3D11_TEXTURE2D_DESC texDesc(image.format,
+        image.GetWidth(), image.GetHeight(), 1,
+        generateMips ? 0 : image.GetMipLevels(),
+        D3D11_BIND_SHADER_RESOURCE | (generateMips ? D3D11_BIND_RENDER_TARGET : 0),
+        D3D11_USAGE_DEFAULT, 0, 1, 0,
+        generateMips ? D3D11_RESOURCE_MISC_GENERATE_MIPS : 0);
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> tex;
+    if (generateMips)
+    {
+        HR(m_pDevice->CreateTexture2D(&texDesc, nullptr, tex.GetAddressOf()));
+        // 上传纹理数据
+        m_pDeviceContext->UpdateSubresource(tex.Get(), 0, nullptr, image.levels[0].pixels.data(), image.levels[0].rowPitch, 0);
+    }
+    else
+    {
+        std::vector<D3D11_SUBRESOURCE_DATA> initData(image.GetMipLevels());
+        for (size_t i = 0; i < initData.size(); ++i)
+        {
+            initData[i].pSysMem = image.levels[i].pixels.data();
+            initData[i].SysMemPitch = image.levels[i].rowPitch;
+            initData[i].SysMemSlicePitch = static_cast<UINT>(image.levels[i].pixels.size());
+        }
+        HR(m_pDevice->CreateTexture2D(&texDesc, initData.data(), tex.GetAddressOf()));
+    }
+    CD3D11_SHADER_RESOURCE_VIEW_DESC srvDesc(D3D11_SRV_DIMENSION_TEXTURE2D, image.format);
+    // 创建SRV
+    HR(m_pDevice->CreateShaderResourceView(tex.Get(), &srvDesc, res.ReleaseAndGetAddressOf()));
+    // 生成mipmap
+    if (generateMips)
+        m_pDeviceContext->GenerateMips(res.Get());
+}
+
+void TextureManager::LogWarning(const std::string& warning)
+{
+    if (ImGuiLog::HasInstance())
+    {
+        ImGuiLog::Get().AddLog(warning.c_str());
+    }
+    else
+    {
+        OutputDebugStringA(warning.c_str());
+    }
+}
@@ -13,11 +13,16 @@
 
 
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
 #include <string>
 #include "WinMin.h"
 #include <d3d11_1.h>
 #include <wrl/client.h>
 #include <XUtil.h>
+#include "MipGenerator.h"
+#include "BCEncoder.h"
+#include "ResourceBudget.h"
 
 class TextureManager
 {
@@ -38,11 +43,107 @@ public:
     ID3D11ShaderResourceView* GetTexture(std::string_view filename);
     ID3D11ShaderResourceView* GetNullTexture();
 
+    // 开启后，CreateFromFile/CreateFromMemory只提交任务并返回空纹理，文件的读取和解码在线程池中进行
+    // 解码结果放入有界的上传队列，由Update在设备线程中按每帧字节预算创建纹理并替换空纹理
+    // 注意：此时CreateFromFile的返回值是空纹理，需要在绘制时通过GetTexture获取
+    void SetAsyncLoading(bool enable, uint32_t numThreads = 0);
+    void SetUploadBudget(size_t bytesPerFrame, size_t maxQueuedBytes);
+    // 每帧在设备线程调用一次
+    void Update();
+    // 尚未上传完成的纹理数目
+    size_t GetPendingCount() const { return m_PendingTextures.size(); }
+
+    // 开启后，非DDS纹理在请求mipmap时改由CPU生成完整的mip链(sRGB纹理在线性空间滤波)，不再使用GenerateMips
+    // cacheToDDS为true时，从文件读取的纹理会把结果写到同目录下的"<文件名>[.srgb].mips.dds"，
+    // 之后缓存比源文件新就直接读取缓存。修改滤波方式后需要手动删除缓存
+    void SetCpuMipGeneration(bool enable, MipGenerator::Filter filter = MipGenerator::Filter::Box, bool cacheToDDS = false);
+    // 开启后，非DDS纹理解码后压缩为BC7，或按是否含Alpha压缩为BC1/BC3(宽高需为4的倍数，否则保持RGBA8)
+    // 请求mipmap的纹理会先在CPU生成mip链。cacheToDDS的含义同上，缓存文件为"<文件名>[.srgb].bc[7].dds"，
+    // 宽高不满足要求而未压缩的纹理不写入缓存。开启压缩时不读写SetCpuMipGeneration的缓存
+    void SetBlockCompression(bool enable, BCEncoder::Quality quality = BCEncoder::Quality::Normal, bool useBC7 = false, bool cacheToDDS = false);
+
+    //
+    // 纹理流送
+    //
+
+    struct StreamingStats
+    {
+        size_t residentBytes = 0;       // 当前驻留的字节数
+        size_t requestedBytes = 0;      // 满足本帧所有请求所需的字节数(不受预算限制)
+        size_t budgetBytes = 0;
+        uint32_t numTextures = 0;       // 参与流送的纹理数目
+        uint32_t numPendingMips = 0;    // 尚未载入的请求mip等级数
+    };
+
+    // 开启后，CreateFromFile载入带mip链的2D DDS纹理时只载入尺寸不超过initialSize的低精度mip，
+    // 更精细的mip根据RequestMip的请求在Update中按每帧的上传字节数逐步载入；
+    // 总驻留字节超过budgetBytes时，从最久未被请求的纹理开始回收最精细的mip
+    // 注意：载入新的mip时纹理会被重建，需要在绘制时通过GetTexture获取
+    void SetStreaming(bool enable, size_t budgetBytes = 256 << 20, uint32_t initialSize = 64, size_t uploadBytesPerFrame = 16 << 20);
+    // uvPerPixel为屏幕上一个像素覆盖的UV长度，所需mip等级为log2(纹理尺寸 * uvPerPixel)
+    // 每帧对可见的物体调用，未参与流送的纹理忽略该请求
+    void RequestMip(std::string_view filename, float uvPerPixel);
+    StreamingStats GetStreamingStats() const;
+
+    //
+    // 内存统计与回收
+    //
+
+    enum MemoryCategory
+    {
+        MemoryCategory_Texture2D,
+        MemoryCategory_Compressed,      // 块压缩的2D纹理
+        MemoryCategory_TextureCube,
+        MemoryCategory_Other,           // 纹理数组、1D/3D纹理等
+        MemoryCategory_Count
+    };
+
+    // 显存预算，0表示不限制。超出预算时，Update会从最久未被GetTexture访问的纹理开始，
+    // 回收没有引用、且上一帧之后没有被访问的纹理。被回收的纹理需要重新CreateFromFile
+    void SetMemoryBudget(size_t bytes);
+    // 引用计数，ModelManager会为模型材质中的纹理增加引用；
+    // 在材质中手动设置纹理名的代码应当自行调用
+    void AddRef(std::string_view name);
+    void Release(std::string_view name);
+    size_t GetMemoryUsage() const { return m_Budget.GetTotalBytes(); }
+    // 按类别统计的文本报告，可直接输出到ImGui或控制台
+    std::string GetMemoryReport();
+
 private:
+    struct DecodedTexture;
+    struct AsyncLoader;
+    struct Streamer;
+    struct StreamedTexture;
+
+    bool CreateStreamed(XID id, std::string_view filename, bool forceSRGB);
+    bool LoadStreamedMips(XID id, StreamedTexture& texture, uint32_t firstMip);
+    void UpdateStreaming();
+
+    DecodedTexture MakeDecodeJob(XID id, std::string_view name, bool fromFile, bool enableMips, bool forceSRGB) const;
+    void SubmitAsync(DecodedTexture&& job, std::vector<uint8_t>&& memoryData);
+    // 可在工作线程调用：读取文件(pData为空时)并解码，按需在CPU生成mip链
+    static void DecodeTexture(DecodedTexture& job, const uint8_t* pData, size_t byteWidth);
+    bool CreateFromDecoded(const DecodedTexture& decoded, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& res);
+    void CreateFromImage(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& res, const Image& image, bool enableMips);
+    void LogWarning(const std::string& warning);
+    // 为新建或被替换的纹理重新计算字节数
+    void SyncMemoryUsage();
 
     Microsoft::WRL::ComPtr<ID3D11Device> m_pDevice;
     Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_pDeviceContext;
     std::unordered_map<XID, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> m_TextureSRVs;
+    std::unordered_set<XID> m_PendingTextures;
+    std::unique_ptr<AsyncLoader> m_pAsyncLoader;
+    std::unique_ptr<Streamer> m_pStreamer;
+    ResourceBudget m_Budget{ MemoryCategory_Count };
+    std::unordered_map<XID, ID3D11ShaderResourceView*> m_TrackedSRVs;     // 计算字节数时对应的SRV
+    bool m_CpuMips = false;
+    bool m_CacheMips = false;           // CPU生成的mip链写入.mips.dds缓存
+    bool m_Compress = false;
+    bool m_CacheCompressed = false;     // 压缩结果写入.bc[7].dds缓存
+    bool m_UseBC7 = false;
+    BCEncoder::Quality m_CompressQuality = BCEncoder::Quality::Normal;
+    MipGenerator::Filter m_MipFilter = MipGenerator::Filter::Box;
 };
 
 #endif
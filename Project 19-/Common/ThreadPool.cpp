@@ -0,0 +1,128 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(uint32_t numThreads)
+{
+    if (numThreads == 0)
+    {
+        // hardware_concurrency无法获取时返回0
+        unsigned hc = std::thread::hardware_concurrency();
+        numThreads = hc > 1 ? hc - 1 : 1;
+    }
+    m_Threads.reserve(numThreads);
+    for (uint32_t i = 0; i < numThreads; ++i)
+        m_Threads.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_TaskCV.notify_all();
+    for (auto& thread : m_Threads)
+        thread.join();
+}
+
+ThreadPool& ThreadPool::GetDefault()
+{
+    static ThreadPool s_ThreadPool;
+    return s_ThreadPool;
+}
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Tasks.push(std::move(task));
+    }
+    m_TaskCV.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_IdleCV.wait(lock, [this] { return m_Tasks.empty() && m_ActiveTasks == 0; });
+}
+
+void ThreadPool::ParallelFor(uint32_t begin, uint32_t end, uint32_t grain,
+    const std::function<void(uint32_t, uint32_t)>& func)
+{
+    if (begin >= end)
+        return;
+    grain = (std::max)(grain, 1u);
+    uint32_t numChunks = (end - begin + grain - 1) / grain;
+    if (numChunks == 1 || m_Threads.empty())
+    {
+        func(begin, end);
+        return;
+    }
+
+    // 辅助任务可能在本函数返回后才被执行，因此共享状态需要独立于调用栈
+    struct SharedState
+    {
+        std::atomic<uint32_t> nextChunk{ 0 };
+        std::atomic<uint32_t> remaining{ 0 };
+        std::mutex mutex;
+        std::condition_variable doneCV;
+    };
+    auto pState = std::make_shared<SharedState>();
+    pState->remaining = numChunks;
+
+    auto RunChunks = [=, &func]() {
+        for (;;)
+        {
+            uint32_t chunk = pState->nextChunk.fetch_add(1);
+            if (chunk >= numChunks)
+                return;
+            uint32_t chunkBegin = begin + chunk * grain;
+            uint32_t chunkEnd = (std::min)(chunkBegin + grain, end);
+            func(chunkBegin, chunkEnd);
+            if (pState->remaining.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(pState->mutex);
+                pState->doneCV.notify_all();
+            }
+        }
+    };
+
+    uint32_t numHelpers = (std::min)(numChunks - 1, GetThreadCount());
+    for (uint32_t i = 0; i < numHelpers; ++i)
+    {
+        // 只有领到分块时才会访问func，此时调用者仍在等待，引用有效
+        Submit(RunChunks);
+    }
+    RunChunks();
+
+    std::unique_lock<std::mutex> lock(pState->mutex);
+    pState->doneCV.wait(lock, [&] { return pState->remaining.load() == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_TaskCV.wait(lock, [this] { return m_Stop || !m_Tasks.empty(); });
+            if (m_Stop && m_Tasks.empty())
+                return;
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop();
+            ++m_ActiveTasks;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            --m_ActiveTasks;
+            if (m_Tasks.empty() && m_ActiveTasks == 0)
+                m_IdleCV.notify_all();
+        }
+    }
+}
@@ -0,0 +1,57 @@
+//***************************************************************************************
+// ThreadPool.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 简易线程池
+// Simple thread pool.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    // numThreads为0时使用(硬件线程数 - 1)，至少为1
+    explicit ThreadPool(uint32_t numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 全局共享的线程池，供并行计算使用
+    static ThreadPool& GetDefault();
+
+    void Submit(std::function<void()> task);
+    // 等待所有已提交的任务执行完毕
+    void Wait();
+
+    // 将[begin, end)按grain大小分块并行执行func(chunkBegin, chunkEnd)，调用线程也参与计算
+    // 返回时所有分块均已完成
+    void ParallelFor(uint32_t begin, uint32_t end, uint32_t grain,
+        const std::function<void(uint32_t, uint32_t)>& func);
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_Threads;
+    std::queue<std::function<void()>> m_Tasks;
+    std::mutex m_Mutex;
+    std::condition_variable m_TaskCV;
+    std::condition_variable m_IdleCV;
+    uint32_t m_ActiveTasks = 0;
+    bool m_Stop = false;
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include "TransparentQueue.h"
+#include "GameObject.h"
+#include "ModelManager.h"
+#include "CpuSort.h"
+#include "CpuTimer.h"
+#include <algorithm>
+#include <cfloat>
+
+using namespace DirectX;
+
+void TransparentQueue::Clear()
+{
+    m_Objects.clear();
+    m_Items.clear();
+    m_SortedItems.clear();
+    std::fill(std::begin(m_LayerItemCounts), std::end(m_LayerItemCounts), 0u);
+    m_Stats = Stats{};
+}
+
+void TransparentQueue::AddObject(GameObject& object, bool splitClusters)
+{
+    const Model* pModel = object.GetModel();
+    if (!pModel || !object.InFrustum())
+        return;
+
+    uint32_t objectIndex = (uint32_t)m_Objects.size();
+    m_Objects.push_back({ &object, nullptr, object.GetBoundingBox(), Layer_Back });
+
+    XMMATRIX W = object.GetTransform().GetLocalToWorldMatrixXM();
+    size_t sz = pModel->meshdatas.size();
+    for (size_t i = 0; i < sz; ++i)
+    {
+        const MeshData& meshData = pModel->meshdatas[i];
+        if (!object.IsSubModelInFrustum(i))
+            continue;
+
+        if (splitClusters && !meshData.m_Clusters.empty())
+        {
+            for (const MeshCluster& cluster : meshData.m_Clusters)
+            {
+                Item item{ objectIndex, (uint32_t)i, cluster.startIndex, cluster.indexCount };
+                XMStoreFloat3(&item.centerInWorld, XMVector3Transform(XMLoadFloat3(&cluster.boundingSphere.Center), W));
+                m_Items.push_back(item);
+            }
+        }
+        else
+        {
+            Item item{ objectIndex, (uint32_t)i, 0, meshData.m_IndexCount };
+            item.centerInWorld = object.GetBoundingBox(i).Center;
+            m_Items.push_back(item);
+        }
+    }
+}
+
+void TransparentQueue::AddCustom(const BoundingBox& boxInWorld, DrawFunc drawFunc)
+{
+    uint32_t objectIndex = (uint32_t)m_Objects.size();
+    m_Objects.push_back({ nullptr, std::move(drawFunc), boxInWorld, Layer_Back });
+    m_Items.push_back({ objectIndex, 0, 0, 0, boxInWorld.Center });
+}
+
+void XM_CALLCONV TransparentQueue::Sort(FXMMATRIX view, bool resolveIntersections)
+{
+    CpuTimer timer;
+    timer.Reset();
+    timer.Start();
+
+    size_t objectCount = m_Objects.size();
+    for (auto& obj : m_Objects)
+        obj.layer = Layer_Back;
+
+    if (resolveIntersections && objectCount > 1)
+    {
+        // 对象之间的包围盒相交时无法按对象排序
+        std::vector<bool> isOIT(objectCount);
+        for (size_t i = 0; i < objectCount; ++i)
+            for (size_t j = i + 1; j < objectCount; ++j)
+                if (m_Objects[i].boxInWorld.Intersects(m_Objects[j].boxInWorld))
+                    isOIT[i] = isOIT[j] = true;
+
+        // 计算各对象的视深度范围
+        std::vector<XMFLOAT2> depthRanges(objectCount);
+        for (size_t i = 0; i < objectCount; ++i)
+        {
+            XMFLOAT3 corners[BoundingBox::CORNER_COUNT];
+            m_Objects[i].boxInWorld.GetCorners(corners);
+            float minZ = FLT_MAX, maxZ = -FLT_MAX;
+            for (const XMFLOAT3& corner : corners)
+            {
+                float z = XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&corner), view));
+                minZ = (std::min)(minZ, z);
+                maxZ = (std::max)(maxZ, z);
+            }
+            depthRanges[i] = XMFLOAT2(minZ, maxZ);
+        }
+
+        // 深度范围与逐像素排序的物体重叠的对象也需要逐像素排序，直到不再扩大
+        float oitMinZ = FLT_MAX, oitMaxZ = -FLT_MAX;
+        for (bool changed = true; changed; )
+        {
+            changed = false;
+            for (size_t i = 0; i < objectCount; ++i)
+            {
+                if (isOIT[i])
+                {
+                    oitMinZ = (std::min)(oitMinZ, depthRanges[i].x);
+                    oitMaxZ = (std::max)(oitMaxZ, depthRanges[i].y);
+                }
+            }
+            for (size_t i = 0; i < objectCount; ++i)
+            {
+                if (!isOIT[i] && depthRanges[i].y > oitMinZ && depthRanges[i].x < oitMaxZ)
+                    isOIT[i] = changed = true;
+            }
+        }
+
+        if (oitMinZ <= oitMaxZ)
+        {
+            for (size_t i = 0; i < objectCount; ++i)
+            {
+                if (isOIT[i])
+                    m_Objects[i].layer = Layer_OIT;
+                else
+                    m_Objects[i].layer = depthRanges[i].x >= oitMaxZ ? Layer_Back : Layer_Front;
+            }
+        }
+    }
+
+    // 视深度越大越先绘制，取反后升序排序
+    uint32_t itemCount = (uint32_t)m_Items.size();
+    m_SortKeys.resize(itemCount);
+    m_SortedItems.resize(itemCount);
+    std::fill(std::begin(m_LayerItemCounts), std::end(m_LayerItemCounts), 0u);
+    for (uint32_t i = 0; i < itemCount; ++i)
+    {
+        float z = XMVectorGetZ(XMVector3TransformCoord(XMLoadFloat3(&m_Items[i].centerInWorld), view));
+        m_SortKeys[i] = ~CpuSort::FloatToKey(z);
+        m_SortedItems[i] = i;
+        ++m_LayerItemCounts[m_Objects[m_Items[i].objectIndex].layer];
+    }
+    CpuSort::RadixSort(m_SortKeys.data(), m_SortedItems.data(), itemCount);
+
+    timer.Tick();
+    timer.Stop();
+
+    m_Stats = Stats{};
+    m_Stats.objectCount = (uint32_t)objectCount;
+    m_Stats.itemCount = itemCount;
+    m_Stats.oitObjectCount = (uint32_t)std::count_if(m_Objects.begin(), m_Objects.end(),
+        [](const Object& obj) { return obj.layer == Layer_OIT; });
+    m_Stats.sortTimeMs = timer.TotalTime() * 1000.0f;
+}
+
+void TransparentQueue::Draw(ID3D11DeviceContext* deviceContext, IEffect& effect, Layer layer)
+{
+    uint32_t drawCount = 0;
+    size_t itemCount = m_SortedItems.size();
+    for (size_t i = 0; i < itemCount; )
+    {
+        const Item& item = m_Items[m_SortedItems[i]];
+        Object& obj = m_Objects[item.objectIndex];
+        ++i;
+        if (obj.layer != layer)
+            continue;
+
+        if (!obj.pObject)
+        {
+            obj.drawFunc(deviceContext, effect);
+            ++drawCount;
+            continue;
+        }
+
+        // 合并紧随其后、索引区间接在后面的同一子网格的簇，绘制顺序不变
+        uint32_t startIndex = item.startIndex, endIndex = item.startIndex + item.indexCount;
+        while (i < itemCount)
+        {
+            const Item& next = m_Items[m_SortedItems[i]];
+            if (next.objectIndex != item.objectIndex || next.subMesh != item.subMesh || next.startIndex != endIndex)
+                break;
+            endIndex += next.indexCount;
+            ++i;
+        }
+        obj.pObject->DrawSubMesh(deviceContext, effect, item.subMesh, startIndex, endIndex - startIndex);
+        ++drawCount;
+    }
+    m_Stats.drawCounts[layer] = drawCount;
+}
@@ -0,0 +1,87 @@
+//***************************************************************************************
+// TransparentQueue.h by X_Jun(MKXJun) (C) 2018-2022 All Rights Reserved.
+// Licensed under the MIT License.
+//
+// 在CPU端按视深度从后往前排序的透明物体绘制队列
+// CPU-side transparent draw queue sorted back to front by view depth.
+//***************************************************************************************
+
+#pragma once
+
+#ifndef TRANSPARENT_QUEUE_H
+#define TRANSPARENT_QUEUE_H
+
+#include "WinMin.h"
+#include <d3d11_1.h>
+#include <DirectXCollision.h>
+#include <functional>
+#include <vector>
+
+class GameObject;
+class IEffect;
+
+class TransparentQueue
+{
+public:
+    // 排序后条目所在的层，按Back、OIT、Front的顺序绘制
+    enum Layer
+    {
+        Layer_Back,     // 在所有逐像素排序的物体之后，先混合到背景上
+        Layer_OIT,      // 与其它透明物体相交，需要逐像素排序
+        Layer_Front,    // 在所有逐像素排序的物体之前，最后混合
+        Layer_Count
+    };
+
+    struct Stats
+    {
+        uint32_t objectCount = 0;           // 加入的对象数
+        uint32_t itemCount = 0;             // 参与排序的子网格或簇数
+        uint32_t oitObjectCount = 0;        // 需要逐像素排序的对象数
+        uint32_t drawCounts[Layer_Count]{}; // 各层合并相邻簇后的绘制调用数
+        float sortTimeMs = 0.0f;            // 计算深度、划分层与排序的用时
+    };
+
+    using DrawFunc = std::function<void(ID3D11DeviceContext*, IEffect&)>;
+
+    void Clear();
+    // 加入对象中在视锥体内的子网格，splitClusters为true时有簇的子网格按簇加入
+    void AddObject(GameObject& object, bool splitClusters);
+    // 加入整体绘制的对象，如需要额外设置状态的水面
+    void AddCustom(const DirectX::BoundingBox& boxInWorld, DrawFunc drawFunc);
+
+    // 按视深度从后往前排序。resolveIntersections为true时，世界包围盒互相相交的对象
+    // 以及深度范围与其重叠的对象归入Layer_OIT，否则所有条目都在Layer_Back
+    void XM_CALLCONV Sort(DirectX::FXMMATRIX view, bool resolveIntersections);
+    // 按排序结果绘制某一层，同一子网格中相邻且连续的簇合并为一次绘制
+    void Draw(ID3D11DeviceContext* deviceContext, IEffect& effect, Layer layer);
+
+    bool HasLayer(Layer layer) const { return m_LayerItemCounts[layer] > 0; }
+    const Stats& GetStats() const { return m_Stats; }
+
+private:
+    struct Object
+    {
+        GameObject* pObject;                // 为空时使用drawFunc
+        DrawFunc drawFunc;
+        DirectX::BoundingBox boxInWorld;
+        Layer layer;
+    };
+
+    struct Item
+    {
+        uint32_t objectIndex;
+        uint32_t subMesh;
+        uint32_t startIndex;                // 相对于子网格
+        uint32_t indexCount;
+        DirectX::XMFLOAT3 centerInWorld;
+    };
+
+    std::vector<Object> m_Objects;
+    std::vector<Item> m_Items;
+    std::vector<uint32_t> m_SortKeys;
+    std::vector<uint32_t> m_SortedItems;    // 从后往前的条目下标
+    uint32_t m_LayerItemCounts[Layer_Count]{};
+    Stats m_Stats;
+};
+
+#endif
@@ -16,6 +16,10 @@ rule("hlsl_shader_complier")
                 local hlsl_basename = path.basename(sourcefile_hlsl)
                 local hlsl_relative_file_name = path.relative(sourcefile_hlsl,target:scriptdir())
                 local hlsl_relative_path = path.directory(hlsl_relative_file_name)
+                -- 来自其它目录(如Common/Shaders)的着色器同样输出到Shaders
+                if hlsl_relative_path:startswith("..") then
+                    hlsl_relative_path = "Shaders"
+                end
                 local hlsl_output_path = path.join(target:targetdir() ,hlsl_relative_path)
                 if not os.isdir(hlsl_output_path) then
                     os.mkdir(hlsl_output_path)